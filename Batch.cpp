@@ -0,0 +1,490 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzer.h"
+#include "Batch.h"
+#include "CompileServer.h"
+#include "DependencyDatabase.h"
+#include "IsaStats.h"
+#include "WorkerProcess.h"
+
+#include <fstream>
+#include <chrono>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace IntelGPUCompiler;
+using namespace ServerProtocol;
+
+// how often a worker's timeout is checked, while waiting for its answer
+static const int POLL_MS = 200;
+
+//
+//  A batch manifest is a text file with one job per line.  Each line uses the same syntax as the command line, e.g:
+//
+//      -s hlsl -p ps_5_0 -f MainPS -D FOO=1 --isa out/foo_ shaders/foo.hlsl
+//      -s dxbc --api dx12 --rootsig_file rs.bin --isa out/bar_ shaders/bar.dxbc
+//
+//  Blank lines and lines beginning with '#' are ignored.  Arguments containing spaces may be double-quoted.
+//  Options given on the tool's command line are used as defaults for every job in the manifest.  A line's options replace the
+//   defaults, except for those which may be given more than once (-c, -D and --permute), which add to the command line's list.
+//   A job run with '-c Skylake' on the command line and '-c Icelake' in its line is compiled for both
+//
+//  With --incremental, jobs whose inputs and outputs haven't changed since they last succeeded are skipped.
+//
+//  With --workers, jobs are compiled by copies of the tool running as workers (see RunStream), which each load the compiler once
+//   and take one job at a time from a shared queue.  A job is sent to its worker as a COMPILE request holding the manifest line's
+//   arguments, so workers read and write files themselves, and only report messages and a status.  A compiler crash takes its
+//   worker with it, but nothing else:  the worker is replaced, and the job retried by itself in the new one.  A job which
+//   crashes that worker too is quarantined, rather than tried again.  A worker which takes longer than --worker-timeout over
+//   one job is treated as if it had crashed
+//
+//  With --coordinate, the batch is shared between machines instead.  See Coordinator.h
+//
+
+void TokenizeManifestLine( const std::string& line, std::vector<std::string>& tokens )
+{
+    size_t i = 0;
+    while ( i < line.size() )
+    {
+        while ( i < line.size() && isspace( (unsigned char)line[i] ) )
+            i++;
+        if ( i == line.size() )
+            break;
+
+        std::string token;
+        bool quoted = false;
+        while ( i < line.size() && (quoted || !isspace( (unsigned char)line[i] )) )
+        {
+            if ( line[i] == '"' )
+                quoted = !quoted;
+            else
+                token.push_back( line[i] );
+            i++;
+        }
+        tokens.push_back( std::move( token ) );
+    }
+}
+
+bool WriteBatchSummary( const char* summary_file, const std::vector<BatchResult>& results )
+{
+    FILE* fp = fopen( summary_file,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open summary file: %s\n",summary_file );
+        return false;
+    }
+
+    fprintf( fp,"line,status,api,milliseconds,input\n" );
+    for ( const BatchResult& r : results )
+    {
+        const char* status = r.up_to_date ? "up-to-date" : r.succeeded ? "ok" : r.quarantined ? "quarantined" : "failed";
+        fprintf( fp,"%zu,%s,%s,%.3f,",r.line,status,r.api.c_str(),r.milliseconds );
+        WriteCsvString( fp,r.input );
+        fputc( '\n',fp );
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write summary file: %s\n",summary_file );
+    return succeeded;
+}
+
+bool ParseManifestLine( const char* manifest_file, size_t lineNumber, std::vector<std::string>& tokens, JobOptions& job )
+{
+    std::vector<char*> argv;
+    for ( std::string& tok : tokens )
+        argv.push_back( &tok[0] );
+
+    int argc = (int)argv.size();
+    for ( int i=0; i<argc; i++ )
+    {
+        switch ( ParseJobArgument( argc,argv.data(),i,job ) )
+        {
+        case ArgResult::CONSUMED:
+            break;
+        case ArgResult::FAILED:
+            return false;
+        case ArgResult::UNKNOWN:
+            printf( "%s(%zu): Don't understand what: '%s' means\n",manifest_file,lineNumber,argv[i] );
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PrintBatchTotals( const std::vector<BatchResult>& results, bool incremental, double seconds )
+{
+    size_t nFailed = 0;
+    size_t nUpToDate = 0;
+    size_t nQuarantined = 0;
+    for ( const BatchResult& r : results )
+    {
+        if ( !r.succeeded )
+            nFailed++;
+        if ( r.up_to_date )
+            nUpToDate++;
+        if ( r.quarantined )
+            nQuarantined++;
+    }
+
+    printf( "Batch: %zu jobs, %zu succeeded",results.size(),results.size() - nFailed );
+    if ( incremental )
+        printf( " (%zu up to date)",nUpToDate );
+    printf( ", %zu failed",nFailed );
+    if ( nQuarantined )
+        printf( " (%zu quarantined)",nQuarantined );
+    printf( " in %.2fs\n",seconds );
+    return nFailed;
+}
+
+bool RunBatch( ToolContext& ctx, const JobOptions& defaults, const char* manifest_file, const char* summary_file )
+{
+    std::ifstream manifest( manifest_file );
+    if ( !manifest.good() )
+    {
+        printf( "Failed to read batch manifest: %s\n",manifest_file );
+        return false;
+    }
+
+    std::vector<BatchResult> results;
+    auto batchStart = std::chrono::high_resolution_clock::now();
+
+    std::string line;
+    size_t lineNumber = 0;
+    while ( std::getline( manifest,line ) )
+    {
+        lineNumber++;
+
+        std::vector<std::string> tokens;
+        TokenizeManifestLine( line,tokens );
+        if ( tokens.empty() || tokens[0][0] == '#' )
+            continue;
+
+        auto jobStart = std::chrono::high_resolution_clock::now();
+
+        JobOptions job = defaults;
+        bool succeeded = ParseManifestLine( manifest_file,lineNumber,tokens,job );
+
+        bool upToDate = false;
+        DependencyRecord record;
+        if ( succeeded && ctx.deps )
+            upToDate = ctx.deps->Check( job,record );
+
+        if ( succeeded && !upToDate )
+        {
+            if ( job.permute.empty() )
+                succeeded = PrepareInputs( job ) && RunJob( ctx,job );
+            else
+                succeeded = RunPermutations( ctx,job );
+            if ( ctx.deps && succeeded )
+                ctx.deps->Update( record,job );
+            else if ( ctx.deps )
+                ctx.deps->Remove( record.key );
+        }
+
+        auto jobEnd = std::chrono::high_resolution_clock::now();
+
+        BatchResult result;
+        result.line = lineNumber;
+        result.input = job.frontend.input_file ? job.frontend.input_file : "";
+        result.api = job.api;
+        result.succeeded = succeeded;
+        result.up_to_date = upToDate;
+        result.milliseconds = std::chrono::duration<double,std::milli>( jobEnd - jobStart ).count();
+        results.push_back( result );
+
+        if ( !succeeded )
+            printf( "%s(%zu): job failed: %s\n",manifest_file,lineNumber,result.input.c_str() );
+    }
+
+    auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>( batchEnd - batchStart ).count();
+    size_t nFailed = PrintBatchTotals( results,ctx.deps != nullptr,seconds );
+
+    if ( summary_file && !WriteBatchSummary( summary_file,results ) )
+        return false;
+
+    return nFailed == 0;
+}
+
+struct WorkerJob
+{
+    std::string line;                       // as written in the manifest, for the quarantine file
+    std::vector<std::string> args;          // sent to the worker.  Parsing modifies 'tokens', so these are a copy
+    std::vector<std::string> tokens;        // the job keeps pointers into these
+    JobOptions job;
+    DependencyRecord record;
+    std::vector<std::string> platforms;     // compiled by the worker, for the dependency record
+    BatchResult result;
+};
+
+// The jobs waiting for a worker.  The lock also keeps each job's messages together on the console
+class WorkerQueue
+{
+public:
+    WorkerQueue( const char* manifest_file, std::vector<WorkerJob*>&& jobs ) : m_pManifest( manifest_file ), m_Jobs( std::move( jobs ) ) {}
+
+    WorkerJob* Next()
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        return (m_nNext < m_Jobs.size()) ? m_Jobs[m_nNext++] : nullptr;
+    }
+
+    void Report( const WorkerJob& job, const std::vector<std::string>& messages, const char* note )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        for ( const std::string& message : messages )
+            printf( "%s\n",message.c_str() );
+        if ( note )
+            printf( "%s(%zu): %s: %s\n",m_pManifest,job.result.line,note,job.result.input.c_str() );
+        fflush( stdout );
+    }
+
+private:
+    const char* m_pManifest;
+    std::vector<WorkerJob*> m_Jobs;
+    size_t m_nNext = 0;
+    std::mutex m_Mutex;
+};
+
+// Sends a job to a worker, and waits for its answer.  Returns false if the worker died, stopped making sense, or took longer than
+//  'timeout' seconds before answering.  0 waits forever
+static bool CompileInWorker( WorkerProcess& worker, WorkerJob& job, double timeout, bool& succeeded, std::vector<std::string>& messages,
+                             std::string& error )
+{
+    Message request( MessageType::COMPILE );
+    for ( const std::string& arg : job.args )
+        request.AddField( Field::ARGUMENT,arg.data(),arg.size() );
+    if ( !request.Send( worker ) )
+    {
+        error = worker.GetError();
+        return false;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>( timeout );
+    size_t maxSize = ServerOptions().max_request;
+    for ( ;; )
+    {
+        // a hung compiler is as lost as a crashed one
+        while ( timeout > 0 && !worker.Poll( POLL_MS ) )
+        {
+            if ( std::chrono::steady_clock::now() >= deadline )
+            {
+                char seconds[32];
+                snprintf( seconds,sizeof( seconds ),"%g",timeout );
+                error = "no answer after " + std::string( seconds ) + " seconds";
+                return false;
+            }
+        }
+
+        Message reply;
+        if ( !reply.Receive( worker,maxSize,error ) )
+            return false;
+
+        size_t offset = 0;
+        Field tag;
+        const uint8_t* data;
+        uint32_t size;
+        while ( reply.NextField( offset,tag,data,size ) )
+        {
+            if ( reply.GetType() == MessageType::ERROR_TEXT && tag == Field::TEXT )
+                messages.emplace_back( (const char*)data,size );
+            else if ( reply.GetType() == MessageType::DONE && tag == Field::STATUS && size == sizeof( uint32_t ) )
+            {
+                uint32_t status;
+                memcpy( &status,data,sizeof( status ) );
+                succeeded = (status == 0);
+            }
+            else if ( reply.GetType() == MessageType::DONE && tag == Field::PLATFORM )
+                job.platforms.emplace_back( (const char*)data,size );
+        }
+
+        if ( reply.GetType() == MessageType::DONE )
+            return true;
+    }
+}
+
+// Runs one worker process, and feeds it jobs until there are none left
+static void ServeWorker( WorkerQueue& queue, const WorkerOptions& opts, const std::vector<std::string>& args )
+{
+    WorkerProcess worker;
+    while ( WorkerJob* job = queue.Next() )
+    {
+        auto jobStart = std::chrono::high_resolution_clock::now();
+
+        // a job gets two workers to itself.  If it kills both, it is the job's fault, not bad luck
+        bool succeeded = false;
+        bool answered = false;
+        std::vector<std::string> messages;
+        for ( int attempt = 0; attempt < 2 && !answered; attempt++ )
+        {
+            if ( !worker.IsRunning() && !worker.Start( opts.executable,args ) )
+            {
+                messages.push_back( worker.GetError() );
+                break;
+            }
+
+            job->platforms.clear();
+            std::string error;
+            answered = CompileInWorker( worker,*job,opts.job_timeout,succeeded,messages,error );
+            if ( !answered )
+            {
+                std::string ending = worker.Reap();
+                if ( error != "Connection closed" )
+                    ending = error + ", " + ending;
+
+                job->result.quarantined = (attempt == 1);
+                std::string note = "worker lost (" + ending + (job->result.quarantined ? "), quarantined" : "), retrying");
+                queue.Report( *job,messages,note.c_str() );
+                messages.clear();
+            }
+        }
+
+        auto jobEnd = std::chrono::high_resolution_clock::now();
+        job->result.succeeded = answered && succeeded;
+        job->result.milliseconds = std::chrono::duration<double,std::milli>( jobEnd - jobStart ).count();
+
+        if ( answered || !messages.empty() )
+            queue.Report( *job,messages,job->result.succeeded ? nullptr : "job failed" );
+    }
+
+    if ( worker.IsRunning() )
+        worker.Stop();
+}
+
+static bool WriteQuarantine( const char* quarantine_file, const char* manifest_file, const std::vector< std::unique_ptr<WorkerJob> >& jobs )
+{
+    FILE* fp = fopen( quarantine_file,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open quarantine file: %s\n",quarantine_file );
+        return false;
+    }
+
+    fprintf( fp,"# jobs from %s which crashed or hung the compiler\n",manifest_file );
+    for ( const std::unique_ptr<WorkerJob>& job : jobs )
+    {
+        if ( job->result.quarantined )
+            fprintf( fp,"%s\n",job->line.c_str() );
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write quarantine file: %s\n",quarantine_file );
+    return succeeded;
+}
+
+bool RunBatchInWorkers( const JobOptions& defaults, DependencyDatabase* deps, const char* manifest_file, const char* summary_file,
+                        const WorkerOptions& opts )
+{
+    std::ifstream manifest( manifest_file );
+    if ( !manifest.good() )
+    {
+        printf( "Failed to read batch manifest: %s\n",manifest_file );
+        return false;
+    }
+
+    auto batchStart = std::chrono::high_resolution_clock::now();
+
+    // jobs are parsed and checked here, so that workers are only sent jobs which need compiling.  Each job is allocated
+    //  separately, because it points into its own tokens
+    std::vector< std::unique_ptr<WorkerJob> > jobs;
+    std::vector<WorkerJob*> pending;
+    std::string line;
+    size_t lineNumber = 0;
+    while ( std::getline( manifest,line ) )
+    {
+        lineNumber++;
+
+        std::unique_ptr<WorkerJob> job( new WorkerJob() );
+        TokenizeManifestLine( line,job->tokens );
+        if ( job->tokens.empty() || job->tokens[0][0] == '#' )
+            continue;
+
+        job->line = line;
+        job->args = job->tokens;
+        job->job = defaults;
+        bool parsed = ParseManifestLine( manifest_file,lineNumber,job->tokens,job->job );
+
+        BatchResult& result = job->result;
+        result.line = lineNumber;
+        result.input = job->job.frontend.input_file ? job->job.frontend.input_file : "";
+        result.api = job->job.api;
+        result.succeeded = parsed;
+        result.up_to_date = parsed && deps && deps->Check( job->job,job->record );
+        result.milliseconds = 0;
+
+        if ( !parsed )
+            printf( "%s(%zu): job failed: %s\n",manifest_file,lineNumber,result.input.c_str() );
+        else if ( !result.up_to_date )
+            pending.push_back( job.get() );
+        jobs.push_back( std::move( job ) );
+    }
+
+    size_t nWorkers = std::min( opts.count,pending.size() );
+    WorkerQueue queue( manifest_file,std::move( pending ) );
+
+    std::vector<std::string> args = opts.args;
+    args.push_back( "--worker" );
+
+    std::vector<std::thread> threads;
+    for ( size_t i=0; i<nWorkers; i++ )
+        threads.emplace_back( [&queue,&opts,&args]() { ServeWorker( queue,opts,args ); } );
+    for ( std::thread& thread : threads )
+        thread.join();
+
+    auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    // the workers wrote the outputs, and said which platforms they were for
+    std::vector<BatchResult> results;
+    for ( std::unique_ptr<WorkerJob>& job : jobs )
+    {
+        if ( deps && !job->result.up_to_date && job->result.succeeded )
+        {
+            job->job.inputs.asics.clear();
+            for ( const std::string& platform : job->platforms )
+            {
+                PlatformInfo info = {};
+                info.platformName = platform.c_str();
+                job->job.inputs.asics.push_back( info );
+            }
+            deps->Update( job->record,job->job );
+        }
+        else if ( deps && !job->result.up_to_date )
+        {
+            deps->Remove( job->record.key );
+        }
+        results.push_back( job->result );
+    }
+
+    double seconds = std::chrono::duration<double>( batchEnd - batchStart ).count();
+    size_t nFailed = PrintBatchTotals( results,deps != nullptr,seconds );
+
+    // the quarantine is the only record of which jobs crashed, so it is written even if the summary can't be
+    bool written = !summary_file || WriteBatchSummary( summary_file,results );
+    if ( opts.quarantine_file && !WriteQuarantine( opts.quarantine_file,manifest_file,jobs ) )
+        written = false;
+
+    return written && nFailed == 0;
+}
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _BATCH_H_
+#define _BATCH_H_
+
+#include <string>
+#include <vector>
+
+struct JobOptions;
+
+//
+//  Manifest parsing and reporting, shared by the ways a batch may be run:  in this process, in worker processes, or by a
+//   coordinator and its remote workers.  The manifest format is described in Batch.cpp
+//
+
+struct BatchResult
+{
+    size_t line;
+    std::string input;
+    std::string api;
+    bool succeeded;
+    bool up_to_date;
+    bool quarantined = false;
+    double milliseconds;
+};
+
+// Splits a line into arguments.  Arguments containing spaces may be double-quoted
+void TokenizeManifestLine( const std::string& line, std::vector<std::string>& tokens );
+
+// Applies one line's arguments to a job.  Job options keep pointers into the token strings, so the tokens must outlive the job,
+//   and some are modified
+bool ParseManifestLine( const char* manifest_file, size_t lineNumber, std::vector<std::string>& tokens, JobOptions& job );
+
+// Prints the batch's totals, and returns the number of jobs which failed
+size_t PrintBatchTotals( const std::vector<BatchResult>& results, bool incremental, double seconds );
+
+// Writes a CSV file with a line for each job
+bool WriteBatchSummary( const char* summary_file, const std::vector<BatchResult>& results );
+
+#endif
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "ByteStream.h"
+
+bool FileStream::Read( void* data, size_t size )
+{
+    if ( !m_pIn )
+    {
+        m_Error = "Stream is not readable";
+        return false;
+    }
+
+    size_t n = fread( data,1,size,m_pIn );
+    if ( n < size )
+    {
+        if ( ferror( m_pIn ) )
+            m_Error = "Read failed";
+        else
+            m_Error = (n == 0) ? "Connection closed" : "Unexpected end of input";
+        return false;
+    }
+    return true;
+}
+
+bool FileStream::Write( const void* data, size_t size )
+{
+    if ( !m_pOut )
+    {
+        m_Error = "Stream is not writable";
+        return false;
+    }
+
+    if ( fwrite( data,1,size,m_pOut ) != size || fflush( m_pOut ) != 0 )
+    {
+        m_Error = "Write failed";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _BYTE_STREAM_H_
+#define _BYTE_STREAM_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+//
+//  Anything the compile server's messages can travel over:  a socket, or a pair of standard streams.
+//    Reads and writes block, and always transfer the whole buffer
+//
+class ByteStream
+{
+public:
+    virtual ~ByteStream() {}
+
+    // False on error, or if the other end closed the stream first.  The error is "Connection closed" if it did so before sending
+    //  any of the data, and "Unexpected end of input" if part way through it
+    virtual bool Read( void* data, size_t size ) = 0;
+    virtual bool Write( const void* data, size_t size ) = 0;
+
+    virtual const std::string& GetError() const = 0;
+};
+
+// Reads from one file and writes to another, e.g. stdin and stdout.  The files are not closed.  Writes are flushed at once,
+//   so that whoever is reading sees each message as soon as it is sent
+class FileStream : public ByteStream
+{
+public:
+    FileStream( FILE* in, FILE* out ) : m_pIn( in ), m_pOut( out ) {}
+
+    virtual bool Read( void* data, size_t size ) override;
+    virtual bool Write( const void* data, size_t size ) override;
+
+    virtual const std::string& GetError() const override { return m_Error; }
+
+private:
+    FILE* m_pIn;
+    FILE* m_pOut;
+    std::string m_Error;
+};
+
+#endif
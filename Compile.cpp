@@ -0,0 +1,603 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzer.h"
+#include "ShaderAPI.h"
+#include "CompilerContextPool.h"
+#include "IsaCache.h"
+#include "DXBCContainer.h"
+#include "IsaArchive.h"
+#include "IsaParser.h"
+#include "IsaBinary.h"
+#include "IsaStats.h"
+#include "IsaCFG.h"
+#include "CycleModel.h"
+#include "Permutations.h"
+#include "RootSignature.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdarg>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+using namespace IntelGPUCompiler;
+
+//
+//  The compile pipeline:  prepares a job's inputs, compiles them for each platform, and delivers the results.
+//    Nothing here reads global state, so any number of jobs may run at once, with the same or different contexts.
+//    Messages go to the job's log, and results to the context's sink, archive, or .asm files
+//
+
+void LogMessage( const ToolInputs& opts, const char* format, ... )
+{
+    va_list args;
+    va_start( args,format );
+    va_list sizeArgs;
+    va_copy( sizeArgs,args );
+    int length = vsnprintf( nullptr,0,format,sizeArgs );
+    va_end( sizeArgs );
+
+    std::string message( (size_t)std::max( length,0 ),'\0' );
+    if ( length > 0 )
+        vsnprintf( &message[0],message.size() + 1,format,args );
+    va_end( args );
+
+    if ( opts.log )
+        opts.log->Write( message );
+    else
+        printf( "%s\n",message.c_str() );
+}
+
+bool GetRootSignatureFromDXBC( ToolInputs& inputs )
+{
+    DXBCContainer container;
+    if ( !container.Parse( inputs.bytecode.data(),inputs.bytecode.size() ) )
+    {
+        LogMessage( inputs,"Invalid shader container: %s",container.GetError() );
+        return false;
+    }
+
+    // the compiler expects the root signature in a container of its own, the same as D3DGetBlobPart returns it
+    ByteSpan rootsig;
+    if ( container.FindPart( DXBCPart::RTS0,rootsig ) )
+    {
+        uint32_t fourcc = DXBCPart::RTS0;
+        std::vector<uint8_t> rootsigContainer;
+        BuildDXBCContainer( &fourcc,&rootsig,1,rootsigContainer );
+        inputs.rootsig.Assign( std::move( rootsigContainer ) );
+    }
+
+    return true;
+}
+
+static bool WriteIsaFile( ToolInputs& opts, const PlatformInfo& platform, const void* isa, size_t isaLength, bool binary, std::string& error )
+{
+    std::stringstream isaFile;
+    if ( opts.isa_prefix )
+        isaFile << opts.isa_prefix;
+
+    isaFile << platform.platformName << (binary ? ".bin" : ".asm");
+
+    std::string isaFileName = isaFile.str();
+
+    FILE* fp = fopen( isaFileName.c_str(), binary ? "wb" : "w" );
+    if ( !fp )
+    {
+        error = "Failed to open output file: " + isaFileName;
+        return false;
+    }
+
+    fwrite( isa,1,isaLength,fp );
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        error = "Failed to write output file: " + isaFileName;
+    return succeeded;
+}
+
+// Spans for one platform's result are labelled with the shader, API and platform
+static TraceLabel MakeTraceLabel( ToolInputs& opts, API& api, const PlatformInfo& platform )
+{
+    return TraceLabel{ opts.trace,opts.shader_id,api.GetName(),platform.platformName };
+}
+
+static bool WriteResult( ToolContext& ctx, ToolInputs& opts, API& api, const PlatformInfo& platform, const char* isaText, size_t isaLength,
+                         const void* pBinary, size_t binarySize, std::string& error )
+{
+    TraceScope scope( MakeTraceLabel( opts,api,platform ),TraceStage::WRITE_OUTPUT );
+
+    if ( ctx.sink )
+    {
+        if ( !ctx.sink->WriteIsa( platform.platformName,isaText,isaLength,pBinary,binarySize ) )
+        {
+            error = "Failed to send result for: " + std::string( platform.platformName );
+            return false;
+        }
+        return true;
+    }
+
+    if ( ctx.archive )
+    {
+        bool appended = opts.isa_binary ? 
+            ctx.archive->Append( opts.shader_id,api.GetName(),platform.platformName,pBinary,binarySize,IsaArchiveFormat::BINARY ) :
+            ctx.archive->Append( opts.shader_id,api.GetName(),platform.platformName,isaText,isaLength,IsaArchiveFormat::TEXT );
+        if ( !appended )
+        {
+            error = "Failed to write archive entry for: " + std::string( opts.shader_id );
+            return false;
+        }
+        return true;
+    }
+
+    if ( opts.isa_binary )
+        return WriteIsaFile( opts,platform,pBinary,binarySize,true,error );
+    return WriteIsaFile( opts,platform,isaText,isaLength,false,error );
+}
+
+// What happened to one platform.  Collected per platform, and reported in platform order once every platform is done
+struct PlatformResult
+{
+    std::string error;
+    bool finished = false;
+    bool analyzed = false;
+    IsaStats stats;
+};
+
+static bool WriteCfgFile( ToolInputs& opts, const PlatformInfo& platform, const IsaProgram& program, const IsaCFG& cfg,
+                          const CycleEstimate& estimate, unsigned loopTrips, std::string& error )
+{
+    std::stringstream cfgFile;
+    if ( opts.isa_prefix )
+        cfgFile << opts.isa_prefix;
+
+    cfgFile << platform.platformName << ".cfg";
+
+    std::string cfgFileName = cfgFile.str();
+
+    FILE* fp = fopen( cfgFileName.c_str(), "w" );
+    if ( !fp )
+    {
+        error = "Failed to open output file: " + cfgFileName;
+        return false;
+    }
+
+    const std::vector<IsaBlock>& blocks = cfg.GetBlocks();
+    const std::vector<IsaInstruction>& instructions = program.GetInstructions();
+
+    fprintf( fp,"// %zu blocks, %u loops, %llu cycles straight-line, %.0f cycles with %u trips per loop\n",
+             blocks.size(),cfg.GetLoopCount(),(unsigned long long)estimate.straightLine,estimate.total,loopTrips );
+    fprintf( fp,"// block  line  instructions  depth  cycles  weighted  successors\n" );
+    for ( size_t b=0; b<blocks.size(); b++ )
+    {
+        const IsaBlock& block = blocks[b];
+        fprintf( fp,"B%-6zu  %-4u  %-12u  %-5u  %-6llu  %-8.0f ",b,instructions[block.first].line,block.count,
+                 (unsigned)block.loopDepth,(unsigned long long)estimate.blockCycles[b],
+                 (double)estimate.blockCycles[b] * estimate.blockWeights[b] );
+        for ( uint8_t s=0; s<block.nSucc; s++ )
+            fprintf( fp," B%u",block.succ[s] );
+        fprintf( fp,"\n" );
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        error = "Failed to write output file: " + cfgFileName;
+    return succeeded;
+}
+
+// Either the text or the binary may be missing.  Statistics come from whichever is present, and from both if they are
+static bool AnalyzeResult( ToolContext& ctx, ToolInputs& opts, API& api, const PlatformInfo& platform, const char* isaText, size_t isaLength,
+                           const void* pBinary, size_t binarySize, PlatformResult& result )
+{
+    if ( !ctx.stats && !opts.write_cfg )
+        return true;
+
+    TraceScope scope( MakeTraceLabel( opts,api,platform ),TraceStage::ANALYZE );
+
+    // each thread keeps its tables between shaders
+    thread_local IsaProgram program;
+    thread_local IsaCFG cfg;
+    thread_local CycleEstimate estimate;
+    thread_local IsaBinary binary;
+    if ( isaText )
+    {
+        program.Parse( isaText,isaLength );
+        cfg.Build( program );
+        EstimateCycles( program,cfg,platform.Identifier,ctx.loop_trips,estimate );
+
+        ComputeIsaStats( program,result.stats );
+        result.stats.basic_blocks = (uint32_t)cfg.GetBlocks().size();
+        result.stats.loops = cfg.GetLoopCount();
+        result.stats.max_loop_depth = cfg.GetMaxLoopDepth();
+        result.stats.est_cycles = (uint64_t)std::llround( estimate.total );
+        result.analyzed = true;
+    }
+
+    if ( pBinary && ctx.stats )
+    {
+        if ( !binary.Decode( pBinary,binarySize ) )
+        {
+            result.error = "Invalid ISA binary for " + std::string( platform.platformName ) + ": " + binary.GetError();
+            return false;
+        }
+
+        if ( isaText )
+            ComputeEncodingStats( binary,result.stats );
+        else
+            ComputeIsaStats( binary,result.stats );
+        result.analyzed = true;
+    }
+
+    if ( opts.write_cfg && isaText )
+        return WriteCfgFile( opts,platform,program,cfg,estimate,ctx.loop_trips,result.error );
+    return true;
+}
+
+// Compiles the shader for one platform.  Errors are returned rather than printed, so that they can be reported in a
+//  deterministic order when several platforms are compiled at once
+static bool CompileForPlatform( ToolContext& ctx, ToolInputs& opts, API& api, const PlatformInfo& platform, const Hash128& inputHash,
+                                std::mutex* pBackendMutex, PlatformResult& result )
+{
+    std::string& error = result.error;
+    TraceLabel trace = MakeTraceLabel( opts,api,platform );
+
+    CompilerContextPool& pool = *ctx.pool;
+    SFunctionTable& functionTable = pool.GetFunctionTable();
+
+    // the text is only fetched when the result is text, or when something needs to read it
+    bool needText = !opts.isa_binary || opts.write_cfg;
+    bool needBinary = opts.isa_binary || opts.want_binary;
+
+    // so does a program which an earlier permutation of the job compiled to
+    if ( ctx.programs )
+    {
+        std::shared_ptr<const ProgramMemo::Result> program = ctx.programs->Lookup( inputHash,api.GetName(),(int)platform.Identifier );
+        if ( program )
+        {
+            const char* isaText = needText ? program->text.data() : nullptr;
+            size_t isaLength = needText ? program->text.size() : 0;
+            const void* pBinary = needBinary ? program->binary.data() : nullptr;
+            size_t binarySize = needBinary ? program->binary.size() : 0;
+            if ( !AnalyzeResult( ctx,opts,api,platform,isaText,isaLength,pBinary,binarySize,result ) )
+                return false;
+            if ( opts.isa_binary )
+                return WriteResult( ctx,opts,api,platform,nullptr,0,pBinary,binarySize,error );
+            return WriteResult( ctx,opts,api,platform,isaText,isaLength,pBinary,binarySize,error );
+        }
+    }
+
+    // a cache hit skips the compiler entirely.  An entry holds the result's format only, so jobs which need both always compile
+    Hash128 cacheKey;
+    bool useCache = ctx.cache && (opts.isa_binary ? !needText : !needBinary);
+    if ( useCache )
+    {
+        cacheKey = ctx.cache->MakeKey( inputHash,api.GetName(),(int)platform.Identifier,opts.isa_binary );
+
+        std::vector<char> cachedIsa;
+        bool hit;
+        {
+            TraceScope scope( trace,TraceStage::CACHE_LOOKUP );
+            hit = ctx.cache->Lookup( cacheKey,cachedIsa );
+        }
+        if ( hit )
+        {
+            if ( opts.isa_binary )
+            {
+                return AnalyzeResult( ctx,opts,api,platform,nullptr,0,cachedIsa.data(),cachedIsa.size(),result ) &&
+                       WriteResult( ctx,opts,api,platform,nullptr,0,cachedIsa.data(),cachedIsa.size(),error );
+            }
+            return AnalyzeResult( ctx,opts,api,platform,cachedIsa.data(),cachedIsa.size(),nullptr,0,result ) &&
+                   WriteResult( ctx,opts,api,platform,cachedIsa.data(),cachedIsa.size(),nullptr,0,error );
+        }
+    }
+
+    /// lease a compiler context
+    OpaqueCompiler pCompiler;
+    if ( !pool.Lease( api,platform.Identifier,pBackendMutex,pCompiler,error,trace ) )
+        return false;
+
+    bool succeeded = false;
+    OpaqueShader output;
+    bool created;
+    {
+        BackendLock lock( pBackendMutex );
+        TraceScope scope( trace,TraceStage::CREATE_SHADER );
+        created = api.CreateShader( functionTable, pCompiler, output, opts );
+        if ( !created )
+            error = std::string( "ERROR: " ) + functionTable.interface1.pfnGetLastError(  );
+    }
+
+    if( created )
+    {
+        size_t isaSize = 0;
+        const char* isaText = nullptr;
+        size_t binarySize = 0;
+        const void* pBinary = nullptr;
+        bool fetched;
+        {
+            BackendLock lock( pBackendMutex );
+            TraceScope scope( trace,TraceStage::GET_ISA );
+            if ( needText )
+                isaText = functionTable.interface1.pfnGetIsaText( output,isaSize );
+            if ( needBinary && (isaText || !needText) )
+                pBinary = functionTable.interface1.pfnGetIsaBinary( output,binarySize );
+            fetched = (isaText || !needText) && (pBinary || !needBinary);
+            if ( !fetched )
+                error = std::string( "ERROR: " ) + functionTable.interface1.pfnGetLastError(  );
+        }
+
+        if ( fetched )
+        {
+            size_t isaLength = isaText ? strnlen( isaText,isaSize ) : 0;
+            succeeded = AnalyzeResult( ctx,opts,api,platform,isaText,isaLength,pBinary,binarySize,result );
+            if ( opts.isa_binary )
+                succeeded = succeeded && WriteResult( ctx,opts,api,platform,nullptr,0,pBinary,binarySize,error );
+            else
+                succeeded = succeeded && WriteResult( ctx,opts,api,platform,isaText,isaLength,pBinary,binarySize,error );
+
+            if ( succeeded && ctx.programs )
+                ctx.programs->Store( inputHash,api.GetName(),(int)platform.Identifier,isaText,isaLength,pBinary,binarySize );
+
+            if ( succeeded && useCache )
+            {
+                if ( opts.isa_binary )
+                    ctx.cache->Store( cacheKey,(const char*)pBinary,binarySize );
+                else
+                    ctx.cache->Store( cacheKey,isaText,isaLength );
+            }
+        }
+
+        /// free up memory
+        BackendLock lock( pBackendMutex );
+        api.DeleteShader( functionTable,output );
+    }
+
+    // a context which just failed to compile is not trusted for re-use
+    if ( created )
+        pool.Return( api,platform.Identifier,pBackendMutex,pCompiler );
+    else
+        pool.Discard( api,pBackendMutex,pCompiler );
+
+    return succeeded;
+}
+
+bool RunTool( ToolContext& ctx, ToolInputs& opts, API& api )
+{
+    if ( !api.CanRun( opts ) )
+        return false;
+
+    // hash the inputs once.  Each platform's cache key is derived from this
+    Hash128 inputHash;
+    if ( ctx.cache || ctx.programs )
+        inputHash = HashProgram( opts );
+
+    size_t nPlatforms = opts.asics.size();
+    size_t nThreads = opts.threads ? opts.threads : std::thread::hardware_concurrency();
+    nThreads = std::max<size_t>( 1,std::min( nThreads,nPlatforms ) );
+
+    std::mutex* pBackendMutex = opts.serialize_backend ? &ctx.pool->GetBackendMutex() : nullptr;
+
+    // each worker pulls the next platform off the list.  After a failure no new platforms are started, 
+    //   which matches the old behavior of stopping at the first error, unless the caller wants every platform's result
+    std::vector<PlatformResult> results( nPlatforms );
+    std::atomic<size_t> nextPlatform( 0 );
+    std::atomic<bool> failed( false );
+
+    auto worker = [&]()
+    {
+        while ( opts.compile_all || !failed )
+        {
+            size_t i = nextPlatform++;
+            if ( i >= nPlatforms )
+                break;
+
+            if ( !CompileForPlatform( ctx,opts,api,opts.asics[i],inputHash,pBackendMutex,results[i] ) )
+                failed = true;
+            results[i].finished = true;
+        }
+    };
+
+    if ( nThreads == 1 )
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        for ( size_t i=0; i<nThreads; i++ )
+            threads.emplace_back( worker );
+        for ( std::thread& t : threads )
+            t.join();
+    }
+
+    // report errors and statistics in platform order, so output doesn't depend on scheduling
+    for ( size_t i=0; i<nPlatforms; i++ )
+    {
+        if ( results[i].finished && !results[i].error.empty() )
+            LogMessage( opts,"%s",results[i].error.c_str() );
+        if ( ctx.stats && results[i].analyzed && results[i].error.empty() )
+            ctx.stats->Add( opts.shader_id,api.GetName(),opts.asics[i].platformName,results[i].stats );
+    }
+
+    return !failed;
+}
+
+API* GetAPI( const char* name )
+{
+    static API_DX11 dx11;
+    static API_DX12 dx12;
+
+    if ( _stricmp( name,"dx11" ) == 0 )
+        return &dx11;
+    if ( _stricmp( name,"dx12" ) == 0 )
+        return &dx12;
+    return nullptr;
+}
+
+void GetAsicList( SFunctionTable& functionTable, std::vector< IntelGPUCompiler::PlatformInfo >& asics )
+{    
+    size_t nPlatforms = functionTable.interface1.pfnEnumPlatforms( nullptr,0 );
+    asics.resize( nPlatforms );
+    functionTable.interface1.pfnEnumPlatforms( asics.data(),nPlatforms );   
+}
+
+bool PrepareInputs( JobOptions& job )
+{
+    FrontendOptions& frontend_opts = job.frontend;
+    ToolInputs& opts = job.inputs;
+
+    if ( frontend_opts.input_file == nullptr )
+    {
+        LogMessage( opts,"No input filename" );
+        return false;
+    }
+
+    // RunPermutations prepares each permutation separately
+    if ( !job.permute.empty() )
+    {
+        LogMessage( opts,"--permute is only supported on the command line and in batches" );
+        return false;
+    }
+
+    if ( opts.shader_id == nullptr )
+        opts.shader_id = frontend_opts.input_file;
+
+    TraceLabel trace{ opts.trace,opts.shader_id };
+
+    if ( _stricmp( job.source_lang,"hlsl" ) == 0 )
+    {
+        bool loaded;
+        {
+            TraceScope scope( trace,TraceStage::READ_INPUT );
+            loaded = !frontend_opts.input_text.empty() || frontend_opts.input_text.Load( frontend_opts.input_file );
+        }
+        if ( !loaded )
+        {
+            LogMessage( opts,"Failed to read source from: %s",frontend_opts.input_file );
+            return false;
+        }
+
+        if ( frontend_opts.profile == nullptr )
+        {
+            LogMessage( opts,"Missing --profile" );
+            return false;
+        }
+
+        if ( !CompileHLSL( frontend_opts, opts ) )
+            return false;
+    }
+    else if ( _stricmp( job.source_lang,"dxbc" ) == 0 )
+    {
+        // load bytecode, unless the caller already has it
+        bool loaded;
+        {
+            TraceScope scope( trace,TraceStage::READ_INPUT );
+            loaded = !opts.bytecode.empty() || opts.bytecode.Load( frontend_opts.input_file );
+        }
+        if ( !loaded )
+        {
+            LogMessage( opts,"Unable to load bytecode from: %s",frontend_opts.input_file );
+            return false;
+        }
+
+        // try to extract a root signature
+        if( opts.rootsig.empty() )
+        {
+            TraceScope scope( trace,TraceStage::EXTRACT_ROOTSIG );
+            if( !GetRootSignatureFromDXBC( opts ) )
+            {
+                // failure here indicates a malformed shader container
+                // Simply not having a root signature is considered success here...
+                return false;
+            }
+        }
+    }
+    else
+    {
+        LogMessage( opts,"Source language: '%s' not recognized",job.source_lang );
+        return false;
+    }
+
+    // load root signature if we're missing one
+    if ( opts.rootsig.empty() )
+    {
+        if ( job.rootsig_file != nullptr )
+        {
+            bool loaded;
+            {
+                TraceScope scope( trace,TraceStage::READ_INPUT );
+                loaded = opts.rootsig.Load( job.rootsig_file );
+            }
+            if ( !loaded )
+            {
+                LogMessage( opts,"Unable to load root signature from: %s",job.rootsig_file );
+                return false;
+            }
+
+            // anything that isn't a compiled root signature is taken to be one written in HLSL
+            if ( !IsDXBCContainer( opts.rootsig.data(),opts.rootsig.size() ) )
+            {
+                TraceScope scope( trace,TraceStage::COMPILE_ROOTSIG );
+                std::vector<uint8_t> container;
+                std::string error;
+                if ( !CompileRootSignatureSource( frontend_opts,job.rootsig_file,opts.rootsig.data(),opts.rootsig.size(),container,error ) )
+                {
+                    LogMessage( opts,"%s",error.c_str() );
+                    return false;
+                }
+                opts.rootsig.Assign( std::move( container ) );
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RunJob( ToolContext& ctx, JobOptions& job )
+{
+    ToolInputs& opts = job.inputs;
+
+    // filter asic list down to the ones we've been asked to use.  By default use all of them
+    opts.asics.clear();
+    for ( const PlatformInfo& asic : ctx.asics )
+    {
+        if ( job.asicNames.empty() )
+        {
+            opts.asics.push_back( asic );
+            continue;
+        }
+
+        for ( const char* name : job.asicNames )
+            if ( _stricmp( name,asic.platformName ) == 0 )
+                opts.asics.push_back( asic );
+    }
+
+    // run the tool
+    API* api = GetAPI( job.api );
+    if ( !api )
+    {
+        LogMessage( opts,"Unrecognized API: %s",job.api );
+        return false;
+    }
+
+    return RunTool( ctx, opts, *api );
+}
@@ -0,0 +1,815 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzer.h"
+#include "CompileServer.h"
+#include "CompilerContextPool.h"
+#include "IsaCache.h"
+#include "Socket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace ServerProtocol;
+
+namespace
+{
+    struct MessageHeader
+    {
+        uint32_t magic;
+        uint32_t type;
+        uint32_t size;
+    };
+
+    struct FieldHeader
+    {
+        uint32_t tag;
+        uint32_t size;
+    };
+
+    // how long blocking waits sleep before checking for shutdown
+    const int POLL_MS = 200;
+
+    // how often an idle server checks the ISA cache's size.  Trimming may mean scanning the whole cache
+    const double CACHE_TRIM_SECONDS = 60;
+
+    // how long a worker keeps trying to reach its coordinator
+    const int COORDINATOR_WAIT_MS = 60000;
+
+    // set by SIGINT and SIGTERM
+    volatile std::sig_atomic_t g_bInterrupted = 0;
+
+    void OnInterrupt( int )
+    {
+        g_bInterrupted = 1;
+    }
+}
+
+void ServerProtocol::Message::AddField( Field tag, const void* data, size_t size )
+{
+    FieldHeader field = { (uint32_t)tag,(uint32_t)size };
+    const uint8_t* pField = (const uint8_t*)&field;
+    m_Payload.insert( m_Payload.end(),pField,pField + sizeof( field ) );
+    m_Payload.insert( m_Payload.end(),(const uint8_t*)data,(const uint8_t*)data + size );
+}
+
+void ServerProtocol::Message::AddString( Field tag, const char* str )
+{
+    AddField( tag,str,strlen( str ) );
+}
+
+void ServerProtocol::Message::AddUint( Field tag, uint32_t value )
+{
+    AddField( tag,&value,sizeof( value ) );
+}
+
+bool ServerProtocol::Message::NextField( size_t& offset, Field& tag, const uint8_t*& data, uint32_t& size ) const
+{
+    FieldHeader field;
+    if ( m_Payload.size() - offset < sizeof( field ) )
+        return false;
+    memcpy( &field,m_Payload.data() + offset,sizeof( field ) );
+    if ( m_Payload.size() - offset - sizeof( field ) < field.size )
+        return false;
+
+    tag = (Field)field.tag;
+    size = field.size;
+    data = m_Payload.data() + offset + sizeof( field );
+    offset += sizeof( field ) + field.size;
+    return true;
+}
+
+bool ServerProtocol::Message::Send( ByteStream& stream ) const
+{
+    MessageHeader header = { MAGIC,(uint32_t)m_Type,(uint32_t)m_Payload.size() };
+    return stream.Write( &header,sizeof( header ) ) && stream.Write( m_Payload.data(),m_Payload.size() );
+}
+
+bool ServerProtocol::Message::Receive( ByteStream& stream, size_t maxSize, std::string& error )
+{
+    MessageHeader header;
+    if ( !stream.Read( &header,sizeof( header ) ) )
+    {
+        error = stream.GetError();
+        return false;
+    }
+    if ( header.magic != MAGIC )
+    {
+        error = "Malformed message";
+        return false;
+    }
+    if ( header.size > maxSize )
+    {
+        error = "Message too large: " + std::to_string( header.size ) + " bytes";
+        return false;
+    }
+
+    // the stream may only end between messages, so once there is a header, there has to be a payload
+    m_Type = (MessageType)header.type;
+    m_Payload.resize( header.size );
+    if ( !stream.Read( m_Payload.data(),m_Payload.size() ) )
+    {
+        error = stream.GetError();
+        if ( error == "Connection closed" )
+            error = "Unexpected end of input";
+        return false;
+    }
+    return true;
+}
+
+bool ServerProtocol::IsSafePlatformName( const std::string& platform )
+{
+    if ( platform.empty() || platform.find( ".." ) != std::string::npos )
+        return false;
+    for ( char c : platform )
+    {
+        if ( c == '/' || c == '\\' || c == ':' || (unsigned char)c < 0x20 )
+            return false;
+    }
+    return true;
+}
+
+// Limits the number of requests compiled at once.  Connections beyond the limit wait, and stop reading from their clients
+class JobLimiter
+{
+public:
+    JobLimiter( size_t maxJobs ) : m_nFree( maxJobs ) {}
+
+    void Acquire()
+    {
+        std::unique_lock<std::mutex> lock( m_Mutex );
+        m_Available.wait( lock,[this]() { return m_nFree > 0; } );
+        m_nFree--;
+    }
+
+    void Release()
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_nFree++;
+        }
+        m_Available.notify_one();
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::condition_variable m_Available;
+    size_t m_nFree;
+};
+
+// Sends results and messages back as soon as they are ready.  Platforms may finish on several threads at once
+class ConnectionSink : public ResultSink, public MessageLog
+{
+public:
+    ConnectionSink( ByteStream& stream ) : m_Stream( stream ) {}
+
+    virtual bool WriteIsa( const char* platform, const char* isaText, size_t isaLength, const void* pBinary, size_t binarySize ) override
+    {
+        Message message( MessageType::ISA );
+        message.AddString( Field::PLATFORM,platform );
+        if ( isaText )
+            message.AddField( Field::TEXT,isaText,isaLength );
+        if ( pBinary )
+            message.AddField( Field::BINARY,pBinary,binarySize );
+        return Send( message );
+    }
+
+    virtual void Write( const std::string& text ) override
+    {
+        m_nMessages++;
+        Message message( MessageType::ERROR_TEXT );
+        message.AddField( Field::TEXT,text.data(),text.size() );
+        Send( message );
+    }
+
+    // 'platforms' are listed for batch workers, whose supervisor records what they wrote
+    bool Finish( bool succeeded, const std::vector<IntelGPUCompiler::PlatformInfo>* platforms = nullptr )
+    {
+        if ( !succeeded && m_nMessages == 0 )
+            Write( "Compilation failed" );
+
+        Message message( MessageType::DONE );
+        message.AddUint( Field::STATUS,succeeded ? 0 : 1 );
+        if ( platforms )
+        {
+            for ( const IntelGPUCompiler::PlatformInfo& platform : *platforms )
+                message.AddString( Field::PLATFORM,platform.platformName );
+        }
+        return Send( message );
+    }
+
+    bool Failed() const { return m_bFailed; }
+
+private:
+    bool Send( const Message& message )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        if ( !m_bFailed && !message.Send( m_Stream ) )
+            m_bFailed = true;
+        return !m_bFailed;
+    }
+
+    ByteStream& m_Stream;
+    std::mutex m_Mutex;
+    std::atomic<size_t> m_nMessages{ 0 };
+    bool m_bFailed = false;
+};
+
+static bool SendRequestError( ByteStream& stream, const std::string& text )
+{
+    ConnectionSink sink( stream );
+    sink.Write( text );
+    return sink.Finish( false );
+}
+
+// Fills in a job from a COMPILE request.  The job keeps pointers into 'args', so they must outlive it.  With 'readFiles', a request
+//   without INPUT is for the input file named in its arguments
+static bool ParseCompileRequest( const JobOptions& defaults, const Message& request, bool readFiles, std::vector<std::string>& args,
+                                 JobOptions& job, std::string& error )
+{
+    InputBuffer input;
+    InputBuffer rootsig;
+
+    size_t offset = 0;
+    Field tag;
+    const uint8_t* data;
+    uint32_t size;
+    while ( request.NextField( offset,tag,data,size ) )
+    {
+        switch ( tag )
+        {
+        case Field::ARGUMENT:   args.emplace_back( (const char*)data,size ); break;
+        case Field::INPUT:      input.Assign( data,size );                   break;
+        case Field::ROOTSIG:    rootsig.Assign( data,size );                 break;
+        default:                                                             break;
+        }
+    }
+
+    std::vector<char*> argv;
+    for ( std::string& arg : args )
+        argv.push_back( &arg[0] );
+
+    job = defaults;
+    int argc = (int)argv.size();
+    for ( int i=0; i<argc; i++ )
+    {
+        if ( ParseJobArgument( argc,argv.data(),i,job ) != ArgResult::CONSUMED )
+        {
+            error = "Invalid argument: " + std::string( argv[i] );
+            return false;
+        }
+    }
+
+    // without INPUT, PrepareInputs reads the named file
+    bool named = job.frontend.input_file && strcmp( job.frontend.input_file,"-" ) != 0;
+    if ( input.empty() && !(readFiles && named) )
+    {
+        error = "Request has no input";
+        return false;
+    }
+    if ( !named )
+        job.frontend.input_file = "shader";
+    if ( !input.empty() && _stricmp( job.source_lang,"hlsl" ) == 0 )
+        job.frontend.input_text = input;
+    else if ( !input.empty() )
+        job.inputs.bytecode = input;
+    if ( !rootsig.empty() )
+        job.inputs.rootsig = rootsig;
+    return true;
+}
+
+static bool HandleCompile( ToolContext& ctx, const JobOptions& defaults, const Message& request, ByteStream& stream )
+{
+    std::vector<std::string> args;
+    JobOptions job;
+    std::string error;
+    if ( !ParseCompileRequest( defaults,request,false,args,job,error ) )
+        return SendRequestError( stream,error );
+
+    // the client has already read any files it named.  Nothing may be read from, or written to, the server's file system
+    job.rootsig_file = nullptr;
+    job.inputs.write_cfg = false;
+
+    ConnectionSink sink( stream );
+    job.inputs.log = &sink;
+    ToolContext requestCtx = ctx;
+    requestCtx.sink = &sink;
+    requestCtx.archive = nullptr;
+
+    bool succeeded = PrepareInputs( job ) && RunJob( requestCtx,job );
+    return sink.Finish( succeeded ) && !sink.Failed();
+}
+
+struct Connection
+{
+    Socket socket;
+    std::thread thread;
+    std::atomic<bool> done{ false };
+};
+
+// Requests on one connection are handled one at a time.  A client which sends faster than we compile is held up by the socket,
+//   once its buffers fill
+static void ServeConnection( ToolContext& ctx, const JobOptions& defaults, const ServerOptions& opts, JobLimiter& limiter,
+                             Connection& connection, std::atomic<bool>& stop )
+{
+    Socket& socket = connection.socket;
+    while ( !stop && !g_bInterrupted )
+    {
+        if ( !socket.Poll( POLL_MS ) )
+            continue;
+
+        Message request;
+        std::string error;
+        if ( !request.Receive( socket,opts.max_request,error ) )
+        {
+            // a client hanging up between requests is normal
+            if ( error != "Connection closed" )
+            {
+                printf( "Dropping client: %s\n",error.c_str() );
+                SendRequestError( socket,error );
+            }
+            break;
+        }
+
+        bool keepGoing;
+        switch ( request.GetType() )
+        {
+        case MessageType::COMPILE:
+            limiter.Acquire();
+            keepGoing = HandleCompile( ctx,defaults,request,socket );
+            limiter.Release();
+            break;
+        case MessageType::SHUTDOWN:
+            stop = true;
+            keepGoing = Message( MessageType::DONE ).Send( socket );
+            break;
+        default:
+            keepGoing = SendRequestError( socket,"Unknown request type: " + std::to_string( (uint32_t)request.GetType() ) );
+            break;
+        }
+
+        if ( !keepGoing )
+            break;
+    }
+
+    connection.done = true;
+}
+
+bool RunServer( ToolContext& ctx, const JobOptions& defaults, const ServerOptions& opts )
+{
+    size_t maxClients = std::max<size_t>( 1,opts.max_clients );
+    size_t maxJobs = opts.max_jobs ? opts.max_jobs : std::thread::hardware_concurrency();
+    JobLimiter limiter( std::max<size_t>( 1,maxJobs ) );
+
+    Socket listener;
+    if ( !listener.Listen( opts.socket_path,64 ) )
+    {
+        printf( "%s\n",listener.GetError().c_str() );
+        return false;
+    }
+
+    signal( SIGINT,OnInterrupt );
+    signal( SIGTERM,OnInterrupt );
+
+    printf( "Listening on %s\n",opts.socket_path );
+    fflush( stdout );
+
+    std::mutex* pBackendMutex = defaults.inputs.serialize_backend ? &ctx.pool->GetBackendMutex() : nullptr;
+    std::list< std::unique_ptr<Connection> > connections;
+    std::atomic<bool> stop( false );
+
+    while ( !stop && !g_bInterrupted )
+    {
+        // threads are joined once their client leaves
+        for ( auto it = connections.begin(); it != connections.end(); )
+        {
+            if ( (*it)->done )
+            {
+                (*it)->thread.join();
+                it = connections.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // when every slot is busy, new clients wait in the listen queue
+        if ( connections.size() >= maxClients )
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            continue;
+        }
+
+        std::unique_ptr<Connection> connection( new Connection() );
+        if ( !listener.Accept( connection->socket,POLL_MS ) )
+        {
+            // contexts nobody has asked for in a while are released while the server is idle, and the cache kept to its size
+            ctx.pool->EvictIdle( pBackendMutex );
+            if ( ctx.cache )
+                ctx.cache->TrimEvery( CACHE_TRIM_SECONDS );
+            continue;
+        }
+
+        Connection& c = *connection;
+        c.thread = std::thread( [&ctx,&defaults,&opts,&limiter,&c,&stop]() { ServeConnection( ctx,defaults,opts,limiter,c,stop ); } );
+        connections.push_back( std::move( connection ) );
+    }
+
+    // stop accepting, and let requests in progress finish
+    stop = true;
+    listener.Close();
+    for ( std::unique_ptr<Connection>& connection : connections )
+        connection->thread.join();
+
+    printf( "Server stopped\n" );
+    return true;
+}
+
+bool ServeCoordinator( ToolContext& ctx, const JobOptions& defaults, const char* address )
+{
+    // workers may well be started before their coordinator
+    Socket socket;
+    if ( !socket.ConnectTcp( address,COORDINATOR_WAIT_MS ) )
+    {
+        printf( "%s\n",socket.GetError().c_str() );
+        return false;
+    }
+
+    size_t maxSize = ServerOptions().max_request;
+    for ( ;; )
+    {
+        Message request;
+        std::string error;
+        if ( !request.Receive( socket,maxSize,error ) )
+        {
+            printf( "Lost coordinator: %s\n",error.c_str() );
+            return false;
+        }
+
+        bool keepGoing;
+        switch ( request.GetType() )
+        {
+        case MessageType::COMPILE:
+            keepGoing = HandleCompile( ctx,defaults,request,socket );
+            break;
+        case MessageType::SHUTDOWN:
+            return true;
+        default:
+            keepGoing = SendRequestError( socket,"Unknown request type: " + std::to_string( (uint32_t)request.GetType() ) );
+            break;
+        }
+
+        if ( !keepGoing )
+        {
+            printf( "Lost coordinator: %s\n",socket.GetError().c_str() );
+            return false;
+        }
+    }
+}
+
+// Points stdout at stderr, and returns a file for what stdout was, so that nothing but messages can reach it
+static FILE* TakeStdout()
+{
+    fflush( stdout );
+#ifdef _WIN32
+    int fd = _dup( _fileno( stdout ) );
+    if ( fd < 0 || _dup2( _fileno( stderr ),_fileno( stdout ) ) != 0 )
+        return nullptr;
+    _setmode( fd,_O_BINARY );
+    return _fdopen( fd,"wb" );
+#else
+    int fd = dup( STDOUT_FILENO );
+    if ( fd < 0 || dup2( STDERR_FILENO,STDOUT_FILENO ) < 0 )
+        return nullptr;
+    return fdopen( fd,"wb" );
+#endif
+}
+
+static bool CompileStreamJob( ToolContext& ctx, JobOptions& job )
+{
+    if ( !job.permute.empty() )
+        return RunPermutations( ctx,job );
+    return PrepareInputs( job ) && RunJob( ctx,job );
+}
+
+// Runs one job of a stream.  If 'out' is set, messages are sent there, followed by DONE, and so are results unless they go to files
+static bool RunStreamJob( ToolContext& ctx, JobOptions& job, ByteStream* out, StreamOutput output, bool& outputFailed )
+{
+    if ( !out )
+        return CompileStreamJob( ctx,job );
+
+    ConnectionSink sink( *out );
+    job.inputs.log = &sink;
+    ToolContext jobCtx = ctx;
+
+    if ( output == StreamOutput::STATUS )
+    {
+        bool succeeded = CompileStreamJob( jobCtx,job );
+        outputFailed = !sink.Finish( succeeded,&job.inputs.asics ) || sink.Failed();
+        return succeeded;
+    }
+
+    // there is no .asm file for a control-flow graph to go next to
+    job.inputs.write_cfg = false;
+    jobCtx.sink = &sink;
+
+    bool succeeded = PrepareInputs( job ) && RunJob( jobCtx,job );
+    outputFailed = !sink.Finish( succeeded ) || sink.Failed();
+    return succeeded;
+}
+
+bool RunStream( ToolContext& ctx, const JobOptions& defaults, bool readStdin, StreamOutput output )
+{
+    FILE* out = nullptr;
+    if ( output != StreamOutput::FILES )
+    {
+        out = TakeStdout();
+        if ( !out )
+        {
+            printf( "Failed to redirect stdout\n" );
+            return false;
+        }
+    }
+#ifdef _WIN32
+    if ( readStdin )
+        _setmode( _fileno( stdin ),_O_BINARY );
+#endif
+
+    FileStream stream( readStdin ? stdin : nullptr,out );
+    ByteStream* results = out ? &stream : nullptr;
+    bool outputFailed = false;
+    bool succeeded = true;
+
+    if ( !readStdin )
+    {
+        // a single job, from the command line
+        JobOptions job = defaults;
+        succeeded = RunStreamJob( ctx,job,results,output,outputFailed );
+    }
+
+    size_t maxSize = ServerOptions().max_request;
+    for ( size_t record = 1; readStdin && !outputFailed; record++ )
+    {
+        Message request;
+        std::string error;
+        if ( !request.Receive( stream,maxSize,error ) )
+        {
+            // the input ending between records is how a stream finishes
+            if ( error != "Connection closed" )
+            {
+                printf( "stdin(%zu): %s\n",record,error.c_str() );
+                succeeded = false;
+            }
+            break;
+        }
+
+        std::vector<std::string> args;
+        JobOptions job;
+        if ( request.GetType() != MessageType::COMPILE )
+            error = "Unknown request type: " + std::to_string( (uint32_t)request.GetType() );
+        else
+            ParseCompileRequest( defaults,request,true,args,job,error );
+
+        bool jobSucceeded;
+        if ( !error.empty() )
+        {
+            jobSucceeded = false;
+            if ( results )
+                outputFailed = !SendRequestError( *results,error );
+            else
+                printf( "stdin(%zu): %s\n",record,error.c_str() );
+        }
+        else
+        {
+            jobSucceeded = RunStreamJob( ctx,job,results,output,outputFailed );
+        }
+
+        if ( !jobSucceeded && !results )
+            printf( "stdin(%zu): job failed: %s\n",record,job.frontend.input_file ? job.frontend.input_file : "" );
+        succeeded = succeeded && jobSucceeded;
+    }
+
+    if ( outputFailed )
+    {
+        printf( "Failed to write results: %s\n",stream.GetError().c_str() );
+        succeeded = false;
+    }
+    if ( out )
+        fclose( out );
+    return succeeded;
+}
+
+static void ShowClientHelp()
+{
+    printf( "Usage:  client <socket> [options] <filename>\n" );
+    printf( "        client <socket> --shutdown\n" );
+    printf( "Options are the same as for a normal compile.  Results are written locally\n" );
+}
+
+static bool WriteClientIsa( const char* prefix, const std::string& platform, const uint8_t* isa, size_t size, bool binary )
+{
+    if ( !IsSafePlatformName( platform ) )
+    {
+        printf( "Server sent an invalid platform name: %s\n",platform.c_str() );
+        return false;
+    }
+
+    std::string fileName = std::string( prefix ? prefix : "" ) + platform + (binary ? ".bin" : ".asm");
+    FILE* fp = fopen( fileName.c_str(),binary ? "wb" : "w" );
+    if ( !fp )
+    {
+        printf( "Failed to open output file: %s\n",fileName.c_str() );
+        return false;
+    }
+    bool succeeded = fwrite( isa,1,size,fp ) == size;
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write output file: %s\n",fileName.c_str() );
+    return succeeded;
+}
+
+int ClientCommand( int argc, char* argv[] )
+{
+    if ( argc < 2 )
+    {
+        ShowClientHelp();
+        return 1;
+    }
+
+    const char* socketPath = argv[1];
+    bool shutdown = false;
+
+    // parse a copy of the arguments, to find the files we have to send.  Parsing modifies some of them
+    std::vector<std::string> args;
+    for ( int i=2; i<argc; i++ )
+    {
+        if ( strcmp( argv[i],"--shutdown" ) == 0 )
+            shutdown = true;
+        else
+            args.push_back( argv[i] );
+    }
+
+    std::vector<std::string> parsed = args;
+    std::vector<char*> parsedArgv;
+    for ( std::string& arg : parsed )
+        parsedArgv.push_back( &arg[0] );
+
+    JobOptions job;
+    int nArgs = (int)parsedArgv.size();
+    for ( int i=0; i<nArgs; i++ )
+    {
+        switch ( ParseJobArgument( nArgs,parsedArgv.data(),i,job ) )
+        {
+        case ArgResult::CONSUMED:
+            break;
+        case ArgResult::FAILED:
+            return 1;
+        case ArgResult::UNKNOWN:
+            printf( "Don't understand what: '%s' means\n",parsedArgv[i] );
+            ShowClientHelp();
+            return 1;
+        }
+    }
+
+    Message request( shutdown ? MessageType::SHUTDOWN : MessageType::COMPILE );
+    if ( !shutdown )
+    {
+        if ( !job.frontend.input_file )
+        {
+            printf( "No input filename\n" );
+            return 1;
+        }
+
+        InputBuffer input;
+        if ( !input.Load( job.frontend.input_file ) )
+        {
+            printf( "Failed to read: %s\n",job.frontend.input_file );
+            return 1;
+        }
+
+        InputBuffer rootsig;
+        if ( job.rootsig_file && !rootsig.Load( job.rootsig_file ) )
+        {
+            printf( "Unable to load root signature from: %s\n",job.rootsig_file );
+            return 1;
+        }
+
+        for ( const std::string& arg : args )
+            request.AddField( Field::ARGUMENT,arg.data(),arg.size() );
+        request.AddField( Field::INPUT,input.data(),input.size() );
+        if ( !rootsig.empty() )
+            request.AddField( Field::ROOTSIG,rootsig.data(),rootsig.size() );
+    }
+
+    Socket socket;
+    if ( !socket.Connect( socketPath,5000 ) )
+    {
+        printf( "%s\n",socket.GetError().c_str() );
+        return 1;
+    }
+
+    if ( !request.Send( socket ) )
+    {
+        printf( "Failed to send request: %s\n",socket.GetError().c_str() );
+        return 1;
+    }
+
+    bool succeeded = true;
+    for ( ;; )
+    {
+        Message reply;
+        std::string error;
+        if ( !reply.Receive( socket,SIZE_MAX,error ) )
+        {
+            printf( "Lost connection to server: %s\n",error.c_str() );
+            return 1;
+        }
+
+        const uint8_t* platform = nullptr;
+        const uint8_t* text = nullptr;
+        const uint8_t* binary = nullptr;
+        uint32_t platformSize = 0;
+        uint32_t textSize = 0;
+        uint32_t binarySize = 0;
+        uint32_t status = 0;
+
+        size_t offset = 0;
+        Field tag;
+        const uint8_t* data;
+        uint32_t size;
+        while ( reply.NextField( offset,tag,data,size ) )
+        {
+            if ( tag == Field::PLATFORM )
+            {
+                platform = data;
+                platformSize = size;
+            }
+            else if ( tag == Field::TEXT )
+            {
+                text = data;
+                textSize = size;
+            }
+            else if ( tag == Field::BINARY )
+            {
+                binary = data;
+                binarySize = size;
+            }
+            else if ( tag == Field::STATUS && size == sizeof( status ) )
+            {
+                memcpy( &status,data,sizeof( status ) );
+            }
+        }
+
+        switch ( reply.GetType() )
+        {
+        case MessageType::ISA:
+        {
+            // the server sends the binary instead of the text for --isa-bin
+            std::string platformName( platform ? (const char*)platform : "",platformSize );
+            if ( !platform || (!text && !binary) ||
+                 (text && !WriteClientIsa( job.inputs.isa_prefix,platformName,text,textSize,false )) ||
+                 (binary && !WriteClientIsa( job.inputs.isa_prefix,platformName,binary,binarySize,true )) )
+                succeeded = false;
+            break;
+        }
+        case MessageType::ERROR_TEXT:
+            printf( "%.*s\n",(int)textSize,text ? (const char*)text : "" );
+            break;
+        case MessageType::DONE:
+            return (succeeded && status == 0) ? 0 : 1;
+        default:
+            printf( "Unexpected reply from server\n" );
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _COMPILE_SERVER_H_
+#define _COMPILE_SERVER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ByteStream;
+struct ToolContext;
+struct JobOptions;
+
+//
+//  Messages exchanged with the compile server over a local socket.  All integers are little-endian.
+//
+//      header      uint32 magic, uint32 type, uint32 payload size
+//      payload     a sequence of fields:  uint32 tag, uint32 size, then 'size' bytes
+//
+//  A client sends COMPILE, with one ARGUMENT field for each command line argument of the job, the shader as INPUT
+//   (bytecode, or HLSL source with '-s hlsl'), and optionally a ROOTSIG.  Input files named in the arguments are not read
+//   by the server.  The server answers with an ISA message for each platform as soon as it finishes, an ERROR_TEXT message for
+//   each error or compiler message, and then DONE, carrying a uint32 STATUS which is 0 on success.  A connection may send any
+//   number of requests, one after another.  SHUTDOWN asks the server to finish its current requests and exit
+//
+namespace ServerProtocol
+{
+    static const uint32_t MAGIC = 0x53415349;   // 'ISAS'
+
+    enum class MessageType : uint32_t
+    {
+        COMPILE     = 1,
+        SHUTDOWN    = 2,
+        ISA         = 16,       // PLATFORM, and TEXT or BINARY (with --isa-bin)
+        ERROR_TEXT  = 17,       // TEXT
+        DONE        = 18,       // STATUS, and PLATFORM from batch workers
+    };
+
+    enum class Field : uint32_t
+    {
+        ARGUMENT    = 1,
+        INPUT       = 2,
+        ROOTSIG     = 3,
+        PLATFORM    = 4,
+        TEXT        = 5,
+        STATUS      = 6,
+        BINARY      = 7,
+    };
+
+    class Message
+    {
+    public:
+        Message( MessageType type = MessageType::DONE ) : m_Type( type ) {}
+
+        MessageType GetType() const { return m_Type; }
+
+        void AddField( Field tag, const void* data, size_t size );
+        void AddString( Field tag, const char* str );
+        void AddUint( Field tag, uint32_t value );
+
+        // Walks the fields.  'offset' starts at 0.  Returns false after the last field, or if the payload is malformed
+        bool NextField( size_t& offset, Field& tag, const uint8_t*& data, uint32_t& size ) const;
+
+        bool Send( ByteStream& stream ) const;
+
+        // Fails if the message is malformed, or its payload is larger than maxSize
+        bool Receive( ByteStream& stream, size_t maxSize, std::string& error );
+
+    private:
+        MessageType m_Type;
+        std::vector<uint8_t> m_Payload;
+    };
+
+    // Results are written to <prefix><platform>.asm, so a platform name from a peer must not be able to leave the prefix's
+    //  directory.  Rejects empty names, path separators, drive letters and '..'
+    bool IsSafePlatformName( const std::string& platform );
+}
+
+struct ServerOptions
+{
+    const char* socket_path = nullptr;
+    size_t max_clients      = 64;                   // connections open at once.  Later clients wait to be accepted
+    size_t max_jobs         = 0;                    // requests compiled at once.  0 means one per hardware thread
+    size_t max_request      = 256 * 1024 * 1024;    // bytes.  Larger requests are refused
+};
+
+// Serves requests until a client sends SHUTDOWN, or the process is interrupted.  Options in 'defaults' apply to every request
+bool RunServer( ToolContext& ctx, const JobOptions& defaults, const ServerOptions& opts );
+
+//
+//  Pipeline mode, for callers which have shaders in memory rather than in files.  Selected by giving '-' as the input file,
+//   or as the --isa prefix, or both:
+//
+//     input '-'    stdin holds a sequence of COMPILE messages, with INPUT, optionally ROOTSIG, and ARGUMENT fields for any
+//                  options which differ from the command line's.  Each is compiled in turn until stdin ends
+//     --isa '-'    results go to stdout as the server would send them:  ISA for each platform, ERROR_TEXT, then DONE.
+//                  Anything else the tool prints goes to stderr instead, so that stdout only ever holds messages
+//
+//  Unlike the server, files named in the arguments, such as --rootsig_file, are read as usual, and a request without INPUT
+//   compiles the input file its arguments name.
+//
+//  Batch workers (see RunBatchInWorkers) read requests from stdin, write results to files, and send only ERROR_TEXT and DONE to
+//   stdout.  Their DONE also carries a PLATFORM field for each platform the job was compiled for
+//
+enum class StreamOutput
+{
+    FILES,      // results are written to files, and messages printed, as usual
+    RESULTS,    // --isa '-'.  Results, messages and DONE go to stdout
+    STATUS,     // batch workers.  Results are written to files, and messages and DONE go to stdout
+};
+
+bool RunStream( ToolContext& ctx, const JobOptions& defaults, bool readStdin, StreamOutput output );
+
+// Connects to a coordinator at 'address' (host:port), and compiles the requests it sends, as a server would, until it sends
+//  SHUTDOWN.  See Coordinator.h.  Options in 'defaults' apply to every request
+bool ServeCoordinator( ToolContext& ctx, const JobOptions& defaults, const char* address );
+
+// 'client' subcommand
+int ClientCommand( int argc, char* argv[] );
+
+#endif
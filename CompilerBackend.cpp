@@ -0,0 +1,162 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CompilerBackend.h"
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#ifdef _WIN32
+#ifdef _WIN64
+#define DLL_NAME  "IntelGpuCompiler64.dll"
+#else
+#define DLL_NAME  "IntelGpuCompiler32.dll"
+#endif
+#else
+#define DLL_NAME  "libIntelGpuCompiler64.so"
+#endif
+
+using namespace IntelGPUCompiler;
+
+SharedLibrary::~SharedLibrary()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool SharedLibrary::Open( const char* path )
+{
+    Close();
+    m_hLibrary = (void*)LoadLibraryA( path );
+    if ( !m_hLibrary )
+    {
+        m_Error = "LoadLibrary failed with error " + std::to_string( GetLastError() );
+        return false;
+    }
+    return true;
+}
+
+void SharedLibrary::Close()
+{
+    if ( m_hLibrary )
+        FreeLibrary( (HMODULE)m_hLibrary );
+    m_hLibrary = nullptr;
+}
+
+void* SharedLibrary::GetSymbol( const char* name ) const
+{
+    void* pSymbol = (void*)GetProcAddress( (HMODULE)m_hLibrary,name );
+    if ( !pSymbol )
+        m_Error = "GetProcAddress failed for: " + std::string( name );
+    return pSymbol;
+}
+
+std::string SharedLibrary::GetPath() const
+{
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA( (HMODULE)m_hLibrary,path,MAX_PATH );
+    return std::string( path,length );
+}
+
+#else
+
+bool SharedLibrary::Open( const char* path )
+{
+    Close();
+    m_hLibrary = dlopen( path,RTLD_NOW | RTLD_LOCAL );
+    if ( !m_hLibrary )
+    {
+        const char* pError = dlerror();
+        m_Error = pError ? pError : "dlopen failed";
+        return false;
+    }
+    return true;
+}
+
+void SharedLibrary::Close()
+{
+    if ( m_hLibrary )
+        dlclose( m_hLibrary );
+    m_hLibrary = nullptr;
+}
+
+void* SharedLibrary::GetSymbol( const char* name ) const
+{
+    dlerror();
+    void* pSymbol = dlsym( m_hLibrary,name );
+    if ( !pSymbol )
+        m_Error = "dlsym failed for: " + std::string( name );
+    return pSymbol;
+}
+
+std::string SharedLibrary::GetPath() const
+{
+    // dladdr on any symbol in the library reports the file it was loaded from
+    void* pSymbol = dlsym( m_hLibrary,g_cOpenCompilerFnName );
+    Dl_info info;
+    if ( pSymbol && dladdr( pSymbol,&info ) && info.dli_fname )
+        return info.dli_fname;
+    return std::string();
+}
+
+#endif
+
+const char* CompilerBackend::GetDefaultPath()
+{
+    const char* pPath = getenv( "INTEL_GPU_COMPILER" );
+    if ( pPath && pPath[0] )
+        return pPath;
+    return DLL_NAME;
+}
+
+bool CompilerBackend::Load( const char* path )
+{
+    if ( !m_Library.Open( path ) )
+    {
+        m_Error = "Failed to load: " + std::string( path ) + " (" + m_Library.GetError() + ")";
+        return false;
+    }
+
+    m_Path = m_Library.GetPath();
+    if ( m_Path.empty() )
+        m_Path = path;
+
+    PFNOPENCOMPILER pfnOpenCompiler = (PFNOPENCOMPILER)m_Library.GetSymbol( g_cOpenCompilerFnName );
+    if ( !pfnOpenCompiler )
+    {
+        m_Error = m_Library.GetError();
+        return false;
+    }
+
+    SOpenCompiler desc;
+    desc.InterfaceVersion = 1;
+    desc.pCompilerFuncs = &m_FunctionTable;
+
+    /// get the right set of callbacks
+    if ( !pfnOpenCompiler( desc ) )
+    {
+        m_Error = "OpenCompiler failed";
+        return false;
+    }
+
+    return true;
+}
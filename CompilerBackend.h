@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _COMPILER_BACKEND_H_
+#define _COMPILER_BACKEND_H_
+
+#include <string>
+#include "Portability.h"
+#include "IntelGPUCompiler.h"
+
+// A dynamically loaded library.  LoadLibrary/GetProcAddress on Windows, dlopen/dlsym everywhere else
+class SharedLibrary
+{
+public:
+    SharedLibrary() = default;
+    ~SharedLibrary();
+
+    SharedLibrary( const SharedLibrary& ) = delete;
+    SharedLibrary& operator=( const SharedLibrary& ) = delete;
+
+    bool Open( const char* path );
+    void Close();
+    bool IsOpen() const { return m_hLibrary != nullptr; }
+
+    void* GetSymbol( const char* name ) const;
+
+    // Full path of the module that was actually loaded, after the loader's search rules have been applied
+    std::string GetPath() const;
+
+    // Describes the most recent failure of Open or GetSymbol
+    const std::string& GetError() const { return m_Error; }
+
+private:
+    void* m_hLibrary = nullptr;
+    mutable std::string m_Error;
+};
+
+//
+//  Loads an implementation of the IntelGPUCompiler interface and fills its function table.
+//
+//   The library is normally the driver's compiler DLL, but any library which exports OpenCompiler will do.  
+//   This lets the tool run against a stand-in compiler, on machines with no Intel driver
+//
+class CompilerBackend
+{
+public:
+    // The library used when none is specified: $INTEL_GPU_COMPILER if it is set, otherwise the driver's compiler DLL
+    static const char* GetDefaultPath();
+
+    bool Load( const char* path );
+
+    IntelGPUCompiler::SFunctionTable& GetFunctionTable() { return m_FunctionTable; }
+    const std::string& GetPath() const { return m_Path; }
+
+    // Describes why Load failed
+    const std::string& GetError() const { return m_Error; }
+
+private:
+    SharedLibrary m_Library;
+    IntelGPUCompiler::SFunctionTable m_FunctionTable = {};
+    std::string m_Path;
+    std::string m_Error;
+};
+
+#endif
@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CompilerContextPool.h"
+
+using namespace IntelGPUCompiler;
+
+CompilerContextPool::CompilerContextPool( SFunctionTable& functionTable, const PoolOptions& opts )
+    : m_FunctionTable( functionTable ), m_Options( opts )
+{
+}
+
+CompilerContextPool::~CompilerContextPool()
+{
+    std::vector<Evicted> evicted;
+    for ( auto& it : m_Idle )
+        for ( IdleContext& ctx : it.second )
+            evicted.push_back( Evicted{ it.first.api,ctx.compiler } );
+    m_Idle.clear();
+    m_nIdle = 0;
+
+    DeleteContexts( evicted,&m_BackendMutex );
+}
+
+bool CompilerContextPool::Lease( API& api, Platform platform, std::mutex* pBackendMutex, OpaqueCompiler& compiler, std::string& error,
+                                 const TraceLabel& trace )
+{
+    std::vector<Evicted> evicted;
+    bool hit = false;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        CollectExpired( Clock::now(),evicted );
+
+        auto it = m_Idle.find( Key{ &api,platform } );
+        if ( it != m_Idle.end() && !it->second.empty() )
+        {
+            compiler = it->second.back().compiler;
+            it->second.pop_back();
+            m_nIdle--;
+            m_Stats.hits++;
+            hit = true;
+        }
+        else
+        {
+            m_Stats.misses++;
+        }
+    }
+
+    DeleteContexts( evicted,pBackendMutex );
+    if ( hit )
+        return true;
+
+    auto start = Clock::now();
+    {
+        BackendLock lock( pBackendMutex );
+        TraceScope scope( trace,TraceStage::CREATE_COMPILER );
+        if ( !api.CreateCompiler( platform,m_FunctionTable,compiler ) )
+        {
+            error = std::string( "ERROR: " ) + m_FunctionTable.interface1.pfnGetLastError(  );
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_Stats.create_seconds += std::chrono::duration<double>( Clock::now() - start ).count();
+    return true;
+}
+
+void CompilerContextPool::Return( API& api, Platform platform, std::mutex* pBackendMutex, OpaqueCompiler compiler )
+{
+    std::vector<Evicted> evicted;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Clock::time_point now = Clock::now();
+        CollectExpired( now,evicted );
+
+        std::deque<IdleContext>& idle = m_Idle[ Key{ &api,platform } ];
+        if ( idle.size() >= m_Options.max_idle_per_key )
+        {
+            evicted.push_back( Evicted{ &api,compiler } );
+            m_Stats.evictions++;
+        }
+        else
+        {
+            if ( m_nIdle >= m_Options.max_idle )
+                CollectOldest( evicted );
+
+            if ( m_nIdle < m_Options.max_idle )
+            {
+                idle.push_back( IdleContext{ compiler,now } );
+                m_nIdle++;
+            }
+            else
+            {
+                evicted.push_back( Evicted{ &api,compiler } );
+                m_Stats.evictions++;
+            }
+        }
+    }
+
+    DeleteContexts( evicted,pBackendMutex );
+}
+
+void CompilerContextPool::Discard( API& api, std::mutex* pBackendMutex, OpaqueCompiler compiler )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Stats.discards++;
+    }
+
+    BackendLock lock( pBackendMutex );
+    api.DeleteCompiler( m_FunctionTable,compiler );
+}
+
+void CompilerContextPool::EvictIdle( std::mutex* pBackendMutex )
+{
+    std::vector<Evicted> evicted;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        CollectExpired( Clock::now(),evicted );
+    }
+    DeleteContexts( evicted,pBackendMutex );
+}
+
+PoolStats CompilerContextPool::GetStats()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return m_Stats;
+}
+
+void CompilerContextPool::PrintStats()
+{
+    PoolStats stats = GetStats();
+    size_t leases = stats.hits + stats.misses;
+
+    // every hit is a context we didn't have to create.  Estimate what that saved from the cost of the misses
+    double perCreate = stats.misses ? stats.create_seconds / stats.misses : 0.0;
+
+    printf( "Compiler context pool: %zu leases, %zu hits, %zu misses (%.1f%% hit rate), %zu evictions, %zu discards\n",
+            leases,stats.hits,stats.misses,leases ? 100.0 * stats.hits / leases : 0.0,stats.evictions,stats.discards );
+    printf( "Compiler context pool: %.3fs creating contexts, ~%.3fs saved\n",stats.create_seconds,perCreate * stats.hits );
+}
+
+void CompilerContextPool::CollectExpired( Clock::time_point now, std::vector<Evicted>& evicted )
+{
+    if ( m_Options.idle_timeout <= 0 )
+        return;
+
+    for ( auto& it : m_Idle )
+    {
+        // contexts are returned in time order, so the expired ones are at the front
+        std::deque<IdleContext>& idle = it.second;
+        while ( !idle.empty() && std::chrono::duration<double>( now - idle.front().returned ).count() > m_Options.idle_timeout )
+        {
+            evicted.push_back( Evicted{ it.first.api,idle.front().compiler } );
+            idle.pop_front();
+            m_nIdle--;
+            m_Stats.evictions++;
+        }
+    }
+}
+
+void CompilerContextPool::CollectOldest( std::vector<Evicted>& evicted )
+{
+    auto oldest = m_Idle.end();
+    for ( auto it = m_Idle.begin(); it != m_Idle.end(); ++it )
+    {
+        if ( it->second.empty() )
+            continue;
+        if ( oldest == m_Idle.end() || it->second.front().returned < oldest->second.front().returned )
+            oldest = it;
+    }
+
+    if ( oldest == m_Idle.end() )
+        return;
+
+    evicted.push_back( Evicted{ oldest->first.api,oldest->second.front().compiler } );
+    oldest->second.pop_front();
+    m_nIdle--;
+    m_Stats.evictions++;
+}
+
+void CompilerContextPool::DeleteContexts( const std::vector<Evicted>& evicted, std::mutex* pBackendMutex )
+{
+    if ( evicted.empty() )
+        return;
+
+    BackendLock lock( pBackendMutex );
+    for ( const Evicted& e : evicted )
+    {
+        OpaqueCompiler compiler = e.compiler;
+        e.api->DeleteCompiler( m_FunctionTable,compiler );
+    }
+}
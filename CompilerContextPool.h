@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _COMPILER_CONTEXT_POOL_H_
+#define _COMPILER_CONTEXT_POOL_H_
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ShaderAPI.h"
+#include "Trace.h"
+
+// Serializes calls into the compiler DLL, for drivers which are not thread-safe.  Does nothing if given a null mutex
+class BackendLock
+{
+public:
+    BackendLock( std::mutex* pMutex ) : m_pMutex( pMutex )
+    {
+        if ( m_pMutex )
+            m_pMutex->lock();
+    }
+    ~BackendLock()
+    {
+        if ( m_pMutex )
+            m_pMutex->unlock();
+    }
+
+private:
+    std::mutex* m_pMutex;
+};
+
+struct PoolOptions
+{
+    size_t max_idle_per_key = 8;        // warm contexts kept for each (API,platform) pair
+    size_t max_idle         = 64;       // warm contexts kept in total
+    double idle_timeout     = 300.0;    // seconds a context may sit unused before it is deleted.  0 keeps them forever
+};
+
+struct PoolStats
+{
+    size_t hits      = 0;       // leases satisfied by a warm context
+    size_t misses    = 0;       // leases which had to create a new context
+    size_t evictions = 0;       // warm contexts deleted because of the caps or the idle timeout
+    size_t discards  = 0;       // contexts deleted after a failure, instead of being returned
+    double create_seconds = 0;  // time spent creating contexts on a miss
+};
+
+//
+//  Keeps compiler contexts alive between shaders, so that a context for a given API and platform is only created once.
+//    A leased context is owned by the caller until it is returned.  Contexts are never shared between threads at the same time.
+//
+//  The pool also owns the mutex used to serialize calls into drivers which are not thread-safe.  
+//   Callers which want serialization pass it back in to Lease and Return.
+//
+class CompilerContextPool
+{
+public:
+    CompilerContextPool( IntelGPUCompiler::SFunctionTable& functionTable, const PoolOptions& opts = PoolOptions() );
+    ~CompilerContextPool();
+
+    // Creating a context is traced as 'trace', if a new one is needed
+    bool Lease( API& api, IntelGPUCompiler::Platform platform, std::mutex* pBackendMutex, IntelGPUCompiler::OpaqueCompiler& compiler, std::string& error,
+                const TraceLabel& trace = TraceLabel() );
+    void Return( API& api, IntelGPUCompiler::Platform platform, std::mutex* pBackendMutex, IntelGPUCompiler::OpaqueCompiler compiler );
+    void Discard( API& api, std::mutex* pBackendMutex, IntelGPUCompiler::OpaqueCompiler compiler );
+
+    // Deletes every context which has been idle longer than the timeout
+    void EvictIdle( std::mutex* pBackendMutex );
+
+    IntelGPUCompiler::SFunctionTable& GetFunctionTable() { return m_FunctionTable; }
+    std::mutex& GetBackendMutex() { return m_BackendMutex; }
+    PoolStats GetStats();
+    void PrintStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Key
+    {
+        API* api;
+        IntelGPUCompiler::Platform platform;
+
+        bool operator<( const Key& rhs ) const
+        {
+            if ( api != rhs.api )
+                return api < rhs.api;
+            return platform < rhs.platform;
+        }
+    };
+
+    struct IdleContext
+    {
+        IntelGPUCompiler::OpaqueCompiler compiler;
+        Clock::time_point returned;
+    };
+
+    struct Evicted
+    {
+        API* api;
+        IntelGPUCompiler::OpaqueCompiler compiler;
+    };
+
+    void CollectExpired( Clock::time_point now, std::vector<Evicted>& evicted );
+    void CollectOldest( std::vector<Evicted>& evicted );
+    void DeleteContexts( const std::vector<Evicted>& evicted, std::mutex* pBackendMutex );
+
+    IntelGPUCompiler::SFunctionTable& m_FunctionTable;
+    PoolOptions m_Options;
+
+    std::mutex m_Mutex;                                 // guards everything below
+    std::map< Key, std::deque<IdleContext> > m_Idle;    // most recently returned at the back
+    size_t m_nIdle = 0;
+    PoolStats m_Stats;
+
+    std::mutex m_BackendMutex;
+};
+
+#endif
@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Compression.h"
+#include <cstring>
+
+//
+//  A block is a series of sequences.  Each sequence is:
+//      token               high nibble: literal count, low nibble: match length - 4.  15 means more length bytes follow
+//      [literal length]    bytes of 255, terminated by a byte < 255
+//      literals
+//      offset              16-bit little-endian distance back to the match
+//      [match length]
+//
+//  The last sequence has literals only.  The format requires the last 5 bytes to be literals, 
+//    and the last match to start at least 12 bytes before the end of the block
+//
+static const size_t MIN_MATCH       = 4;
+static const size_t LAST_LITERALS   = 5;
+static const size_t MF_LIMIT        = 12;
+static const size_t MAX_OFFSET      = 65535;
+static const int    HASH_BITS       = 12;
+
+static inline uint32_t Read32( const uint8_t* p )
+{
+    uint32_t v;
+    memcpy( &v,p,4 );
+    return v;
+}
+
+static inline uint32_t HashSequence( uint32_t v )
+{
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static inline bool WriteLength( uint8_t*& op, const uint8_t* end, size_t length )
+{
+    while ( length >= 255 )
+    {
+        if ( op >= end )
+            return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if ( op >= end )
+        return false;
+    *op++ = (uint8_t)length;
+    return true;
+}
+
+size_t LZ4CompressBound( size_t size )
+{
+    return size + size / 255 + 16;
+}
+
+static bool EmitSequence( uint8_t*& op, const uint8_t* oend, const uint8_t* literals, size_t nLiterals, size_t offset, size_t matchLength )
+{
+    if ( op >= oend )
+        return false;
+
+    uint8_t* token = op++;
+    *token = (uint8_t)((nLiterals >= 15 ? 15 : nLiterals) << 4);
+    if ( nLiterals >= 15 && !WriteLength( op,oend,nLiterals - 15 ) )
+        return false;
+
+    if ( (size_t)(oend - op) < nLiterals )
+        return false;
+    memcpy( op,literals,nLiterals );
+    op += nLiterals;
+
+    // the final sequence has no match
+    if ( matchLength == 0 )
+        return true;
+
+    if ( oend - op < 2 )
+        return false;
+    *op++ = (uint8_t)(offset & 0xff);
+    *op++ = (uint8_t)(offset >> 8);
+
+    size_t code = matchLength - MIN_MATCH;
+    *token |= (uint8_t)(code >= 15 ? 15 : code);
+    if ( code >= 15 && !WriteLength( op,oend,code - 15 ) )
+        return false;
+    return true;
+}
+
+size_t LZ4Compress( const void* src, size_t size, void* dst, size_t capacity )
+{
+    const uint8_t* base = (const uint8_t*)src;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    const uint8_t* iend = base + size;
+    uint8_t* op = (uint8_t*)dst;
+    uint8_t* oend = op + capacity;
+
+    if ( size > MF_LIMIT )
+    {
+        const uint8_t* mflimit = iend - MF_LIMIT;
+        const uint8_t* matchlimit = iend - LAST_LITERALS;
+
+        uint32_t table[1 << HASH_BITS];
+        memset( table,0xff,sizeof(table) );
+
+        while ( ip < mflimit )
+        {
+            uint32_t seq = Read32( ip );
+            uint32_t h = HashSequence( seq );
+            uint32_t candidate = table[h];
+            table[h] = (uint32_t)(ip - base);
+
+            if ( candidate == 0xffffffff || (size_t)(ip - base) - candidate > MAX_OFFSET || Read32( base + candidate ) != seq )
+            {
+                ip++;
+                continue;
+            }
+
+            const uint8_t* match = base + candidate;
+
+            // extend backwards over literals which also match
+            while ( ip > anchor && match > base && ip[-1] == match[-1] )
+            {
+                ip--;
+                match--;
+            }
+
+            // and forwards
+            size_t length = MIN_MATCH;
+            while ( ip + length < matchlimit && ip[length] == match[length] )
+                length++;
+
+            if ( !EmitSequence( op,oend,anchor,(size_t)(ip - anchor),(size_t)(ip - match),length ) )
+                return 0;
+
+            ip += length;
+            anchor = ip;
+
+            if ( ip < mflimit )
+                table[HashSequence( Read32( ip - 2 ) )] = (uint32_t)(ip - 2 - base);
+        }
+    }
+
+    if ( !EmitSequence( op,oend,anchor,(size_t)(iend - anchor),0,0 ) )
+        return 0;
+
+    return (size_t)(op - (uint8_t*)dst);
+}
+
+bool LZ4Decompress( const void* src, size_t size, void* dst, size_t rawSize )
+{
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* iend = ip + size;
+    uint8_t* op = (uint8_t*)dst;
+    uint8_t* ostart = op;
+    uint8_t* oend = op + rawSize;
+
+    while ( ip < iend )
+    {
+        uint8_t token = *ip++;
+
+        size_t nLiterals = token >> 4;
+        if ( nLiterals == 15 )
+        {
+            uint8_t b;
+            do
+            {
+                if ( ip >= iend )
+                    return false;
+                b = *ip++;
+                nLiterals += b;
+            } while ( b == 255 );
+        }
+
+        if ( (size_t)(iend - ip) < nLiterals || (size_t)(oend - op) < nLiterals )
+            return false;
+        memcpy( op,ip,nLiterals );
+        ip += nLiterals;
+        op += nLiterals;
+
+        // the last sequence ends after its literals
+        if ( ip == iend )
+            break;
+
+        if ( iend - ip < 2 )
+            return false;
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if ( offset == 0 || offset > (size_t)(op - ostart) )
+            return false;
+
+        size_t length = (token & 15);
+        if ( length == 15 )
+        {
+            uint8_t b;
+            do
+            {
+                if ( ip >= iend )
+                    return false;
+                b = *ip++;
+                length += b;
+            } while ( b == 255 );
+        }
+        length += MIN_MATCH;
+
+        if ( (size_t)(oend - op) < length )
+            return false;
+
+        // matches may overlap their own output, so copy forwards a byte at a time
+        const uint8_t* match = op - offset;
+        for ( size_t i=0; i<length; i++ )
+            op[i] = match[i];
+        op += length;
+    }
+
+    return op == oend;
+}
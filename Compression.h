@@ -0,0 +1,36 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+
+#include <cstdint>
+#include <cstddef>
+
+//
+//  Fast LZ compression, using the LZ4 block format.  Favors speed over ratio.  ISA text is very repetitive,
+//    and typically shrinks by 3-5x.
+//
+
+// Worst-case compressed size for an input of the given size
+size_t LZ4CompressBound( size_t size );
+
+// Returns the compressed size, or 0 if the output does not fit in 'capacity'
+size_t LZ4Compress( const void* src, size_t size, void* dst, size_t capacity );
+
+// Decompresses a block whose original size is known.  Returns false if the block is corrupt
+bool LZ4Decompress( const void* src, size_t size, void* dst, size_t rawSize );
+
+#endif
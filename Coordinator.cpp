@@ -0,0 +1,720 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzer.h"
+#include "Batch.h"
+#include "CompileServer.h"
+#include "Coordinator.h"
+#include "Permutations.h"
+#include "Socket.h"
+#include "WorkerProcess.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace ServerProtocol;
+
+namespace
+{
+    // how long blocking waits sleep before checking for shutdown
+    const int POLL_MS = 200;
+
+    const size_t NO_LEASE = SIZE_MAX;
+
+    // a program which has been on this many lost workers is failed, rather than lose another
+    const int MAX_ATTEMPTS = 2;
+
+    // set by SIGINT and SIGTERM
+    volatile std::sig_atomic_t g_bInterrupted = 0;
+
+    void OnInterrupt( int )
+    {
+        g_bInterrupted = 1;
+    }
+}
+
+// Where one job wants a program's results
+struct TaskOutput
+{
+    size_t job;             // index of the job, in manifest order
+    std::string prefix;     // its --isa prefix, and its permutation's name
+};
+
+enum class TaskState
+{
+    PENDING,
+    LEASED,
+    DONE,
+};
+
+// One program, to compile for one API and set of devices
+struct Task
+{
+    std::vector<std::string> args;      // backend options, sent to the worker
+    InputBuffer bytecode;
+    InputBuffer rootsig;
+    std::vector<TaskOutput> outputs;    // in manifest order
+    size_t shard = 0;
+
+    TaskState state = TaskState::PENDING;
+    int attempts = 0;                   // workers lost while compiling it
+};
+
+struct CoordinatedJob
+{
+    BatchResult result;
+    bool reported = false;              // its failure has been printed
+};
+
+// What a worker sent back for one program
+struct TaskResult
+{
+    struct Isa
+    {
+        std::string platform;
+        std::string contents;
+        bool binary;
+    };
+
+    bool succeeded = false;
+    std::vector<Isa> isa;
+    std::vector<std::string> messages;
+};
+
+struct Shard
+{
+    std::vector<size_t> tasks;          // in manifest order
+    size_t cursor = 0;                  // tasks before this one have been handed out
+    bool leased = false;
+};
+
+// Hands out leases and programs to the workers' threads, and collects their results
+class Coordinator
+{
+public:
+    Coordinator( const char* manifest_file, std::vector<Task>& tasks, std::vector<CoordinatedJob>& jobs, size_t nShards );
+
+    // Blocks until there is a program for the worker holding 'lease', or there never will be.  A worker keeps its lease on a shard
+    //  until the shard has nothing left to hand out
+    Task* Next( size_t& lease );
+
+    void Finish( Task& task, const TaskResult& result, double milliseconds );
+
+    // The worker holding 'lease' was lost, while compiling 'task'
+    void Lose( size_t worker, size_t lease, Task& task, const std::string& error );
+
+    // Fails every program which hasn't been compiled yet
+    void Abort();
+
+    size_t GetDoneCount();
+
+private:
+    Task* FirstPending( Shard& shard );
+    void Fail( Task& task, const std::vector<std::string>& messages );
+    bool WriteOutputs( const Task& task, const TaskResult& result );
+
+    const char* m_pManifest;
+    std::vector<Task>& m_Tasks;
+    std::vector<CoordinatedJob>& m_Jobs;
+    std::vector<Shard> m_Shards;
+    size_t m_nDone = 0;
+    bool m_bAborted = false;
+    std::mutex m_Mutex;
+    std::condition_variable m_Changed;
+
+    // the manifest position of whichever job last wrote each file.  Only later jobs may replace it
+    std::map<std::string,size_t> m_Written;
+    std::mutex m_OutputMutex;
+};
+
+Coordinator::Coordinator( const char* manifest_file, std::vector<Task>& tasks, std::vector<CoordinatedJob>& jobs, size_t nShards ) :
+    m_pManifest( manifest_file ), m_Tasks( tasks ), m_Jobs( jobs ), m_Shards( nShards )
+{
+    for ( size_t i=0; i<tasks.size(); i++ )
+        m_Shards[tasks[i].shard].tasks.push_back( i );
+}
+
+Task* Coordinator::FirstPending( Shard& shard )
+{
+    while ( shard.cursor < shard.tasks.size() && m_Tasks[shard.tasks[shard.cursor]].state != TaskState::PENDING )
+        shard.cursor++;
+    return (shard.cursor < shard.tasks.size()) ? &m_Tasks[shard.tasks[shard.cursor]] : nullptr;
+}
+
+Task* Coordinator::Next( size_t& lease )
+{
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    for ( ;; )
+    {
+        if ( lease != NO_LEASE )
+        {
+            Task* task = m_bAborted ? nullptr : FirstPending( m_Shards[lease] );
+            if ( task )
+            {
+                task->state = TaskState::LEASED;
+                return task;
+            }
+            m_Shards[lease].leased = false;
+            lease = NO_LEASE;
+        }
+
+        if ( m_bAborted || m_nDone == m_Tasks.size() )
+            return nullptr;
+
+        for ( size_t i=0; i<m_Shards.size() && lease == NO_LEASE; i++ )
+        {
+            if ( !m_Shards[i].leased && FirstPending( m_Shards[i] ) )
+            {
+                m_Shards[i].leased = true;
+                lease = i;
+            }
+        }
+
+        // every shard with work left is leased.  Wait for one to finish, or be given up
+        if ( lease == NO_LEASE )
+            m_Changed.wait_for( lock,std::chrono::milliseconds( POLL_MS ) );
+    }
+}
+
+// Marks a program, and every job waiting for it, as failed.  The caller holds the lock
+void Coordinator::Fail( Task& task, const std::vector<std::string>& messages )
+{
+    for ( const std::string& message : messages )
+        printf( "%s\n",message.c_str() );
+
+    for ( const TaskOutput& output : task.outputs )
+    {
+        CoordinatedJob& job = m_Jobs[output.job];
+        job.result.succeeded = false;
+        if ( !job.reported )
+            printf( "%s(%zu): job failed: %s\n",m_pManifest,job.result.line,job.result.input.c_str() );
+        job.reported = true;
+    }
+    fflush( stdout );
+}
+
+void Coordinator::Finish( Task& task, const TaskResult& result, double milliseconds )
+{
+    // a program whose output can't be written has failed, even though it compiled
+    bool succeeded = result.succeeded && WriteOutputs( task,result );
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    task.state = TaskState::DONE;
+    m_nDone++;
+    for ( const TaskOutput& output : task.outputs )
+        m_Jobs[output.job].result.milliseconds += milliseconds;
+
+    if ( !succeeded )
+    {
+        Fail( task,result.messages );
+    }
+    else
+    {
+        for ( const std::string& message : result.messages )
+            printf( "%s\n",message.c_str() );
+    }
+    m_Changed.notify_all();
+}
+
+void Coordinator::Lose( size_t worker, size_t lease, Task& task, const std::string& error )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    printf( "Lost worker %zu: %s\n",worker,error.c_str() );
+
+    // whatever the shard's worker had finished stays finished.  The rest goes to the next worker to take the shard
+    if ( lease != NO_LEASE )
+    {
+        m_Shards[lease].leased = false;
+        m_Shards[lease].cursor = 0;
+    }
+
+    if ( task.state == TaskState::LEASED && ++task.attempts >= MAX_ATTEMPTS )
+    {
+        task.state = TaskState::DONE;
+        m_nDone++;
+        Fail( task,{ "Lost " + std::to_string( task.attempts ) + " workers while compiling this program, giving up" } );
+    }
+    else if ( task.state == TaskState::LEASED )
+    {
+        task.state = TaskState::PENDING;
+    }
+    fflush( stdout );
+    m_Changed.notify_all();
+}
+
+void Coordinator::Abort()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_bAborted = true;
+    for ( Task& task : m_Tasks )
+    {
+        if ( task.state != TaskState::DONE )
+        {
+            task.state = TaskState::DONE;
+            m_nDone++;
+            Fail( task,{} );
+        }
+    }
+    m_Changed.notify_all();
+}
+
+size_t Coordinator::GetDoneCount()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return m_nDone;
+}
+
+bool Coordinator::WriteOutputs( const Task& task, const TaskResult& result )
+{
+    std::lock_guard<std::mutex> lock( m_OutputMutex );
+    bool succeeded = true;
+    for ( const TaskOutput& output : task.outputs )
+    {
+        for ( const TaskResult::Isa& isa : result.isa )
+        {
+            std::string path = output.prefix + isa.platform + (isa.binary ? ".bin" : ".asm");
+            auto it = m_Written.find( path );
+            if ( it != m_Written.end() && it->second > output.job )
+                continue;
+            m_Written[path] = output.job;
+
+            FILE* fp = fopen( path.c_str(),isa.binary ? "wb" : "w" );
+            if ( !fp )
+            {
+                printf( "Failed to open output file: %s\n",path.c_str() );
+                succeeded = false;
+                continue;
+            }
+            bool written = fwrite( isa.contents.data(),1,isa.contents.size(),fp ) == isa.contents.size();
+            if ( fclose( fp ) != 0 || !written )
+            {
+                printf( "Failed to write output file: %s\n",path.c_str() );
+                succeeded = false;
+            }
+        }
+    }
+    return succeeded;
+}
+
+// Runs the frontend for a job, or one permutation of it, and adds its program to the tasks.  A program which has already been
+//   added with the same backend options is shared
+static bool AddProgram( JobOptions& job, size_t jobIndex, size_t nShards, std::vector<Task>& tasks, std::map<std::string,size_t>& programs )
+{
+    if ( !PrepareInputs( job ) )
+        return false;
+
+    std::vector<std::string> args = { "-s","dxbc","--api",job.api,"-j",std::to_string( job.inputs.threads ) };
+    for ( const char* asic : job.asicNames )
+    {
+        args.push_back( "-c" );
+        args.push_back( asic );
+    }
+    if ( job.inputs.isa_binary )
+        args.push_back( "--isa-bin" );
+
+    Hash128 program = HashProgram( job.inputs );
+    std::string key = program.ToString();
+    for ( const std::string& arg : args )
+        key += " " + arg;
+
+    auto it = programs.find( key );
+    if ( it == programs.end() )
+    {
+        // inputs are copied, rather than kept mapped, because a whole corpus of mapped files could exhaust the address space
+        Task task;
+        task.args = std::move( args );
+        task.bytecode.Assign( job.inputs.bytecode.data(),job.inputs.bytecode.size() );
+        task.rootsig.Assign( job.inputs.rootsig.data(),job.inputs.rootsig.size() );
+        task.shard = (size_t)(program.lo % nShards);
+        it = programs.emplace( key,tasks.size() ).first;
+        tasks.push_back( std::move( task ) );
+    }
+
+    tasks[it->second].outputs.push_back( TaskOutput{ jobIndex,job.inputs.isa_prefix ? job.inputs.isa_prefix : "" } );
+    return true;
+}
+
+// Adds a job's programs, one for each permutation if it has any.  See RunPermutations
+static bool AddJob( JobOptions& job, size_t jobIndex, size_t nShards, std::vector<Task>& tasks, std::map<std::string,size_t>& programs )
+{
+    if ( job.permute.empty() )
+        return AddProgram( job,jobIndex,nShards,tasks,programs );
+
+    if ( job.frontend.input_file == nullptr )
+    {
+        LogMessage( job.inputs,"No input filename" );
+        return false;
+    }
+
+    std::vector<Permutation> permutations;
+    ExpandPermutations( job,permutations );
+
+    if ( _stricmp( job.source_lang,"hlsl" ) == 0 && job.frontend.input_text.empty() )
+        job.frontend.input_text.Load( job.frontend.input_file );
+
+    std::string basePrefix = job.inputs.isa_prefix ? job.inputs.isa_prefix : "";
+    std::string baseId = job.inputs.shader_id ? job.inputs.shader_id : job.frontend.input_file;
+
+    bool succeeded = true;
+    for ( const Permutation& permutation : permutations )
+    {
+        std::string prefix = basePrefix + permutation.name + "_";
+        std::string id = baseId + "_" + permutation.name;
+
+        JobOptions permutationJob = job;
+        permutationJob.permute.clear();
+        permutationJob.inputs.isa_prefix = prefix.c_str();
+        permutationJob.inputs.shader_id = id.c_str();
+        for ( const auto& define : permutation.defines )
+            permutationJob.frontend.defines.emplace_back( define.first.c_str(),define.second.c_str() );
+
+        if ( !AddProgram( permutationJob,jobIndex,nShards,tasks,programs ) )
+        {
+            LogMessage( job.inputs,"Permutation failed: %s",permutation.name.c_str() );
+            succeeded = false;
+        }
+    }
+    return succeeded;
+}
+
+// Whether a worker may send results for 'platform'.  Its name becomes part of an output path, so it has to be one the program
+//  was sent to be compiled for, or any safe name if it was sent for all of them
+static bool IsRequestedPlatform( const Task& task, const std::string& platform )
+{
+    if ( !IsSafePlatformName( platform ) )
+        return false;
+
+    bool anyRequested = false;
+    for ( size_t i = 0; i + 1 < task.args.size(); i++ )
+    {
+        if ( task.args[i] != "-c" )
+            continue;
+        anyRequested = true;
+        if ( _stricmp( task.args[i + 1].c_str(),platform.c_str() ) == 0 )
+            return true;
+    }
+    return !anyRequested;
+}
+
+// Sends one program to a worker, and collects the results.  Fails if the worker is lost, or takes longer than 'timeout' seconds
+static bool CompileOnWorker( Socket& socket, const Task& task, double timeout, TaskResult& result, std::string& error )
+{
+    Message request( MessageType::COMPILE );
+    for ( const std::string& arg : task.args )
+        request.AddField( Field::ARGUMENT,arg.data(),arg.size() );
+    request.AddField( Field::INPUT,task.bytecode.data(),task.bytecode.size() );
+    if ( !task.rootsig.empty() )
+        request.AddField( Field::ROOTSIG,task.rootsig.data(),task.rootsig.size() );
+
+    // a worker which stops reading is as lost as one which stops answering
+    if ( !socket.SetSendTimeout( (int)(timeout * 1000) ) || !request.Send( socket ) )
+    {
+        error = socket.GetError();
+        return false;
+    }
+
+    bool rejected = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>( timeout );
+    size_t maxSize = ServerOptions().max_request;
+    for ( ;; )
+    {
+        // a worker which hangs is as lost as one which disconnects
+        while ( !socket.Poll( POLL_MS ) )
+        {
+            if ( g_bInterrupted )
+            {
+                error = "Interrupted";
+                return false;
+            }
+            if ( std::chrono::steady_clock::now() >= deadline )
+            {
+                error = "No answer after " + std::to_string( (int)timeout ) + " seconds";
+                return false;
+            }
+        }
+
+        Message reply;
+        if ( !reply.Receive( socket,maxSize,error ) )
+            return false;
+
+        TaskResult::Isa isa;
+        bool hasIsa = false;
+        uint32_t status = 1;
+
+        size_t offset = 0;
+        Field tag;
+        const uint8_t* data;
+        uint32_t size;
+        while ( reply.NextField( offset,tag,data,size ) )
+        {
+            if ( tag == Field::PLATFORM )
+            {
+                isa.platform.assign( (const char*)data,size );
+            }
+            else if ( tag == Field::TEXT && reply.GetType() == MessageType::ERROR_TEXT )
+            {
+                result.messages.emplace_back( (const char*)data,size );
+            }
+            else if ( tag == Field::TEXT || tag == Field::BINARY )
+            {
+                // the server sends the binary instead of the text for --isa-bin
+                isa.contents.assign( (const char*)data,size );
+                isa.binary = (tag == Field::BINARY);
+                hasIsa = true;
+            }
+            else if ( tag == Field::STATUS && size == sizeof( status ) )
+            {
+                memcpy( &status,data,sizeof( status ) );
+            }
+        }
+
+        if ( reply.GetType() == MessageType::ISA && hasIsa && !IsRequestedPlatform( task,isa.platform ) )
+        {
+            result.messages.push_back( "Worker sent results for an unexpected platform: " + isa.platform );
+            rejected = true;
+        }
+        else if ( reply.GetType() == MessageType::ISA && hasIsa )
+        {
+            result.isa.push_back( std::move( isa ) );
+        }
+
+        if ( reply.GetType() == MessageType::DONE )
+        {
+            result.succeeded = (status == 0) && !rejected;
+            return true;
+        }
+    }
+}
+
+struct WorkerConnection
+{
+    Socket socket;
+    size_t id = 0;
+    std::thread thread;
+    std::atomic<bool> done{ false };
+};
+
+// Feeds a worker programs until there are none left, or the worker is lost
+static void ServeWorker( Coordinator& coordinator, WorkerConnection& connection, double timeout )
+{
+    size_t lease = NO_LEASE;
+    while ( Task* task = coordinator.Next( lease ) )
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        TaskResult result;
+        std::string error;
+        if ( !CompileOnWorker( connection.socket,*task,timeout,result,error ) )
+        {
+            connection.socket.Close();
+            coordinator.Lose( connection.id,lease,*task,error );
+            connection.done = true;
+            return;
+        }
+
+        auto end = std::chrono::high_resolution_clock::now();
+        coordinator.Finish( *task,result,std::chrono::duration<double,std::milli>( end - start ).count() );
+    }
+
+    Message( MessageType::SHUTDOWN ).Send( connection.socket );
+    connection.done = true;
+}
+
+// Where local workers can reach a listener on 'address'
+static std::string GetLocalAddress( const char* address, int port )
+{
+    std::string host = address;
+    host.resize( host.rfind( ':' ) );
+    if ( host.empty() || host == "0.0.0.0" )
+        host = "127.0.0.1";
+    else if ( host == "[::]" )
+        host = "[::1]";
+    return host + ":" + std::to_string( port );
+}
+
+bool RunCoordinator( const JobOptions& defaults, const char* manifest_file, const char* summary_file, const CoordinatorOptions& opts )
+{
+    std::ifstream manifest( manifest_file );
+    if ( !manifest.good() )
+    {
+        printf( "Failed to read batch manifest: %s\n",manifest_file );
+        return false;
+    }
+
+    auto batchStart = std::chrono::high_resolution_clock::now();
+    size_t nShards = std::max<size_t>( 1,opts.shards );
+
+    std::vector<CoordinatedJob> jobs;
+    std::vector<Task> tasks;
+    std::map<std::string,size_t> programs;
+    std::string line;
+    size_t lineNumber = 0;
+    while ( std::getline( manifest,line ) )
+    {
+        lineNumber++;
+
+        std::vector<std::string> tokens;
+        TokenizeManifestLine( line,tokens );
+        if ( tokens.empty() || tokens[0][0] == '#' )
+            continue;
+
+        JobOptions job = defaults;
+        bool succeeded = ParseManifestLine( manifest_file,lineNumber,tokens,job ) && AddJob( job,jobs.size(),nShards,tasks,programs );
+
+        CoordinatedJob coordinated;
+        coordinated.result.line = lineNumber;
+        coordinated.result.input = job.frontend.input_file ? job.frontend.input_file : "";
+        coordinated.result.api = job.api;
+        coordinated.result.succeeded = succeeded;
+        coordinated.result.up_to_date = false;
+        coordinated.result.milliseconds = 0;
+        coordinated.reported = !succeeded;
+        if ( !succeeded )
+            printf( "%s(%zu): job failed: %s\n",manifest_file,lineNumber,coordinated.result.input.c_str() );
+        jobs.push_back( std::move( coordinated ) );
+    }
+
+    Socket listener;
+    if ( !listener.ListenTcp( opts.address,64 ) )
+    {
+        printf( "%s\n",listener.GetError().c_str() );
+        return false;
+    }
+
+    signal( SIGINT,OnInterrupt );
+    signal( SIGTERM,OnInterrupt );
+
+    printf( "Coordinating %zu programs for %zu jobs on port %d\n",tasks.size(),jobs.size(),listener.GetPort() );
+    fflush( stdout );
+
+    Coordinator coordinator( manifest_file,tasks,jobs,nShards );
+
+    std::vector<std::string> workerArgs = opts.worker_args;
+    workerArgs.push_back( "--work" );
+    workerArgs.push_back( GetLocalAddress( opts.address,listener.GetPort() ) );
+
+    std::vector< std::unique_ptr<WorkerProcess> > localWorkers;
+    for ( size_t i=0; i<opts.local_workers; i++ )
+    {
+        localWorkers.emplace_back( new WorkerProcess() );
+        if ( !localWorkers.back()->Start( opts.executable,workerArgs,false ) )
+            printf( "%s\n",localWorkers.back()->GetError().c_str() );
+    }
+
+    // local workers which die are replaced, unless they keep dying without getting anything done
+    size_t maxRestarts = 2 * opts.local_workers;
+    size_t nRestarts = 0;
+    size_t nDoneAtRestart = 0;
+
+    std::list< std::unique_ptr<WorkerConnection> > connections;
+    size_t nConnections = 0;
+    while ( coordinator.GetDoneCount() < tasks.size() )
+    {
+        if ( g_bInterrupted )
+        {
+            printf( "Interrupted\n" );
+            coordinator.Abort();
+            break;
+        }
+
+        for ( auto it = connections.begin(); it != connections.end(); )
+        {
+            if ( (*it)->done )
+            {
+                (*it)->thread.join();
+                it = connections.erase( it );
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        size_t nRunning = 0;
+        for ( std::unique_ptr<WorkerProcess>& worker : localWorkers )
+        {
+            if ( worker->IsRunning() && !worker->HasExited() )
+            {
+                nRunning++;
+                continue;
+            }
+
+            size_t nDone = coordinator.GetDoneCount();
+            if ( nDone != nDoneAtRestart )
+                nRestarts = 0;
+            nDoneAtRestart = nDone;
+            if ( nRestarts < maxRestarts && worker->Start( opts.executable,workerArgs,false ) )
+            {
+                nRestarts++;
+                nRunning++;
+            }
+        }
+
+        if ( !localWorkers.empty() && nRunning == 0 && connections.empty() )
+        {
+            printf( "Local workers keep failing, giving up\n" );
+            coordinator.Abort();
+            break;
+        }
+
+        std::unique_ptr<WorkerConnection> connection( new WorkerConnection() );
+        if ( !listener.Accept( connection->socket,POLL_MS ) )
+            continue;
+
+        WorkerConnection& c = *connection;
+        c.id = ++nConnections;
+        c.thread = std::thread( [&coordinator,&c,&opts]() { ServeWorker( coordinator,c,opts.lease_timeout ); } );
+        connections.push_back( std::move( connection ) );
+    }
+
+    // workers still connected are sent SHUTDOWN.  Local workers which never got as far as connecting are stopped
+    listener.Close();
+    for ( std::unique_ptr<WorkerConnection>& connection : connections )
+        connection->thread.join();
+
+    auto graceEnd = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+    for ( std::unique_ptr<WorkerProcess>& worker : localWorkers )
+    {
+        while ( worker->IsRunning() && !worker->HasExited() && std::chrono::steady_clock::now() < graceEnd )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+        if ( worker->IsRunning() )
+            worker->Reap();
+    }
+
+    auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    std::vector<BatchResult> results;
+    for ( const CoordinatedJob& job : jobs )
+        results.push_back( job.result );
+
+    double seconds = std::chrono::duration<double>( batchEnd - batchStart ).count();
+    size_t nFailed = PrintBatchTotals( results,false,seconds );
+
+    if ( summary_file && !WriteBatchSummary( summary_file,results ) )
+        return false;
+
+    return nFailed == 0;
+}
@@ -0,0 +1,52 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _COORDINATOR_H_
+#define _COORDINATOR_H_
+
+#include <string>
+#include <vector>
+
+struct JobOptions;
+
+//
+//  Compiles a batch on many machines.  The coordinator runs the frontend for every job in the manifest:  it reads the bytecode,
+//   or compiles the HLSL, and finds the root signature.  Each permutation is a job of its own.  A program, identified by its
+//   bytecode and root signature, is compiled once for each API and set of devices that asks for it, however many jobs share it.
+//
+//  Programs are sharded by that content hash.  Workers are copies of the tool, started with --work <host:port>, which connect to
+//   the coordinator over TCP.  Each worker is given a lease on one shard at a time, and sent the shard's programs one by one, as
+//   COMPILE requests in the compile server's format (see CompileServer.h).  Results stream back as ISA, ERROR_TEXT and DONE
+//   messages, and the coordinator writes the files.  A worker which disconnects, or spends longer than the lease timeout on one
+//   program, is dropped, and its shard goes back to be leased to another.  A program which has lost two workers is failed.
+//
+//  The output doesn't depend on which worker compiled what, or when:  the compiler is deterministic, results are only written
+//   once their DONE arrives, and where several jobs write the same file, the last in the manifest wins, as in a plain batch
+//
+struct CoordinatorOptions
+{
+    const char* address    = nullptr;  // host:port to listen on
+    size_t local_workers   = 0;        // workers to start on this machine
+    size_t shards          = 64;
+    double lease_timeout   = 600;      // seconds a worker may spend on one program before it is given up for lost
+    std::string executable;            // this tool, for local workers
+    std::vector<std::string> worker_args;   // options for local workers, such as --compiler
+};
+
+// Doesn't need the compiler itself
+bool RunCoordinator( const JobOptions& defaults, const char* manifest_file, const char* summary_file, const CoordinatorOptions& opts );
+
+#endif
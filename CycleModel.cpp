@@ -0,0 +1,290 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "CycleModel.h"
+#include "IsaParser.h"
+#include "IsaCFG.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace IntelGPUCompiler;
+
+namespace
+{
+
+struct OpcodeCost
+{
+    uint16_t issue;         // cycles to issue a SIMD8 instruction
+    uint16_t latency;       // cycles until the result can be read
+};
+
+enum MathFunction
+{
+    MATH_SIMPLE,            // inv, sqrt, rsqrt, log, exp
+    MATH_TRIG,              // sin, cos
+    MATH_SLOW,              // pow, fdiv, and integer division
+    MATH_COUNT
+};
+
+const size_t N_OPCODES = (size_t)IsaOpcode::COUNT;
+const size_t N_SEND_TARGETS = (size_t)IsaSendTarget::OTHER + 1;
+
+struct PlatformCosts
+{
+    OpcodeCost opcode[N_OPCODES];
+    OpcodeCost math[MATH_COUNT];
+    OpcodeCost send[N_SEND_TARGETS];
+};
+
+void SetOpcode( PlatformCosts& costs, IsaOpcode op, uint16_t issue, uint16_t latency )
+{
+    costs.opcode[(size_t)op] = OpcodeCost{ issue,latency };
+}
+
+void SetSend( PlatformCosts& costs, IsaSendTarget target, uint16_t issue, uint16_t latency )
+{
+    costs.send[(size_t)target] = OpcodeCost{ issue,latency };
+}
+
+// Gen9:  Skylake and Kabylake
+PlatformCosts MakeGen9Costs()
+{
+    PlatformCosts costs;
+
+    // two SIMD4 FPUs per EU.  A SIMD8 instruction from one thread occupies one of them for 2 cycles
+    for ( size_t i=0; i<N_OPCODES; i++ )
+        costs.opcode[i] = OpcodeCost{ 2,8 };
+
+    SetOpcode( costs,IsaOpcode::MAD,  2,10 );
+    SetOpcode( costs,IsaOpcode::LRP,  2,10 );
+    SetOpcode( costs,IsaOpcode::DP2,  2,10 );
+    SetOpcode( costs,IsaOpcode::DP3,  2,10 );
+    SetOpcode( costs,IsaOpcode::DP4,  2,10 );
+    SetOpcode( costs,IsaOpcode::DPH,  2,10 );
+    SetOpcode( costs,IsaOpcode::PLN,  2,10 );
+    SetOpcode( costs,IsaOpcode::MACH, 4,12 );
+    SetOpcode( costs,IsaOpcode::NOP,  1,0 );
+    SetOpcode( costs,IsaOpcode::SYNC, 1,0 );
+    SetOpcode( costs,IsaOpcode::WAIT, 1,0 );
+
+    // branches flush the pipeline
+    IsaOpcode branches[] = { IsaOpcode::BRC,IsaOpcode::BRD,IsaOpcode::BREAK,IsaOpcode::CALL,IsaOpcode::CALLA,IsaOpcode::CONT,
+                             IsaOpcode::ELSE,IsaOpcode::ENDIF,IsaOpcode::GOTO,IsaOpcode::HALT,IsaOpcode::IF,IsaOpcode::JMPI,
+                             IsaOpcode::JOIN,IsaOpcode::RET,IsaOpcode::WHILE };
+    for ( IsaOpcode op : branches )
+        SetOpcode( costs,op,4,0 );
+
+    // the extended math unit runs at a quarter rate or less
+    costs.math[MATH_SIMPLE] = OpcodeCost{ 4,22 };
+    costs.math[MATH_TRIG]   = OpcodeCost{ 8,30 };
+    costs.math[MATH_SLOW]   = OpcodeCost{ 16,40 };
+
+    // message latencies assume a cache hit.  Writes don't return anything, so their latency is never waited for
+    SetSend( costs,IsaSendTarget::NONE,           2,0 );
+    SetSend( costs,IsaSendTarget::SAMPLER,        2,220 );
+    SetSend( costs,IsaSendTarget::DATAPORT_READ,  2,150 );
+    SetSend( costs,IsaSendTarget::DATAPORT_WRITE, 2,0 );
+    SetSend( costs,IsaSendTarget::RENDER_TARGET,  2,0 );
+    SetSend( costs,IsaSendTarget::URB,            2,120 );
+    SetSend( costs,IsaSendTarget::SCRATCH_READ,   2,200 );
+    SetSend( costs,IsaSendTarget::SCRATCH_WRITE,  2,0 );
+    SetSend( costs,IsaSendTarget::GATEWAY,        2,50 );
+    SetSend( costs,IsaSendTarget::THREAD_SPAWNER, 2,0 );
+    SetSend( costs,IsaSendTarget::OTHER,          2,150 );
+    return costs;
+}
+
+// Gen11:  Icelake.  Same EU, with a faster sampler and data cache
+PlatformCosts MakeGen11Costs()
+{
+    PlatformCosts costs = MakeGen9Costs();
+    costs.math[MATH_TRIG] = OpcodeCost{ 8,28 };
+    SetSend( costs,IsaSendTarget::SAMPLER,       2,200 );
+    SetSend( costs,IsaSendTarget::DATAPORT_READ, 2,140 );
+    SetSend( costs,IsaSendTarget::SCRATCH_READ,  2,180 );
+    return costs;
+}
+
+const PlatformCosts& GetCosts( Platform platform )
+{
+    static const PlatformCosts gen9 = MakeGen9Costs();
+    static const PlatformCosts gen11 = MakeGen11Costs();
+
+    switch ( platform )
+    {
+    case Platform::ICLLP:
+        return gen11;
+    case Platform::SKL:
+    case Platform::KBL:
+    default:
+        return gen9;
+    }
+}
+
+MathFunction GetMathFunction( const IsaProgram& program, const IsaInstruction& inst )
+{
+    // the function is the mnemonic suffix:  math.sin
+    const char* p = program.GetText() + inst.mnemonic;
+    const char* end = p + inst.mnemonicLength;
+    const char* dot = (const char*)memchr( p,'.',(size_t)(end - p) );
+    if ( !dot )
+        return MATH_SIMPLE;
+
+    size_t n = (size_t)(end - dot - 1);
+    const char* fn = dot+1;
+    if ( (n == 3 && (memcmp( fn,"sin",3 ) == 0 || memcmp( fn,"cos",3 ) == 0)) )
+        return MATH_TRIG;
+    if ( (n == 3 && memcmp( fn,"pow",3 ) == 0) || (n >= 3 && memcmp( fn,"int",3 ) == 0) || (n >= 4 && memcmp( fn,"fdiv",4 ) == 0) )
+        return MATH_SLOW;
+    return MATH_SIMPLE;
+}
+
+// Register slots tracked by the scoreboard:  the GRFs, then the flag registers
+const uint32_t N_GRF = 256;
+const uint32_t N_FLAGS = 4;
+const uint32_t FLAG_SLOT = N_GRF;
+
+// GRFs covered by a register operand:  one per 32 bytes, assuming 4-byte channels
+uint32_t OperandRegisters( const IsaInstruction& inst, const IsaOperand& operand )
+{
+    if ( operand.vstride == 0 && operand.width == 1 )
+        return 1;   // scalar region
+    return std::max<uint32_t>( 1,inst.execSize / 8 );
+}
+
+class Scoreboard
+{
+public:
+    Scoreboard() { memset( m_Ready,0,sizeof( m_Ready ) ); }
+
+    uint64_t ReadyTime( const IsaOperand& operand, uint32_t nRegs ) const
+    {
+        uint64_t ready = 0;
+        if ( operand.kind == IsaOperandKind::GRF )
+        {
+            for ( uint32_t r=operand.value; r<operand.value + nRegs && r<N_GRF; r++ )
+                ready = std::max( ready,m_Ready[r] );
+        }
+        else if ( operand.kind == IsaOperandKind::ARF )
+        {
+            // f0, f1 and friends are the only architecture registers we track
+            ready = m_Ready[FLAG_SLOT + (operand.value % N_FLAGS)];
+        }
+        return ready;
+    }
+
+    uint64_t FlagReady() const
+    {
+        uint64_t ready = 0;
+        for ( uint32_t i=0; i<N_FLAGS; i++ )
+            ready = std::max( ready,m_Ready[FLAG_SLOT+i] );
+        return ready;
+    }
+
+    void Write( const IsaOperand& operand, uint32_t nRegs, uint64_t time )
+    {
+        if ( operand.kind != IsaOperandKind::GRF )
+            return;
+        for ( uint32_t r=operand.value; r<operand.value + nRegs && r<N_GRF; r++ )
+            m_Ready[r] = time;
+    }
+
+    void WriteFlags( uint64_t time )
+    {
+        for ( uint32_t i=0; i<N_FLAGS; i++ )
+            m_Ready[FLAG_SLOT+i] = time;
+    }
+
+private:
+    uint64_t m_Ready[N_GRF + N_FLAGS];
+};
+
+}
+
+void EstimateCycles( const IsaProgram& program, const IsaCFG& cfg, Platform platform, unsigned loopTrips, CycleEstimate& estimate )
+{
+    const PlatformCosts& costs = GetCosts( platform );
+    const std::vector<IsaInstruction>& instructions = program.GetInstructions();
+    const std::vector<IsaBlock>& blocks = cfg.GetBlocks();
+
+    estimate.blockCycles.assign( blocks.size(),0 );
+    estimate.blockWeights.assign( blocks.size(),1.0 );
+    estimate.straightLine = 0;
+    estimate.total = 0;
+
+    Scoreboard scoreboard;
+    uint64_t clock = 0;
+    for ( size_t b=0; b<blocks.size(); b++ )
+    {
+        const IsaBlock& block = blocks[b];
+        uint64_t blockStart = clock;
+
+        for ( uint32_t i=block.first; i<block.first + block.count; i++ )
+        {
+            const IsaInstruction& inst = instructions[i];
+
+            OpcodeCost cost;
+            uint32_t nDstRegs = OperandRegisters( inst,inst.dst );
+            uint32_t nPayloadRegs = 1;
+            if ( inst.cls == IsaClass::SEND )
+            {
+                // message and response lengths are in the descriptor, where the disassembly gives one
+                cost = costs.send[(size_t)inst.send];
+                uint32_t mlen = (inst.descriptor >> 25) & 0xF;
+                uint32_t rlen = (inst.descriptor >> 20) & 0x1F;
+                nPayloadRegs = std::max<uint32_t>( 1,mlen );
+                nDstRegs = std::max<uint32_t>( 1,rlen );
+            }
+            else if ( inst.cls == IsaClass::MATH )
+            {
+                cost = costs.math[GetMathFunction( program,inst )];
+            }
+            else
+            {
+                cost = costs.opcode[(size_t)inst.opcode];
+            }
+
+            // wider instructions take proportionally longer to issue.  Narrower ones take as long as SIMD8
+            uint64_t issue = cost.issue;
+            if ( inst.cls != IsaClass::SEND && inst.execSize > 8 )
+                issue = issue * inst.execSize / 8;
+
+            uint64_t start = clock;
+            for ( uint8_t s=0; s<inst.nSources; s++ )
+            {
+                uint32_t nRegs = (inst.cls == IsaClass::SEND && s == 0) ? nPayloadRegs : OperandRegisters( inst,inst.src[s] );
+                start = std::max( start,scoreboard.ReadyTime( inst.src[s],nRegs ) );
+            }
+            if ( inst.flags & IsaFlags::PREDICATED )
+                start = std::max( start,scoreboard.FlagReady() );
+
+            clock = start + issue;
+            scoreboard.Write( inst.dst,nDstRegs,start + cost.latency );
+
+            // a compare with a conditional modifier writes the flags
+            if ( inst.opcode == IsaOpcode::CMP || inst.opcode == IsaOpcode::CMPN )
+                scoreboard.WriteFlags( start + cost.latency );
+        }
+
+        uint64_t cycles = clock - blockStart;
+        double weight = std::pow( (double)std::max( 1u,loopTrips ),(double)block.loopDepth );
+        estimate.blockCycles[b] = cycles;
+        estimate.blockWeights[b] = weight;
+        estimate.straightLine += cycles;
+        estimate.total += (double)cycles * weight;
+    }
+}
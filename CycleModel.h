@@ -0,0 +1,51 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _CYCLE_MODEL_H_
+#define _CYCLE_MODEL_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Portability.h"
+#include "IntelGPUCompiler.h"
+
+class IsaProgram;
+class IsaCFG;
+
+struct CycleEstimate
+{
+    std::vector<uint64_t> blockCycles;  // cycles for one pass through each block
+    std::vector<double> blockWeights;   // expected executions of each block, from its loop depth
+    uint64_t straightLine = 0;          // every block once
+    double total = 0;                   // weighted by the loop trip count
+};
+
+//
+//  Static estimate of the cycles one hardware thread spends in each block.
+//
+//   Instructions issue in order.  Each opcode has an issue cost, for SIMD8, and a latency.  An instruction waits until the
+//   registers and flags it reads have been written.  The scoreboard carries over from one block to the next in program order,
+//   so a sampler result used after a branch still costs its latency.  Both sides of every branch are assumed to run, because
+//   channels in a thread usually diverge.  A block nested in N loops is assumed to run loopTrips^N times.
+//
+//   The tables are rough estimates for comparing shaders with one another.  They are not measured timings, and ignore
+//   co-issue between threads, cache behavior and memory bandwidth
+//
+void EstimateCycles( const IsaProgram& program, const IsaCFG& cfg, IntelGPUCompiler::Platform platform, unsigned loopTrips,
+                     CycleEstimate& estimate );
+
+#endif
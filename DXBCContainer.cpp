@@ -0,0 +1,270 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "DXBCContainer.h"
+#include <cstring>
+
+//
+//  Container layout:
+//      uint32  magic           'DXBC'
+//      uint8   checksum[16]
+//      uint32  version         always 1
+//      uint32  total size
+//      uint32  part count
+//      uint32  part offsets[part count]
+//
+//  Each part is:
+//      uint32  fourcc
+//      uint32  size
+//      uint8   data[size]
+//
+static const size_t HEADER_SIZE      = 32;
+static const size_t PART_HEADER_SIZE = 8;
+
+uint32_t DXBCContainer::ReadU32( size_t offset ) const
+{
+    uint32_t v;
+    memcpy( &v,m_pData + offset,sizeof(v) );
+    return v;
+}
+
+bool DXBCContainer::Parse( const void* data, size_t size )
+{
+    m_pData = (const uint8_t*)data;
+    m_nSize = 0;
+    m_nParts = 0;
+    m_pError = nullptr;
+
+    if ( size < HEADER_SIZE || !data )
+    {
+        m_pError = "buffer is too small for a DXBC container";
+        return false;
+    }
+    if ( ReadU32( 0 ) != DXBCPart::DXBC )
+    {
+        m_pError = "missing DXBC magic";
+        return false;
+    }
+    if ( ReadU32( 20 ) != 1 )
+    {
+        m_pError = "unsupported container version";
+        return false;
+    }
+
+    uint32_t totalSize = ReadU32( 24 );
+    uint32_t nParts = ReadU32( 28 );
+    if ( totalSize > size || totalSize < HEADER_SIZE )
+    {
+        m_pError = "container size does not match the buffer";
+        return false;
+    }
+    if ( nParts > (totalSize - HEADER_SIZE) / 4 )
+    {
+        m_pError = "part table is larger than the container";
+        return false;
+    }
+
+    size_t partTableEnd = HEADER_SIZE + 4 * (size_t)nParts;
+    for ( uint32_t i=0; i<nParts; i++ )
+    {
+        size_t offset = ReadU32( HEADER_SIZE + 4*i );
+        if ( offset < partTableEnd || offset > totalSize || totalSize - offset < PART_HEADER_SIZE )
+        {
+            m_pError = "part header lies outside the container";
+            return false;
+        }
+        
+        size_t partSize = ReadU32( offset + 4 );
+        if ( partSize > totalSize - offset - PART_HEADER_SIZE )
+        {
+            m_pError = "part data lies outside the container";
+            return false;
+        }
+    }
+
+    m_nSize = totalSize;
+    m_nParts = nParts;
+    return true;
+}
+
+bool DXBCContainer::HasChecksum() const
+{
+    // tools which don't sign their output leave the checksum zeroed
+    for ( size_t i=0; i<16; i++ )
+        if ( m_pData[4+i] )
+            return true;
+    return false;
+}
+
+uint32_t DXBCContainer::GetPartFourCC( uint32_t i ) const
+{
+    return ReadU32( ReadU32( HEADER_SIZE + 4*i ) );
+}
+
+ByteSpan DXBCContainer::GetPart( uint32_t i ) const
+{
+    size_t offset = ReadU32( HEADER_SIZE + 4*i );
+    return ByteSpan{ m_pData + offset + PART_HEADER_SIZE,ReadU32( offset + 4 ) };
+}
+
+bool DXBCContainer::FindPart( uint32_t fourcc, ByteSpan& part ) const
+{
+    for ( uint32_t i=0; i<m_nParts; i++ )
+    {
+        if ( GetPartFourCC( i ) == fourcc )
+        {
+            part = GetPart( i );
+            return true;
+        }
+    }
+    return false;
+}
+
+bool IsDXBCContainer( const void* data, size_t size )
+{
+    uint32_t magic;
+    if ( size < HEADER_SIZE )
+        return false;
+    memcpy( &magic,data,sizeof(magic) );
+    return magic == DXBCPart::DXBC;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//  Checksums
+//
+//   The container checksum is MD5 with a non-standard finalization step.  
+//    The message length (in bits) is placed at the start of the final block instead of the end, 
+//    and the last dword of the final block holds (bits >> 2) | 1
+/////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t Rotl32( uint32_t x, int r )
+{
+    return (x << r) | (x >> (32 - r));
+}
+
+static void MD5Transform( uint32_t state[4], const uint8_t block[64] )
+{
+    static const uint32_t K[64] = {
+        0xd76aa478,0xe8c7b756,0x242070db,0xc1bdceee,0xf57c0faf,0x4787c62a,0xa8304613,0xfd469501,
+        0x698098d8,0x8b44f7af,0xffff5bb1,0x895cd7be,0x6b901122,0xfd987193,0xa679438e,0x49b40821,
+        0xf61e2562,0xc040b340,0x265e5a51,0xe9b6c7aa,0xd62f105d,0x02441453,0xd8a1e681,0xe7d3fbc8,
+        0x21e1cde6,0xc33707d6,0xf4d50d87,0x455a14ed,0xa9e3e905,0xfcefa3f8,0x676f02d9,0x8d2a4c8a,
+        0xfffa3942,0x8771f681,0x6d9d6122,0xfde5380c,0xa4beea44,0x4bdecfa9,0xf6bb4b60,0xbebfbc70,
+        0x289b7ec6,0xeaa127fa,0xd4ef3085,0x04881d05,0xd9d4d039,0xe6db99e5,0x1fa27cf8,0xc4ac5665,
+        0xf4292244,0x432aff97,0xab9423a7,0xfc93a039,0x655b59c3,0x8f0ccc92,0xffeff47d,0x85845dd1,
+        0x6fa87e4f,0xfe2ce6e0,0xa3014314,0x4e0811a1,0xf7537e82,0xbd3af235,0x2ad7d2bb,0xeb86d391 };
+    static const int R[64] = {
+        7,12,17,22,7,12,17,22,7,12,17,22,7,12,17,22,
+        5, 9,14,20,5, 9,14,20,5, 9,14,20,5, 9,14,20,
+        4,11,16,23,4,11,16,23,4,11,16,23,4,11,16,23,
+        6,10,15,21,6,10,15,21,6,10,15,21,6,10,15,21 };
+
+    uint32_t M[16];
+    memcpy( M,block,64 );
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    for ( int i=0; i<64; i++ )
+    {
+        uint32_t f;
+        int g;
+        if ( i < 16 )      { f = (b & c) | (~b & d); g = i; }
+        else if ( i < 32 ) { f = (d & b) | (~d & c); g = (5*i + 1) & 15; }
+        else if ( i < 48 ) { f = b ^ c ^ d;          g = (3*i + 5) & 15; }
+        else               { f = c ^ (b | ~d);       g = (7*i) & 15; }
+
+        uint32_t t = d;
+        d = c;
+        c = b;
+        b = b + Rotl32( a + f + K[i] + M[g],R[i] );
+        a = t;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+}
+
+void ComputeDXBCChecksum( const void* data, size_t size, uint8_t checksum[16] )
+{
+    uint32_t state[4] = { 0x67452301,0xefcdab89,0x98badcfe,0x10325476 };
+
+    // skip the magic and the checksum itself
+    const uint8_t* p = (const uint8_t*)data + 20;
+    size -= 20;
+
+    size_t nFull = size & ~(size_t)63;
+    for ( size_t i=0; i<nFull; i += 64 )
+        MD5Transform( state,p + i );
+
+    p += nFull;
+    size_t left = size - nFull;
+    uint32_t nBits = (uint32_t)(size * 8);
+    uint32_t lastDword = (nBits >> 2) | 1;
+
+    uint8_t block[64];
+    if ( left >= 56 )
+    {
+        memset( block,0,64 );
+        memcpy( block,p,left );
+        block[left] = 0x80;
+        MD5Transform( state,block );
+
+        memset( block,0,64 );
+        memcpy( block,&nBits,4 );
+        memcpy( block + 60,&lastDword,4 );
+        MD5Transform( state,block );
+    }
+    else
+    {
+        memset( block,0,64 );
+        memcpy( block,&nBits,4 );
+        memcpy( block + 4,p,left );
+        block[4 + left] = 0x80;
+        memcpy( block + 60,&lastDword,4 );
+        MD5Transform( state,block );
+    }
+
+    memcpy( checksum,state,16 );
+}
+
+void BuildDXBCContainer( const uint32_t* fourccs, const ByteSpan* parts, uint32_t nParts, std::vector<uint8_t>& container )
+{
+    size_t total = HEADER_SIZE + 4 * (size_t)nParts;
+    for ( uint32_t i=0; i<nParts; i++ )
+        total += PART_HEADER_SIZE + parts[i].size;
+
+    container.assign( total,0 );
+    uint8_t* p = container.data();
+
+    uint32_t header[4] = { DXBCPart::DXBC,1,(uint32_t)total,nParts };
+    memcpy( p,&header[0],4 );
+    memcpy( p + 20,&header[1],12 );
+
+    size_t offset = HEADER_SIZE + 4 * (size_t)nParts;
+    for ( uint32_t i=0; i<nParts; i++ )
+    {
+        uint32_t partHeader[2] = { fourccs[i],(uint32_t)parts[i].size };
+        uint32_t partOffset = (uint32_t)offset;
+        memcpy( p + HEADER_SIZE + 4*i,&partOffset,4 );
+        memcpy( p + offset,partHeader,PART_HEADER_SIZE );
+        if ( parts[i].size )
+            memcpy( p + offset + PART_HEADER_SIZE,parts[i].data,parts[i].size );
+        offset += PART_HEADER_SIZE + parts[i].size;
+    }
+
+    ComputeDXBCChecksum( p,total,p + 4 );
+}
@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _DXBC_CONTAINER_H_
+#define _DXBC_CONTAINER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Non-owning view of a range of bytes
+struct ByteSpan
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+    bool empty() const { return size == 0; }
+};
+
+#define DXBC_FOURCC(a,b,c,d) ( (uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24) )
+
+namespace DXBCPart
+{
+    static const uint32_t DXBC = DXBC_FOURCC( 'D','X','B','C' );    // container magic
+    static const uint32_t RTS0 = DXBC_FOURCC( 'R','T','S','0' );    // serialized root signature
+    static const uint32_t SHEX = DXBC_FOURCC( 'S','H','E','X' );    // SM5 bytecode
+    static const uint32_t SHDR = DXBC_FOURCC( 'S','H','D','R' );    // SM4 bytecode
+    static const uint32_t DXIL = DXBC_FOURCC( 'D','X','I','L' );    // SM6 bitcode
+    static const uint32_t RDEF = DXBC_FOURCC( 'R','D','E','F' );    // resource definitions
+    static const uint32_t ISGN = DXBC_FOURCC( 'I','S','G','N' );    // input signature
+    static const uint32_t OSGN = DXBC_FOURCC( 'O','S','G','N' );    // output signature
+    static const uint32_t ISG1 = DXBC_FOURCC( 'I','S','G','1' );    // SM5.1+ input signature
+    static const uint32_t OSG1 = DXBC_FOURCC( 'O','S','G','1' );    // SM5.1+ output signature
+    static const uint32_t PSV0 = DXBC_FOURCC( 'P','S','V','0' );    // pipeline state validation
+    static const uint32_t STAT = DXBC_FOURCC( 'S','T','A','T' );    // statistics
+    static const uint32_t SFI0 = DXBC_FOURCC( 'S','F','I','0' );    // feature info
+}
+
+//
+//  Reader for the DXBC container format, which wraps both DXBC and DXIL shaders.
+//    Parse validates the header and every part offset against the size of the buffer.  
+//    Parts are returned as views into the caller's buffer, which must outlive the container.  Nothing is allocated or copied.
+//
+class DXBCContainer
+{
+public:
+    bool Parse( const void* data, size_t size );
+
+    // Reason for the last Parse failure
+    const char* GetError() const { return m_pError; }
+
+    // The whole container.  May be smaller than the buffer given to Parse
+    ByteSpan GetContainer() const { return ByteSpan{ m_pData,m_nSize }; }
+    const uint8_t* GetChecksum() const { return m_pData + 4; }
+    bool HasChecksum() const;
+
+    uint32_t GetPartCount() const { return m_nParts; }
+    uint32_t GetPartFourCC( uint32_t i ) const;
+    ByteSpan GetPart( uint32_t i ) const;
+
+    bool FindPart( uint32_t fourcc, ByteSpan& part ) const;
+    bool HasPart( uint32_t fourcc ) const { ByteSpan part; return FindPart( fourcc,part ); }
+
+private:
+    uint32_t ReadU32( size_t offset ) const;
+
+    const uint8_t* m_pData = nullptr;
+    size_t m_nSize = 0;
+    uint32_t m_nParts = 0;
+    const char* m_pError = nullptr;
+};
+
+// Returns true if the buffer starts with the container magic.  Cheap enough for sniffing files
+bool IsDXBCContainer( const void* data, size_t size );
+
+// Computes the checksum stored in a container header.  The checksum covers everything after the checksum field
+void ComputeDXBCChecksum( const void* data, size_t size, uint8_t checksum[16] );
+
+// Builds a new container holding the given parts, with a valid checksum
+void BuildDXBCContainer( const uint32_t* fourccs, const ByteSpan* parts, uint32_t nParts, std::vector<uint8_t>& container );
+
+#endif
@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "DependencyDatabase.h"
+#include "IncludeScanner.h"
+#include "IntelShaderAnalyzer.h"
+#include "Permutations.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+Hash128 DependencyDatabase::MakeKey( const JobOptions& job ) const
+{
+    auto str = []( const char* s ) { return std::string( s ? s : "" ); };
+
+    // everything which changes what the job reads, what it produces, or where it writes it
+    Hasher h;
+    h.UpdateValue( m_Salt );
+    h.Update( str( job.source_lang ) );
+    h.Update( str( job.api ) );
+    h.Update( str( job.rootsig_file ) );
+    for ( const char* asic : job.asicNames )
+        h.Update( str( asic ) );
+    h.Update( "" );
+    for ( const char* option : job.permute )
+        h.Update( str( option ) );
+    h.Update( "" );
+
+    const FrontendOptions& frontend = job.frontend;
+    h.Update( str( frontend.input_file ) );
+    h.Update( str( frontend.profile ) );
+    h.Update( str( frontend.entry ) );
+    for ( const auto& define : frontend.defines )
+    {
+        h.Update( str( define.first ) );
+        h.Update( str( define.second ) );
+    }
+    h.Update( "" );
+    h.UpdateValue( frontend.dx_flags );
+    h.Update( str( frontend.dx_location ) );
+    h.Update( str( frontend.rs_macro ) );
+    h.Update( str( frontend.rs_profile ) );
+
+    const ToolInputs& inputs = job.inputs;
+    h.Update( str( inputs.isa_prefix ) );
+    h.Update( str( inputs.shader_id ) );
+    h.UpdateValue( inputs.isa_binary );
+    h.UpdateValue( inputs.write_cfg );
+    return h.Finish();
+}
+
+bool DependencyDatabase::HashFile( const std::string& path, Hash128& hash )
+{
+    InputBuffer buffer;
+    if ( !buffer.Load( path.c_str() ) )
+        return false;
+    hash = Hasher::Compute( buffer.data(),buffer.size() );
+    return true;
+}
+
+bool DependencyDatabase::Open( const char* path, const Hash128& salt )
+{
+    m_Path = path;
+    m_Salt = salt;
+    m_Records.clear();
+
+    std::ifstream file( path );
+    if ( !file.good() )
+    {
+        std::error_code ec;
+        if ( !fs::exists( path,ec ) )
+            return true;
+        m_Error = "Failed to read dependency database: " + m_Path;
+        return false;
+    }
+
+    DependencyRecord* record = nullptr;
+    std::string line;
+    size_t lineNumber = 0;
+    while ( std::getline( file,line ) )
+    {
+        lineNumber++;
+        if ( line.empty() || line[0] == '#' )
+            continue;
+
+        size_t space = line.find( ' ' );
+        std::string tag = line.substr( 0,space );
+        std::string rest = (space == std::string::npos) ? "" : line.substr( space + 1 );
+
+        bool valid = false;
+        if ( tag == "job" )
+        {
+            Hash128 key;
+            if ( Hash128::FromString( rest.c_str(),key ) )
+            {
+                record = &m_Records[key.ToString()];
+                *record = DependencyRecord();
+                record->key = key;
+                valid = true;
+            }
+        }
+        else if ( tag == "in" && record && rest.size() > 33 && rest[32] == ' ' )
+        {
+            Hash128 hash;
+            if ( Hash128::FromString( rest.substr( 0,32 ).c_str(),hash ) )
+            {
+                record->inputs.emplace_back( rest.substr( 33 ),hash );
+                valid = true;
+            }
+        }
+        else if ( tag == "out" && record && !rest.empty() )
+        {
+            record->outputs.push_back( rest );
+            valid = true;
+        }
+
+        if ( !valid )
+        {
+            m_Error = m_Path + "(" + std::to_string( lineNumber ) + "): malformed dependency record";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DependencyDatabase::Check( const JobOptions& job, DependencyRecord& record )
+{
+    record = DependencyRecord();
+    record.key = MakeKey( job );
+
+    const char* input_file = job.frontend.input_file;
+    if ( input_file == nullptr )
+    {
+        record.complete = false;
+        return false;
+    }
+
+    std::vector<Permutation> permutations;
+    ExpandPermutations( job,permutations );
+
+    if ( _stricmp( job.source_lang,"hlsl" ) == 0 )
+    {
+        // each permutation may include different files.  The job depends on all of them
+        for ( const Permutation& permutation : permutations )
+        {
+            std::vector< std::pair<const char*,const char*> > defines = job.frontend.defines;
+            for ( const auto& define : permutation.defines )
+                defines.emplace_back( define.first.c_str(),define.second.c_str() );
+
+            DependencyScan scan;
+            if ( !ScanDependencies( m_Sources,input_file,defines,scan ) || !scan.complete )
+            {
+                record.complete = false;
+                return false;
+            }
+
+            for ( auto& file : scan.files )
+                if ( std::find( record.inputs.begin(),record.inputs.end(),file ) == record.inputs.end() )
+                    record.inputs.push_back( std::move( file ) );
+        }
+    }
+    else
+    {
+        Hash128 hash;
+        if ( !HashFile( input_file,hash ) )
+        {
+            record.complete = false;
+            return false;
+        }
+        record.inputs.emplace_back( input_file,hash );
+    }
+
+    if ( job.rootsig_file != nullptr )
+    {
+        Hash128 hash;
+        if ( !HashFile( job.rootsig_file,hash ) )
+        {
+            record.complete = false;
+            return false;
+        }
+        record.inputs.emplace_back( job.rootsig_file,hash );
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    auto it = m_Records.find( record.key.ToString() );
+    if ( it == m_Records.end() || it->second.inputs != record.inputs )
+        return false;
+
+    for ( const std::string& output : it->second.outputs )
+    {
+        std::error_code ec;
+        if ( !fs::exists( output,ec ) )
+            return false;
+    }
+    return true;
+}
+
+void DependencyDatabase::Update( DependencyRecord& record, const JobOptions& job )
+{
+    if ( !record.complete )
+    {
+        Remove( record.key );
+        return;
+    }
+
+    const ToolInputs& inputs = job.inputs;
+    std::vector<Permutation> permutations;
+    ExpandPermutations( job,permutations );
+
+    record.outputs.clear();
+    for ( const Permutation& permutation : permutations )
+    {
+        for ( const IntelGPUCompiler::PlatformInfo& asic : inputs.asics )
+        {
+            std::string prefix = std::string( inputs.isa_prefix ? inputs.isa_prefix : "" );
+            if ( !permutation.name.empty() )
+                prefix += permutation.name + "_";
+            prefix += asic.platformName;
+
+            record.outputs.push_back( prefix + (inputs.isa_binary ? ".bin" : ".asm") );
+            if ( inputs.write_cfg )
+                record.outputs.push_back( prefix + ".cfg" );
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_Records[record.key.ToString()] = record;
+    m_Dirty = true;
+}
+
+void DependencyDatabase::Remove( const Hash128& key )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if ( m_Records.erase( key.ToString() ) )
+        m_Dirty = true;
+}
+
+bool DependencyDatabase::Save()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if ( !m_Dirty )
+        return true;
+
+    // write a new database beside the old one and rename it into place, so an interrupted run never leaves half a file
+    std::string temp = m_Path + ".tmp";
+    FILE* fp = fopen( temp.c_str(),"w" );
+    if ( !fp )
+    {
+        m_Error = "Failed to write dependency database: " + m_Path;
+        return false;
+    }
+
+    fprintf( fp,"# IntelShaderAnalyzer dependency database\n" );
+    for ( const auto& it : m_Records )
+    {
+        const DependencyRecord& record = it.second;
+        fprintf( fp,"job %s\n",it.first.c_str() );
+        for ( const auto& input : record.inputs )
+            fprintf( fp,"in %s %s\n",input.second.ToString().c_str(),input.first.c_str() );
+        for ( const std::string& output : record.outputs )
+            fprintf( fp,"out %s\n",output.c_str() );
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+
+    std::error_code ec;
+    if ( succeeded )
+        fs::rename( temp,m_Path,ec );
+    if ( !succeeded || ec )
+    {
+        fs::remove( temp,ec );
+        m_Error = "Failed to write dependency database: " + m_Path;
+        return false;
+    }
+
+    m_Dirty = false;
+    return true;
+}
@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _DEPENDENCY_DATABASE_H_
+#define _DEPENDENCY_DATABASE_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Hash.h"
+
+class SourceCache;
+struct JobOptions;
+
+struct DependencyRecord
+{
+    Hash128 key;                                            // identifies the job:  its options and the compiler
+    std::vector< std::pair<std::string,Hash128> > inputs;   // every file the job read, with its content hash
+    std::vector<std::string> outputs;                       // every file the job wrote
+    bool complete = true;                                   // false if the inputs couldn't all be found
+};
+
+//
+//  Remembers what each job read and wrote the last time it succeeded, so that an unchanged job can be skipped.
+//
+//  A job is up to date if the database holds a record for the same options and compiler, every input still has the hash
+//   it had then, and every output still exists.  For HLSL, the inputs are the shader and everything it #includes, as 
+//   found by ScanDependencies.  The database is a text file, rewritten in full by Save:
+//
+//      job <key>
+//      in <hash> <path>
+//      out <path>
+//
+class DependencyDatabase
+{
+public:
+    explicit DependencyDatabase( SourceCache& sources ) : m_Sources( sources ) {}
+
+    // Loads the database.  A missing file is an empty database.  The salt identifies the compiler and anything else
+    //  outside the job's options which changes the results
+    bool Open( const char* path, const Hash128& salt );
+    const std::string& GetError() const { return m_Error; }
+
+    // Fills in the job's key and current inputs.  Returns true if its last results are still good
+    bool Check( const JobOptions& job, DependencyRecord& record );
+
+    // Records a job which succeeded, once RunJob has chosen its platforms.  Incomplete records are not kept
+    void Update( DependencyRecord& record, const JobOptions& job );
+    void Remove( const Hash128& key );
+
+    bool Save();
+
+private:
+    Hash128 MakeKey( const JobOptions& job ) const;
+    bool HashFile( const std::string& path, Hash128& hash );
+
+    SourceCache& m_Sources;
+    std::string m_Path;
+    std::string m_Error;
+    Hash128 m_Salt;
+    bool m_Dirty = false;
+
+    std::mutex m_Mutex;
+    std::map< std::string,DependencyRecord > m_Records;     // keyed by the record's key, as text, so Save is deterministic
+};
+
+#endif
@@ -14,9 +14,18 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #include "IntelShaderAnalyzer.h"
+#include "DXBCContainer.h"
+#include "IncludeScanner.h"
+#include "RootSignature.h"
+#include "RootSignatureCache.h"
+#include "Trace.h"
+
+#ifdef _WIN32
+
 #include <d3dcompiler.h>
 #include <fstream>
 #include <atlbase.h>
+#include <unordered_map>
 
 typedef HRESULT( WINAPI *D3DCOMPILE_FUNC )(
     LPCVOID pSrcData,
@@ -31,61 +40,68 @@ typedef HRESULT( WINAPI *D3DCOMPILE_FUNC )(
     ID3DBlob **ppCode,
     ID3DBlob **ppErrorMsgs);
 
-typedef HRESULT( WINAPI *D3DGETBLOBPART_FUNC )(
-    LPCVOID pShaderBytecode,
-    SIZE_T BytecodeLength,
-    UINT uBlobPartEnum,
-    UINT uFlags,
-    ID3DBlob **ppBlob
-    );
+// Keeps a blob alive for as long as an InputBuffer refers to its contents, so we don't have to copy it
+static std::shared_ptr<const void> HoldBlob( ID3DBlob* pBlob )
+{
+    pBlob->AddRef();
+    return std::shared_ptr<const void>( pBlob,[]( const void* p ) { ((ID3DBlob*)p)->Release(); } );
+}
 
-bool GetRootSignatureFromDXBC( FrontendOptions& frontend_opts, ToolInputs& inputs  )
+// Serves #includes from a SourceCache, so that headers shared by many shaders are read once.  Files are found in the same
+//  places D3D_COMPILE_STANDARD_FILE_INCLUDE looks for them, which are also where ScanDependencies looks for them
+class CachedInclude : public ID3DInclude
 {
-    HINSTANCE hCompiler = LoadLibraryA( frontend_opts.dx_location );
-    if(!hCompiler)
-    {
-        printf( "Failed to load D3D compiler dll from: %s\n", frontend_opts.dx_location );
-        return false;
-    }
+public:
+    CachedInclude( SourceCache& cache, const char* rootFile ) : m_Cache( cache ), m_Root( rootFile ) {}
 
-    D3DGETBLOBPART_FUNC pfnD3DGetBlobPart = (D3DGETBLOBPART_FUNC) GetProcAddress( hCompiler, "D3DGetBlobPart" );
-    if(!pfnD3DGetBlobPart)
+    HRESULT STDMETHODCALLTYPE Open( D3D_INCLUDE_TYPE, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes ) override
     {
-        printf( "GetProcAddress failed for D3DGetBlobPart\n" );
-        return false;
+        // the compiler tells us which file is doing the including by handing back the data we gave it for that file
+        auto parent = m_Open.find( pParentData );
+        const std::string& includingFile = (parent != m_Open.end()) ? parent->second->path : m_Root;
+
+        std::string path;
+        std::shared_ptr<const SourceFile> file = m_Cache.FindInclude( pFileName,includingFile,m_Root,path );
+        if ( !file )
+            return E_FAIL;
+
+        m_Open[file->text.data()] = file;
+        *ppData = file->text.data();
+        *pBytes = (UINT)file->text.size();
+        return S_OK;
     }
 
-    CComPtr<ID3DBlob> pEmbeddedRS;
-    HRESULT hr = pfnD3DGetBlobPart( inputs.bytecode.data(), inputs.bytecode.size(), D3D_BLOB_ROOT_SIGNATURE, 0, &pEmbeddedRS );
-    if(SUCCEEDED( hr ))
+    // files stay open until the compile is done, because they may still be needed to find nested includes
+    HRESULT STDMETHODCALLTYPE Close( LPCVOID ) override
     {
-        inputs.rootsig.resize( pEmbeddedRS->GetBufferSize() );
-        memcpy( inputs.rootsig.data(), pEmbeddedRS->GetBufferPointer(), pEmbeddedRS->GetBufferSize() );
+        return S_OK;
     }
 
-    return true;
-}
-
+private:
+    SourceCache& m_Cache;
+    std::string m_Root;
+    std::unordered_map< LPCVOID,std::shared_ptr<const SourceFile> > m_Open;
+};
 
 bool CompileHLSL( FrontendOptions& frontend_opts,ToolInputs& inputs )
 {
-    HINSTANCE hCompiler = LoadLibraryA( frontend_opts.dx_location );
+    TraceLabel trace{ inputs.trace,inputs.shader_id };
+
+    HINSTANCE hCompiler;
+    {
+        TraceScope scope( trace,TraceStage::LOAD_D3D );
+        hCompiler = LoadLibraryA( frontend_opts.dx_location );
+    }
     if ( !hCompiler )
     {
-        printf( "Failed to load D3D compiler dll from: %s\n",frontend_opts.dx_location );
+        LogMessage( inputs,"Failed to load D3D compiler dll from: %s",frontend_opts.dx_location );
         return false;
     }
 
     D3DCOMPILE_FUNC pfnD3DCompile = (D3DCOMPILE_FUNC)GetProcAddress( hCompiler,"D3DCompile" );
     if ( !pfnD3DCompile )
     {
-        printf( "GetProcAddress failed for D3DCompile\n" );
-        return false;
-    }
-    D3DGETBLOBPART_FUNC pfnD3DGetBlobPart = (D3DGETBLOBPART_FUNC)GetProcAddress( hCompiler,"D3DGetBlobPart" );
-    if ( !pfnD3DGetBlobPart )
-    {
-        printf( "GetProcAddress failed for D3DGetBlobPart\n" );
+        LogMessage( inputs,"GetProcAddress failed for D3DCompile" );
         return false;
     }
 
@@ -100,47 +116,99 @@ bool CompileHLSL( FrontendOptions& frontend_opts,ToolInputs& inputs )
 
     macros.push_back( D3D_SHADER_MACRO{ nullptr,nullptr } );
 
+    std::unique_ptr<CachedInclude> pCachedInclude;
+    ID3DInclude* pInclude = D3D_COMPILE_STANDARD_FILE_INCLUDE;
+    if ( frontend_opts.include_cache )
+    {
+        pCachedInclude.reset( new CachedInclude( *frontend_opts.include_cache,frontend_opts.input_file ) );
+        pInclude = pCachedInclude.get();
+    }
+
     CComPtr<ID3DBlob> pCode;
     CComPtr<ID3DBlob> pMessages;
-    HRESULT hr = pfnD3DCompile( frontend_opts.input_text.c_str(),
-        frontend_opts.input_text.size(),
-        frontend_opts.input_file,macros.data(),
-        D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        frontend_opts.entry,
-        frontend_opts.profile,
-        frontend_opts.dx_flags,
-        0,
-        &pCode,
-        &pMessages );
+    HRESULT hr;
+    {
+        TraceScope scope( trace,TraceStage::D3D_COMPILE );
+        hr = pfnD3DCompile( frontend_opts.input_text.data(),
+            frontend_opts.input_text.size(),
+            frontend_opts.input_file,macros.data(),
+            pInclude,
+            frontend_opts.entry,
+            frontend_opts.profile,
+            frontend_opts.dx_flags,
+            0,
+            &pCode,
+            &pMessages );
+    }
 
     if ( pMessages )
-        printf( "%s\n",(char*)pMessages->GetBufferPointer() );        
+        LogMessage( inputs,"%s",(char*)pMessages->GetBufferPointer() );
     
     if ( FAILED( hr ) )
         return false;
     
     if ( pCode )
     {
-        inputs.bytecode.resize( pCode->GetBufferSize() );
-        memcpy( inputs.bytecode.data(),pCode->GetBufferPointer(),pCode->GetBufferSize() );
+        inputs.bytecode.Borrow( pCode->GetBufferPointer(),pCode->GetBufferSize(),HoldBlob( pCode ) );
 
         // try to extract root signature if one is embedded
-        CComPtr<ID3DBlob> pEmbeddedRS;
-        hr = pfnD3DGetBlobPart( pCode->GetBufferPointer(), pCode->GetBufferSize(),D3D_BLOB_ROOT_SIGNATURE,0, &pEmbeddedRS );
-        if ( SUCCEEDED( hr ) )
+        bool extracted;
         {
-            inputs.rootsig.resize( pEmbeddedRS->GetBufferSize() );
-            memcpy( inputs.rootsig.data(), pEmbeddedRS->GetBufferPointer(), pEmbeddedRS->GetBufferSize() );
+            TraceScope scope( trace,TraceStage::EXTRACT_ROOTSIG );
+            extracted = GetRootSignatureFromDXBC( inputs );
         }
-        else if( frontend_opts.rs_macro && frontend_opts.rs_profile )
+        if ( !extracted )
+            return false;
+
+        std::string rsText;
+        bool rsResolved = false;
+        RootSignatureCache* rsCache = frontend_opts.rootsig_cache;
+        Hash128 rsKey;
+        if( inputs.rootsig.empty() && frontend_opts.rs_macro && frontend_opts.rs_profile )
+        {
+            // most root signature macros can be resolved without the preprocessor, and compiled without the D3D compiler.
+            //  Many shaders share one, so remember them too.  Anything we can't handle goes to the D3D compiler
+            TraceScope scope( trace,TraceStage::COMPILE_ROOTSIG );
+            rsResolved = ResolveRootSignatureMacro( frontend_opts,frontend_opts.input_file,frontend_opts.input_text.data(),
+                                                    frontend_opts.input_text.size(),rsText );
+
+            if ( rsCache && rsResolved )
+            {
+                rsKey = rsCache->MakeKey( rsText,frontend_opts,RootSignatureCompiler::NATIVE );
+                rsCache->Lookup( rsKey,inputs.rootsig );
+            }
+            else if ( rsCache )
+            {
+                rsCache->CountUncacheable();
+            }
+
+            std::vector<uint8_t> rsContainer;
+            std::string rsError;
+            if ( inputs.rootsig.empty() && rsResolved && CompileRootSignature( rsText,frontend_opts.rs_profile,rsContainer,rsError ) )
+            {
+                if ( rsCache )
+                    rsCache->Store( rsKey,rsContainer.data(),rsContainer.size() );
+                inputs.rootsig.Assign( std::move( rsContainer ) );
+            }
+
+            // what the native compiler can't handle, the D3D compiler may have compiled before
+            if ( inputs.rootsig.empty() && rsCache && rsResolved )
+            {
+                rsKey = rsCache->MakeKey( rsText,frontend_opts,RootSignatureCompiler::D3D );
+                rsCache->Lookup( rsKey,inputs.rootsig );
+            }
+        }
+
+        if( inputs.rootsig.empty() && frontend_opts.rs_macro && frontend_opts.rs_profile )
         {
             // try and compile a root signature using user-specified macro name
+            TraceScope scope( trace,TraceStage::D3D_COMPILE );
             CComPtr<ID3DBlob> pRS;
             CComPtr<ID3DBlob> pRSMessages;
-            hr = pfnD3DCompile( frontend_opts.input_text.c_str(),
+            hr = pfnD3DCompile( frontend_opts.input_text.data(),
                 frontend_opts.input_text.size(),
                 frontend_opts.input_file,macros.data(),
-                D3D_COMPILE_STANDARD_FILE_INCLUDE,
+                pInclude,
                 frontend_opts.rs_macro,
                 frontend_opts.rs_profile,
                 frontend_opts.dx_flags,
@@ -149,15 +217,27 @@ bool CompileHLSL( FrontendOptions& frontend_opts,ToolInputs& inputs )
                 &pRSMessages );
 
             if ( pRSMessages )
-                printf( "%s\n",(char*)pRSMessages->GetBufferPointer() );
+                LogMessage( inputs,"%s",(char*)pRSMessages->GetBufferPointer() );
 
             if ( SUCCEEDED( hr ) )
             {
-                inputs.rootsig.resize( pRS->GetBufferSize() );
-                memcpy( inputs.rootsig.data(),pRS->GetBufferPointer(),pRS->GetBufferSize() );
+                inputs.rootsig.Borrow( pRS->GetBufferPointer(),pRS->GetBufferSize(),HoldBlob( pRS ) );
+                if ( rsCache && rsResolved )
+                    rsCache->Store( rsKey,pRS->GetBufferPointer(),pRS->GetBufferSize() );
             }
         }
     }
 
     return true;
 }
+
+#else
+
+// The HLSL frontend is the D3D compiler DLL, which only exists on Windows.  Elsewhere, shaders must be precompiled
+bool CompileHLSL( FrontendOptions& frontend_opts,ToolInputs& inputs )
+{
+    LogMessage( inputs,"HLSL compilation is not supported on this platform: %s",frontend_opts.input_file );
+    return false;
+}
+
+#endif
@@ -0,0 +1,208 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Hash.h"
+#include <cstring>
+#include <cstdio>
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+static const uint64_t SEED_LO = 0;
+static const uint64_t SEED_HI = 0x6A09E667F3BCC908ull;
+
+static inline uint64_t Rotl( uint64_t x, int r )
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t Read64( const uint8_t* p )
+{
+    uint64_t v;
+    memcpy( &v,p,sizeof(v) );
+    return v;
+}
+
+static inline uint32_t Read32( const uint8_t* p )
+{
+    uint32_t v;
+    memcpy( &v,p,sizeof(v) );
+    return v;
+}
+
+static inline uint64_t Round( uint64_t acc, uint64_t input )
+{
+    acc += input * PRIME64_2;
+    acc = Rotl( acc,31 );
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t MergeRound( uint64_t acc, uint64_t val )
+{
+    acc ^= Round( 0,val );
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+std::string Hash128::ToString() const
+{
+    char buffer[33];
+    snprintf( buffer,sizeof(buffer),"%016llx%016llx",(unsigned long long)hi,(unsigned long long)lo );
+    return buffer;
+}
+
+bool Hash128::FromString( const char* str, Hash128& hash )
+{
+    uint64_t parts[2] = { 0,0 };
+    for ( size_t i=0; i<32; i++ )
+    {
+        char c = str[i];
+        uint64_t digit;
+        if ( c >= '0' && c <= '9' )
+            digit = c - '0';
+        else if ( c >= 'a' && c <= 'f' )
+            digit = c - 'a' + 10;
+        else if ( c >= 'A' && c <= 'F' )
+            digit = c - 'A' + 10;
+        else
+            return false;
+        parts[i/16] = (parts[i/16] << 4) | digit;
+    }
+
+    hash.hi = parts[0];
+    hash.lo = parts[1];
+    return true;
+}
+
+Hasher::Hasher()
+{
+    m_Lanes[0].seed = SEED_LO;
+    m_Lanes[1].seed = SEED_HI;
+    for ( Lane& lane : m_Lanes )
+    {
+        lane.v[0] = lane.seed + PRIME64_1 + PRIME64_2;
+        lane.v[1] = lane.seed + PRIME64_2;
+        lane.v[2] = lane.seed;
+        lane.v[3] = lane.seed - PRIME64_1;
+    }
+}
+
+void Hasher::Consume( const uint8_t* stripe )
+{
+    for ( Lane& lane : m_Lanes )
+    {
+        lane.v[0] = Round( lane.v[0],Read64( stripe ) );
+        lane.v[1] = Round( lane.v[1],Read64( stripe + 8 ) );
+        lane.v[2] = Round( lane.v[2],Read64( stripe + 16 ) );
+        lane.v[3] = Round( lane.v[3],Read64( stripe + 24 ) );
+    }
+}
+
+void Hasher::Update( const void* data, size_t size )
+{
+    const uint8_t* p = (const uint8_t*)data;
+    m_nTotal += size;
+
+    if ( m_nBuffered )
+    {
+        size_t n = sizeof(m_Buffer) - m_nBuffered;
+        if ( n > size )
+            n = size;
+        memcpy( m_Buffer + m_nBuffered,p,n );
+        m_nBuffered += n;
+        p += n;
+        size -= n;
+
+        if ( m_nBuffered < sizeof(m_Buffer) )
+            return;
+
+        Consume( m_Buffer );
+        m_nBuffered = 0;
+    }
+
+    while ( size >= 32 )
+    {
+        Consume( p );
+        p += 32;
+        size -= 32;
+    }
+
+    memcpy( m_Buffer,p,size );
+    m_nBuffered = size;
+}
+
+uint64_t Hasher::FinishLane( const Lane& lane, uint64_t total, const uint8_t* tail, size_t tailSize )
+{
+    uint64_t h;
+    if ( total >= 32 )
+    {
+        h = Rotl( lane.v[0],1 ) + Rotl( lane.v[1],7 ) + Rotl( lane.v[2],12 ) + Rotl( lane.v[3],18 );
+        h = MergeRound( h,lane.v[0] );
+        h = MergeRound( h,lane.v[1] );
+        h = MergeRound( h,lane.v[2] );
+        h = MergeRound( h,lane.v[3] );
+    }
+    else
+    {
+        h = lane.seed + PRIME64_5;
+    }
+
+    h += total;
+
+    const uint8_t* p = tail;
+    const uint8_t* end = tail + tailSize;
+    while ( p + 8 <= end )
+    {
+        h ^= Round( 0,Read64( p ) );
+        h = Rotl( h,27 ) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if ( p + 4 <= end )
+    {
+        h ^= (uint64_t)Read32( p ) * PRIME64_1;
+        h = Rotl( h,23 ) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while ( p < end )
+    {
+        h ^= (*p) * PRIME64_5;
+        h = Rotl( h,11 ) * PRIME64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+Hash128 Hasher::Finish() const
+{
+    Hash128 hash;
+    hash.lo = FinishLane( m_Lanes[0],m_nTotal,m_Buffer,m_nBuffered );
+    hash.hi = FinishLane( m_Lanes[1],m_nTotal,m_Buffer,m_nBuffered );
+    return hash;
+}
+
+Hash128 Hasher::Compute( const void* data, size_t size )
+{
+    Hasher h;
+    h.Update( data,size );
+    return h.Finish();
+}
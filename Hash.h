@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _HASH_H_
+#define _HASH_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+struct Hash128
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==( const Hash128& rhs ) const { return lo == rhs.lo && hi == rhs.hi; }
+    bool operator!=( const Hash128& rhs ) const { return !(*this == rhs); }
+    bool operator<( const Hash128& rhs ) const { return hi != rhs.hi ? hi < rhs.hi : lo < rhs.lo; }
+
+    // 32 lower-case hex digits
+    std::string ToString() const;
+    static bool FromString( const char* str, Hash128& hash );
+};
+
+//
+//  Streaming content hash.  Runs two XXH64 lanes with different seeds over the same data to produce 128 bits.
+//    This is not a cryptographic hash.  It is used to identify shaders, not to defend against tampering.
+//
+class Hasher
+{
+public:
+    Hasher();
+
+    void Update( const void* data, size_t size );
+    void Update( const std::string& str ) { Update( str.c_str(), str.size() + 1 ); }
+
+    template< class T >
+    void UpdateValue( const T& value ) { Update( &value, sizeof(value) ); }
+
+    Hash128 Finish() const;
+
+    static Hash128 Compute( const void* data, size_t size );
+
+private:
+    struct Lane
+    {
+        uint64_t seed;
+        uint64_t v[4];
+    };
+
+    void Consume( const uint8_t* stripe );
+    static uint64_t FinishLane( const Lane& lane, uint64_t total, const uint8_t* tail, size_t tailSize );
+
+    Lane m_Lanes[2];
+    uint8_t m_Buffer[32];
+    size_t m_nBuffered = 0;
+    uint64_t m_nTotal = 0;
+};
+
+#endif
@@ -0,0 +1,851 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IncludeScanner.h"
+#include "InputBuffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <unordered_set>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Directive parsing
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool IsIdentStart( char c )
+{
+    return isalpha( (unsigned char)c ) || c == '_';
+}
+
+bool IsIdent( char c )
+{
+    return isalnum( (unsigned char)c ) || c == '_';
+}
+
+// Joins continued lines and replaces comments with spaces, leaving one logical line per '\n'.  String literals are
+//  copied as they are, so that '//' inside a string isn't taken for a comment
+std::string CleanSource( const char* p, const char* end )
+{
+    std::string out;
+    out.reserve( (size_t)(end - p) );
+    char quote = 0;
+    while ( p < end )
+    {
+        if ( p[0] == '\\' && p + 1 < end && (p[1] == '\n' || (p[1] == '\r' && p + 2 < end && p[2] == '\n')) )
+        {
+            p += (p[1] == '\r') ? 3 : 2;
+            continue;
+        }
+
+        char c = *p;
+        if ( quote )
+        {
+            out.push_back( c );
+            if ( c == '\\' && p + 1 < end && p[1] != '\n' )
+                out.push_back( *++p );
+            else if ( c == quote || c == '\n' )
+                quote = 0;
+            p++;
+        }
+        else if ( c == '"' || c == '\'' )
+        {
+            quote = c;
+            out.push_back( *p++ );
+        }
+        else if ( c == '/' && p + 1 < end && p[1] == '/' )
+        {
+            while ( p < end && *p != '\n' )
+                p++;
+        }
+        else if ( c == '/' && p + 1 < end && p[1] == '*' )
+        {
+            p += 2;
+            while ( p + 1 < end && !(p[0] == '*' && p[1] == '/') )
+                p++;
+            p = std::min( p + 2,end );
+            out.push_back( ' ' );
+        }
+        else if ( c != '\r' )
+        {
+            out.push_back( *p++ );
+        }
+        else
+        {
+            p++;
+        }
+    }
+    return out;
+}
+
+const char* SkipSpace( const char* p, const char* end )
+{
+    while ( p < end && (*p == ' ' || *p == '\t' || *p == '\f' || *p == '\v') )
+        p++;
+    return p;
+}
+
+std::string Trim( const char* p, const char* end )
+{
+    p = SkipSpace( p,end );
+    while ( end > p && isspace( (unsigned char)end[-1] ) )
+        end--;
+    return std::string( p,end );
+}
+
+std::string ReadIdent( const char*& p, const char* end )
+{
+    const char* start = p;
+    if ( p < end && IsIdentStart( *p ) )
+        while ( p < end && IsIdent( *p ) )
+            p++;
+    return std::string( start,p );
+}
+
+void ParseDirective( const char* p, const char* end, std::vector<SourceDirective>& directives )
+{
+    p = SkipSpace( p + 1,end );
+    std::string keyword = ReadIdent( p,end );
+    p = SkipSpace( p,end );
+
+    SourceDirective d;
+    if ( keyword == "include" )
+    {
+        d.kind = DirectiveKind::INCLUDE;
+        if ( p < end && (*p == '"' || *p == '<') )
+        {
+            char close = (*p == '"') ? '"' : '>';
+            const char* start = ++p;
+            while ( p < end && *p != close )
+                p++;
+            d.name.assign( start,p );
+        }
+        else
+        {
+            d.name = ReadIdent( p,end );
+            d.macro_include = true;
+        }
+        if ( d.name.empty() )
+            return;
+    }
+    else if ( keyword == "define" )
+    {
+        d.kind = DirectiveKind::DEFINE;
+        d.name = ReadIdent( p,end );
+        d.function_like = p < end && *p == '(';
+        d.text = Trim( p,end );
+    }
+    else if ( keyword == "undef" || keyword == "ifdef" || keyword == "ifndef" )
+    {
+        d.kind = (keyword == "undef") ? DirectiveKind::UNDEF : (keyword == "ifdef") ? DirectiveKind::IFDEF : DirectiveKind::IFNDEF;
+        d.name = ReadIdent( p,end );
+    }
+    else if ( keyword == "if" || keyword == "elif" )
+    {
+        d.kind = (keyword == "if") ? DirectiveKind::IF : DirectiveKind::ELIF;
+        d.text = Trim( p,end );
+    }
+    else if ( keyword == "else" || keyword == "endif" )
+    {
+        d.kind = (keyword == "else") ? DirectiveKind::ELSE : DirectiveKind::ENDIF;
+    }
+    else if ( keyword == "pragma" && Trim( p,end ) == "once" )
+    {
+        d.kind = DirectiveKind::PRAGMA_ONCE;
+    }
+    else
+    {
+        return;
+    }
+    directives.push_back( std::move( d ) );
+}
+
+void ParseDirectives( const std::string& text, std::vector<SourceDirective>& directives )
+{
+    std::string clean = CleanSource( text.data(),text.data() + text.size() );
+    const char* p = clean.data();
+    const char* end = p + clean.size();
+    while ( p < end )
+    {
+        const char* eol = std::find( p,end,'\n' );
+        const char* first = SkipSpace( p,eol );
+        if ( first < eol && *first == '#' )
+            ParseDirective( first,eol,directives );
+        p = (eol < end) ? eol + 1 : end;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Condition evaluation
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Ordered, so that the state of a nested block is the lesser of its own and its parent's
+enum class Truth : uint8_t
+{
+    NO,
+    MAYBE,
+    YES,
+};
+
+struct Macro
+{
+    bool known;                 // false once the macro might or might not have been (re)defined
+    bool function_like;
+    std::string value;
+};
+
+typedef std::unordered_map<std::string,Macro> MacroTable;
+
+struct Value
+{
+    bool known;
+    long long v;
+};
+
+const Value UNKNOWN = { false,0 };
+
+// Recursive-descent evaluator for #if expressions.  Anything it doesn't understand evaluates to unknown
+class Expression
+{
+public:
+    Expression( const std::string& text, const MacroTable& macros, int depth ) 
+        : m_p( text.data() ), m_End( text.data() + text.size() ), m_Macros( macros ), m_nDepth( depth ) {}
+
+    Value Evaluate()
+    {
+        Value v = Conditional();
+        Skip();
+        if ( m_Failed || m_p != m_End )
+            return UNKNOWN;
+        return v;
+    }
+
+private:
+    void Skip()
+    {
+        while ( m_p < m_End && isspace( (unsigned char)*m_p ) )
+            m_p++;
+    }
+
+    bool Accept( const char* op )
+    {
+        Skip();
+        size_t n = strlen( op );
+        if ( (size_t)(m_End - m_p) < n || strncmp( m_p,op,n ) != 0 )
+            return false;
+
+        // don't take '<' from '<<', '&' from '&&', and so on
+        if ( n == 1 && m_p + 1 < m_End && strchr( "<>&|=",*op ) && m_p[1] == *op )
+            return false;
+        if ( n == 1 && (*op == '<' || *op == '>' || *op == '!') && m_p + 1 < m_End && m_p[1] == '=' )
+            return false;
+        m_p += n;
+        return true;
+    }
+
+    static Value Binary( Value a, Value b, long long (*op)( long long,long long ) )
+    {
+        if ( !a.known || !b.known )
+            return UNKNOWN;
+        return Value{ true,op( a.v,b.v ) };
+    }
+
+    Value Conditional()
+    {
+        Value c = LogicalOr();
+        if ( !Accept( "?" ) )
+            return c;
+        Value a = Conditional();
+        if ( !Accept( ":" ) )
+        {
+            m_Failed = true;
+            return UNKNOWN;
+        }
+        Value b = Conditional();
+        if ( c.known )
+            return c.v ? a : b;
+        return (a.known && b.known && a.v == b.v) ? a : UNKNOWN;
+    }
+
+    Value LogicalOr()
+    {
+        Value a = LogicalAnd();
+        while ( Accept( "||" ) )
+        {
+            Value b = LogicalAnd();
+            if ( (a.known && a.v) || (b.known && b.v) )
+                a = Value{ true,1 };
+            else if ( a.known && b.known )
+                a = Value{ true,0 };
+            else
+                a = UNKNOWN;
+        }
+        return a;
+    }
+
+    Value LogicalAnd()
+    {
+        Value a = BitOr();
+        while ( Accept( "&&" ) )
+        {
+            Value b = BitOr();
+            if ( (a.known && !a.v) || (b.known && !b.v) )
+                a = Value{ true,0 };
+            else if ( a.known && b.known )
+                a = Value{ true,1 };
+            else
+                a = UNKNOWN;
+        }
+        return a;
+    }
+
+    Value BitOr()
+    {
+        Value a = BitXor();
+        while ( Accept( "|" ) )
+            a = Binary( a,BitXor(),[]( long long x, long long y ) { return x | y; } );
+        return a;
+    }
+
+    Value BitXor()
+    {
+        Value a = BitAnd();
+        while ( Accept( "^" ) )
+            a = Binary( a,BitAnd(),[]( long long x, long long y ) { return x ^ y; } );
+        return a;
+    }
+
+    Value BitAnd()
+    {
+        Value a = Equality();
+        while ( Accept( "&" ) )
+            a = Binary( a,Equality(),[]( long long x, long long y ) { return x & y; } );
+        return a;
+    }
+
+    Value Equality()
+    {
+        Value a = Relational();
+        for ( ;; )
+        {
+            if ( Accept( "==" ) )
+                a = Binary( a,Relational(),[]( long long x, long long y ) { return (long long)(x == y); } );
+            else if ( Accept( "!=" ) )
+                a = Binary( a,Relational(),[]( long long x, long long y ) { return (long long)(x != y); } );
+            else
+                return a;
+        }
+    }
+
+    Value Relational()
+    {
+        Value a = Shift();
+        for ( ;; )
+        {
+            if ( Accept( "<=" ) )
+                a = Binary( a,Shift(),[]( long long x, long long y ) { return (long long)(x <= y); } );
+            else if ( Accept( ">=" ) )
+                a = Binary( a,Shift(),[]( long long x, long long y ) { return (long long)(x >= y); } );
+            else if ( Accept( "<" ) )
+                a = Binary( a,Shift(),[]( long long x, long long y ) { return (long long)(x < y); } );
+            else if ( Accept( ">" ) )
+                a = Binary( a,Shift(),[]( long long x, long long y ) { return (long long)(x > y); } );
+            else
+                return a;
+        }
+    }
+
+    Value Shift()
+    {
+        Value a = Additive();
+        for ( ;; )
+        {
+            if ( Accept( "<<" ) )
+                a = Binary( a,Additive(),[]( long long x, long long y ) { return (y >= 0 && y < 63) ? x << y : 0; } );
+            else if ( Accept( ">>" ) )
+                a = Binary( a,Additive(),[]( long long x, long long y ) { return (y >= 0 && y < 63) ? x >> y : 0; } );
+            else
+                return a;
+        }
+    }
+
+    Value Additive()
+    {
+        Value a = Multiplicative();
+        for ( ;; )
+        {
+            if ( Accept( "+" ) )
+                a = Binary( a,Multiplicative(),[]( long long x, long long y ) { return x + y; } );
+            else if ( Accept( "-" ) )
+                a = Binary( a,Multiplicative(),[]( long long x, long long y ) { return x - y; } );
+            else
+                return a;
+        }
+    }
+
+    Value Multiplicative()
+    {
+        Value a = Unary();
+        for ( ;; )
+        {
+            char op;
+            if ( Accept( "*" ) )
+                op = '*';
+            else if ( Accept( "/" ) )
+                op = '/';
+            else if ( Accept( "%" ) )
+                op = '%';
+            else
+                return a;
+
+            Value b = Unary();
+            if ( !a.known || !b.known || (op != '*' && b.v == 0) )
+                a = UNKNOWN;
+            else
+                a.v = (op == '*') ? a.v * b.v : (op == '/') ? a.v / b.v : a.v % b.v;
+        }
+    }
+
+    Value Unary()
+    {
+        if ( Accept( "!" ) )
+        {
+            Value a = Unary();
+            return a.known ? Value{ true,(long long)!a.v } : UNKNOWN;
+        }
+        if ( Accept( "~" ) )
+        {
+            Value a = Unary();
+            return a.known ? Value{ true,~a.v } : UNKNOWN;
+        }
+        if ( Accept( "-" ) )
+        {
+            Value a = Unary();
+            return a.known ? Value{ true,-a.v } : UNKNOWN;
+        }
+        if ( Accept( "+" ) )
+            return Unary();
+        return Primary();
+    }
+
+    Value Primary()
+    {
+        Skip();
+        if ( Accept( "(" ) )
+        {
+            Value v = Conditional();
+            if ( !Accept( ")" ) )
+                m_Failed = true;
+            return v;
+        }
+
+        if ( m_p < m_End && isdigit( (unsigned char)*m_p ) )
+        {
+            char* numEnd;
+            long long v = (long long)strtoull( m_p,&numEnd,0 );
+            m_p = numEnd;
+            while ( m_p < m_End && (*m_p == 'u' || *m_p == 'U' || *m_p == 'l' || *m_p == 'L') )
+                m_p++;
+            return Value{ true,v };
+        }
+
+        std::string name = ReadIdent( m_p,m_End );
+        if ( name.empty() )
+        {
+            m_Failed = true;
+            return UNKNOWN;
+        }
+
+        if ( name == "defined" )
+        {
+            bool paren = Accept( "(" );
+            Skip();
+            std::string macro = ReadIdent( m_p,m_End );
+            if ( macro.empty() || (paren && !Accept( ")" )) )
+            {
+                m_Failed = true;
+                return UNKNOWN;
+            }
+            return Defined( macro );
+        }
+
+        auto it = m_Macros.find( name );
+        if ( it == m_Macros.end() )
+        {
+            // the compiler predefines some macros, such as __SHADER_TARGET_MAJOR.  We don't know their values
+            if ( name.compare( 0,2,"__" ) == 0 )
+                return UNKNOWN;
+            return Value{ true,0 };
+        }
+
+        const Macro& macro = it->second;
+        if ( !macro.known || macro.function_like || macro.value.empty() || m_nDepth > 16 )
+            return UNKNOWN;
+        return Expression( macro.value,m_Macros,m_nDepth + 1 ).Evaluate();
+    }
+
+    Value Defined( const std::string& name ) const
+    {
+        auto it = m_Macros.find( name );
+        if ( it == m_Macros.end() )
+            return (name.compare( 0,2,"__" ) == 0) ? UNKNOWN : Value{ true,0 };
+        return it->second.known ? Value{ true,1 } : UNKNOWN;
+    }
+
+    const char* m_p;
+    const char* m_End;
+    const MacroTable& m_Macros;
+    int m_nDepth;
+    bool m_Failed = false;
+};
+
+Truth ToTruth( const Value& v )
+{
+    if ( !v.known )
+        return Truth::MAYBE;
+    return v.v ? Truth::YES : Truth::NO;
+}
+
+Truth Not( Truth t )
+{
+    return (t == Truth::MAYBE) ? t : (t == Truth::YES) ? Truth::NO : Truth::YES;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Scanner
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Scanner
+{
+public:
+    Scanner( SourceCache& cache, const std::string& root, DependencyScan& scan ) : m_Cache( cache ), m_Root( root ), m_Scan( scan ) {}
+
+    void Define( const char* name, const char* value )
+    {
+        m_Macros[name] = Macro{ true,false,value ? value : "" };
+    }
+
+    void AddFile( const std::string& path, const SourceFile* file )
+    {
+        if ( m_Seen.insert( path ).second )
+            m_Scan.files.emplace_back( path,file ? file->hash : Hash128() );
+    }
+
+    void ScanFile( const SourceFile& file, Truth context, int depth );
+
+    const MacroTable& GetMacros() const { return m_Macros; }
+
+private:
+    struct Level
+    {
+        Truth parent;
+        Truth branch;
+        Truth prior;    // whether an earlier branch of this #if was taken
+    };
+
+    void Include( const SourceFile& file, const SourceDirective& d, Truth active, int depth );
+    void Incomplete( const std::string& reason );
+
+    SourceCache& m_Cache;
+    std::string m_Root;
+    DependencyScan& m_Scan;
+    MacroTable m_Macros;
+    std::unordered_set<std::string> m_Seen;
+    std::unordered_set<std::string> m_Once;
+    size_t m_nDirectives = 0;
+};
+
+// guards against headers which include each other without include guards the scanner can decide
+const int MAX_DEPTH = 64;
+const size_t MAX_DIRECTIVES = 1 << 22;
+
+void Scanner::Incomplete( const std::string& reason )
+{
+    if ( m_Scan.complete )
+    {
+        m_Scan.complete = false;
+        m_Scan.incomplete_reason = reason;
+    }
+}
+
+void Scanner::ScanFile( const SourceFile& file, Truth context, int depth )
+{
+    std::vector<Level> stack;
+    for ( const SourceDirective& d : file.directives )
+    {
+        if ( ++m_nDirectives > MAX_DIRECTIVES )
+        {
+            Incomplete( "too many preprocessor directives" );
+            return;
+        }
+
+        Truth active = stack.empty() ? context : std::min( stack.back().parent,stack.back().branch );
+        switch ( d.kind )
+        {
+        case DirectiveKind::IF:
+        case DirectiveKind::IFDEF:
+        case DirectiveKind::IFNDEF:
+        {
+            Truth t = Truth::NO;
+            if ( active != Truth::NO )
+            {
+                if ( d.kind == DirectiveKind::IF )
+                    t = ToTruth( Expression( d.text,m_Macros,0 ).Evaluate() );
+                else
+                {
+                    std::string expr = "defined(" + d.name + ")";
+                    t = ToTruth( Expression( expr,m_Macros,0 ).Evaluate() );
+                    if ( d.kind == DirectiveKind::IFNDEF )
+                        t = Not( t );
+                }
+            }
+            stack.push_back( Level{ active,t,t } );
+            break;
+        }
+
+        case DirectiveKind::ELIF:
+        case DirectiveKind::ELSE:
+        {
+            if ( stack.empty() )
+                break;
+            Level& level = stack.back();
+            Truth t = Truth::NO;
+            if ( level.prior != Truth::YES && level.parent != Truth::NO )
+                t = (d.kind == DirectiveKind::ELSE) ? Truth::YES : ToTruth( Expression( d.text,m_Macros,0 ).Evaluate() );
+            level.branch = (level.prior == Truth::MAYBE && t == Truth::YES) ? Truth::MAYBE : t;
+            level.prior = std::max( level.prior,t );
+            break;
+        }
+
+        case DirectiveKind::ENDIF:
+            if ( !stack.empty() )
+                stack.pop_back();
+            break;
+
+        case DirectiveKind::DEFINE:
+            if ( active == Truth::YES )
+                m_Macros[d.name] = Macro{ true,d.function_like,d.text };
+            else if ( active == Truth::MAYBE )
+                m_Macros[d.name] = Macro{ false,d.function_like,std::string() };
+            break;
+
+        case DirectiveKind::UNDEF:
+            if ( active == Truth::YES )
+                m_Macros.erase( d.name );
+            else if ( active == Truth::MAYBE )
+                m_Macros[d.name] = Macro{ false,false,std::string() };
+            break;
+
+        case DirectiveKind::PRAGMA_ONCE:
+            if ( active != Truth::NO )
+                m_Once.insert( file.path );
+            break;
+
+        case DirectiveKind::INCLUDE:
+            if ( active != Truth::NO )
+                Include( file,d,active,depth );
+            break;
+        }
+    }
+}
+
+void Scanner::Include( const SourceFile& file, const SourceDirective& d, Truth active, int depth )
+{
+    std::string name = d.name;
+    if ( d.macro_include )
+    {
+        auto it = m_Macros.find( d.name );
+        std::string value = (it != m_Macros.end() && it->second.known && !it->second.function_like) ? it->second.value : "";
+        if ( value.size() < 2 || !((value.front() == '"' && value.back() == '"') || (value.front() == '<' && value.back() == '>')) )
+        {
+            Incomplete( "#include " + d.name + " in " + file.path + " names a file we can't work out" );
+            return;
+        }
+        name = value.substr( 1,value.size() - 2 );
+    }
+
+    std::string path;
+    std::shared_ptr<const SourceFile> included = m_Cache.FindInclude( name,file.path,m_Root,path );
+    AddFile( path,included.get() );
+
+    if ( included && depth < MAX_DEPTH && m_Once.count( included->path ) == 0 )
+        ScanFile( *included,active,depth + 1 );
+}
+
+// Appends 'text' to 'out' with every object-like macro in it replaced by its value.  String literals are copied as they are
+bool ExpandMacros( const MacroTable& macros, const std::string& text, int depth, std::string& out )
+{
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while ( p < end )
+    {
+        if ( *p == '"' || *p == '\'' )
+        {
+            char quote = *p;
+            const char* start = p++;
+            while ( p < end && *p != quote )
+                p += (*p == '\\' && p + 1 < end) ? 2 : 1;
+            p = std::min( p + 1,end );
+            out.append( start,p );
+        }
+        else if ( IsIdentStart( *p ) )
+        {
+            std::string name = ReadIdent( p,end );
+            auto it = macros.find( name );
+            if ( it == macros.end() )
+            {
+                // a predefined macro, whose value only the compiler knows
+                if ( name.compare( 0,2,"__" ) == 0 )
+                    return false;
+                out += name;
+                continue;
+            }
+
+            const Macro& macro = it->second;
+            if ( !macro.known || macro.function_like || depth > 16 || !ExpandMacros( macros,macro.value,depth + 1,out ) )
+                return false;
+        }
+        else
+        {
+            out.push_back( *p++ );
+        }
+    }
+    return true;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  SourceCache
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const SourceFile> SourceCache::Get( const std::string& path )
+{
+    std::string key = fs::path( path ).lexically_normal().string();
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        auto it = m_Files.find( key );
+        if ( it != m_Files.end() )
+            return it->second;
+    }
+
+    // read and parse outside the lock.  If two threads race for the same file, the first one to finish wins
+    std::shared_ptr<SourceFile> file;
+    InputBuffer buffer;
+    if ( buffer.Load( key.c_str() ) )
+    {
+        file = std::make_shared<SourceFile>();
+        file->path = key;
+        file->text.assign( (const char*)buffer.data(),buffer.size() );
+        file->hash = Hasher::Compute( buffer.data(),buffer.size() );
+        ParseDirectives( file->text,file->directives );
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return m_Files.emplace( key,std::move( file ) ).first->second;
+}
+
+std::shared_ptr<const SourceFile> SourceCache::FindInclude( const std::string& name, const std::string& includingFile, 
+                                                            const std::string& rootFile, std::string& path )
+{
+    fs::path candidates[] = 
+    {
+        fs::path( includingFile ).parent_path() / name,
+        fs::path( rootFile ).parent_path() / name,
+        fs::path( name ),
+    };
+
+    path.clear();
+    for ( const fs::path& candidate : candidates )
+    {
+        std::string candidatePath = candidate.lexically_normal().string();
+        if ( path.empty() )
+            path = candidatePath;
+
+        std::shared_ptr<const SourceFile> file = Get( candidatePath );
+        if ( file )
+        {
+            path = file->path;
+            return file;
+        }
+    }
+    return nullptr;
+}
+
+size_t SourceCache::GetFileCount() const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    size_t n = 0;
+    for ( auto& it : m_Files )
+        if ( it.second )
+            n++;
+    return n;
+}
+
+bool ScanDependencies( SourceCache& cache, const char* sourceFile, const std::vector< std::pair<const char*,const char*> >& defines,
+                       DependencyScan& scan )
+{
+    scan = DependencyScan();
+
+    std::shared_ptr<const SourceFile> root = cache.Get( sourceFile );
+    if ( !root )
+        return false;
+
+    Scanner scanner( cache,root->path,scan );
+    for ( const auto& define : defines )
+        scanner.Define( define.first,define.second );
+
+    scanner.AddFile( root->path,root.get() );
+    scanner.ScanFile( *root,Truth::YES,0 );
+    return true;
+}
+
+bool ResolveMacro( SourceCache& cache, const char* sourceFile, const void* sourceText, size_t sourceSize,
+                   const std::vector< std::pair<const char*,const char*> >& defines, const char* name, std::string& value )
+{
+    SourceFile root;
+    root.path = fs::path( sourceFile ).lexically_normal().string();
+    root.text.assign( (const char*)sourceText,sourceSize );
+    ParseDirectives( root.text,root.directives );
+
+    DependencyScan scan;
+    Scanner scanner( cache,root.path,scan );
+    for ( const auto& define : defines )
+        scanner.Define( define.first,define.second );
+    scanner.ScanFile( root,Truth::YES,0 );
+    if ( !scan.complete )
+        return false;
+
+    // a header we couldn't find might have redefined the macro
+    for ( const auto& file : scan.files )
+        if ( file.second == Hash128() )
+            return false;
+
+    auto it = scanner.GetMacros().find( name );
+    if ( it == scanner.GetMacros().end() || !it->second.known || it->second.function_like )
+        return false;
+
+    value.clear();
+    return ExpandMacros( scanner.GetMacros(),it->second.value,0,value );
+}
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _INCLUDE_SCANNER_H_
+#define _INCLUDE_SCANNER_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Hash.h"
+
+//
+//  Finds the files an HLSL shader #includes, without running the full preprocessor.
+//
+//   Conditional blocks are evaluated when the condition depends only on the -D defines, on macros #defined earlier,
+//   and on integer arithmetic.  A condition the scanner can't decide is treated as possibly true:  both sides of it are 
+//   scanned, and macros #defined inside it become unknown.  The scan may therefore list headers the compiler won't read,
+//   but never misses one that it will.  An #include whose file name comes from an unknown macro makes the scan incomplete.
+//
+//   Included files are looked for the way D3D_COMPILE_STANDARD_FILE_INCLUDE looks for them:  next to the including file, 
+//   then next to the shader, then in the current directory.
+//
+
+enum class DirectiveKind : uint8_t
+{
+    INCLUDE,
+    DEFINE,
+    UNDEF,
+    IF,
+    IFDEF,
+    IFNDEF,
+    ELIF,
+    ELSE,
+    ENDIF,
+    PRAGMA_ONCE,
+};
+
+struct SourceDirective
+{
+    DirectiveKind kind;
+    std::string name;               // file name for INCLUDE, otherwise the macro name
+    std::string text;               // condition for IF and ELIF, value for DEFINE
+    bool macro_include = false;     // '#include NAME', where the file name comes from a macro
+    bool function_like = false;     // '#define NAME(...)'
+};
+
+// A file read through the cache.  Never modified once loaded, so it may be shared between threads
+struct SourceFile
+{
+    std::string path;
+    std::string text;
+    Hash128 hash;
+    std::vector<SourceDirective> directives;   // only the ones which can affect what is included
+};
+
+// Reads and parses each file once, however many shaders include it.  Safe to use from several threads at once
+class SourceCache
+{
+public:
+    // Returns null if the file can't be read
+    std::shared_ptr<const SourceFile> Get( const std::string& path );
+
+    // Finds an included file.  'path' is set to where it was found or, if it wasn't, to the first place it was looked for
+    std::shared_ptr<const SourceFile> FindInclude( const std::string& name, const std::string& includingFile, 
+                                                   const std::string& rootFile, std::string& path );
+
+    // Number of distinct files read so far
+    size_t GetFileCount() const;
+
+private:
+    mutable std::mutex m_Mutex;
+    std::unordered_map< std::string,std::shared_ptr<const SourceFile> > m_Files;    // null for files which couldn't be read
+};
+
+struct DependencyScan
+{
+    std::vector< std::pair<std::string,Hash128> > files;    // the shader first, then includes as they were found.  Zero hash if missing
+    bool complete = true;
+    std::string incomplete_reason;
+};
+
+bool ScanDependencies( SourceCache& cache, const char* sourceFile, const std::vector< std::pair<const char*,const char*> >& defines,
+                       DependencyScan& scan );
+
+// Finds the value a macro has at the end of a shader, with the macros it refers to expanded.  The shader's text is given,
+//  because it may not have come from a file.  Fails if the value can't be known without running the preprocessor, for
+//  example if the macro is defined under an #if the scanner can't decide, or refers to a function-like macro
+bool ResolveMacro( SourceCache& cache, const char* sourceFile, const void* sourceText, size_t sourceSize,
+                   const std::vector< std::pair<const char*,const char*> >& defines, const char* name, std::string& value );
+
+#endif
@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "InputBuffer.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// files smaller than this are read instead of mapped
+static const uint64_t MAP_THRESHOLD = 64 * 1024;
+
+#ifdef _WIN32
+
+class MappedFile
+{
+public:
+    ~MappedFile()
+    {
+        if ( m_pView )
+            UnmapViewOfFile( m_pView );
+        if ( m_hMapping )
+            CloseHandle( m_hMapping );
+        if ( m_hFile != INVALID_HANDLE_VALUE )
+            CloseHandle( m_hFile );
+    }
+
+    bool Open( const char* filename )
+    {
+        m_hFile = CreateFileA( filename,GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr );
+        if ( m_hFile == INVALID_HANDLE_VALUE )
+            return false;
+
+        LARGE_INTEGER size;
+        if ( !GetFileSizeEx( m_hFile,&size ) )
+            return false;
+        m_nSize = (uint64_t)size.QuadPart;
+        return true;
+    }
+
+    bool Map()
+    {
+        if ( m_nSize > SIZE_MAX )
+            return false;
+
+        m_hMapping = CreateFileMappingA( m_hFile,nullptr,PAGE_READONLY,0,0,nullptr );
+        if ( !m_hMapping )
+            return false;
+
+        m_pView = MapViewOfFile( m_hMapping,FILE_MAP_READ,0,0,0 );
+        return m_pView != nullptr;
+    }
+
+    bool Read( void* dst )
+    {
+        DWORD nRead = 0;
+        return ReadFile( m_hFile,dst,(DWORD)m_nSize,&nRead,nullptr ) && nRead == m_nSize;
+    }
+
+    uint64_t GetSize() const { return m_nSize; }
+    const void* GetView() const { return m_pView; }
+
+private:
+    HANDLE m_hFile = INVALID_HANDLE_VALUE;
+    HANDLE m_hMapping = nullptr;
+    void* m_pView = nullptr;
+    uint64_t m_nSize = 0;
+};
+
+#else
+
+class MappedFile
+{
+public:
+    ~MappedFile()
+    {
+        if ( m_pView )
+            munmap( m_pView,(size_t)m_nSize );
+        if ( m_fd >= 0 )
+            close( m_fd );
+    }
+
+    bool Open( const char* filename )
+    {
+        m_fd = open( filename,O_RDONLY );
+        if ( m_fd < 0 )
+            return false;
+
+        struct stat st;
+        if ( fstat( m_fd,&st ) != 0 || !S_ISREG( st.st_mode ) )
+            return false;
+        m_nSize = (uint64_t)st.st_size;
+        return true;
+    }
+
+    bool Map()
+    {
+        if ( m_nSize > SIZE_MAX )
+            return false;
+
+        void* view = mmap( nullptr,(size_t)m_nSize,PROT_READ,MAP_PRIVATE,m_fd,0 );
+        if ( view == MAP_FAILED )
+            return false;
+        m_pView = view;
+        return true;
+    }
+
+    bool Read( void* dst )
+    {
+        uint8_t* p = (uint8_t*)dst;
+        uint64_t left = m_nSize;
+        while ( left )
+        {
+            ssize_t n = read( m_fd,p,(size_t)left );
+            if ( n <= 0 )
+                return false;
+            p += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    uint64_t GetSize() const { return m_nSize; }
+    const void* GetView() const { return m_pView; }
+
+private:
+    int m_fd = -1;
+    void* m_pView = nullptr;
+    uint64_t m_nSize = 0;
+};
+
+#endif
+
+void InputBuffer::clear()
+{
+    m_Storage.reset();
+    m_pData = nullptr;
+    m_nSize = 0;
+}
+
+bool InputBuffer::Load( const char* filename )
+{
+    clear();
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if ( !file->Open( filename ) )
+        return false;
+
+    uint64_t size = file->GetSize();
+    if ( size == 0 )
+        return true;
+
+    if ( size < MAP_THRESHOLD )
+    {
+        std::vector<uint8_t> bytes( (size_t)size );
+        if ( !file->Read( bytes.data() ) )
+            return false;
+        Assign( std::move( bytes ) );
+        return true;
+    }
+
+    if ( !file->Map() )
+        return false;
+
+    const void* view = file->GetView();
+    Borrow( view,(size_t)size,file );
+    return true;
+}
+
+void InputBuffer::Assign( std::vector<uint8_t>&& bytes )
+{
+    auto storage = std::make_shared< std::vector<uint8_t> >( std::move( bytes ) );
+    m_pData = storage->data();
+    m_nSize = storage->size();
+    m_Storage = storage;
+}
+
+void InputBuffer::Assign( const void* data, size_t size )
+{
+    const uint8_t* p = (const uint8_t*)data;
+    Assign( std::vector<uint8_t>( p,p + size ) );
+}
+
+void InputBuffer::Borrow( const void* data, size_t size, std::shared_ptr<const void> owner )
+{
+    m_Storage = std::move( owner );
+    m_pData = (const uint8_t*)data;
+    m_nSize = size;
+}
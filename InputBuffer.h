@@ -0,0 +1,56 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _INPUT_BUFFER_H_
+#define _INPUT_BUFFER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//
+//  Read-only bytes handed to the frontend and the compiler.  The bytes may be owned by the buffer, 
+//   or borrowed from something which the buffer keeps alive, such as a file mapping or a D3D blob.
+//
+//  Copies share the underlying storage, so passing buffers around never copies the bytes themselves
+//
+class InputBuffer
+{
+public:
+    const uint8_t* data() const { return m_pData; }
+    size_t size() const         { return m_nSize; }
+    bool empty() const          { return m_nSize == 0; }
+    void clear();
+
+    // Maps the file read-only.  Small files are read into memory instead, because mapping them costs more than it saves
+    bool Load( const char* filename );
+
+    // Takes ownership of a vector
+    void Assign( std::vector<uint8_t>&& bytes );
+
+    // Copies the bytes
+    void Assign( const void* data, size_t size );
+
+    // References bytes held alive by 'owner'.  For example, a blob returned by a DLL
+    void Borrow( const void* data, size_t size, std::shared_ptr<const void> owner );
+
+private:
+    std::shared_ptr<const void> m_Storage;
+    const uint8_t* m_pData = nullptr;
+    size_t m_nSize = 0;
+};
+
+#endif
@@ -16,276 +16,447 @@
 #define _CRT_SECURE_NO_WARNINGS
 
 #include "IntelShaderAnalyzer.h"
-
-#include <windows.h>
-#include <iostream>
-#include <fstream>
-#include <sstream>
-
-#include <d3dcompiler.h>
-
-#ifdef _WIN64
-#define DLL_NAME  "IntelGpuCompiler64.dll"
-#else
-#define DLL_NAME  "IntelGpuCompiler32.dll"
-#endif
+#include "CompilerContextPool.h"
+#include "IsaCache.h"
+#include "DXBCContainer.h"
+#include "IsaArchive.h"
+#include "CompilerBackend.h"
+#include "IsaStats.h"
+#include "CompileServer.h"
+#include "IncludeScanner.h"
+#include "DependencyDatabase.h"
+#include "Permutations.h"
+#include "RootSignature.h"
+#include "RootSignatureCache.h"
+#include "Trace.h"
+#include "IsaDiff.h"
+#include "IsaReport.h"
+#include "WorkerProcess.h"
+#include "Coordinator.h"
+
+#include <chrono>
+#include <memory>
+#include <cstring>
+#include <filesystem>
 
 using namespace IntelGPUCompiler;
 
-
-
-int sizeOfFile(const char* filename) {
-    struct stat st;
-    if (stat(filename, &st) == -1)
-        return -1;
-    return st.st_size;
+static const char* FourCCToString( uint32_t fourcc, char str[5] )
+{
+    memcpy( str,&fourcc,4 );
+    str[4] = '\0';
+    return str;
 }
 
-bool readAllBytes( std::vector<uint8_t>& bytes, const char * filename )
+bool DumpContainer( const char* filename )
 {
-    size_t length = sizeOfFile( filename );
-    if ( length == -1 )
+    InputBuffer bytes;
+    if ( !bytes.Load( filename ) )
+    {
+        printf( "Unable to load bytecode from: %s\n",filename );
         return false;
+    }
 
-    std::ifstream is(filename, std::ifstream::binary);
-    
-    bytes.resize( length );
-    is.read((char*)bytes.data(), length);
+    DXBCContainer container;
+    if ( !container.Parse( bytes.data(),bytes.size() ) )
+    {
+        printf( "Invalid shader container: %s\n",container.GetError() );
+        return false;
+    }
 
+    uint8_t checksum[16];
+    ComputeDXBCChecksum( bytes.data(),container.GetContainer().size,checksum );
+
+    printf( "size: %zu\n",container.GetContainer().size );
+    printf( "checksum: " );
+    for ( size_t i=0; i<16; i++ )
+        printf( "%02x",container.GetChecksum()[i] );
+    if ( !container.HasChecksum() )
+        printf( " (unsigned)\n" );
+    else if ( memcmp( checksum,container.GetChecksum(),16 ) != 0 )
+        printf( " (MISMATCH)\n" );
+    else
+        printf( " (valid)\n" );
+
+    for ( uint32_t i=0; i<container.GetPartCount(); i++ )
+    {
+        char name[5];
+        ByteSpan part = container.GetPart( i );
+        printf( "part %u: %s offset=%zu size=%zu\n",i,FourCCToString( container.GetPartFourCC( i ),name ),
+                (size_t)(part.data - bytes.data()),part.size );
+    }
     return true;
 }
 
-bool readAllText( std::string& text,const char * filename )
+bool ListAsics( const char* compiler_path )
 {
-    std::ifstream file( filename );
-    if ( !file.good() )
+    CompilerBackend backend;
+    if ( !backend.Load( compiler_path ) )
+    {
+        printf( "%s\n",backend.GetError().c_str() );
         return false;
+    }
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    text = std::move( buffer.str() );
+    std::vector< IntelGPUCompiler::PlatformInfo > asics;
+    GetAsicList( backend.GetFunctionTable(),asics );
+    
+    for ( size_t i=0; i<asics.size(); i++ )
+        printf( "%s\n", asics[i].platformName );   
     return true;
 }
 
+void ShowHelp()
+{
+    printf( "To compile hlsl use:  -s hlsl -p <profile> -f <function> <filename>\n" );
+    printf( "To compile dxbc use:  -s dxbc  <filename>\n" );
+    printf( "To compile a list of shaders use:  --batch <manifest>, and to survive compiler crashes:  --workers <count>\n" );
+    printf( "To compile every distinct shader in a directory tree use:  --scan <directory>\n" );
+    printf( "To read shaders from stdin, or write ISA to stdout, use '-' as the filename or the --isa prefix\n" );
+    printf( "To list or extract archived results use:  ls <archive>  or  extract <archive>\n" );
+    printf( "To keep the compiler loaded between requests use:  --serve <socket>, then:  client <socket> <options> <filename>\n" );
+    printf( "To share a batch between machines use:  --batch <manifest> --coordinate <host:port>, and on each machine:  --work <host:port>\n" );
+    printf( "To compile a root signature without the D3D compiler use:  rootsig <filename> [--rootsig_macro <name>] [-o <output>]\n" );
+    printf( "To compare ISA from two drivers, APIs or devices use:  diff <old> <new> [-v] [--csv <file>]\n" );
+    printf( "To rank shaders across a whole sweep use:  report <archive or directory>... [--top <count>] [--csv <file>] [--html <file>]\n" );
+    printf( "For details, read the readme\n" );
+}
 
-class API
+// A batch's workers are given the command line's options, except those which only concern the batch as a whole
+static std::vector<std::string> GetWorkerArgs( int argc, char* argv[] )
 {
-public:
-    virtual bool CanRun( ToolInputs& opts ) = 0;
-    virtual bool CreateCompiler( Platform platformID,SFunctionTable& functionTable,OpaqueCompiler& compiler ) = 0;    
-    virtual bool CreateShader( SFunctionTable& functionTable,OpaqueCompiler& compiler,OpaqueShader& output,ToolInputs& opts ) = 0;
-    virtual void DeleteShader( SFunctionTable& functionTable,OpaqueShader& shader ) = 0;
-    virtual void DeleteCompiler( SFunctionTable& functionTable,OpaqueCompiler& compiler ) = 0;
-};
-
-class API_DX11 : public API
+    static const char* BATCH_OPTIONS[] = { "--batch","--summary","--incremental","--workers","--quarantine","--worker-timeout" };
+
+    std::vector<std::string> args;
+    for ( int i=1; i<argc; i++ )
+    {
+        bool batchOption = false;
+        for ( const char* option : BATCH_OPTIONS )
+            batchOption = batchOption || _stricmp( argv[i],option ) == 0;
+
+        // skip the option's argument too
+        if ( batchOption )
+            i++;
+        else
+            args.push_back( argv[i] );
+    }
+    return args;
+}
+
+// A coordinator's local workers only need to know where the compiler is, and how to run it.  Everything else arrives with each program
+static std::vector<std::string> GetLocalWorkerArgs( int argc, char* argv[] )
 {
-public:
-    virtual bool CanRun( ToolInputs& opts ) override
+    static const char* WORKER_OPTIONS[] = { "--compiler","--cache","--cache-size","--pool-max-idle","--pool-max-total","--pool-idle-timeout" };
+
+    std::vector<std::string> args;
+    for ( int i=1; i<argc-1; i++ )
     {
-        if ( opts.bytecode.empty() )
+        for ( const char* option : WORKER_OPTIONS )
         {
-            printf( "Missing shader bytecode\n" );
-            return false;
+            if ( _stricmp( argv[i],option ) == 0 )
+            {
+                args.push_back( argv[i] );
+                args.push_back( argv[++i] );
+                break;
+            }
         }
-        return true;
     }
+    return args;
+}
 
-    virtual bool CreateCompiler( Platform platformID, SFunctionTable& functionTable,OpaqueCompiler& compiler ) override
+// Results depend on the compiler as well as on the job, so a new driver invalidates every dependency record.  So does
+//  a different trip count, which changes the .cfg files.  'module_path' is the library which was actually loaded, not the
+//  name it was loaded by, which the loader may have found anywhere on its search path
+static Hash128 MakeDependencySalt( const std::string& module_path, unsigned int loop_trips )
+{
+    std::error_code sizeError, timeError;
+    uint64_t size = std::filesystem::file_size( module_path,sizeError );
+    int64_t time = (int64_t)std::filesystem::last_write_time( module_path,timeError ).time_since_epoch().count();
+
+    Hasher h;
+    h.Update( module_path );
+    h.UpdateValue( size );
+    h.UpdateValue( time );
+    h.UpdateValue( loop_trips );
+
+    // a compiler which can't be identified can't be trusted to be the one which built the records, so salt with something
+    //  that will never match them, or anything written by this run
+    if ( sizeError || timeError )
     {
-        return functionTable.interface1.pfnDX11.pfnCreateCompiler( platformID,compiler );
+        printf( "Failed to identify compiler: %s.  Every job will be rebuilt\n",module_path.c_str() );
+        h.UpdateValue( (int64_t)std::chrono::system_clock::now().time_since_epoch().count() );
     }
+    return h.Finish();
+}
 
-    virtual bool CreateShader( SFunctionTable& functionTable, OpaqueCompiler& compiler, OpaqueShader& output,ToolInputs& opts ) override
+static bool LoadBackend( CompilerBackend& backend, const char* compiler_path, Tracer* tracer )
+{
+    bool loaded;
     {
-        ShaderInput_DX11_V1 input;
-        input.DXBCBin = (void*)opts.bytecode.data();
-        return functionTable.interface1.pfnDX11.pfnCreateShader( compiler,input,output );
+        TraceScope scope( TraceLabel{ tracer },TraceStage::LOAD_COMPILER );
+        loaded = backend.Load( compiler_path );
     }
+    if ( !loaded )
+        printf( "%s\n",backend.GetError().c_str() );
+    return loaded;
+}
 
-    virtual void DeleteCompiler( SFunctionTable& functionTable, OpaqueCompiler& compiler ) override
+ArgResult ParseJobArgument( int argc, char* argv[], int& i, JobOptions& job )
+{
+    FrontendOptions& frontend_opts = job.frontend;
+    ToolInputs& opts = job.inputs;
+
+    if ( _stricmp( argv[i], "-c" ) == 0 ||
+         _stricmp( argv[i], "--asic" ) == 0 )
     {
-        functionTable.interface1.pfnDX11.pfnDeleteShaderCompiler( compiler );
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for --asic\n" );
+            return ArgResult::FAILED;
+        }
+        job.asicNames.push_back( argv[++i] );
     }
-
-    virtual void DeleteShader( SFunctionTable& functionTable,OpaqueShader& shader ) override
+    else if ( _stricmp( argv[i],"--api" ) == 0 )
+    {
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for --api\n" );
+            return ArgResult::FAILED;
+        }
+        job.api = argv[++i];
+    }        
+    else if ( _stricmp( argv[i],"--rootsig_file" ) == 0 )
     {
-        functionTable.interface1.pfnDX11.pfnDeleteShader( shader );
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for --rootsig_file\n" );
+            return ArgResult::FAILED;
+        }
+        job.rootsig_file = argv[++i];
     }
-};
-
-class API_DX12 : public API
-{
-public:
-    virtual bool CanRun( ToolInputs& opts ) override
+    else if ( _stricmp( argv[i],"--rootsig_profile" ) == 0 )
     {
-        if ( opts.bytecode.empty() )
+        if ( i == argc-1 )
         {
-            printf( "Missing shader bytecode\n" );
-            return false;
+            printf( "Missing argument for %s\n", argv[i] );
+            return ArgResult::FAILED;
         }
-        if ( opts.rootsig.empty() )
+        frontend_opts.rs_profile = argv[++i];
+    }
+    else if ( _stricmp( argv[i],"--rootsig_macro" ) == 0 )
+    {
+        if ( i == argc-1 )
         {
-            printf( "Missing root signature\n" );
-            return false;
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
         }
-        return true;
+        frontend_opts.rs_macro = argv[++i];
     }
-
-    virtual bool CreateCompiler( Platform platformID,SFunctionTable& functionTable,OpaqueCompiler& compiler ) override
+    else if ( _stricmp( argv[i],"--id" ) == 0 )
     {
-        return functionTable.interface1.pfnDX12.pfnCreateCompiler( platformID,compiler );
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
+        opts.shader_id = argv[++i];
     }
-
-    virtual bool CreateShader( SFunctionTable& functionTable,OpaqueCompiler& compiler,OpaqueShader& output,ToolInputs& opts ) override
+    else if ( strcmp( argv[i],"-j" ) == 0 ||
+              _stricmp( argv[i],"--threads" ) == 0 )
     {
-        ShaderInput_DX12_V1 input;
-        input.DXBCBin = (void*)opts.bytecode.data();
-        input.rootSignature = (void*)opts.rootsig.data();
-        input.rootSignatureSize = opts.rootsig.size();
-        return functionTable.interface1.pfnDX12.pfnCreateShader( compiler,input,output );
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
+        opts.threads = strtoul( argv[++i], nullptr, 0 );
     }
-
-    virtual void DeleteCompiler( SFunctionTable& functionTable,OpaqueCompiler& compiler ) override
+    else if ( _stricmp( argv[i],"--serialize-backend" ) == 0 )
     {
-        functionTable.interface1.pfnDX12.pfnDeleteShaderCompiler( compiler );
+        opts.serialize_backend = true;
     }
-
-    virtual void DeleteShader( SFunctionTable& functionTable,OpaqueShader& shader ) override
+    else if ( _stricmp( argv[i],"--isa" ) == 0 )
     {
-        functionTable.interface1.pfnDX12.pfnDeleteShader( shader );
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for --isa\n" );
+            return ArgResult::FAILED;
+        }
+        opts.isa_prefix = argv[++i];
     }
-};
-
-
-
-
-bool RunTool( SFunctionTable& functionTable, ToolInputs& opts, API& api )
-{
-    if ( !api.CanRun( opts ) )
-        return false;
-
-    for ( PlatformInfo& platform : opts.asics )
+    else if ( _stricmp( argv[i],"--cfg" ) == 0 )
+    {
+        opts.write_cfg = true;
+    }
+    else if ( _stricmp( argv[i],"--isa-bin" ) == 0 )
+    {
+        opts.isa_binary = true;
+    }
+    else if ( strcmp( argv[i],"-s" ) == 0 )
+    {
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for -s\n" );
+            return ArgResult::FAILED;
+        }
+        job.source_lang = argv[++i];
+    }
+    else if ( strcmp( argv[i],"-D" ) == 0 )
     {
-        /// create compiler context
-        OpaqueCompiler pCompiler;
-        if ( !api.CreateCompiler( platform.Identifier,functionTable,pCompiler ) )
+        if ( i == argc-1 )
         {
-            printf( "ERROR: %s\n",functionTable.interface1.pfnGetLastError(  ) );
-            return false;
+            printf( "Missing argument for %s\n", argv[i] );
+            return ArgResult::FAILED;
         }
 
-        OpaqueShader output;
-        if( api.CreateShader( functionTable, pCompiler, output, opts ) )
+        char* def = argv[++i];
+        char* value = def;
+        while ( *value )
         {
-            size_t isaSize = 0;
-            const char* isaText = functionTable.interface1.pfnGetIsaText( output,isaSize );
-            if ( isaText )
+            if ( *(value++) == '=' )
             {
-                std::stringstream isaFile;
-                if ( opts.isa_prefix )
-                    isaFile << opts.isa_prefix;
+                value[-1] = '\0'; // replace '=' with null and stop scanning
+                break;
+            }
+        }
 
-                isaFile << platform.platformName << ".asm";
+        frontend_opts.defines.push_back( std::pair<char*,char*>( def,value ) );
+    }
+    else if ( _stricmp( argv[i],"--permute" ) == 0 )
+    {
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
 
-                std::string isaFileName = isaFile.str();
+        std::string name;
+        std::vector<std::string> values;
+        if ( !ParsePermuteOption( argv[++i],name,values ) )
+        {
+            printf( "Expected NAME=value,value,... for --permute: '%s'\n",argv[i] );
+            return ArgResult::FAILED;
+        }
 
-                FILE* fp = fopen( isaFileName.c_str(), "w" );
-                if ( fp )
-                {
-                    fprintf( fp,"%s",isaText );
-                    fclose( fp );
-                }
-                else
-                {
-                    printf( "Failed to open output file: %s\n",isaFileName.c_str() );
-                    return false;
-                }
-            }
-            else
+        for ( const char* option : job.permute )
+        {
+            if ( strncmp( option,name.c_str(),name.size() ) == 0 && option[name.size()] == '=' )
             {
-                printf( "ERROR: %s\n", functionTable.interface1.pfnGetLastError(  ) );
-                return false;
+                printf( "%s is permuted twice\n",name.c_str() );
+                return ArgResult::FAILED;
             }
-
-            /// free up memory
-            api.DeleteShader( functionTable,output );
         }
-        else
+        job.permute.push_back( argv[i] );
+    }
+    else if ( _stricmp( argv[i],"--profile" ) == 0 ||
+              _stricmp( argv[i], "-p" ) == 0 )
+    {
+        if ( i == argc-1 )
         {
-            printf( "ERROR: %s\n", functionTable.interface1.pfnGetLastError(  ) );
-            return false;
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
         }
 
-        api.DeleteCompiler( functionTable,pCompiler );
+        frontend_opts.profile = argv[++i];
     }
+    else if ( _stricmp( argv[i],"--function" ) == 0 ||
+              _stricmp( argv[i],"-f" ) == 0 )
+    {
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
 
-    return true;
-}
-
-void GetAsicList( SFunctionTable& functionTable, std::vector< IntelGPUCompiler::PlatformInfo >& asics )
-{    
-    size_t nPlatforms = functionTable.interface1.pfnEnumPlatforms( nullptr,0 );
-    asics.resize( nPlatforms );
-    functionTable.interface1.pfnEnumPlatforms( asics.data(),nPlatforms );   
-}
+        frontend_opts.entry = argv[++i];
+    }
+    else if ( _stricmp( argv[i], "--DXFlags" ) == 0 )
+    {
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
 
-bool ListAsics()
-{
-    HINSTANCE compilerInstance = (HINSTANCE)LoadLibraryA( DLL_NAME );
-    if ( !compilerInstance )
+        frontend_opts.dx_flags = strtoul( argv[++i], nullptr, 0 );
+        
+    }
+    else if ( _stricmp( argv[i],"--DXLocation" ) == 0 )
     {
-        printf( "Failed to load: %s\n",DLL_NAME );
-        return false;
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return ArgResult::FAILED;
+        }
+        frontend_opts.dx_location = argv[++i];
     }
-
-    PFNOPENCOMPILER pfnOpenCompiler = (PFNOPENCOMPILER)GetProcAddress( compilerInstance,g_cOpenCompilerFnName );
-    if ( !pfnOpenCompiler )
+    else if ( argv[i][0] == '-' && argv[i][1] != 0 )
     {
-        printf( "GetProcAddress failed for: %s\n",g_cOpenCompilerFnName );
-        return false;
+        return ArgResult::UNKNOWN;
     }
-
-    SFunctionTable functionTable;
-    SOpenCompiler desc;
-    desc.InterfaceVersion = 1;
-    desc.pCompilerFuncs = &functionTable;
-
-    /// get the right set of callbacks
-    if ( !pfnOpenCompiler( desc ) )
+    else
     {
-        printf( "OpenCompiler failed\n" );
-        return false;
+        // '-' is stdin, see RunStream
+        frontend_opts.input_file = argv[i];
     }
 
-    std::vector< IntelGPUCompiler::PlatformInfo > asics;
-    GetAsicList( functionTable,asics );
-    
-    for ( size_t i=0; i<asics.size(); i++ )
-        printf( "%s\n", asics[i].platformName );   
-    return true;
-}
-
-void ShowHelp()
-{
-    printf( "To compile hlsl use:  -s hlsl -p <profile> -f <function> <filename>\n" );
-    printf( "To compile dxbc use:  -s dxbc  <filename>\n" );
-    printf( "For details, read the readme\n" );
+    return ArgResult::CONSUMED;
 }
 
-
-
-
 int main(int argc, char *argv[])
 {
-    std::vector<const char*> asicNames;
-    
-    const char* api           = "dx11";
-    const char* rootsig_file  = nullptr;
-    const char* source_lang   = "dxbc";
-
-    ToolInputs opts;
-    FrontendOptions frontend_opts;
+    JobOptions job;
+    const char* batch_file    = nullptr;
+    const char* summary_file  = nullptr;
+    const char* scan_dir      = nullptr;
+    bool pool_stats           = false;
+    PoolOptions pool_opts;
+    const char* cache_dir     = nullptr;
+    uint64_t cache_size       = 1024ull * 1024 * 1024;
+    bool cache_stats          = false;
+    const char* archive_file  = nullptr;
+    bool archive_compress     = false;
+    const char* compiler_path = CompilerBackend::GetDefaultPath();
+    bool stats                = false;
+    StatsFormat stats_format  = StatsFormat::JSON;
+    const char* stats_file    = nullptr;
+    unsigned int loop_trips   = 8;
+    ServerOptions server_opts;
+    const char* deps_file     = nullptr;
+    const char* rootsig_cache_dir = nullptr;
+    const char* trace_file    = nullptr;
+    bool timing               = false;
+    StatsFormat timing_format = StatsFormat::JSON;
+    const char* timing_file   = nullptr;
+    size_t worker_count       = 0;
+    const char* quarantine_file = nullptr;
+    double worker_timeout     = WorkerOptions().job_timeout;
+    bool worker               = false;
+    CoordinatorOptions coordinator_opts;
+    const char* work_address  = nullptr;
+
+    // archive inspection doesn't need the compiler
+    if ( argc > 1 && (strcmp( argv[1],"ls" ) == 0 || strcmp( argv[1],"extract" ) == 0) )
+        return ArchiveCommand( argc-1,argv+1 );
+
+    // neither does talking to a server
+    if ( argc > 1 && strcmp( argv[1],"client" ) == 0 )
+        return ClientCommand( argc-1,argv+1 );
+
+    // or compiling a root signature
+    if ( argc > 1 && strcmp( argv[1],"rootsig" ) == 0 )
+        return RootSignatureCommand( argc-1,argv+1 );
+
+    // or comparing ISA
+    if ( argc > 1 && strcmp( argv[1],"diff" ) == 0 )
+        return DiffCommand( argc-1,argv+1 );
+
+    // or summarizing it
+    if ( argc > 1 && strcmp( argv[1],"report" ) == 0 )
+        return ReportCommand( argc-1,argv+1 );
+
+    // parsing modifies some arguments, so workers get a copy taken beforehand
+    std::vector<std::string> worker_args = GetWorkerArgs( argc,argv );
+    coordinator_opts.worker_args = GetLocalWorkerArgs( argc,argv );
 
     // parse the command line.  Where possible we have tried to match the syntax of AMD's RGA
     int i=1;
@@ -294,7 +465,7 @@ int main(int argc, char *argv[])
         if ( _stricmp( argv[i], "-l" ) == 0 ||
              _stricmp( argv[i], "--list-asics" ) == 0 )
         {
-            if ( ListAsics() )
+            if ( ListAsics( compiler_path ) )
                 return 0;
             else
                 return 1;
@@ -305,276 +476,586 @@ int main(int argc, char *argv[])
             ShowHelp();
             return 0;
         }
-        else if ( _stricmp( argv[i], "-c" ) == 0 ||
-                  _stricmp( argv[i], "--asic" ) == 0 )
+        else if ( _stricmp( argv[i],"--dump-container" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for --asic\n" );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            asicNames.push_back( argv[++i] );
+            return DumpContainer( argv[i+1] ) ? 0 : 1;
         }
-        else if ( _stricmp( argv[i],"--api" ) == 0 )
+        else if ( _stricmp( argv[i],"--compiler" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for --api\n" );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            api = argv[++i];
-        }        
-        else if ( _stricmp( argv[i],"--rootsig_file" ) == 0 )
+            compiler_path = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--batch" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for --rootsig_file\n" );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            rootsig_file = argv[++i];
+            batch_file = argv[++i];
         }
-        else if ( _stricmp( argv[i],"--rootsig_profile" ) == 0 )
+        else if ( _stricmp( argv[i],"--scan" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for %s\n", argv[i] );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            frontend_opts.rs_profile = argv[++i];
+            scan_dir = argv[++i];
         }
-        else if ( _stricmp( argv[i],"--rootsig_macro" ) == 0 )
+        else if ( _stricmp( argv[i],"--summary" ) == 0 )
         {
             if ( i == argc-1 )
             {
                 printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            frontend_opts.rs_macro = argv[++i];
+            summary_file = argv[++i];
         }
-        else if ( _stricmp( argv[i],"--isa" ) == 0 )
+        else if ( _stricmp( argv[i],"--pool-max-idle" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for --isa\n" );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            opts.isa_prefix = argv[++i];
+            pool_opts.max_idle_per_key = strtoul( argv[++i], nullptr, 0 );
         }
-        else if ( strcmp( argv[i],"-s" ) == 0 )
+        else if ( _stricmp( argv[i],"--pool-max-total" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for -s\n" );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            source_lang = argv[++i];
+            pool_opts.max_idle = strtoul( argv[++i], nullptr, 0 );
         }
-        else if ( strcmp( argv[i],"-D" ) == 0 )
+        else if ( _stricmp( argv[i],"--pool-idle-timeout" ) == 0 )
         {
             if ( i == argc-1 )
             {
-                printf( "Missing argument for %s\n", argv[i] );
+                printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-
-            char* def = argv[++i];
-            char* value = def;
-            while ( *value )
+            pool_opts.idle_timeout = atof( argv[++i] );
+        }
+        else if ( _stricmp( argv[i],"--cache" ) == 0 )
+        {
+            if ( i == argc-1 )
             {
-                if ( *(value++) == '=' )
-                {
-                    value[-1] = '\0'; // replace '=' with null and stop scanning
-                    break;
-                }
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
             }
-
-            frontend_opts.defines.push_back( std::pair<char*,char*>( def,value ) );
+            cache_dir = argv[++i];
         }
-        else if ( _stricmp( argv[i],"--profile" ) == 0 ||
-                  _stricmp( argv[i], "-p" ) == 0 )
+        else if ( _stricmp( argv[i],"--cache-size" ) == 0 )
         {
             if ( i == argc-1 )
             {
                 printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-
-            frontend_opts.profile = argv[++i];
+            cache_size = strtoull( argv[++i], nullptr, 0 ) * 1024 * 1024;
         }
-        else if ( _stricmp( argv[i],"--function" ) == 0 ||
-                  _stricmp( argv[i],"-f" ) == 0 )
+        else if ( _stricmp( argv[i],"--rootsig-cache" ) == 0 )
         {
             if ( i == argc-1 )
             {
                 printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-
-            frontend_opts.entry = argv[++i];
+            rootsig_cache_dir = argv[++i];
         }
-        else if ( _stricmp( argv[i], "--DXFlags" ) == 0 )
+        else if ( _stricmp( argv[i],"--cache-stats" ) == 0 )
+        {
+            cache_stats = true;
+        }
+        else if ( _stricmp( argv[i],"--stats" ) == 0 )
         {
             if ( i == argc-1 )
             {
                 printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-
-            frontend_opts.dx_flags = strtoul( argv[++i], nullptr, 0 );
-            
+            if ( !ParseStatsFormat( argv[++i],stats_format ) )
+            {
+                printf( "Unknown stats format: '%s'.  Use json or csv\n",argv[i] );
+                return 1;
+            }
+            stats = true;
         }
-        else if ( _stricmp( argv[i],"--DXLocation" ) == 0 )
+        else if ( _stricmp( argv[i],"--stats-file" ) == 0 )
         {
             if ( i == argc-1 )
             {
                 printf( "Missing argument for %s\n",argv[i] );
                 return 1;
             }
-            frontend_opts.dx_location = argv[++i];
+            stats_file = argv[++i];
         }
-        else if ( argv[i][0] == '-' )
+        else if ( _stricmp( argv[i],"--timing" ) == 0 )
         {
-            printf( "Don't understand what: '%s' means\n",argv[i] );
-            ShowHelp();
-            return 1;
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            if ( !ParseStatsFormat( argv[++i],timing_format ) )
+            {
+                printf( "Unknown timing format: '%s'.  Use json or csv\n",argv[i] );
+                return 1;
+            }
+            timing = true;
+        }
+        else if ( _stricmp( argv[i],"--timing-file" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            timing_file = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--trace" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            trace_file = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--loop-trips" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            loop_trips = (unsigned int)strtoul( argv[++i],nullptr,0 );
+            if ( loop_trips == 0 )
+            {
+                printf( "Loop trip count must be at least 1\n" );
+                return 1;
+            }
+        }
+        else if ( _stricmp( argv[i],"--archive" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            archive_file = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--archive-compress" ) == 0 )
+        {
+            archive_compress = true;
+        }
+        else if ( _stricmp( argv[i],"--serve" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            server_opts.socket_path = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--serve-clients" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            server_opts.max_clients = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( _stricmp( argv[i],"--serve-jobs" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            server_opts.max_jobs = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( _stricmp( argv[i],"--incremental" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            deps_file = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--pool-stats" ) == 0 )
+        {
+            pool_stats = true;
+        }
+        else if ( _stricmp( argv[i],"--workers" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            worker_count = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( _stricmp( argv[i],"--quarantine" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            quarantine_file = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--worker-timeout" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            worker_timeout = strtod( argv[++i],nullptr );
+        }
+        else if ( _stricmp( argv[i],"--coordinate" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            coordinator_opts.address = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--local-workers" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            coordinator_opts.local_workers = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( _stricmp( argv[i],"--shards" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            coordinator_opts.shards = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( _stricmp( argv[i],"--lease-timeout" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            coordinator_opts.lease_timeout = strtod( argv[++i],nullptr );
+        }
+        else if ( _stricmp( argv[i],"--work" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for %s\n",argv[i] );
+                return 1;
+            }
+            work_address = argv[++i];
+        }
+        else if ( _stricmp( argv[i],"--worker" ) == 0 )
+        {
+            // not for users.  Added by RunBatchInWorkers to its workers' command lines
+            worker = true;
         }
         else
         {
-            frontend_opts.input_file = argv[i];
+            switch ( ParseJobArgument( argc, argv, i, job ) )
+            {
+            case ArgResult::CONSUMED:
+                break;
+            case ArgResult::FAILED:
+                return 1;
+            case ArgResult::UNKNOWN:
+                printf( "Don't understand what: '%s' means\n",argv[i] );
+                ShowHelp();
+                return 1;
+            }
         }
 
         ++i;
     }
 
-    if ( frontend_opts.input_file == nullptr )
+    // a server's jobs come from its clients, and an archive is rewritten on every run, so skipping jobs makes no sense for either
+    if ( deps_file && (server_opts.socket_path || archive_file) )
     {
-        printf( "No input filename\n" );
+        printf( "--incremental can't be used with %s\n",server_opts.socket_path ? "--serve" : "--archive" );
         return 1;
     }
 
-    
-    if ( _stricmp( source_lang,"hlsl" ) == 0 )
+    // workers compile in processes of their own, and send back nothing but messages, so nothing gathered across the whole batch
+    //  can be had from them
+    if ( worker_count > 0 || quarantine_file )
     {
-        if ( !readAllText( frontend_opts.input_text,frontend_opts.input_file ) )
+        if ( batch_file == nullptr || worker_count == 0 )
         {
-            printf( "Failed to read source from: %s\n",frontend_opts.input_file );
+            printf( "%s needs --batch and --workers\n",worker_count > 0 ? "--workers" : "--quarantine" );
             return 1;
         }
 
-        if ( frontend_opts.profile == nullptr )
+        const char* conflict = server_opts.socket_path ? "--serve" : archive_file ? "--archive" : stats ? "--stats" :
+                               trace_file ? "--trace" : timing ? "--timing" : pool_stats ? "--pool-stats" :
+                               cache_stats ? "--cache-stats" : nullptr;
+        if ( conflict )
         {
-            printf( "Missing --profile\n" );
+            printf( "--workers can't be used with %s\n",conflict );
             return 1;
         }
+    }
 
-        if ( !CompileHLSL( frontend_opts, opts ) )
+    // a scan finds its own inputs, which are already compiled
+    if ( scan_dir )
+    {
+        const char* conflict = batch_file ? "--batch" : server_opts.socket_path ? "--serve" : job.frontend.input_file ? "an input file" :
+                               !job.permute.empty() ? "--permute" : worker ? "--worker" : work_address ? "--work" : nullptr;
+        if ( conflict )
+        {
+            printf( "--scan can't be used with %s\n",conflict );
             return 1;
+        }
     }
-    else if ( _stricmp( source_lang,"dxbc" ) == 0 )
+
+    // a coordinator only sends workers programs, and receives ISA, so whatever else a batch can collect isn't available.  Nor can
+    //  it tell which jobs are up to date, because it doesn't know which platforms they were compiled for until a worker says
+    if ( coordinator_opts.address || coordinator_opts.local_workers > 0 )
     {
-        // load bytecode        
-        if ( frontend_opts.input_file != nullptr )
+        if ( batch_file == nullptr || coordinator_opts.address == nullptr )
         {
-            if ( !readAllBytes( opts.bytecode, frontend_opts.input_file ) )
-            {
-                printf( "Unable to load bytecode from: %s\n", frontend_opts.input_file );
-                return 1;
-            }
+            printf( "%s needs --batch and --coordinate\n",coordinator_opts.address ? "--coordinate" : "--local-workers" );
+            return 1;
         }
 
-        // try to extract a root signature
-        if( opts.rootsig.empty() )
+        const char* conflict = server_opts.socket_path ? "--serve" : worker_count > 0 ? "--workers" : archive_file ? "--archive" :
+                               stats ? "--stats" : trace_file ? "--trace" : timing ? "--timing" : deps_file ? "--incremental" :
+                               pool_stats ? "--pool-stats" : cache_stats ? "--cache-stats" : job.inputs.write_cfg ? "--cfg" : nullptr;
+        if ( conflict )
         {
-            if( !GetRootSignatureFromDXBC( frontend_opts, opts ) )
-            {
-                // failure here indicates DX compiler DLL problems
-                //    diagnostics will happen elsewhere
-                // Simply not having a root signature is considered success here...
-                return 1;
-            }
+            printf( "--coordinate can't be used with %s\n",conflict );
+            return 1;
         }
     }
-    else
+
+    // a worker's programs all come from its coordinator
+    if ( work_address )
     {
-        printf( "Source language: '%s' not recognized\n",source_lang );
-        return 1;
+        const char* conflict = batch_file ? "--batch" : server_opts.socket_path ? "--serve" : job.frontend.input_file ? "an input file" :
+                               worker ? "--worker" : nullptr;
+        if ( conflict )
+        {
+            printf( "--work can't be used with %s\n",conflict );
+            return 1;
+        }
     }
 
-    // load root signature if we're missing one
-    if ( opts.rootsig.empty() )
+    // '-' as the input or the --isa prefix means shaders come from stdin, or results go to stdout.  See RunStream
+    bool stream_in = job.frontend.input_file && strcmp( job.frontend.input_file,"-" ) == 0;
+    bool stream_out = job.inputs.isa_prefix && strcmp( job.inputs.isa_prefix,"-" ) == 0;
+    if ( stream_in || stream_out )
     {
-        if ( rootsig_file != nullptr )
+        const char* conflict = batch_file ? "--batch" : scan_dir ? "--scan" : server_opts.socket_path ? "--serve" :
+                               !job.permute.empty() ? "--permute" : deps_file ? "--incremental" : (archive_file && stream_out) ? "--archive" : nullptr;
+        if ( conflict )
         {
-            if ( !readAllBytes( opts.rootsig, rootsig_file ) )
-            {
-                printf( "Unable to load root signature from: %s\n",rootsig_file );
-                return 1;
-            }
+            printf( "'-' can't be used with %s\n",conflict );
+            return 1;
         }
     }
 
-    // Load compiler DLL
-    HINSTANCE compilerInstance = (HINSTANCE)LoadLibraryA( DLL_NAME );
-    if ( !compilerInstance )
+    // every job reads its #includes through the same cache, so a header shared by a whole batch is only read once.  The cache
+    //  never notices a file changing, so a server, which may run for days, reads them afresh for each job
+    SourceCache sources;
+    if ( server_opts.socket_path == nullptr )
+        job.frontend.include_cache = &sources;
+
+    // root signature keys come from the source, so unlike the include cache this is safe for a server to keep
+    RootSignatureCache rootsig_cache;
+    if ( rootsig_cache_dir && !rootsig_cache.Open( rootsig_cache_dir ) )
     {
-        printf( "Failed to load: %s\n",DLL_NAME );
+        printf( "%s\n",rootsig_cache.GetError().c_str() );
         return 1;
     }
+    job.frontend.rootsig_cache = &rootsig_cache;
 
-    PFNOPENCOMPILER pfnOpenCompiler = (PFNOPENCOMPILER)GetProcAddress( compilerInstance,g_cOpenCompilerFnName );
-    if ( !pfnOpenCompiler )
+    // timers are only started if something will read them
+    std::unique_ptr<Tracer> tracer;
+    if ( trace_file || timing )
     {
-        printf( "GetProcAddress failed for: %s\n",g_cOpenCompilerFnName );
-        return 1;
+        tracer.reset( new Tracer() );
+        job.inputs.trace = tracer.get();
     }
 
+    // the compiler is normally loaded once the job is prepared, but the dependency database is salted with the library which
+    //  was actually loaded
+    CompilerBackend backend;
+    bool loaded = false;
+    std::unique_ptr<DependencyDatabase> deps;
+    DependencyRecord record;
+    if ( deps_file )
+    {
+        if ( !LoadBackend( backend,compiler_path,tracer.get() ) )
+            return 1;
+        loaded = true;
 
-    SFunctionTable functionTable;
-    SOpenCompiler desc;
-    desc.InterfaceVersion = 1;
-    desc.pCompilerFuncs = &functionTable;
+        deps.reset( new DependencyDatabase( sources ) );
+        if ( !deps->Open( deps_file,MakeDependencySalt( backend.GetPath(),loop_trips ) ) )
+        {
+            printf( "%s\n",deps->GetError().c_str() );
+            return 1;
+        }
 
-    // get the right set of callbacks
-    if ( !pfnOpenCompiler( desc ) )
+        // an up to date job doesn't need to be prepared or compiled
+        if ( batch_file == nullptr && scan_dir == nullptr && deps->Check( job,record ) )
+        {
+            printf( "Up to date: %s\n",job.frontend.input_file );
+            return 0;
+        }
+    }
+
+    // the workers compile, so the batch itself only loads the compiler to identify it for --incremental
+    if ( worker_count > 0 )
     {
-        printf( "OpenCompiler failed\n" );
-        return 1;
+        WorkerOptions worker_opts;
+        worker_opts.count = worker_count;
+        worker_opts.executable = GetExecutablePath( argv[0] );
+        worker_opts.args = worker_args;
+        worker_opts.quarantine_file = quarantine_file;
+        worker_opts.job_timeout = worker_timeout;
+
+        bool succeeded = RunBatchInWorkers( job,deps.get(),batch_file,summary_file,worker_opts );
+        if ( deps && !deps->Save() )
+        {
+            printf( "%s\n",deps->GetError().c_str() );
+            succeeded = false;
+        }
+        return succeeded ? 0 : 1;
     }
 
+    // the coordinator only runs the frontend.  Its workers load the compiler
+    if ( coordinator_opts.address )
+    {
+        coordinator_opts.executable = GetExecutablePath( argv[0] );
+        return RunCoordinator( job,batch_file,summary_file,coordinator_opts ) ? 0 : 1;
+    }
+
+    // in batch, scan, server, stream and worker modes, command line options are defaults for every job.  Otherwise, prepare the
+    //   job before we bother loading the compiler.  Permutations are prepared one at a time, as they are run, and streamed jobs
+    //   report errors along with their results
+    if ( batch_file == nullptr && server_opts.socket_path == nullptr && job.permute.empty() && !stream_in && !stream_out && !worker &&
+         work_address == nullptr && scan_dir == nullptr && !PrepareInputs( job ) )
+        return 1;
+
+    // Load compiler DLL
+    if ( !loaded && !LoadBackend( backend,compiler_path,tracer.get() ) )
+        return 1;
+
+    SFunctionTable& functionTable = backend.GetFunctionTable();
+
+    ToolContext ctx;
+    ctx.loop_trips = loop_trips;
+    ctx.deps = deps.get();
+
     // get list of supported asics
-    GetAsicList( functionTable,opts.asics );
+    GetAsicList( functionTable,ctx.asics );
+
+    CompilerContextPool pool( functionTable,pool_opts );
+    ctx.pool = &pool;
 
-    // filter asic list down to the ones we've been asked to use.  By default use all of them
-    if ( !asicNames.empty() )
+    std::unique_ptr<IsaCache> cache;
+    if ( cache_dir )
     {
-        size_t nAsicsToKeep=0;
-        for ( size_t i=0; i<opts.asics.size(); i++ )
+        cache.reset( new IsaCache( cache_dir,cache_size ) );
+        if ( !cache->Open( backend.GetPath().c_str() ) )
         {
-            for ( const char* name : asicNames )
-                if ( _stricmp( name,opts.asics[i].platformName ) == 0 )
-                    opts.asics[nAsicsToKeep++] = opts.asics[i];
+            printf( "%s\n",cache->GetError().c_str() );
+            return 1;
         }
-        opts.asics.resize( nAsicsToKeep );
+        ctx.cache = cache.get();
     }
 
-    // run the tool
-    if ( _stricmp( api,"dx11" ) == 0 )
+    IsaArchiveWriter archive;
+    if ( archive_file )
     {
-        API_DX11 api;
-        if( !RunTool( functionTable, opts, api ) )
+        if ( !archive.Open( archive_file,archive_compress ) )
             return 1;
+        ctx.archive = &archive;
     }
-    else if ( _stricmp( api,"dx12" ) == 0 )
+
+    IsaStatsReport report;
+    if ( stats )
+        ctx.stats = &report;
+
+    bool succeeded;
+    if ( server_opts.socket_path != nullptr )
+        succeeded = RunServer( ctx, job, server_opts );
+    else if ( batch_file != nullptr )
+        succeeded = RunBatch( ctx, job, batch_file, summary_file );
+    else if ( scan_dir != nullptr )
+        succeeded = RunScan( ctx, job, scan_dir, summary_file );
+    else if ( worker )
+        succeeded = RunStream( ctx, job, true, StreamOutput::STATUS );
+    else if ( work_address != nullptr )
+        succeeded = ServeCoordinator( ctx, job, work_address );
+    else if ( stream_in || stream_out )
+        succeeded = RunStream( ctx, job, stream_in, stream_out ? StreamOutput::RESULTS : StreamOutput::FILES );
+    else
     {
-        API_DX12 api;
-        if( !RunTool( functionTable, opts, api ) )
-            return 1;
+        succeeded = job.permute.empty() ? RunJob( ctx, job ) : RunPermutations( ctx, job );
+        if ( deps && succeeded )
+            deps->Update( record,job );
+        else if ( deps )
+            deps->Remove( record.key );
     }
-    else
+
+    if ( deps && !deps->Save() )
     {
-        printf( "Unrecognized API: %s\n",api );
-        return 1;
+        printf( "%s\n",deps->GetError().c_str() );
+        succeeded = false;
     }
 
-    return 0;
+    if ( archive_file && !archive.Close() )
+        succeeded = false;
+
+    if ( stats && !report.Write( stats_format,stats_file ) )
+        succeeded = false;
+
+    if ( trace_file && !tracer->WriteChromeTrace( trace_file ) )
+        succeeded = false;
+
+    if ( timing && !tracer->WriteSummary( timing_format,timing_file ) )
+        succeeded = false;
+
+    if ( pool_stats )
+        pool.PrintStats();
+
+    if ( cache )
+    {
+        cache->Trim();
+        if ( cache_stats )
+            cache->PrintStats();
+    }
+
+    if ( cache_stats )
+        rootsig_cache.PrintStats();
+
+    return succeeded ? 0 : 1;
 }
@@ -18,12 +18,35 @@
 #define _INTEL_SHADER_ANALYZER_H_
 
 #include <vector>
+#include <string>
+#include "Portability.h"
 #include "IntelGPUCompiler.h"
+#include "InputBuffer.h"
+
+class CompilerContextPool;
+class IsaCache;
+class IsaArchiveWriter;
+class IsaStatsReport;
+class DependencyDatabase;
+class SourceCache;
+class ProgramMemo;
+class RootSignatureCache;
+class Tracer;
+class API;
+
+// Where errors and compiler messages go.  The command line tool prints them.  Library callers and server clients get them
+//   back with their results.  May be called from several threads at once
+class MessageLog
+{
+public:
+    virtual ~MessageLog() {}
+    virtual void Write( const std::string& message ) = 0;
+};
 
 struct FrontendOptions
 {
     std::vector< std::pair<const char*,const char*> > defines;
-    std::string input_text;
+    InputBuffer input_text;
 
     const char* profile         = nullptr;
     const char* entry           = "main";
@@ -32,17 +55,102 @@ struct FrontendOptions
     const char* input_file      = nullptr;
     const char* rs_macro        = nullptr;
     const char* rs_profile      = "rootsig_1_0";
+    SourceCache* include_cache  = nullptr;  // if set, #included files are read through it instead of from disk
+    RootSignatureCache* rootsig_cache = nullptr;    // if set, root signatures compiled with rs_macro are remembered here
 };
 
 struct ToolInputs
 {
-    std::vector<uint8_t> bytecode;
-    std::vector<uint8_t> rootsig;
+    InputBuffer bytecode;
+    InputBuffer rootsig;
     const char* isa_prefix = "./isa_";
+    const char* shader_id  = nullptr;   // names the shader in an archive.  Defaults to the input file name
+    unsigned int threads = 1;           // platforms compiled concurrently.  0 means one per hardware thread
+    bool serialize_backend = false;     // never make concurrent calls into the compiler DLL
+    bool write_cfg = false;             // write each result's control-flow graph and cycle estimate next to its .asm file
+    bool want_binary = false;           // pass the ISA binary to the sink as well as the text
+    bool isa_binary = false;            // the result is the ISA binary.  Text is only fetched if something needs it, e.g. --cfg
+    bool compile_all = false;           // keep starting platforms after one fails, instead of stopping at the first error
+    MessageLog* log = nullptr;          // if null, messages are printed
+    Tracer* trace = nullptr;            // if set, each stage of the job is timed
     std::vector< IntelGPUCompiler::PlatformInfo > asics;
 };
 
+// Everything needed to run one shader through the tool.  Filled in from the command line, or from one line of a batch manifest
+struct JobOptions
+{
+    FrontendOptions frontend;
+    ToolInputs inputs;
+    std::vector<const char*> asicNames;
+    std::vector<const char*> permute;   // --permute options, 'NAME=v1,v2,...'.  See Permutations.h
+
+    const char* api             = "dx11";
+    const char* rootsig_file    = nullptr;
+    const char* source_lang     = "dxbc";
+};
+
+// Receives results in place of the .asm files, for example to send them to a client.  Called from worker threads.
+//   The binary is only given if the job asked for it
+class ResultSink
+{
+public:
+    virtual ~ResultSink() {}
+    virtual bool WriteIsa( const char* platform, const char* isaText, size_t isaLength, const void* pBinary, size_t binarySize ) = 0;
+};
+
+// Long-lived state shared by every job the tool runs
+struct ToolContext
+{
+    CompilerContextPool* pool = nullptr;
+    IsaCache* cache           = nullptr;
+    IsaArchiveWriter* archive = nullptr;   // if set, results go here instead of to .asm files
+    IsaStatsReport* stats     = nullptr;   // if set, every result is parsed and its statistics recorded here
+    ResultSink* sink          = nullptr;   // if set, results go here instead of to files
+    DependencyDatabase* deps  = nullptr;   // if set, batch jobs whose inputs haven't changed are skipped
+    ProgramMemo* programs     = nullptr;   // if set, programs compiled earlier in the job aren't compiled again
+    unsigned int loop_trips   = 8;         // iterations assumed for each loop, when estimating cycles
+    std::vector< IntelGPUCompiler::PlatformInfo > asics;    // every platform the compiler supports
+};
+
+enum class ArgResult
+{
+    CONSUMED,   // argument (and its parameter, if any) was applied to the job
+    UNKNOWN,    // not a per-job option
+    FAILED,     // recognized, but malformed
+};
+
+// Formats a message for the job's log, without a trailing newline
+void LogMessage( const ToolInputs& opts, const char* format, ... );
+
 bool CompileHLSL( FrontendOptions& opts, ToolInputs& inputs );
-bool GetRootSignatureFromDXBC( FrontendOptions& frontend_opts, ToolInputs& inputs );
+bool GetRootSignatureFromDXBC( ToolInputs& inputs );
+
+void GetAsicList( IntelGPUCompiler::SFunctionTable& functionTable, std::vector< IntelGPUCompiler::PlatformInfo >& asics );
+bool RunTool( ToolContext& ctx, ToolInputs& opts, API& api );
+
+ArgResult ParseJobArgument( int argc, char* argv[], int& i, JobOptions& job );
+bool PrepareInputs( JobOptions& job );
+bool RunJob( ToolContext& ctx, JobOptions& job );
+bool RunPermutations( ToolContext& ctx, JobOptions& job );
+bool RunBatch( ToolContext& ctx, const JobOptions& defaults, const char* manifest_file, const char* summary_file );
+
+// Compiles every shader container in a directory tree, once per distinct program.  The summary, which maps files to programs, is
+//  written next to the results unless 'summary_file' is given.  See Scan.cpp
+bool RunScan( ToolContext& ctx, const JobOptions& defaults, const char* directory, const char* summary_file );
+
+// How a batch is shared out among worker processes, so that a compiler crash only loses the job which caused it
+struct WorkerOptions
+{
+    size_t count = 0;                           // worker processes
+    std::string executable;                     // this tool
+    std::vector<std::string> args;              // the command line's options, for the workers to use as defaults
+    const char* quarantine_file = nullptr;      // if set, jobs which crashed twice are written here, as a manifest
+    double job_timeout = 600;                   // seconds a worker may spend on one job before it is killed.  0 for no limit
+};
+
+// Runs a batch in worker processes, each of which loads the compiler once and compiles one job at a time.  A job whose worker
+//  dies, or hangs, is retried in a new worker, and quarantined if that dies too.  Doesn't need the compiler itself
+bool RunBatchInWorkers( const JobOptions& defaults, DependencyDatabase* deps, const char* manifest_file, const char* summary_file,
+                        const WorkerOptions& opts );
 
 #endif
\ No newline at end of file
@@ -0,0 +1,321 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzerLib.h"
+#include "IntelShaderAnalyzer.h"
+#include "CompilerBackend.h"
+#include "CompilerContextPool.h"
+#include "IsaCache.h"
+#include "RootSignatureCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+
+using namespace IntelGPUCompiler;
+
+// how often compiles check the ISA cache's size.  An analyzer may live as long as its application, so waiting for
+//  ISA_DestroyAnalyzer isn't enough
+static const double CACHE_TRIM_SECONDS = 60;
+
+struct ISA_Analyzer
+{
+    CompilerBackend backend;
+    std::unique_ptr<CompilerContextPool> pool;
+    std::unique_ptr<IsaCache> cache;
+    RootSignatureCache rootsig_cache;
+    std::vector<PlatformInfo> asics;
+    bool serialize_backend = false;
+};
+
+struct ISA_Result
+{
+    struct Output
+    {
+        size_t order;               // position in the analyzer's device list
+        std::string asic;
+        std::string text;
+        std::vector<uint8_t> binary;
+        bool has_binary;
+    };
+
+    std::atomic<uint32_t> refs{ 1 };
+    std::string diagnostics;
+    std::vector<Output> outputs;
+};
+
+// Collects one compile's results and messages.  Devices may finish on several threads at once
+class ResultCollector : public ResultSink, public MessageLog
+{
+public:
+    ResultCollector( ISA_Result& result, const std::vector<PlatformInfo>& asics ) : m_Result( result ), m_Asics( asics ) {}
+
+    virtual bool WriteIsa( const char* platform, const char* isaText, size_t isaLength, const void* pBinary, size_t binarySize ) override
+    {
+        ISA_Result::Output output;
+        output.order = 0;
+        while ( output.order < m_Asics.size() && strcmp( m_Asics[output.order].platformName,platform ) != 0 )
+            output.order++;
+        output.asic = platform;
+        if ( isaText )
+            output.text.assign( isaText,isaLength );
+        output.has_binary = pBinary != nullptr;
+        if ( pBinary )
+            output.binary.assign( (const uint8_t*)pBinary,(const uint8_t*)pBinary + binarySize );
+
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Result.outputs.push_back( std::move( output ) );
+        return true;
+    }
+
+    virtual void Write( const std::string& message ) override
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Result.diagnostics += message;
+        m_Result.diagnostics += '\n';
+    }
+
+private:
+    ISA_Result& m_Result;
+    const std::vector<PlatformInfo>& m_Asics;
+    std::mutex m_Mutex;
+};
+
+static void CopyError( const std::string& message, char* error, size_t error_size )
+{
+    if ( !error || error_size == 0 )
+        return;
+    size_t n = std::min( message.size(),error_size - 1 );
+    memcpy( error,message.data(),n );
+    error[n] = '\0';
+}
+
+extern "C" uint32_t ISA_GetLibraryVersion( void )
+{
+    return ISA_LIBRARY_VERSION;
+}
+
+extern "C" ISA_Status ISA_CreateAnalyzer( const ISA_AnalyzerDesc* desc, ISA_Analyzer** analyzer, char* error, size_t error_size )
+{
+    if ( !desc || !analyzer || desc->struct_size < sizeof( ISA_AnalyzerDesc ) )
+    {
+        CopyError( "Invalid argument",error,error_size );
+        return ISA_INVALID_ARGUMENT;
+    }
+    *analyzer = nullptr;
+
+    try
+    {
+        std::unique_ptr<ISA_Analyzer> pAnalyzer( new ISA_Analyzer() );
+        const char* compilerPath = desc->compiler_path ? desc->compiler_path : CompilerBackend::GetDefaultPath();
+        if ( !pAnalyzer->backend.Load( compilerPath ) )
+        {
+            CopyError( pAnalyzer->backend.GetError(),error,error_size );
+            return ISA_LOAD_FAILED;
+        }
+
+        SFunctionTable& functionTable = pAnalyzer->backend.GetFunctionTable();
+        GetAsicList( functionTable,pAnalyzer->asics );
+
+        PoolOptions poolOpts;
+        if ( desc->max_idle_contexts )
+            poolOpts.max_idle_per_key = desc->max_idle_contexts;
+        pAnalyzer->pool.reset( new CompilerContextPool( functionTable,poolOpts ) );
+        pAnalyzer->serialize_backend = desc->serialize_backend != 0;
+
+        if ( desc->cache_dir )
+        {
+            uint64_t cacheSize = desc->cache_size ? desc->cache_size : 1024ull * 1024 * 1024;
+            pAnalyzer->cache.reset( new IsaCache( desc->cache_dir,cacheSize ) );
+            if ( !pAnalyzer->cache->Open( pAnalyzer->backend.GetPath().c_str() ) )
+            {
+                CopyError( pAnalyzer->cache->GetError(),error,error_size );
+                return ISA_LOAD_FAILED;
+            }
+        }
+
+        *analyzer = pAnalyzer.release();
+        return ISA_OK;
+    }
+    catch ( const std::bad_alloc& )
+    {
+        CopyError( "Out of memory",error,error_size );
+        return ISA_OUT_OF_MEMORY;
+    }
+}
+
+extern "C" void ISA_DestroyAnalyzer( ISA_Analyzer* analyzer )
+{
+    if ( !analyzer )
+        return;
+
+    // contexts must be deleted before the library which created them is unloaded
+    if ( analyzer->cache )
+        analyzer->cache->Trim();
+    analyzer->pool.reset();
+    delete analyzer;
+}
+
+extern "C" uint32_t ISA_GetAsicCount( const ISA_Analyzer* analyzer )
+{
+    return analyzer ? (uint32_t)analyzer->asics.size() : 0;
+}
+
+extern "C" const char* ISA_GetAsicName( const ISA_Analyzer* analyzer, uint32_t index )
+{
+    if ( !analyzer || index >= analyzer->asics.size() )
+        return nullptr;
+    return analyzer->asics[index].platformName;
+}
+
+extern "C" ISA_Status ISA_Compile( ISA_Analyzer* analyzer, const ISA_CompileDesc* desc, ISA_Result** result )
+{
+    if ( !result )
+        return ISA_INVALID_ARGUMENT;
+    *result = nullptr;
+    if ( !analyzer || !desc || desc->struct_size < sizeof( ISA_CompileDesc ) || !desc->data || desc->size == 0 ||
+         (desc->asic_count && !desc->asics) || (desc->define_count && !desc->defines) )
+        return ISA_INVALID_ARGUMENT;
+
+    try
+    {
+        std::unique_ptr<ISA_Result> pResult( new ISA_Result() );
+        ResultCollector collector( *pResult,analyzer->asics );
+
+        // the caller's buffers outlive the compile, so they are used in place
+        JobOptions job;
+        job.api = desc->api ? desc->api : "dx11";
+        job.source_lang = (desc->source == ISA_SOURCE_HLSL) ? "hlsl" : "dxbc";
+        for ( uint32_t i=0; i<desc->asic_count; i++ )
+            job.asicNames.push_back( desc->asics[i] );
+
+        FrontendOptions& frontend = job.frontend;
+        frontend.input_file = desc->name ? desc->name : "shader";
+        if ( desc->source == ISA_SOURCE_HLSL )
+        {
+            frontend.input_text.Borrow( desc->data,desc->size,nullptr );
+            frontend.profile = desc->profile;
+            if ( desc->entry )
+                frontend.entry = desc->entry;
+            for ( uint32_t i=0; i<desc->define_count; i++ )
+                frontend.defines.push_back( std::make_pair( desc->defines[i].name,desc->defines[i].value ? desc->defines[i].value : "" ) );
+            frontend.dx_flags = desc->dx_flags;
+            if ( desc->dx_location )
+                frontend.dx_location = desc->dx_location;
+            frontend.rs_macro = desc->rootsig_macro;
+            frontend.rootsig_cache = &analyzer->rootsig_cache;
+            if ( desc->rootsig_profile )
+                frontend.rs_profile = desc->rootsig_profile;
+        }
+
+        ToolInputs& inputs = job.inputs;
+        if ( desc->source != ISA_SOURCE_HLSL )
+            inputs.bytecode.Borrow( desc->data,desc->size,nullptr );
+        if ( desc->rootsig && desc->rootsig_size )
+            inputs.rootsig.Borrow( desc->rootsig,desc->rootsig_size,nullptr );
+        inputs.shader_id = frontend.input_file;
+        inputs.threads = desc->threads;
+        inputs.serialize_backend = analyzer->serialize_backend;
+        inputs.want_binary = (desc->flags & ISA_COMPILE_BINARY) != 0;
+        inputs.compile_all = true;
+        inputs.log = &collector;
+
+        ToolContext ctx;
+        ctx.pool = analyzer->pool.get();
+        ctx.cache = analyzer->cache.get();
+        ctx.sink = &collector;
+        ctx.asics = analyzer->asics;
+
+        bool succeeded = PrepareInputs( job ) && RunJob( ctx,job );
+        if ( analyzer->cache )
+            analyzer->cache->TrimEvery( CACHE_TRIM_SECONDS );
+
+        std::sort( pResult->outputs.begin(),pResult->outputs.end(),
+                   []( const ISA_Result::Output& a, const ISA_Result::Output& b ) { return a.order < b.order; } );
+
+        *result = pResult.release();
+        return succeeded ? ISA_OK : ISA_COMPILE_FAILED;
+    }
+    catch ( const std::bad_alloc& )
+    {
+        return ISA_OUT_OF_MEMORY;
+    }
+}
+
+extern "C" void ISA_RetainResult( ISA_Result* result )
+{
+    if ( result )
+        result->refs++;
+}
+
+extern "C" void ISA_ReleaseResult( ISA_Result* result )
+{
+    if ( result && --result->refs == 0 )
+        delete result;
+}
+
+extern "C" const char* ISA_GetDiagnostics( const ISA_Result* result, size_t* size )
+{
+    if ( !result )
+    {
+        if ( size )
+            *size = 0;
+        return "";
+    }
+    if ( size )
+        *size = result->diagnostics.size();
+    return result->diagnostics.c_str();
+}
+
+extern "C" uint32_t ISA_GetOutputCount( const ISA_Result* result )
+{
+    return result ? (uint32_t)result->outputs.size() : 0;
+}
+
+extern "C" const char* ISA_GetOutputAsic( const ISA_Result* result, uint32_t index )
+{
+    if ( !result || index >= result->outputs.size() )
+        return nullptr;
+    return result->outputs[index].asic.c_str();
+}
+
+extern "C" const char* ISA_GetOutputText( const ISA_Result* result, uint32_t index, size_t* size )
+{
+    if ( !result || index >= result->outputs.size() )
+    {
+        if ( size )
+            *size = 0;
+        return nullptr;
+    }
+    if ( size )
+        *size = result->outputs[index].text.size();
+    return result->outputs[index].text.c_str();
+}
+
+extern "C" const void* ISA_GetOutputBinary( const ISA_Result* result, uint32_t index, size_t* size )
+{
+    if ( size )
+        *size = 0;
+    if ( !result || index >= result->outputs.size() || !result->outputs[index].has_binary )
+        return nullptr;
+    if ( size )
+        *size = result->outputs[index].binary.size();
+    return result->outputs[index].binary.data();
+}
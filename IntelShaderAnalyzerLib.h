@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _INTEL_SHADER_ANALYZER_LIB_H_
+#define _INTEL_SHADER_ANALYZER_LIB_H_
+
+/*
+ *  C interface to the shader analyzer, for tools which want to compile shaders without spawning the command line tool.
+ *    Inputs are buffers in memory, and results come back in memory.  Nothing is read from or written to disk, except
+ *    for the compiler library itself, the D3D compiler for HLSL, and the ISA cache if one is requested.
+ *
+ *  An ISA_Analyzer owns a loaded compiler library and a pool of warm compiler contexts.  Analyzers are independent of each
+ *    other, and each one may be used from any number of threads at once.  The library has no global state.
+ *
+ *  ISA_Compile always returns a result if it was given valid arguments, even when compilation fails, so that its diagnostics
+ *    can be read.  Results are reference counted.  They stay valid until their last reference is released, even if the
+ *    analyzer is destroyed first.
+ *
+ *  Link against the shared library with ISA_LIBRARY_DLL defined, or against the static library without it
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( ISA_LIBRARY_EXPORTS )
+    #if defined( _WIN32 )
+        #define ISA_EXPORT __declspec( dllexport )
+    #else
+        #define ISA_EXPORT __attribute__(( visibility( "default" ) ))
+    #endif
+#elif defined( ISA_LIBRARY_DLL ) && defined( _WIN32 )
+    #define ISA_EXPORT __declspec( dllimport )
+#else
+    #define ISA_EXPORT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ISA_LIBRARY_VERSION 1
+
+typedef struct ISA_Analyzer ISA_Analyzer;
+typedef struct ISA_Result ISA_Result;
+
+typedef enum ISA_Status
+{
+    ISA_OK                  = 0,
+    ISA_INVALID_ARGUMENT    = 1,
+    ISA_LOAD_FAILED         = 2,    /* the compiler library, or the cache, could not be opened */
+    ISA_COMPILE_FAILED      = 3,    /* the shader, or at least one device, failed.  A failed device doesn't stop the others:
+                                       the result has every device which compiled, and diagnostics for each which didn't */
+    ISA_OUT_OF_MEMORY       = 4,
+} ISA_Status;
+
+typedef enum ISA_Source
+{
+    ISA_SOURCE_DXBC = 0,            /* DXBC or DXIL container */
+    ISA_SOURCE_HLSL = 1,            /* HLSL source.  Windows only */
+} ISA_Source;
+
+/* Compile flags */
+#define ISA_COMPILE_BINARY  0x1     /* return the ISA binary for each device, as well as the text */
+
+typedef struct ISA_AnalyzerDesc
+{
+    uint32_t struct_size;           /* sizeof( ISA_AnalyzerDesc ) */
+    const char* compiler_path;      /* NULL for the default:  $INTEL_GPU_COMPILER, or the driver's compiler */
+    const char* cache_dir;          /* NULL for no ISA cache */
+    uint64_t cache_size;            /* bytes.  0 for the default of 1GB.  Enforced at most once a minute, and on destruction */
+    uint32_t max_idle_contexts;     /* warm contexts kept for each API and device.  0 for the default */
+    uint32_t serialize_backend;     /* non-zero to never call into the compiler from two threads at once */
+} ISA_AnalyzerDesc;
+
+typedef struct ISA_Define
+{
+    const char* name;
+    const char* value;
+} ISA_Define;
+
+typedef struct ISA_CompileDesc
+{
+    uint32_t struct_size;           /* sizeof( ISA_CompileDesc ) */
+    ISA_Source source;
+    const char* api;                /* "dx11" or "dx12".  NULL for dx11 */
+    const void* data;               /* the shader */
+    size_t size;
+    const void* rootsig;            /* optional serialized root signature.  By default, the one in the container is used */
+    size_t rootsig_size;
+    const char* const* asics;       /* device names, as returned by ISA_GetAsicName.  NULL for every device */
+    uint32_t asic_count;
+    uint32_t threads;               /* devices compiled at once.  0 for one per CPU core */
+    uint32_t flags;                 /* ISA_COMPILE_ flags */
+
+    /* HLSL only */
+    const char* name;               /* file name, for messages and #include.  Optional */
+    const char* profile;
+    const char* entry;              /* NULL for "main" */
+    const ISA_Define* defines;
+    uint32_t define_count;
+    uint32_t dx_flags;
+    const char* dx_location;        /* NULL for d3dcompiler_47.dll */
+    const char* rootsig_macro;      /* compiles a root signature from this macro, if the shader has none */
+    const char* rootsig_profile;    /* NULL for rootsig_1_0 */
+} ISA_CompileDesc;
+
+ISA_EXPORT uint32_t ISA_GetLibraryVersion( void );
+
+/* On failure, a description is copied into 'error', if one is given */
+ISA_EXPORT ISA_Status ISA_CreateAnalyzer( const ISA_AnalyzerDesc* desc, ISA_Analyzer** analyzer, char* error, size_t error_size );
+ISA_EXPORT void ISA_DestroyAnalyzer( ISA_Analyzer* analyzer );
+
+ISA_EXPORT uint32_t ISA_GetAsicCount( const ISA_Analyzer* analyzer );
+ISA_EXPORT const char* ISA_GetAsicName( const ISA_Analyzer* analyzer, uint32_t index );
+
+ISA_EXPORT ISA_Status ISA_Compile( ISA_Analyzer* analyzer, const ISA_CompileDesc* desc, ISA_Result** result );
+
+ISA_EXPORT void ISA_RetainResult( ISA_Result* result );
+ISA_EXPORT void ISA_ReleaseResult( ISA_Result* result );
+
+/* Errors and compiler messages, one per line.  Never NULL */
+ISA_EXPORT const char* ISA_GetDiagnostics( const ISA_Result* result, size_t* size );
+
+/* One output for each device which compiled, in the order of ISA_GetAsicName.  Text is NUL-terminated.
+ *   The binary is NULL unless ISA_COMPILE_BINARY was given */
+ISA_EXPORT uint32_t ISA_GetOutputCount( const ISA_Result* result );
+ISA_EXPORT const char* ISA_GetOutputAsic( const ISA_Result* result, uint32_t index );
+ISA_EXPORT const char* ISA_GetOutputText( const ISA_Result* result, uint32_t index, size_t* size );
+ISA_EXPORT const void* ISA_GetOutputBinary( const ISA_Result* result, uint32_t index, size_t* size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
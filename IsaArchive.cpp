@@ -0,0 +1,466 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IsaArchive.h"
+#include "Compression.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#define fseek64 _fseeki64
+#define ftell64 _ftelli64
+#define strcasecmp _stricmp
+#else
+#include <strings.h>
+#define fseek64 fseeko
+#define ftell64 ftello
+#endif
+
+using namespace IsaArchiveFormat;
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//  Reader
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool IsaArchiveReader::Open( const char* path )
+{
+    if ( !m_File.Load( path ) )
+    {
+        printf( "Unable to read archive: %s\n",path );
+        return false;
+    }
+
+    Header header;
+    if ( m_File.size() < sizeof(header) )
+    {
+        printf( "Not an ISA archive: %s\n",path );
+        return false;
+    }
+
+    memcpy( &header,m_File.data(),sizeof(header) );
+    if ( memcmp( header.magic,MAGIC,sizeof(MAGIC) ) != 0 || (header.version != 1 && header.version != VERSION) )
+    {
+        printf( "Not an ISA archive: %s\n",path );
+        return false;
+    }
+
+    uint64_t fileSize = m_File.size();
+    if ( header.index_offset > fileSize || header.index_size > fileSize - header.index_offset ||
+         header.entry_count > header.index_size / sizeof(IndexEntry) ||
+         header.strings_offset < header.entry_count * sizeof(IndexEntry) || header.strings_offset > header.index_size )
+    {
+        printf( "Corrupt archive index: %s\n",path );
+        return false;
+    }
+
+    m_pIndex = m_File.data() + header.index_offset;
+    m_pStrings = (const char*)m_pIndex + header.strings_offset;
+    m_nStringBytes = (size_t)(header.index_size - header.strings_offset);
+    m_nEntries = (size_t)header.entry_count;
+
+    // validate once up front, so lookups don't have to
+    for ( size_t i=0; i<m_nEntries; i++ )
+    {
+        const IndexEntry* e = Index( i );
+        if ( e->offset > fileSize || e->stored_size > fileSize - e->offset ||
+             e->id >= m_nStringBytes || e->api >= m_nStringBytes || e->platform >= m_nStringBytes ||
+             (e->compression != NONE && e->compression != LZ4) || (e->format != TEXT && e->format != BINARY) ||
+             (e->compression == NONE && e->raw_size != e->stored_size) )
+        {
+            printf( "Corrupt archive index: %s\n",path );
+            return false;
+        }
+    }
+    if ( m_nStringBytes && m_pStrings[m_nStringBytes-1] != '\0' )
+    {
+        printf( "Corrupt archive index: %s\n",path );
+        return false;
+    }
+
+    return true;
+}
+
+const IndexEntry* IsaArchiveReader::Index( size_t i ) const
+{
+    // the index is 8-byte aligned in the file, and mappings are page-aligned
+    return (const IndexEntry*)(m_pIndex + i * sizeof(IndexEntry));
+}
+
+const char* IsaArchiveReader::String( uint32_t offset ) const
+{
+    return m_pStrings + offset;
+}
+
+ArchiveEntry IsaArchiveReader::GetEntry( size_t i ) const
+{
+    const IndexEntry* e = Index( i );
+
+    ArchiveEntry entry;
+    entry.id = String( e->id );
+    entry.api = String( e->api );
+    entry.platform = String( e->platform );
+    entry.offset = e->offset;
+    entry.raw_size = e->raw_size;
+    entry.stored_size = e->stored_size;
+    entry.compression = e->compression;
+    entry.format = e->format;
+    return entry;
+}
+
+ptrdiff_t IsaArchiveReader::Find( const char* id, const char* api, const char* platform ) const
+{
+    const char* key[3] = { id,api,platform };
+
+    size_t lo = 0;
+    size_t hi = m_nEntries;
+    while ( lo < hi )
+    {
+        size_t mid = (lo + hi) / 2;
+        const IndexEntry* e = Index( mid );
+        const char* midKey[3] = { String( e->id ),String( e->api ),String( e->platform ) };
+
+        int cmp = 0;
+        for ( size_t k=0; k<3 && cmp == 0; k++ )
+            cmp = strcmp( key[k],midKey[k] );
+
+        if ( cmp == 0 )
+            return (ptrdiff_t)mid;
+        if ( cmp < 0 )
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return -1;
+}
+
+bool IsaArchiveReader::Read( size_t i, std::vector<char>& data ) const
+{
+    const IndexEntry* e = Index( i );
+    const uint8_t* stored = m_File.data() + e->offset;
+
+    data.resize( (size_t)e->raw_size );
+    if ( e->compression == NONE )
+    {
+        memcpy( data.data(),stored,(size_t)e->stored_size );
+        return true;
+    }
+
+    return LZ4Decompress( stored,(size_t)e->stored_size,data.data(),data.size() );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//  Writer
+/////////////////////////////////////////////////////////////////////////////////////////
+
+IsaArchiveWriter::~IsaArchiveWriter()
+{
+    if ( m_pFile )
+        fclose( m_pFile );
+}
+
+bool IsaArchiveWriter::Open( const char* path, bool compress )
+{
+    m_Path = path;
+    m_bCompress = compress;
+    m_Entries.clear();
+
+    // carry forward the entries of an existing archive
+    FILE* fp = fopen( path,"rb" );
+    if ( fp )
+    {
+        fclose( fp );
+
+        {
+            IsaArchiveReader reader;
+            if ( !reader.Open( path ) )
+                return false;
+
+            for ( size_t i=0; i<reader.GetEntryCount(); i++ )
+            {
+                ArchiveEntry entry = reader.GetEntry( i );
+
+                IndexEntry e = {};
+                e.offset = entry.offset;
+                e.stored_size = entry.stored_size;
+                e.raw_size = entry.raw_size;
+                e.compression = (uint16_t)entry.compression;
+                e.format = (uint16_t)entry.format;
+                m_Entries[ Key{ entry.id,entry.api,entry.platform } ] = e;
+            }
+        }
+
+        // the reader's mapping must be gone before the file can be opened for writing
+        m_pFile = fopen( path,"r+b" );
+    }
+    else
+    {
+        m_pFile = fopen( path,"w+b" );
+        if ( m_pFile )
+        {
+            Header header = {};
+            memcpy( header.magic,MAGIC,sizeof(MAGIC) );
+            header.version = VERSION;
+            header.index_offset = sizeof(Header);
+            if ( !WriteAt( 0,&header,sizeof(header) ) )
+            {
+                printf( "Failed to write archive: %s\n",path );
+                return false;
+            }
+        }
+    }
+
+    if ( !m_pFile || fseek64( m_pFile,0,SEEK_END ) != 0 )
+    {
+        printf( "Failed to open archive for writing: %s\n",path );
+        return false;
+    }
+
+    m_nEnd = (uint64_t)ftell64( m_pFile );
+    return true;
+}
+
+bool IsaArchiveWriter::WriteAt( uint64_t offset, const void* data, size_t size )
+{
+    if ( fseek64( m_pFile,(int64_t)offset,SEEK_SET ) != 0 )
+        return false;
+    return fwrite( data,1,size,m_pFile ) == size;
+}
+
+bool IsaArchiveWriter::Append( const char* id, const char* api, const char* platform, const void* data, size_t size, Format format )
+{
+    // compress outside the lock, so that threads writing different results don't wait on each other
+    std::vector<uint8_t> compressed;
+    IndexEntry e = {};
+    e.raw_size = size;
+    e.stored_size = size;
+    e.compression = NONE;
+    e.format = format;
+
+    if ( m_bCompress && size )
+    {
+        compressed.resize( LZ4CompressBound( size ) );
+        size_t n = LZ4Compress( data,size,compressed.data(),compressed.size() );
+        if ( n && n < size )
+        {
+            data = compressed.data();
+            e.stored_size = n;
+            e.compression = LZ4;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if ( !m_pFile )
+        return false;
+
+    e.offset = m_nEnd;
+    if ( !WriteAt( m_nEnd,data,(size_t)e.stored_size ) )
+    {
+        printf( "Failed to write archive: %s\n",m_Path.c_str() );
+        return false;
+    }
+
+    m_nEnd += e.stored_size;
+    m_Entries[ Key{ id,api,platform } ] = e;
+    return true;
+}
+
+bool IsaArchiveWriter::Close()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if ( !m_pFile )
+        return false;
+
+    // the map is already in key order, which is the order readers binary-search
+    std::vector<IndexEntry> index;
+    std::vector<char> strings;
+    std::map<std::string,uint32_t> stringOffsets;
+
+    auto addString = [&]( const std::string& str ) -> uint32_t
+    {
+        auto it = stringOffsets.find( str );
+        if ( it != stringOffsets.end() )
+            return it->second;
+
+        uint32_t offset = (uint32_t)strings.size();
+        strings.insert( strings.end(),str.c_str(),str.c_str() + str.size() + 1 );
+        stringOffsets[str] = offset;
+        return offset;
+    };
+
+    for ( auto& it : m_Entries )
+    {
+        IndexEntry e = it.second;
+        e.id = addString( it.first.id );
+        e.api = addString( it.first.api );
+        e.platform = addString( it.first.platform );
+        index.push_back( e );
+    }
+
+    Header header = {};
+    memcpy( header.magic,MAGIC,sizeof(MAGIC) );
+    header.version = VERSION;
+    header.index_offset = (m_nEnd + 7) & ~7ull;
+    header.entry_count = index.size();
+    header.strings_offset = index.size() * sizeof(IndexEntry);
+    header.index_size = header.strings_offset + strings.size();
+
+    static const uint8_t padding[8] = {};
+    bool ok = WriteAt( m_nEnd,padding,(size_t)(header.index_offset - m_nEnd) ) &&
+              fwrite( index.data(),sizeof(IndexEntry),index.size(),m_pFile ) == index.size() &&
+              fwrite( strings.data(),1,strings.size(),m_pFile ) == strings.size() &&
+              fflush( m_pFile ) == 0;
+
+    // the new index is safely on disk.  Now point the header at it
+    ok = ok && WriteAt( 0,&header,sizeof(header) );
+    ok = (fclose( m_pFile ) == 0) && ok;
+    m_pFile = nullptr;
+
+    if ( !ok )
+        printf( "Failed to write archive: %s\n",m_Path.c_str() );
+    return ok;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//  Subcommands
+/////////////////////////////////////////////////////////////////////////////////////////
+
+static void ShowArchiveHelp()
+{
+    printf( "To list an archive use:  ls <archive>\n" );
+    printf( "To extract from an archive use:  extract <archive> [--id <shader>] [--api <api>] [-c <asic>] [--isa <path_prefix>]\n" );
+}
+
+// archive fields are untrusted, so keep them from steering the output path
+static void AppendSafe( std::string& name, const char* field )
+{
+    for ( const char* p = field; *p; p++ )
+        name.push_back( (*p == '/' || *p == '\\' || *p == ':') ? '_' : *p );
+}
+
+static std::string OutputName( const char* prefix, const ArchiveEntry& entry )
+{
+    std::string name = prefix;
+    AppendSafe( name,entry.id );
+    name += "_";
+    AppendSafe( name,entry.api );
+    name += "_";
+    AppendSafe( name,entry.platform );
+    name += (entry.format == IsaArchiveFormat::BINARY) ? ".bin" : ".asm";
+    return name;
+}
+
+int ArchiveCommand( int argc, char* argv[] )
+{
+    bool extract = strcmp( argv[0],"extract" ) == 0;
+
+    const char* archive = nullptr;
+    const char* id = nullptr;
+    const char* api = nullptr;
+    const char* asic = nullptr;
+    const char* prefix = "./isa_";
+
+    for ( int i=1; i<argc; i++ )
+    {
+        const char** target = nullptr;
+        if ( strcmp( argv[i],"--id" ) == 0 )
+            target = &id;
+        else if ( strcmp( argv[i],"--api" ) == 0 )
+            target = &api;
+        else if ( strcmp( argv[i],"-c" ) == 0 || strcmp( argv[i],"--asic" ) == 0 )
+            target = &asic;
+        else if ( strcmp( argv[i],"--isa" ) == 0 )
+            target = &prefix;
+        else if ( argv[i][0] == '-' )
+        {
+            printf( "Don't understand what: '%s' means\n",argv[i] );
+            ShowArchiveHelp();
+            return 1;
+        }
+        else
+        {
+            archive = argv[i];
+            continue;
+        }
+
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return 1;
+        }
+        *target = argv[++i];
+    }
+
+    if ( !archive )
+    {
+        printf( "No archive filename\n" );
+        ShowArchiveHelp();
+        return 1;
+    }
+
+    IsaArchiveReader reader;
+    if ( !reader.Open( archive ) )
+        return 1;
+
+    size_t nMatched = 0;
+    std::vector<char> data;
+    for ( size_t i=0; i<reader.GetEntryCount(); i++ )
+    {
+        ArchiveEntry entry = reader.GetEntry( i );
+        if ( (id && strcmp( id,entry.id ) != 0) ||
+             (api && strcasecmp( api,entry.api ) != 0) ||
+             (asic && strcasecmp( asic,entry.platform ) != 0) )
+            continue;
+
+        nMatched++;
+        if ( !extract )
+        {
+            printf( "%-6s %-12s %10llu %10llu %s  %s  %s\n",entry.api,entry.platform,(unsigned long long)entry.raw_size,
+                    (unsigned long long)entry.stored_size,entry.compression == IsaArchiveFormat::LZ4 ? "lz4 " : "none",
+                    entry.format == IsaArchiveFormat::BINARY ? "bin " : "text",entry.id );
+            continue;
+        }
+
+        if ( !reader.Read( i,data ) )
+        {
+            printf( "Corrupt archive entry: %s %s %s\n",entry.id,entry.api,entry.platform );
+            return 1;
+        }
+
+        std::string name = OutputName( prefix,entry );
+        FILE* fp = fopen( name.c_str(),(entry.format == IsaArchiveFormat::BINARY) ? "wb" : "w" );
+        if ( !fp )
+        {
+            printf( "Failed to open output file: %s\n",name.c_str() );
+            return 1;
+        }
+        bool succeeded = fwrite( data.data(),1,data.size(),fp ) == data.size();
+        succeeded = (fclose( fp ) == 0) && succeeded;
+        if ( !succeeded )
+        {
+            printf( "Failed to write output file: %s\n",name.c_str() );
+            return 1;
+        }
+    }
+
+    // asking for something specific and not finding it is an error.  Listing an empty archive is not
+    if ( nMatched == 0 && (extract || id || api || asic) )
+    {
+        printf( "No matching entries in: %s\n",archive );
+        return 1;
+    }
+    return 0;
+}
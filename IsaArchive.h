@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _ISA_ARCHIVE_H_
+#define _ISA_ARCHIVE_H_
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "InputBuffer.h"
+
+//
+//  A single file holding many compiled results, indexed by (shader id, API, platform).
+//
+//  Layout:
+//      header          fixed size, at offset 0.  Points at the current index
+//      entry data      appended as results arrive.  Never rewritten
+//      index           sorted table of entries, followed by a string table
+//
+//  Re-opening an archive for writing appends new entries after the old index, then writes a new index and updates the
+//   header.  The header is the commit point: if the tool dies part-way, the archive still reads back as it was before.
+//   A later entry with the same key replaces an earlier one.
+//
+namespace IsaArchiveFormat
+{
+    static const char MAGIC[8]      = { 'I','S','A','A','R','C','H','1' };
+    static const uint32_t VERSION   = 2;    // 2 took the entry format out of the compression field, so version 1 entries read as text
+
+    enum Compression : uint16_t
+    {
+        NONE = 0,
+        LZ4  = 1,
+    };
+
+    enum Format : uint16_t
+    {
+        TEXT   = 0,             // disassembly from pfnGetIsaText
+        BINARY = 1,             // kernel binary from pfnGetIsaBinary
+    };
+
+    struct Header
+    {
+        char     magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t index_offset;
+        uint64_t index_size;        // bytes, including the string table
+        uint64_t entry_count;
+        uint64_t strings_offset;    // string table, relative to index_offset
+    };
+
+    struct IndexEntry
+    {
+        uint64_t offset;            // of the stored bytes, from the start of the file
+        uint64_t stored_size;
+        uint64_t raw_size;
+        uint32_t id;                // NUL-terminated strings, as offsets into the string table
+        uint32_t api;
+        uint32_t platform;
+        uint16_t compression;
+        uint16_t format;
+    };
+}
+
+struct ArchiveEntry
+{
+    const char* id;
+    const char* api;
+    const char* platform;
+    uint64_t offset;
+    uint64_t raw_size;
+    uint64_t stored_size;
+    uint32_t compression;
+    uint32_t format;
+};
+
+// Random-access reader.  The archive is memory mapped, and lookups binary-search the index in place
+class IsaArchiveReader
+{
+public:
+    bool Open( const char* path );
+
+    size_t GetEntryCount() const { return m_nEntries; }
+    ArchiveEntry GetEntry( size_t i ) const;
+
+    // Returns the index of the entry, or -1
+    ptrdiff_t Find( const char* id, const char* api, const char* platform ) const;
+
+    bool Read( size_t i, std::vector<char>& data ) const;
+
+private:
+    const IsaArchiveFormat::IndexEntry* Index( size_t i ) const;
+    const char* String( uint32_t offset ) const;
+
+    InputBuffer m_File;
+    const uint8_t* m_pIndex = nullptr;
+    const char* m_pStrings = nullptr;
+    size_t m_nStringBytes = 0;
+    size_t m_nEntries = 0;
+};
+
+// Appends results to an archive.  Safe to call from several threads at once
+class IsaArchiveWriter
+{
+public:
+    ~IsaArchiveWriter();
+
+    bool Open( const char* path, bool compress );
+    bool Append( const char* id, const char* api, const char* platform, const void* data, size_t size, IsaArchiveFormat::Format format );
+
+    // Writes the index and commits.  Entries appended since the last Close are lost if this is not called
+    bool Close();
+
+private:
+    struct Key
+    {
+        std::string id;
+        std::string api;
+        std::string platform;
+
+        bool operator<( const Key& rhs ) const
+        {
+            if ( id != rhs.id )
+                return id < rhs.id;
+            if ( api != rhs.api )
+                return api < rhs.api;
+            return platform < rhs.platform;
+        }
+    };
+
+    bool WriteAt( uint64_t offset, const void* data, size_t size );
+
+    std::mutex m_Mutex;
+    FILE* m_pFile = nullptr;
+    std::string m_Path;
+    bool m_bCompress = false;
+    uint64_t m_nEnd = 0;
+    std::map< Key,IsaArchiveFormat::IndexEntry > m_Entries;
+};
+
+// 'ls' and 'extract' subcommands
+int ArchiveCommand( int argc, char* argv[] );
+
+#endif
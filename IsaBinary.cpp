@@ -0,0 +1,224 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IsaBinary.h"
+
+#include <cstring>
+
+namespace
+{
+
+// bits of the first dword which are common to the full and compacted encodings
+const uint32_t OPCODE_MASK       = 0x7F;
+const uint32_t CMPT_CTRL         = 1u << 29;
+const uint32_t EXEC_SIZE_SHIFT   = 21;
+const uint32_t EXEC_SIZE_MASK    = 0x7;
+
+const size_t FULL_SIZE      = 16;
+const size_t COMPACTED_SIZE = 8;
+
+struct HwOpcode
+{
+    uint8_t hw;
+    IsaOpcode op;
+};
+
+// Gen9 and Gen11 opcode numbers.  Gen11 adds the rotates and drops nothing we care about
+const HwOpcode HW_OPCODES[] =
+{
+    { 0x00, IsaOpcode::ILLEGAL },
+    { 0x01, IsaOpcode::MOV },
+    { 0x02, IsaOpcode::SEL },
+    { 0x03, IsaOpcode::MOVI },
+    { 0x04, IsaOpcode::NOT },
+    { 0x05, IsaOpcode::AND },
+    { 0x06, IsaOpcode::OR },
+    { 0x07, IsaOpcode::XOR },
+    { 0x08, IsaOpcode::SHR },
+    { 0x09, IsaOpcode::SHL },
+    { 0x0A, IsaOpcode::SMOV },
+    { 0x0C, IsaOpcode::ASR },
+    { 0x0E, IsaOpcode::ROR },
+    { 0x0F, IsaOpcode::ROL },
+    { 0x10, IsaOpcode::CMP },
+    { 0x11, IsaOpcode::CMPN },
+    { 0x12, IsaOpcode::CSEL },
+    { 0x13, IsaOpcode::F32TO16 },
+    { 0x14, IsaOpcode::F16TO32 },
+    { 0x17, IsaOpcode::BFREV },
+    { 0x18, IsaOpcode::BFE },
+    { 0x19, IsaOpcode::BFI1 },
+    { 0x1A, IsaOpcode::BFI2 },
+    { 0x20, IsaOpcode::JMPI },
+    { 0x21, IsaOpcode::BRD },
+    { 0x22, IsaOpcode::IF },
+    { 0x23, IsaOpcode::BRC },
+    { 0x24, IsaOpcode::ELSE },
+    { 0x25, IsaOpcode::ENDIF },
+    { 0x27, IsaOpcode::WHILE },
+    { 0x28, IsaOpcode::BREAK },
+    { 0x29, IsaOpcode::CONT },
+    { 0x2A, IsaOpcode::HALT },
+    { 0x2B, IsaOpcode::CALLA },
+    { 0x2C, IsaOpcode::CALL },
+    { 0x2D, IsaOpcode::RET },
+    { 0x2E, IsaOpcode::GOTO },
+    { 0x2F, IsaOpcode::JOIN },
+    { 0x30, IsaOpcode::WAIT },
+    { 0x31, IsaOpcode::SEND },
+    { 0x32, IsaOpcode::SENDC },
+    { 0x33, IsaOpcode::SENDS },
+    { 0x34, IsaOpcode::SENDSC },
+    { 0x38, IsaOpcode::MATH },
+    { 0x40, IsaOpcode::ADD },
+    { 0x41, IsaOpcode::MUL },
+    { 0x42, IsaOpcode::AVG },
+    { 0x43, IsaOpcode::FRC },
+    { 0x44, IsaOpcode::RNDU },
+    { 0x45, IsaOpcode::RNDD },
+    { 0x46, IsaOpcode::RNDE },
+    { 0x47, IsaOpcode::RNDZ },
+    { 0x48, IsaOpcode::MAC },
+    { 0x49, IsaOpcode::MACH },
+    { 0x4A, IsaOpcode::LZD },
+    { 0x4B, IsaOpcode::FBH },
+    { 0x4C, IsaOpcode::FBL },
+    { 0x4D, IsaOpcode::CBIT },
+    { 0x4E, IsaOpcode::ADDC },
+    { 0x4F, IsaOpcode::SUBB },
+    { 0x50, IsaOpcode::SAD2 },
+    { 0x51, IsaOpcode::SADA2 },
+    { 0x54, IsaOpcode::DP4 },
+    { 0x55, IsaOpcode::DPH },
+    { 0x56, IsaOpcode::DP3 },
+    { 0x57, IsaOpcode::DP2 },
+    { 0x59, IsaOpcode::LINE },
+    { 0x5A, IsaOpcode::PLN },
+    { 0x5B, IsaOpcode::MAD },
+    { 0x5C, IsaOpcode::LRP },
+    { 0x5D, IsaOpcode::MADM },
+    { 0x7E, IsaOpcode::NOP },
+};
+
+struct OpcodeTable
+{
+    IsaOpcode ops[OPCODE_MASK + 1];
+
+    OpcodeTable()
+    {
+        for ( IsaOpcode& op : ops )
+            op = IsaOpcode::UNKNOWN;
+        for ( const HwOpcode& hw : HW_OPCODES )
+            ops[hw.hw] = hw.op;
+    }
+};
+
+const OpcodeTable OPCODE_TABLE;
+
+bool AllZero( const uint8_t* p, size_t size )
+{
+    for ( size_t i=0; i<size; i++ )
+        if ( p[i] )
+            return false;
+    return true;
+}
+
+}
+
+IsaOpcode IsaBinary::GetOpcode( uint8_t hwOpcode )
+{
+    return OPCODE_TABLE.ops[hwOpcode & OPCODE_MASK];
+}
+
+bool IsaBinary::Decode( const void* pBinary, size_t size )
+{
+    m_Instructions.clear();
+    m_Error.clear();
+    m_nEncodedSize = 0;
+    m_nPadding = 0;
+    m_nCompacted = 0;
+    m_nSimdWidth = 0;
+
+    m_Instructions.reserve( size / 12 );
+
+    const uint8_t* pBytes = (const uint8_t*)pBinary;
+    uint32_t widthCounts[6] = {};
+    size_t offset = 0;
+    while ( offset < size )
+    {
+        size_t remaining = size - offset;
+        if ( AllZero( pBytes + offset,remaining ) )
+        {
+            m_nPadding = remaining;
+            break;
+        }
+
+        if ( remaining < COMPACTED_SIZE )
+        {
+            m_Error = "Truncated instruction at offset " + std::to_string( offset );
+            return false;
+        }
+
+        uint32_t dword0;
+        memcpy( &dword0,pBytes + offset,sizeof( dword0 ) );
+
+        IsaBinaryInstruction inst;
+        inst.offset = (uint32_t)offset;
+        inst.hwOpcode = (uint8_t)(dword0 & OPCODE_MASK);
+        inst.opcode = GetOpcode( inst.hwOpcode );
+        inst.compacted = (dword0 & CMPT_CTRL) != 0;
+
+        size_t instSize = inst.compacted ? COMPACTED_SIZE : FULL_SIZE;
+        if ( remaining < instSize )
+        {
+            m_Error = "Truncated instruction at offset " + std::to_string( offset );
+            return false;
+        }
+
+        if ( inst.compacted )
+        {
+            m_nCompacted++;
+        }
+        else
+        {
+            uint32_t execSizeCode = (dword0 >> EXEC_SIZE_SHIFT) & EXEC_SIZE_MASK;
+            inst.execSize = (uint8_t)(1u << execSizeCode);
+            if ( execSizeCode < 6 )
+                widthCounts[execSizeCode]++;
+        }
+
+        m_Instructions.push_back( inst );
+        offset += instSize;
+    }
+    m_nEncodedSize = offset;
+
+    // same rule as the text parser:  the most common width of 8 or more, falling back to narrower ones
+    for ( uint32_t first : { 3u,0u } )
+    {
+        uint32_t best = 0;
+        for ( uint32_t i=first; i<6; i++ )
+        {
+            if ( widthCounts[i] > best )
+            {
+                best = widthCounts[i];
+                m_nSimdWidth = 1u << i;
+            }
+        }
+        if ( best )
+            break;
+    }
+
+    return true;
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_BINARY_H_
+#define _ISA_BINARY_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "IsaParser.h"
+
+//
+//  Decodes Gen9 and Gen11 kernel binaries, as returned by pfnGetIsaBinary, into a table of instructions.
+//
+//   Only the fields which are in the same place in every instruction are decoded:  the opcode, and the compaction bit 
+//   which selects between 8 and 16 byte encodings.  The execution size is decoded for full-size instructions.  Compacted
+//   instructions keep it in a per-platform table, so it is left at 0.  That is enough to walk the kernel, measure its 
+//   size, and classify its instructions without asking the compiler for the much larger text disassembly.
+//
+//   Trailing zero bytes after the last instruction are treated as padding
+//
+
+struct IsaBinaryInstruction
+{
+    uint32_t offset     = 0;    // bytes from the start of the kernel
+    uint8_t hwOpcode    = 0;
+    IsaOpcode opcode    = IsaOpcode::UNKNOWN;
+    uint8_t execSize    = 0;    // 0 if compacted
+    bool compacted      = false;
+};
+
+class IsaBinary
+{
+public:
+    // Returns false if the binary ends part-way through an instruction
+    bool Decode( const void* pBinary, size_t size );
+    const std::string& GetError() const { return m_Error; }
+
+    const std::vector<IsaBinaryInstruction>& GetInstructions() const { return m_Instructions; }
+
+    // Bytes of instructions, not counting padding
+    size_t GetEncodedSize() const { return m_nEncodedSize; }
+    size_t GetPadding() const { return m_nPadding; }
+    uint32_t GetCompactedCount() const { return m_nCompacted; }
+
+    // The execution width used by most full-size instructions, e.g. 8 or 16
+    uint32_t GetSimdWidth() const { return m_nSimdWidth; }
+
+    static IsaOpcode GetOpcode( uint8_t hwOpcode );
+
+private:
+    std::vector<IsaBinaryInstruction> m_Instructions;
+    std::string m_Error;
+    size_t m_nEncodedSize = 0;
+    size_t m_nPadding = 0;
+    uint32_t m_nCompacted = 0;
+    uint32_t m_nSimdWidth = 0;
+};
+
+#endif
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IsaCFG.h"
+#include "IsaParser.h"
+
+#include <algorithm>
+
+static const uint32_t NO_BLOCK = UINT32_MAX;
+
+// Instruction index which a label operand refers to, or UINT32_MAX
+static uint32_t GetTarget( const IsaProgram& program, const IsaOperand& operand )
+{
+    if ( operand.kind != IsaOperandKind::LABEL )
+        return UINT32_MAX;
+    return program.GetLabels()[operand.value].instruction;
+}
+
+static bool EndsBlock( const IsaInstruction& inst )
+{
+    return inst.cls == IsaClass::FLOW || (inst.flags & IsaFlags::EOT);
+}
+
+uint32_t IsaCFG::GetBlockOf( uint32_t instruction ) const
+{
+    return instruction < m_BlockOf.size() ? m_BlockOf[instruction] : NO_BLOCK;
+}
+
+void IsaCFG::AddEdge( IsaBlock& block, uint32_t target )
+{
+    if ( target == NO_BLOCK || block.nSucc == 2 )
+        return;
+    if ( block.nSucc == 1 && block.succ[0] == target )
+        return;
+    block.succ[block.nSucc++] = target;
+}
+
+void IsaCFG::Build( const IsaProgram& program )
+{
+    const std::vector<IsaInstruction>& instructions = program.GetInstructions();
+    uint32_t nInstructions = (uint32_t)instructions.size();
+
+    m_Blocks.clear();
+    m_nLoops = 0;
+    m_nMaxDepth = 0;
+    if ( nInstructions == 0 )
+    {
+        m_BlockOf.clear();
+        return;
+    }
+
+    // find the leaders
+    m_Leader.assign( nInstructions,0 );
+    m_Leader[0] = 1;
+    for ( const IsaLabel& label : program.GetLabels() )
+        if ( label.instruction < nInstructions )
+            m_Leader[label.instruction] = 1;
+    for ( uint32_t i=0; i+1<nInstructions; i++ )
+        if ( EndsBlock( instructions[i] ) )
+            m_Leader[i+1] = 1;
+
+    m_BlockOf.resize( nInstructions );
+    for ( uint32_t i=0; i<nInstructions; i++ )
+    {
+        if ( m_Leader[i] )
+        {
+            IsaBlock block = {};
+            block.first = i;
+            m_Blocks.push_back( block );
+        }
+        m_Blocks.back().count++;
+        m_BlockOf[i] = (uint32_t)m_Blocks.size() - 1;
+    }
+
+    // edges
+    uint32_t nBlocks = (uint32_t)m_Blocks.size();
+    for ( uint32_t b=0; b<nBlocks; b++ )
+    {
+        IsaBlock& block = m_Blocks[b];
+        const IsaInstruction& last = instructions[block.first + block.count - 1];
+        uint32_t next = (b+1 < nBlocks) ? b+1 : NO_BLOCK;
+        bool predicated = (last.flags & IsaFlags::PREDICATED) != 0;
+
+        if ( last.flags & IsaFlags::EOT )
+            continue;
+
+        if ( last.cls != IsaClass::FLOW )
+        {
+            AddEdge( block,next );
+            continue;
+        }
+
+        uint32_t jip = GetTarget( program,last.src[0] );
+        uint32_t uip = (last.nSources > 1) ? GetTarget( program,last.src[1] ) : jip;
+        switch ( last.opcode )
+        {
+        case IsaOpcode::IF:
+        case IsaOpcode::GOTO:
+            // either side of a branch may run, because channels diverge
+            AddEdge( block,next );
+            AddEdge( block,GetBlockOf( jip ) );
+            break;
+
+        case IsaOpcode::ELSE:
+        case IsaOpcode::JMPI:
+        case IsaOpcode::BRD:
+        case IsaOpcode::BRC:
+            if ( predicated || last.opcode == IsaOpcode::BRC )
+                AddEdge( block,next );
+            AddEdge( block,GetBlockOf( jip ) );
+            break;
+
+        case IsaOpcode::BREAK:
+        {
+            // exits through the while instruction at UIP.  Without a UIP label there is no known exit
+            AddEdge( block,next );
+            if ( uip == UINT32_MAX )
+                break;
+            uint32_t target = uip;
+            while ( target < nInstructions && instructions[target].opcode != IsaOpcode::WHILE )
+                target++;
+            AddEdge( block,GetBlockOf( target+1 ) );
+            break;
+        }
+
+        case IsaOpcode::CONT:
+            AddEdge( block,next );
+            AddEdge( block,GetBlockOf( uip ) );
+            break;
+
+        case IsaOpcode::WHILE:
+            AddEdge( block,GetBlockOf( jip ) );
+            if ( predicated )
+                AddEdge( block,next );
+            break;
+
+        case IsaOpcode::RET:
+        case IsaOpcode::HALT:
+            break;
+
+        default:
+            // endif, join, call:  fall through
+            AddEdge( block,next );
+            break;
+        }
+    }
+
+    // a back edge from b to an earlier block t makes a loop of the blocks in between.  Gen flow control is structured,
+    //   so loops nest properly and this is the same as the natural loop
+    std::vector<int32_t> depthDelta( nBlocks+1,0 );
+    for ( uint32_t b=0; b<nBlocks; b++ )
+    {
+        const IsaBlock& block = m_Blocks[b];
+        for ( uint8_t s=0; s<block.nSucc; s++ )
+        {
+            uint32_t t = block.succ[s];
+            if ( t <= b )
+            {
+                m_nLoops++;
+                depthDelta[t]++;
+                depthDelta[b+1]--;
+            }
+        }
+    }
+
+    int32_t depth = 0;
+    for ( uint32_t b=0; b<nBlocks; b++ )
+    {
+        depth += depthDelta[b];
+        m_Blocks[b].loopDepth = (uint8_t)std::min<int32_t>( depth,255 );
+        m_nMaxDepth = std::max( m_nMaxDepth,(uint32_t)depth );
+    }
+}
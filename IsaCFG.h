@@ -0,0 +1,64 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_CFG_H_
+#define _ISA_CFG_H_
+
+#include <cstdint>
+#include <vector>
+
+class IsaProgram;
+
+struct IsaBlock
+{
+    uint32_t first;             // index of the first instruction
+    uint32_t count;             // number of instructions
+    uint32_t succ[2];           // successor blocks
+    uint8_t nSucc;
+    uint8_t loopDepth;          // number of loops which contain the block
+};
+
+//
+//  Basic-block control flow graph for a parsed program.
+//
+//   Blocks end at every flow control instruction, and at end-of-thread sends.  Blocks begin at every label.
+//   Gen flow control is structured:  'if' falls through or jumps to its JIP (the else or endif), 'break' and 'cont' jump
+//    to the loop's 'while' (break then exits the loop), and 'while' jumps back to the top of the loop.
+//   Loops are found from back edges, and each block records how deeply it is nested
+//
+class IsaCFG
+{
+public:
+    void Build( const IsaProgram& program );
+
+    const std::vector<IsaBlock>& GetBlocks() const { return m_Blocks; }
+    uint32_t GetLoopCount() const   { return m_nLoops; }
+    uint32_t GetMaxLoopDepth() const { return m_nMaxDepth; }
+
+    // Block containing an instruction
+    uint32_t GetBlockOf( uint32_t instruction ) const;
+
+private:
+    void AddEdge( IsaBlock& block, uint32_t target );
+
+    std::vector<IsaBlock> m_Blocks;
+    std::vector<uint32_t> m_BlockOf;        // per instruction
+    std::vector<uint8_t> m_Leader;          // per instruction, scratch space for Build
+    uint32_t m_nLoops = 0;
+    uint32_t m_nMaxDepth = 0;
+};
+
+#endif
@@ -0,0 +1,371 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IsaCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+static const uint32_t ENTRY_MAGIC   = 0x43415349;   // 'ISAC'
+static const uint32_t ENTRY_VERSION = 1;
+
+struct EntryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size;
+    Hash128 key;
+};
+
+static int64_t FileTime( const fs::path& path, std::error_code& ec )
+{
+    return (int64_t)fs::last_write_time( path,ec ).time_since_epoch().count();
+}
+
+// a name no other thread or process will pick, for staging an entry before it is renamed into place
+static std::string TempSuffix()
+{
+    static std::atomic<uint64_t> counter{ 0 };
+    Hasher h;
+    h.UpdateValue( std::hash<std::thread::id>()( std::this_thread::get_id() ) );
+    h.UpdateValue( std::chrono::high_resolution_clock::now().time_since_epoch().count() );
+    h.UpdateValue( counter++ );
+    h.UpdateValue( (uintptr_t)&h );     // differs between processes
+    return h.Finish().ToString().substr( 0,16 ) + ".tmp";
+}
+
+IsaCache::IsaCache( const char* root, uint64_t max_bytes )
+    : m_Root( root ), m_nMaxBytes( max_bytes )
+{
+    std::string suffix = TempSuffix();
+    m_DeltaPath = (fs::path( m_Root ) / "usage.d" / suffix.substr( 0,suffix.size() - 4 )).string();
+}
+
+bool IsaCache::Open( const char* compilerPath )
+{
+    std::error_code ec;
+    fs::create_directories( fs::path( m_Root ) / "compilers",ec );
+    if ( !ec )
+        fs::create_directories( fs::path( m_Root ) / "usage.d",ec );
+    if ( ec )
+    {
+        m_Error = "Failed to create cache directory: " + m_Root + " (" + ec.message() + ")";
+        return false;
+    }
+
+    return IdentifyCompiler( compilerPath );
+}
+
+//
+//  The compiler is identified by its size, modification time, and content hash.  Hashing a large driver DLL on every 
+//    run would cost more than a cache hit saves, so the content hash is remembered in the cache, keyed by path, size and time
+//
+bool IsaCache::IdentifyCompiler( const char* compilerPath )
+{
+    std::error_code ec;
+    uint64_t size = fs::file_size( compilerPath,ec );
+    int64_t time = ec ? 0 : FileTime( compilerPath,ec );
+    if ( ec )
+    {
+        m_Error = "Failed to identify compiler for cache: " + std::string( compilerPath );
+        return false;
+    }
+
+    Hasher statHash;
+    statHash.Update( std::string( fs::absolute( compilerPath,ec ).string() ) );
+    statHash.UpdateValue( size );
+    statHash.UpdateValue( time );
+
+    fs::path memo = fs::path( m_Root ) / "compilers" / statHash.Finish().ToString();
+
+    Hash128 contentHash;
+    std::ifstream in( memo );
+    std::string text;
+    if ( !(in >> text) || text.size() != 32 || !Hash128::FromString( text.c_str(),contentHash ) )
+    {
+        std::ifstream dll( compilerPath,std::ifstream::binary );
+        if ( !dll.good() )
+        {
+            m_Error = "Failed to identify compiler for cache: " + std::string( compilerPath );
+            return false;
+        }
+
+        Hasher h;
+        std::vector<char> chunk( 1 << 20 );
+        while ( dll )
+        {
+            dll.read( chunk.data(),chunk.size() );
+            h.Update( chunk.data(),(size_t)dll.gcount() );
+        }
+        contentHash = h.Finish();
+
+        fs::path tmp = memo;
+        tmp += TempSuffix();
+        {
+            std::ofstream out( tmp );
+            out << contentHash.ToString() << "\n";
+        }
+        fs::rename( tmp,memo,ec );
+        if ( ec )
+            fs::remove( tmp,ec );
+    }
+
+    Hasher id;
+    id.UpdateValue( size );
+    id.UpdateValue( time );
+    id.UpdateValue( contentHash );
+    m_CompilerId = id.Finish();
+    return true;
+}
+
+Hash128 IsaCache::MakeKey( const Hash128& inputHash, const char* api, int platform, bool binary ) const
+{
+    Hasher h;
+    h.UpdateValue( ENTRY_VERSION );
+    h.UpdateValue( inputHash );
+    h.Update( std::string( api ) );
+    h.UpdateValue( platform );
+    h.UpdateValue( m_CompilerId );
+
+    // text keys are unchanged from before binaries could be cached, so existing entries stay valid
+    if ( binary )
+        h.Update( std::string( "bin" ) );
+    return h.Finish();
+}
+
+std::string IsaCache::EntryPath( const Hash128& key ) const
+{
+    std::string name = key.ToString();
+    return (fs::path( m_Root ) / name.substr( 0,2 ) / (name + ".isa")).string();
+}
+
+bool IsaCache::Lookup( const Hash128& key, std::vector<char>& isa )
+{
+    std::string path = EntryPath( key );
+
+    // an entry whose header doesn't match its file's size is damaged, or not an entry, and is treated as missing
+    bool hit = false;
+    std::error_code ec;
+    uint64_t fileSize = fs::file_size( path,ec );
+    FILE* fp = ec ? nullptr : fopen( path.c_str(),"rb" );
+    if ( fp )
+    {
+        EntryHeader header;
+        if ( fread( &header,sizeof(header),1,fp ) == 1 &&
+             header.magic == ENTRY_MAGIC && header.version == ENTRY_VERSION && header.key == key &&
+             fileSize >= sizeof(header) && header.size == fileSize - sizeof(header) )
+        {
+            isa.resize( (size_t)header.size );
+            hit = fread( isa.data(),1,isa.size(),fp ) == isa.size();
+        }
+        fclose( fp );
+    }
+
+    if ( !hit )
+    {
+        m_Stats.misses++;
+        return false;
+    }
+
+    // refresh the entry's position in the LRU order.  Losing this race to an eviction is harmless
+    fs::last_write_time( path,fs::file_time_type::clock::now(),ec );
+
+    m_Stats.hits++;
+    m_Stats.bytes_read += isa.size();
+    return true;
+}
+
+bool IsaCache::Store( const Hash128& key, const char* isa, size_t size )
+{
+    fs::path path = EntryPath( key );
+
+    std::error_code ec;
+    fs::create_directories( path.parent_path(),ec );
+
+    fs::path tmp = path;
+    tmp += "." + TempSuffix();
+
+    FILE* fp = fopen( tmp.string().c_str(),"wb" );
+    if ( !fp )
+        return false;
+
+    EntryHeader header;
+    header.magic = ENTRY_MAGIC;
+    header.version = ENTRY_VERSION;
+    header.size = size;
+    header.key = key;
+
+    bool written = fwrite( &header,sizeof(header),1,fp ) == 1 &&
+                   fwrite( isa,1,size,fp ) == size;
+    written = (fclose( fp ) == 0) && written;
+
+    // concurrent writers of the same key produce the same contents, so whichever rename lands last is fine
+    if ( written )
+        fs::rename( tmp,path,ec );
+    if ( !written || ec )
+    {
+        fs::remove( tmp,ec );
+        return false;
+    }
+
+    m_Stats.stores++;
+    m_Stats.bytes_written += sizeof(header) + size;
+    return true;
+}
+
+uint64_t IsaCache::ScanEntries( std::vector<Entry>& entries ) const
+{
+    uint64_t total = 0;
+    std::error_code ec;
+    for ( fs::recursive_directory_iterator it( m_Root,ec ), end; !ec && it != end; it.increment( ec ) )
+    {
+        if ( !it->is_regular_file( ec ) || it->path().extension() != ".isa" )
+            continue;
+
+        Entry e;
+        e.path = it->path().string();
+        e.size = it->file_size( ec );
+        e.time = FileTime( it->path(),ec );
+        if ( ec )
+        {
+            ec.clear();
+            continue;
+        }
+
+        total += e.size;
+        entries.push_back( std::move( e ) );
+    }
+    return total;
+}
+
+uint64_t IsaCache::ReadUsage() const
+{
+    uint64_t total = 0;
+    std::ifstream in( fs::path( m_Root ) / "usage" );
+    in >> total;
+
+    std::error_code ec;
+    for ( fs::directory_iterator it( fs::path( m_Root ) / "usage.d",ec ), end; !ec && it != end; it.increment( ec ) )
+    {
+        if ( it->path().extension() == ".tmp" )
+            continue;
+        uint64_t bytes = 0;
+        std::ifstream delta( it->path() );
+        if ( delta >> bytes )
+            total += bytes;
+    }
+    return total;
+}
+
+void IsaCache::WriteUsage( const std::string& path, uint64_t bytes ) const
+{
+    fs::path tmp = path;
+    tmp += "." + TempSuffix();
+    {
+        std::ofstream out( tmp );
+        out << bytes << "\n";
+    }
+
+    std::error_code ec;
+    fs::rename( tmp,path,ec );
+    if ( ec )
+        fs::remove( tmp,ec );
+}
+
+//
+//  Keeping an exact size would need a lock shared by every process using the cache.  Instead we keep an estimate, and fall
+//   back to a full scan of the directory when it passes the cap.  The estimate over-counts entries which were stored by more
+//   than one process, or which another process has evicted, and can miss what a process stores between another's scan and
+//   that scan removing the processes' files.  Either way the error lasts only until the next full scan
+//
+void IsaCache::TrimEvery( double seconds )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_TrimMutex );
+        auto now = std::chrono::steady_clock::now();
+        if ( now - m_LastTrim < std::chrono::duration<double>( seconds ) )
+            return;
+        m_LastTrim = now;
+    }
+    Trim();
+}
+
+void IsaCache::Trim()
+{
+    std::lock_guard<std::mutex> lock( m_TrimMutex );
+    uint64_t written = m_Stats.bytes_written;
+    if ( written == m_nCountedBytes )
+        return;
+
+    // this process's file holds everything it has written since the last scan, so rewriting it replaces its earlier value
+    WriteUsage( m_DeltaPath,written - m_nCountedBytes );
+    if ( ReadUsage() <= m_nMaxBytes )
+        return;
+
+    std::vector<Entry> entries;
+    uint64_t total = ScanEntries( entries );
+    if ( total > m_nMaxBytes )
+    {
+        // evict down to 90% of the cap, so that we aren't back here after the next store
+        uint64_t target = m_nMaxBytes - m_nMaxBytes / 10;
+        std::sort( entries.begin(),entries.end(),[]( const Entry& a, const Entry& b ) { return a.time < b.time; } );
+
+        std::error_code ec;
+        for ( const Entry& e : entries )
+        {
+            if ( total <= target )
+                break;
+            if ( fs::remove( e.path,ec ) )
+            {
+                total -= e.size;
+                m_Stats.evictions++;
+            }
+        }
+    }
+
+    // the scan counted every process's stores so far, so their files start again from nothing
+    std::error_code ec;
+    for ( fs::directory_iterator it( fs::path( m_Root ) / "usage.d",ec ), end; !ec && it != end; it.increment( ec ) )
+    {
+        std::error_code removeError;
+        if ( it->path().extension() != ".tmp" )
+            fs::remove( it->path(),removeError );
+    }
+    WriteUsage( (fs::path( m_Root ) / "usage").string(),total );
+    m_nCountedBytes = written;
+}
+
+void IsaCache::PrintStats()
+{
+    std::vector<Entry> entries;
+    uint64_t total = ScanEntries( entries );
+
+    size_t lookups = m_Stats.hits + m_Stats.misses;
+    printf( "ISA cache: %zu lookups, %zu hits, %zu misses (%.1f%% hit rate), %zu stores, %zu evictions\n",
+            lookups,(size_t)m_Stats.hits,(size_t)m_Stats.misses,lookups ? 100.0 * m_Stats.hits / lookups : 0.0,
+            (size_t)m_Stats.stores,(size_t)m_Stats.evictions );
+    printf( "ISA cache: %.2f MB read, %.2f MB written, %zu entries using %.2f of %.2f MB\n",
+            m_Stats.bytes_read / (1024.0*1024.0),m_Stats.bytes_written / (1024.0*1024.0),
+            entries.size(),total / (1024.0*1024.0),m_nMaxBytes / (1024.0*1024.0) );
+}
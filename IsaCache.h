@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#pragma once
+#ifndef _ISA_CACHE_H_
+#define _ISA_CACHE_H_
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Hash.h"
+
+struct CacheStats
+{
+    std::atomic<size_t> hits{ 0 };
+    std::atomic<size_t> misses{ 0 };
+    std::atomic<size_t> stores{ 0 };
+    std::atomic<size_t> evictions{ 0 };
+    std::atomic<uint64_t> bytes_read{ 0 };
+    std::atomic<uint64_t> bytes_written{ 0 };
+};
+
+//
+//  Persistent, content-addressed store for compiled ISA.
+//
+//  Entries live in a sharded directory tree:  <root>/<first two hex digits>/<32 hex digits>.isa
+//   Each entry is written to a temporary file and renamed into place, so concurrent writers (threads or processes) never
+//   expose a partial entry.  Readers touch an entry's modification time on every hit, and eviction removes the least
+//   recently used entries once the total size passes the cap.
+//
+//   The total size is estimated from <root>/usage, the size at the last full scan, plus one file in <root>/usage.d for each
+//   process which has stored entries since.  Each process only ever writes its own file, so no update is lost to a race.
+//
+class IsaCache
+{
+public:
+    IsaCache( const char* root, uint64_t max_bytes );
+
+    // Creates the directory tree and identifies the compiler DLL.  Must succeed before the cache is used
+    bool Open( const char* compilerPath );
+    const std::string& GetError() const { return m_Error; }
+
+    // Key for a shader compiled with a particular API and platform by the current compiler.  Text and binary results
+    //  are separate entries
+    Hash128 MakeKey( const Hash128& inputHash, const char* api, int platform, bool binary ) const;
+
+    bool Lookup( const Hash128& key, std::vector<char>& isa );
+    bool Store( const Hash128& key, const char* isa, size_t size );
+
+    // Evicts least recently used entries if the cache may have grown past its cap
+    void Trim();
+
+    // Trims, unless it was done less than 'seconds' ago.  For servers and libraries, which may run for days before they exit
+    void TrimEvery( double seconds );
+
+    void PrintStats();
+
+private:
+    struct Entry
+    {
+        std::string path;
+        uint64_t size;
+        int64_t time;
+    };
+
+    std::string EntryPath( const Hash128& key ) const;
+    bool IdentifyCompiler( const char* compilerPath );
+    uint64_t ScanEntries( std::vector<Entry>& entries ) const;
+    uint64_t ReadUsage() const;
+    void WriteUsage( const std::string& path, uint64_t bytes ) const;
+
+    std::string m_Root;
+    std::string m_Error;
+    uint64_t m_nMaxBytes;
+    Hash128 m_CompilerId;
+    CacheStats m_Stats;
+    std::string m_DeltaPath;            // this process's file in usage.d
+    uint64_t m_nCountedBytes = 0;       // bytes written before the last full scan, which already counted them
+    std::mutex m_TrimMutex;
+    std::chrono::steady_clock::time_point m_LastTrim = std::chrono::steady_clock::now();
+};
+
+#endif
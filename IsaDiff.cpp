@@ -0,0 +1,582 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IsaDiff.h"
+#include "InputBuffer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+inline uint64_t Mix( uint64_t h, uint64_t v )
+{
+    h ^= v * 0x9E3779B97F4A7C15ull;
+    h = (h ^ (h >> 29)) * 0xBF58476D1CE4E5B9ull;
+    return h ^ (h >> 32);
+}
+
+uint64_t MixOperand( uint64_t h, const IsaOperand& operand, size_t instruction, const std::vector<IsaLabel>& labels )
+{
+    uint64_t shape = (uint64_t)operand.kind | ((uint64_t)operand.negate << 8) | ((uint64_t)operand.abs << 9) |
+                     ((uint64_t)operand.vstride << 16) | ((uint64_t)operand.width << 24) | ((uint64_t)operand.hstride << 32);
+    h = Mix( h,shape );
+
+    switch ( operand.kind )
+    {
+    case IsaOperandKind::IMMEDIATE:
+    case IsaOperandKind::ARF:
+        return Mix( h,operand.value );
+    case IsaOperandKind::LABEL:
+        // a jump is the same jump wherever its target ended up, as long as it goes the same way
+        return Mix( h,labels[operand.value].instruction > instruction ? 1 : 2 );
+    default:
+        // general registers are whatever the allocator picked
+        return h;
+    }
+}
+
+}
+
+void IsaDiff::Normalize( const IsaProgram& program, std::vector<uint64_t>& hashes )
+{
+    const char* text = program.GetText();
+    const char* textEnd = text + program.GetLength();
+    const std::vector<IsaInstruction>& instructions = program.GetInstructions();
+    const std::vector<IsaLabel>& labels = program.GetLabels();
+
+    hashes.resize( instructions.size() );
+    for ( size_t i=0; i<instructions.size(); i++ )
+    {
+        const IsaInstruction& inst = instructions[i];
+
+        // compaction is a property of the encoding, not of the instruction
+        uint64_t h = Mix( 0,(uint64_t)inst.opcode | ((uint64_t)inst.execSize << 8) | ((uint64_t)(inst.flags & ~IsaFlags::COMPACTED) << 16) |
+                            ((uint64_t)inst.send << 24) | ((uint64_t)inst.sfid << 32) | ((uint64_t)inst.nSources << 40) );
+        h = Mix( h,inst.descriptor );
+
+        // the mnemonic's modifiers, e.g. 'cmp.lt.f0.0' or 'math.inv', and the operand types, which the parser doesn't keep
+        const char* p = text + inst.mnemonic;
+        const char* eol = (const char*)memchr( p,'\n',(size_t)(textEnd - p) );
+        if ( !eol )
+            eol = textEnd;
+        for ( const char* q = p; q < p + inst.mnemonicLength; q++ )
+            h = Mix( h,(uint8_t)*q );
+        for ( const char* q = p + inst.mnemonicLength; q < eol; q++ )
+        {
+            if ( q[0] == '/' && q+1 < eol && q[1] == '/' )
+                break;
+            if ( *q != ':' )
+                continue;
+            uint64_t type = 0;
+            while ( q+1 < eol && isalnum( (unsigned char)q[1] ) )
+                type = (type << 8) | (uint8_t)*++q;
+            h = Mix( h,type );
+        }
+
+        h = MixOperand( h,inst.dst,i,labels );
+        for ( uint8_t s=0; s<inst.nSources && s<3; s++ )
+            h = MixOperand( h,inst.src[s],i,labels );
+
+        hashes[i] = h;
+    }
+}
+
+void IsaDiff::Compare( const IsaProgram& oldProgram, const IsaProgram& newProgram, IsaDiffResult& result )
+{
+    result = IsaDiffResult();
+    ComputeIsaStats( oldProgram,result.old_stats );
+    ComputeIsaStats( newProgram,result.new_stats );
+
+    Normalize( oldProgram,m_Old );
+    Normalize( newProgram,m_New );
+    m_OldState.assign( m_Old.size(),KEPT );
+    m_NewState.assign( m_New.size(),KEPT );
+
+    // most differences are small and local, so the common ends are skipped before diffing
+    size_t first = 0;
+    while ( first < m_Old.size() && first < m_New.size() && m_Old[first] == m_New[first] )
+        first++;
+    size_t oldEnd = m_Old.size();
+    size_t newEnd = m_New.size();
+    while ( oldEnd > first && newEnd > first && m_Old[oldEnd-1] == m_New[newEnd-1] )
+    {
+        oldEnd--;
+        newEnd--;
+    }
+
+    Diff( first,oldEnd,newEnd,result );
+    FindMoves( result );
+
+    const std::vector<IsaInstruction>& oldInstructions = oldProgram.GetInstructions();
+    const std::vector<IsaInstruction>& newInstructions = newProgram.GetInstructions();
+    for ( size_t i=0; i<m_OldState.size(); i++ )
+    {
+        if ( m_OldState[i] == KEPT )
+            result.unchanged++;
+        else if ( m_OldState[i] == CHANGED )
+        {
+            result.removed++;
+            result.removed_ops[(size_t)oldInstructions[i].opcode]++;
+        }
+    }
+    for ( size_t i=0; i<m_NewState.size(); i++ )
+    {
+        if ( m_NewState[i] == CHANGED )
+        {
+            result.added++;
+            result.added_ops[(size_t)newInstructions[i].opcode]++;
+        }
+    }
+    for ( const IsaMove& move : result.moves )
+        result.moved += move.count;
+}
+
+void IsaDiff::Diff( size_t first, size_t oldEnd, size_t newEnd, IsaDiffResult& result )
+{
+    //  Myers' greedy algorithm.  m_V holds the furthest x reached on each diagonal k = x - y, and m_Trace keeps a copy of
+    //   diagonals -d, -d+2 .. d after each step d, at offset d*(d+1)/2, so the path can be walked back.  -1 marks a diagonal
+    //   which can't be reached without leaving the grid
+    const uint64_t* a = m_Old.data() + first;
+    const uint64_t* b = m_New.data() + first;
+    int32_t n = (int32_t)(oldEnd - first);
+    int32_t m = (int32_t)(newEnd - first);
+    if ( n == 0 && m == 0 )
+        return;
+
+    int32_t maxD = std::min<int32_t>( n + m,(int32_t)MAX_EDITS );
+    int32_t offset = maxD + 1;
+    m_V.assign( 2*maxD + 3,-1 );
+    m_Trace.clear();
+
+    // Which diagonal a step to diagonal k came from, given the previous step's diagonals.  Sets x to where the step lands
+    auto Step = [n,m]( int32_t k, int32_t down, int32_t right, int32_t& x ) -> int32_t
+    {
+        bool downOk = down >= 0 && down - k <= m;
+        bool rightOk = right >= 0 && right + 1 <= n;
+        if ( downOk && (!rightOk || down >= right + 1) )
+        {
+            x = down;
+            return k+1;
+        }
+        if ( rightOk )
+        {
+            x = right + 1;
+            return k-1;
+        }
+        return k;
+    };
+
+    int32_t found = -1;
+    for ( int32_t d=0; d<=maxD && found < 0; d++ )
+    {
+        for ( int32_t k=-d; k<=d; k+=2 )
+        {
+            int32_t x = -1;
+            if ( d == 0 )
+                x = 0;
+            else
+                Step( k,m_V[offset+k+1],m_V[offset+k-1],x );
+
+            if ( x >= 0 )
+            {
+                int32_t y = x - k;
+                while ( x < n && y < m && a[x] == b[y] )
+                {
+                    x++;
+                    y++;
+                }
+                if ( x >= n && y >= m )
+                    found = d;
+            }
+            m_V[offset+k] = x;
+            m_Trace.push_back( x );
+            if ( found >= 0 )
+                break;
+        }
+    }
+
+    if ( found < 0 )
+    {
+        result.truncated = true;
+        std::fill( m_OldState.begin() + first,m_OldState.begin() + oldEnd,CHANGED );
+        std::fill( m_NewState.begin() + first,m_NewState.begin() + newEnd,CHANGED );
+        return;
+    }
+
+    int32_t x = n;
+    int32_t y = m;
+    for ( int32_t d=found; d>0; d-- )
+    {
+        int32_t k = x - y;
+        const int32_t* prev = m_Trace.data() + (size_t)(d-1)*d/2;
+        auto Prev = [prev,d]( int32_t diagonal ) { return (diagonal < -(d-1) || diagonal > d-1) ? -1 : prev[(diagonal + d-1)/2]; };
+        int32_t down = Prev( k+1 );
+        int32_t right = Prev( k-1 );
+
+        int32_t stepX = 0;
+        int32_t from = Step( k,down,right,stepX );
+        int32_t stepY = stepX - k;
+        if ( from == k+1 )
+            m_NewState[first + stepY - 1] = CHANGED;
+        else
+            m_OldState[first + stepX - 1] = CHANGED;
+
+        x = Prev( from );
+        y = x - from;
+    }
+}
+
+void IsaDiff::FindMoves( IsaDiffResult& result )
+{
+    // added instructions by hash, in descending order so that the earliest is at the back
+    m_Added.clear();
+    for ( size_t j=m_New.size(); j-- > 0; )
+    {
+        if ( m_NewState[j] == CHANGED )
+            m_Added[m_New[j]].push_back( (uint32_t)j );
+    }
+    if ( m_Added.empty() )
+        return;
+
+    // a removed instruction which matches an added one moved.  Runs of them which stay together are one move
+    size_t current = SIZE_MAX;
+    for ( size_t i=0; i<m_Old.size(); i++ )
+    {
+        if ( m_OldState[i] != CHANGED )
+        {
+            current = SIZE_MAX;
+            continue;
+        }
+
+        if ( current != SIZE_MAX )
+        {
+            IsaMove& move = result.moves[current];
+            size_t j = move.new_first + move.count;
+            if ( move.old_first + move.count == i && j < m_New.size() && m_NewState[j] == CHANGED && m_New[j] == m_Old[i] )
+            {
+                m_OldState[i] = MOVED;
+                m_NewState[j] = MOVED;
+                move.count++;
+                continue;
+            }
+        }
+
+        current = SIZE_MAX;
+        auto it = m_Added.find( m_Old[i] );
+        if ( it == m_Added.end() )
+            continue;
+
+        std::vector<uint32_t>& candidates = it->second;
+        while ( !candidates.empty() && m_NewState[candidates.back()] != CHANGED )
+            candidates.pop_back();
+        if ( candidates.empty() )
+            continue;
+
+        uint32_t j = candidates.back();
+        candidates.pop_back();
+        m_OldState[i] = MOVED;
+        m_NewState[j] = MOVED;
+        current = result.moves.size();
+        result.moves.push_back( IsaMove{ (uint32_t)i,j,1 } );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  diff subcommand
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct DiffSide
+{
+    InputBuffer text;
+    IsaProgram program;
+};
+
+bool LoadSide( const std::string& path, DiffSide& side )
+{
+    if ( !side.text.Load( path.c_str() ) )
+    {
+        printf( "Failed to read ISA from: %s\n",path.c_str() );
+        return false;
+    }
+    if ( !side.program.Parse( (const char*)side.text.data(),side.text.size() ) )
+    {
+        printf( "No instructions found in: %s\n",path.c_str() );
+        return false;
+    }
+    return true;
+}
+
+const char* const CLASS_NAMES[] = { "alu","math","send","flow","other" };
+
+void PrintOpcodes( const char* heading, const uint32_t* counts )
+{
+    bool any = false;
+    for ( size_t op=0; op<(size_t)IsaOpcode::COUNT; op++ )
+    {
+        if ( !counts[op] )
+            continue;
+        printf( "%s %s %u",any ? "," : heading,IsaProgram::GetOpcodeName( (IsaOpcode)op ),counts[op] );
+        any = true;
+    }
+    if ( any )
+        printf( "\n" );
+}
+
+void PrintReport( const char* oldName, const char* newName, const DiffSide& oldSide, const DiffSide& newSide, const IsaDiffResult& r )
+{
+    const IsaStats& o = r.old_stats;
+    const IsaStats& n = r.new_stats;
+    printf( "--- %s\n+++ %s\n",oldName,newName );
+    printf( "    instructions %u -> %u:  %u unchanged, %u removed, %u added, %u moved\n",o.instructions,n.instructions,
+            r.unchanged,r.removed,r.added,r.moved );
+    if ( r.truncated )
+        printf( "    the programs differ in more than %u places, so some moved code may be reported as removed and added\n",IsaDiff::MAX_EDITS );
+
+    const uint32_t oldClasses[] = { o.alu,o.math,o.send,o.flow_control,o.other };
+    const uint32_t newClasses[] = { n.alu,n.math,n.send,n.flow_control,n.other };
+    for ( size_t c=0; c<5; c++ )
+    {
+        if ( oldClasses[c] != newClasses[c] )
+            printf( "    %-6s %u -> %u\n",CLASS_NAMES[c],oldClasses[c],newClasses[c] );
+    }
+
+    printf( "    sends %u -> %u, sampler %u -> %u, spills %u -> %u, fills %u -> %u\n",o.send,n.send,o.sampler,n.sampler,
+            o.scratch_write,n.scratch_write,o.scratch_read,n.scratch_read );
+    PrintOpcodes( "    removed:",r.removed_ops );
+    PrintOpcodes( "    added:  ",r.added_ops );
+
+    // line numbers are more use than instruction indices to someone with the files open
+    const std::vector<IsaInstruction>& oldInstructions = oldSide.program.GetInstructions();
+    const std::vector<IsaInstruction>& newInstructions = newSide.program.GetInstructions();
+    const size_t MAX_MOVES = 20;
+    for ( size_t i=0; i<r.moves.size() && i<MAX_MOVES; i++ )
+    {
+        const IsaMove& move = r.moves[i];
+        printf( "    moved %u instruction%s:  lines %u-%u -> %u-%u\n",move.count,move.count == 1 ? "" : "s",
+                oldInstructions[move.old_first].line,oldInstructions[move.old_first + move.count - 1].line,
+                newInstructions[move.new_first].line,newInstructions[move.new_first + move.count - 1].line );
+    }
+    if ( r.moves.size() > MAX_MOVES )
+        printf( "    and %zu more moves\n",r.moves.size() - MAX_MOVES );
+}
+
+void PrintSummaryLine( const char* name, const IsaDiffResult& r )
+{
+    printf( "%s:  %u -> %u instructions, %u removed, %u added, %u moved, sends %u -> %u, spills %u -> %u\n",name,
+            r.old_stats.instructions,r.new_stats.instructions,r.removed,r.added,r.moved,r.old_stats.send,r.new_stats.send,
+            r.old_stats.scratch_write,r.new_stats.scratch_write );
+}
+
+void WriteCsvRow( FILE* fp, const std::string& name, const char* status, const IsaDiffResult* r )
+{
+    fprintf( fp,"%s,%s",name.c_str(),status );
+    if ( r )
+        fprintf( fp,",%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",r->old_stats.instructions,r->new_stats.instructions,r->removed,r->added,
+                 r->moved,r->unchanged,r->old_stats.send,r->new_stats.send,r->old_stats.scratch_write,r->new_stats.scratch_write,
+                 r->old_stats.scratch_read,r->new_stats.scratch_read );
+    else
+        fprintf( fp,",,,,,,,,,,,,\n" );
+}
+
+// Relative paths of the ISA files in a directory and its subdirectories, sorted
+bool ListIsaFiles( const char* dir, std::vector<std::string>& files )
+{
+    std::error_code ec;
+    for ( fs::recursive_directory_iterator it( dir,ec ), end; !ec && it != end; it.increment( ec ) )
+    {
+        if ( it->is_regular_file() && it->path().extension() == ".asm" )
+            files.push_back( it->path().lexically_relative( dir ).generic_string() );
+    }
+    if ( ec )
+    {
+        printf( "Failed to read directory: %s\n",dir );
+        return false;
+    }
+    std::sort( files.begin(),files.end() );
+    return true;
+}
+
+void ShowDiffHelp()
+{
+    printf( "To compare ISA use:  diff <old> <new> [-v] [--csv <file>]\n" );
+    printf( "  <old> and <new> are .asm files, or directories of them, which are paired by name\n" );
+}
+
+}
+
+int DiffCommand( int argc, char* argv[] )
+{
+    const char* paths[2] = {};
+    int nPaths = 0;
+    const char* csv_file = nullptr;
+    bool verbose = false;
+
+    for ( int i=1; i<argc; i++ )
+    {
+        if ( strcmp( argv[i],"--csv" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for --csv\n" );
+                return 1;
+            }
+            csv_file = argv[++i];
+        }
+        else if ( strcmp( argv[i],"-v" ) == 0 )
+        {
+            verbose = true;
+        }
+        else if ( argv[i][0] == '-' || nPaths == 2 )
+        {
+            printf( "Don't understand what: '%s' means\n",argv[i] );
+            ShowDiffHelp();
+            return 1;
+        }
+        else
+        {
+            paths[nPaths++] = argv[i];
+        }
+    }
+
+    if ( nPaths != 2 )
+    {
+        ShowDiffHelp();
+        return 1;
+    }
+
+    std::error_code ec;
+    bool oldDir = fs::is_directory( paths[0],ec );
+    bool newDir = fs::is_directory( paths[1],ec );
+    if ( oldDir != newDir )
+    {
+        printf( "Can't compare a file with a directory: %s and %s\n",paths[0],paths[1] );
+        return 1;
+    }
+
+    IsaDiff diff;
+    IsaDiffResult result;
+    DiffSide oldSide;
+    DiffSide newSide;
+
+    if ( !oldDir )
+    {
+        if ( !LoadSide( paths[0],oldSide ) || !LoadSide( paths[1],newSide ) )
+            return 1;
+        diff.Compare( oldSide.program,newSide.program,result );
+        if ( result.Identical() )
+            return 0;
+        PrintReport( paths[0],paths[1],oldSide,newSide,result );
+        return 1;
+    }
+
+    std::vector<std::string> oldFiles;
+    std::vector<std::string> newFiles;
+    if ( !ListIsaFiles( paths[0],oldFiles ) || !ListIsaFiles( paths[1],newFiles ) )
+        return 1;
+
+    FILE* csv = nullptr;
+    if ( csv_file )
+    {
+        csv = fopen( csv_file,"w" );
+        if ( !csv )
+        {
+            printf( "Failed to open CSV file: %s\n",csv_file );
+            return 1;
+        }
+        fprintf( csv,"file,status,old_instructions,new_instructions,removed,added,moved,unchanged,old_sends,new_sends,old_spills,new_spills,old_fills,new_fills\n" );
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t nIdentical = 0, nChanged = 0, nOnlyOld = 0, nOnlyNew = 0, nFailed = 0;
+
+    // both lists are sorted, so pairs are found by merging them
+    size_t i = 0, j = 0;
+    while ( i < oldFiles.size() || j < newFiles.size() )
+    {
+        int c = (i == oldFiles.size()) ? 1 : (j == newFiles.size()) ? -1 : oldFiles[i].compare( newFiles[j] );
+        if ( c < 0 )
+        {
+            printf( "Only in %s: %s\n",paths[0],oldFiles[i].c_str() );
+            if ( csv )
+                WriteCsvRow( csv,oldFiles[i],"removed",nullptr );
+            nOnlyOld++;
+            i++;
+            continue;
+        }
+        if ( c > 0 )
+        {
+            printf( "Only in %s: %s\n",paths[1],newFiles[j].c_str() );
+            if ( csv )
+                WriteCsvRow( csv,newFiles[j],"added",nullptr );
+            nOnlyNew++;
+            j++;
+            continue;
+        }
+
+        const std::string& name = oldFiles[i];
+        std::string oldPath = (fs::path( paths[0] ) / name).string();
+        std::string newPath = (fs::path( paths[1] ) / name).string();
+        i++;
+        j++;
+
+        if ( !LoadSide( oldPath,oldSide ) || !LoadSide( newPath,newSide ) )
+        {
+            if ( csv )
+                WriteCsvRow( csv,name,"failed",nullptr );
+            nFailed++;
+            continue;
+        }
+
+        diff.Compare( oldSide.program,newSide.program,result );
+        if ( result.Identical() )
+            nIdentical++;
+        else if ( verbose )
+            PrintReport( oldPath.c_str(),newPath.c_str(),oldSide,newSide,result );
+        else
+            PrintSummaryLine( name.c_str(),result );
+        nChanged += result.Identical() ? 0 : 1;
+
+        if ( csv )
+            WriteCsvRow( csv,name,result.Identical() ? "identical" : "changed",&result );
+    }
+
+    bool written = true;
+    if ( csv )
+    {
+        written = !ferror( csv );
+        written = (fclose( csv ) == 0) && written;
+        if ( !written )
+            printf( "Failed to write CSV file: %s\n",csv_file );
+    }
+
+    double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count();
+    printf( "Diff: %zu identical, %zu changed, %zu only in old, %zu only in new, %zu failed in %.2fs\n",nIdentical,nChanged,
+            nOnlyOld,nOnlyNew,nFailed,seconds );
+
+    return (nChanged || nOnlyOld || nOnlyNew || nFailed || !written) ? 1 : 0;
+}
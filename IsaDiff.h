@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_DIFF_H_
+#define _ISA_DIFF_H_
+
+#include "IsaParser.h"
+#include "IsaStats.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//
+//  Structural comparison of two programs, e.g. the same shader from two drivers, APIs or devices.
+//
+//   Each instruction is reduced to a hash of what it does rather than how it was allocated:  its opcode and modifiers,
+//   execution size, predication, operand kinds, regions and types, immediates, and send descriptors.  Register numbers
+//   and sub-registers are left out, and so are label names, which are replaced by the direction of the jump.  Comments,
+//   where disassemblers put addresses and instruction ids, are never part of an instruction.
+//
+//   The hashes are compared with Myers' O(ND) difference algorithm.  Instructions which were removed in one place and
+//   added in another are reported as moved, not as removed and added
+//
+
+struct IsaMove
+{
+    uint32_t old_first;         // index of the first instruction in each program
+    uint32_t new_first;
+    uint32_t count;
+};
+
+struct IsaDiffResult
+{
+    uint32_t unchanged  = 0;
+    uint32_t removed    = 0;
+    uint32_t added      = 0;
+    uint32_t moved      = 0;
+    bool truncated      = false;    // the programs differ too much for an exact diff, see IsaDiff::MAX_EDITS
+
+    // removed and added instructions, not counting moved ones
+    uint32_t removed_ops[(size_t)IsaOpcode::COUNT] = {};
+    uint32_t added_ops[(size_t)IsaOpcode::COUNT] = {};
+
+    IsaStats old_stats;
+    IsaStats new_stats;
+    std::vector<IsaMove> moves;
+
+    bool Identical() const { return removed == 0 && added == 0 && moved == 0; }
+};
+
+//
+//  Re-using an IsaDiff for many pairs of programs avoids re-allocating its tables
+//
+class IsaDiff
+{
+public:
+    // Beyond this many edits, the remaining differences are reported as a block removed and a block added
+    static const uint32_t MAX_EDITS = 1024;
+
+    // One hash per instruction
+    static void Normalize( const IsaProgram& program, std::vector<uint64_t>& hashes );
+
+    void Compare( const IsaProgram& oldProgram, const IsaProgram& newProgram, IsaDiffResult& result );
+
+private:
+    enum State : uint8_t
+    {
+        KEPT,
+        CHANGED,        // removed from the old program or added to the new one
+        MOVED,
+    };
+
+    void Diff( size_t first, size_t oldEnd, size_t newEnd, IsaDiffResult& result );
+    void FindMoves( IsaDiffResult& result );
+
+    std::vector<uint64_t> m_Old;
+    std::vector<uint64_t> m_New;
+    std::vector<uint8_t> m_OldState;
+    std::vector<uint8_t> m_NewState;
+    std::vector<int32_t> m_V;
+    std::vector<int32_t> m_Trace;
+    std::unordered_map< uint64_t,std::vector<uint32_t> > m_Added;
+};
+
+// The 'diff' subcommand, for comparing ISA files or directories of them.  Returns 0 if nothing changed
+int DiffCommand( int argc, char* argv[] );
+
+#endif
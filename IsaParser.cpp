@@ -0,0 +1,654 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "IsaParser.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+struct OpcodeInfo
+{
+    const char* name;
+    IsaOpcode op;
+    IsaClass cls;
+};
+
+// sorted by name, for binary search
+const OpcodeInfo OPCODES[] =
+{
+    { "add",     IsaOpcode::ADD,     IsaClass::ALU },
+    { "addc",    IsaOpcode::ADDC,    IsaClass::ALU },
+    { "and",     IsaOpcode::AND,     IsaClass::ALU },
+    { "asr",     IsaOpcode::ASR,     IsaClass::ALU },
+    { "avg",     IsaOpcode::AVG,     IsaClass::ALU },
+    { "bfe",     IsaOpcode::BFE,     IsaClass::ALU },
+    { "bfi1",    IsaOpcode::BFI1,    IsaClass::ALU },
+    { "bfi2",    IsaOpcode::BFI2,    IsaClass::ALU },
+    { "bfrev",   IsaOpcode::BFREV,   IsaClass::ALU },
+    { "brc",     IsaOpcode::BRC,     IsaClass::FLOW },
+    { "brd",     IsaOpcode::BRD,     IsaClass::FLOW },
+    { "break",   IsaOpcode::BREAK,   IsaClass::FLOW },
+    { "call",    IsaOpcode::CALL,    IsaClass::FLOW },
+    { "calla",   IsaOpcode::CALLA,   IsaClass::FLOW },
+    { "cbit",    IsaOpcode::CBIT,    IsaClass::ALU },
+    { "cmp",     IsaOpcode::CMP,     IsaClass::ALU },
+    { "cmpn",    IsaOpcode::CMPN,    IsaClass::ALU },
+    { "cont",    IsaOpcode::CONT,    IsaClass::FLOW },
+    { "csel",    IsaOpcode::CSEL,    IsaClass::ALU },
+    { "dim",     IsaOpcode::DIM,     IsaClass::ALU },
+    { "dp2",     IsaOpcode::DP2,     IsaClass::ALU },
+    { "dp3",     IsaOpcode::DP3,     IsaClass::ALU },
+    { "dp4",     IsaOpcode::DP4,     IsaClass::ALU },
+    { "dph",     IsaOpcode::DPH,     IsaClass::ALU },
+    { "else",    IsaOpcode::ELSE,    IsaClass::FLOW },
+    { "endif",   IsaOpcode::ENDIF,   IsaClass::FLOW },
+    { "f16to32", IsaOpcode::F16TO32, IsaClass::ALU },
+    { "f32to16", IsaOpcode::F32TO16, IsaClass::ALU },
+    { "fbh",     IsaOpcode::FBH,     IsaClass::ALU },
+    { "fbl",     IsaOpcode::FBL,     IsaClass::ALU },
+    { "frc",     IsaOpcode::FRC,     IsaClass::ALU },
+    { "goto",    IsaOpcode::GOTO,    IsaClass::FLOW },
+    { "halt",    IsaOpcode::HALT,    IsaClass::FLOW },
+    { "if",      IsaOpcode::IF,      IsaClass::FLOW },
+    { "illegal", IsaOpcode::ILLEGAL, IsaClass::OTHER },
+    { "jmpi",    IsaOpcode::JMPI,    IsaClass::FLOW },
+    { "join",    IsaOpcode::JOIN,    IsaClass::FLOW },
+    { "line",    IsaOpcode::LINE,    IsaClass::ALU },
+    { "lrp",     IsaOpcode::LRP,     IsaClass::ALU },
+    { "lzd",     IsaOpcode::LZD,     IsaClass::ALU },
+    { "mac",     IsaOpcode::MAC,     IsaClass::ALU },
+    { "mach",    IsaOpcode::MACH,    IsaClass::ALU },
+    { "mad",     IsaOpcode::MAD,     IsaClass::ALU },
+    { "madm",    IsaOpcode::MADM,    IsaClass::ALU },
+    { "math",    IsaOpcode::MATH,    IsaClass::MATH },
+    { "mov",     IsaOpcode::MOV,     IsaClass::ALU },
+    { "movi",    IsaOpcode::MOVI,    IsaClass::ALU },
+    { "mul",     IsaOpcode::MUL,     IsaClass::ALU },
+    { "nop",     IsaOpcode::NOP,     IsaClass::OTHER },
+    { "not",     IsaOpcode::NOT,     IsaClass::ALU },
+    { "or",      IsaOpcode::OR,      IsaClass::ALU },
+    { "pln",     IsaOpcode::PLN,     IsaClass::ALU },
+    { "ret",     IsaOpcode::RET,     IsaClass::FLOW },
+    { "rndd",    IsaOpcode::RNDD,    IsaClass::ALU },
+    { "rnde",    IsaOpcode::RNDE,    IsaClass::ALU },
+    { "rndu",    IsaOpcode::RNDU,    IsaClass::ALU },
+    { "rndz",    IsaOpcode::RNDZ,    IsaClass::ALU },
+    { "rol",     IsaOpcode::ROL,     IsaClass::ALU },
+    { "ror",     IsaOpcode::ROR,     IsaClass::ALU },
+    { "sad2",    IsaOpcode::SAD2,    IsaClass::ALU },
+    { "sada2",   IsaOpcode::SADA2,   IsaClass::ALU },
+    { "sel",     IsaOpcode::SEL,     IsaClass::ALU },
+    { "send",    IsaOpcode::SEND,    IsaClass::SEND },
+    { "sendc",   IsaOpcode::SENDC,   IsaClass::SEND },
+    { "sends",   IsaOpcode::SENDS,   IsaClass::SEND },
+    { "sendsc",  IsaOpcode::SENDSC,  IsaClass::SEND },
+    { "shl",     IsaOpcode::SHL,     IsaClass::ALU },
+    { "shr",     IsaOpcode::SHR,     IsaClass::ALU },
+    { "smov",    IsaOpcode::SMOV,    IsaClass::ALU },
+    { "subb",    IsaOpcode::SUBB,    IsaClass::ALU },
+    { "sync",    IsaOpcode::SYNC,    IsaClass::OTHER },
+    { "wait",    IsaOpcode::WAIT,    IsaClass::OTHER },
+    { "while",   IsaOpcode::WHILE,   IsaClass::FLOW },
+    { "xor",     IsaOpcode::XOR,     IsaClass::ALU },
+};
+
+const size_t N_OPCODES = sizeof( OPCODES ) / sizeof( OPCODES[0] );
+
+// compares a counted string with a NUL-terminated one
+int Compare( const char* p, size_t n, const char* str )
+{
+    int c = strncmp( p,str,n );
+    if ( c != 0 )
+        return c;
+    return str[n] == 0 ? 0 : -1;
+}
+
+const OpcodeInfo* FindOpcode( const char* p, size_t n )
+{
+    size_t lo = 0, hi = N_OPCODES;
+    while ( lo < hi )
+    {
+        size_t mid = (lo + hi) / 2;
+        int c = Compare( p,n,OPCODES[mid].name );
+        if ( c == 0 )
+            return &OPCODES[mid];
+        if ( c < 0 )
+            hi = mid;
+        else
+            lo = mid+1;
+    }
+    return nullptr;
+}
+
+inline bool IsSpace( char c )   { return c == ' ' || c == '\t' || c == '\r'; }
+inline bool IsDigit( char c )   { return c >= '0' && c <= '9'; }
+inline bool IsAlpha( char c )   { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+inline bool IsIdent( char c )   { return IsAlpha( c ) || IsDigit( c ) || c == '_' || c == '$'; }
+
+const char* SkipSpace( const char* p, const char* end )
+{
+    while ( p < end && IsSpace( *p ) )
+        p++;
+    return p;
+}
+
+// Parses a decimal number, advancing p.  Returns 0 if there are no digits
+uint32_t ParseDecimal( const char*& p, const char* end )
+{
+    uint32_t value = 0;
+    while ( p < end && IsDigit( *p ) )
+        value = value*10 + (uint32_t)(*p++ - '0');
+    return value;
+}
+
+uint32_t ParseHex( const char*& p, const char* end )
+{
+    uint32_t value = 0;
+    for ( ; p < end; p++ )
+    {
+        char c = *p;
+        if ( IsDigit( c ) )
+            value = (value << 4) | (uint32_t)(c - '0');
+        else if ( c >= 'a' && c <= 'f' )
+            value = (value << 4) | (uint32_t)(c - 'a' + 10);
+        else if ( c >= 'A' && c <= 'F' )
+            value = (value << 4) | (uint32_t)(c - 'A' + 10);
+        else
+            break;
+    }
+    return value;
+}
+
+uint8_t Clamp8( uint32_t value )
+{
+    return (uint8_t)std::min<uint32_t>( value,255 );
+}
+
+bool Contains( const char* p, const char* end, const char* word )
+{
+    size_t n = strlen( word );
+    for ( ; p + n <= end; p++ )
+        if ( memcmp( p,word,n ) == 0 )
+            return true;
+    return false;
+}
+
+// architecture register files, which are followed by a register number
+const char* ARF_NAMES[] = { "acc","a","ce","cr","dbg","f","ip","mme","n","sp","sr","tdr","tm" };
+
+bool IsArchitectureRegister( const char* p, const char* end )
+{
+    for ( const char* name : ARF_NAMES )
+    {
+        size_t n = strlen( name );
+        if ( (size_t)(end - p) < n || memcmp( p,name,n ) != 0 )
+            continue;
+        if ( strcmp( name,"ip" ) == 0 )
+            return p + n == end || !IsIdent( p[n] );
+        if ( p + n < end && IsDigit( p[n] ) )
+            return true;
+    }
+    return false;
+}
+
+}
+
+const char* IsaProgram::GetOpcodeName( IsaOpcode op )
+{
+    for ( const OpcodeInfo& info : OPCODES )
+        if ( info.op == op )
+            return info.name;
+    return "unknown";
+}
+
+IsaClass IsaProgram::GetOpcodeClass( IsaOpcode op )
+{
+    for ( const OpcodeInfo& info : OPCODES )
+        if ( info.op == op )
+            return info.cls;
+    return IsaClass::OTHER;
+}
+
+bool IsaProgram::Parse( const char* text, size_t length )
+{
+    m_pText = text;
+    m_nLength = length;
+    m_Instructions.clear();
+    m_Labels.clear();
+    m_Pending.clear();
+    m_nUnresolved = 0;
+    m_nSimdWidth = 0;
+
+    // a typical instruction line is 60-100 characters
+    m_Instructions.reserve( length / 64 );
+
+    const char* p = text;
+    const char* end = text + length;
+    uint32_t lineNumber = 0;
+    while ( p < end )
+    {
+        const char* eol = (const char*)memchr( p,'\n',(size_t)(end - p) );
+        if ( !eol )
+            eol = end;
+
+        ParseLine( p,eol,++lineNumber );
+        p = eol + 1;
+    }
+
+    ResolveLabels();
+
+    // the dominant execution width.  Scalar and narrow instructions only count if there is nothing else
+    uint32_t widthCounts[6] = {};
+    for ( const IsaInstruction& inst : m_Instructions )
+    {
+        for ( uint32_t i=0; i<6; i++ )
+            if ( inst.execSize == (1u << i) )
+                widthCounts[i]++;
+    }
+    for ( uint32_t first : { 3u,0u } )
+    {
+        uint32_t best = 0;
+        for ( uint32_t i=first; i<6; i++ )
+        {
+            if ( widthCounts[i] > best )
+            {
+                best = widthCounts[i];
+                m_nSimdWidth = 1u << i;
+            }
+        }
+        if ( best )
+            break;
+    }
+
+    return !m_Instructions.empty();
+}
+
+bool IsaProgram::ParseLine( const char* p, const char* end, uint32_t lineNumber )
+{
+    p = SkipSpace( p,end );
+    if ( p == end || (p[0] == '/' && p+1 < end && p[1] == '/') )
+        return false;
+
+    // labels.  An instruction may follow on the same line
+    const char* q = p;
+    while ( q < end && IsIdent( *q ) )
+        q++;
+    if ( q > p && q < end && *q == ':' && !IsDigit( *p ) )
+    {
+        IsaLabel label;
+        label.name = (uint32_t)(p - m_pText);
+        label.nameLength = (uint16_t)std::min<size_t>( q - p,UINT16_MAX );
+        label.instruction = (uint32_t)m_Instructions.size();
+        m_Labels.push_back( label );
+
+        p = SkipSpace( q+1,end );
+        if ( p == end || (p[0] == '/' && p+1 < end && p[1] == '/') )
+            return true;
+    }
+
+    IsaInstruction inst;
+    inst.line = lineNumber;
+
+    // predicate or mask control:  (W), (f0.0), (~f0.1), (W&f0.0), (+f0.0.any4h)
+    if ( *p == '(' )
+    {
+        const char* close = (const char*)memchr( p,')',(size_t)(end - p) );
+        if ( !close )
+            return false;
+        for ( const char* c = p+1; c < close; c++ )
+        {
+            if ( *c == 'W' )
+                inst.flags |= IsaFlags::NOMASK;
+            else if ( *c == '~' || *c == '-' )
+                inst.flags |= IsaFlags::PRED_INVERT;
+            else if ( *c == 'f' && c+1 < close && IsDigit( c[1] ) )
+                inst.flags |= IsaFlags::PREDICATED;
+        }
+        p = SkipSpace( close+1,end );
+    }
+
+    // mnemonic, with optional modifiers:  math.inv, cmp.lt.f0.0, add.sat
+    const char* mnemonic = p;
+    while ( p < end && (IsIdent( *p ) || *p == '.') )
+        p++;
+    if ( p == mnemonic )
+        return false;
+
+    const char* dot = (const char*)memchr( mnemonic,'.',(size_t)(p - mnemonic) );
+    const char* baseEnd = dot ? dot : p;
+    const OpcodeInfo* pInfo = FindOpcode( mnemonic,(size_t)(baseEnd - mnemonic) );
+    if ( !pInfo )
+        return false;
+
+    inst.mnemonic = (uint32_t)(mnemonic - m_pText);
+    inst.mnemonicLength = (uint16_t)std::min<size_t>( p - mnemonic,UINT16_MAX );
+    inst.opcode = pInfo->op;
+    inst.cls = pInfo->cls;
+    if ( dot && Contains( dot,p,".sat" ) )
+        inst.flags |= IsaFlags::SATURATE;
+
+    // execution size:  (8|M0) or (8)
+    p = SkipSpace( p,end );
+    if ( p < end && *p == '(' )
+    {
+        p++;
+        inst.execSize = Clamp8( ParseDecimal( p,end ) );
+        const char* close = (const char*)memchr( p,')',(size_t)(end - p) );
+        p = close ? close+1 : end;
+    }
+
+    size_t index = m_Instructions.size();
+    uint32_t immediates[4];
+    size_t nImmediates = 0;
+    int slot = (inst.cls == IsaClass::FLOW) ? 0 : -1;     // flow control has no destination
+    const char* comment = end;
+
+    while ( true )
+    {
+        p = SkipSpace( p,end );
+        if ( p >= end )
+            break;
+
+        if ( p[0] == '/' && p+1 < end && p[1] == '/' )
+        {
+            comment = p;
+            break;
+        }
+
+        // instruction options:  {EOT}, {Compacted}, {NoMask, Switch}
+        if ( *p == '{' )
+        {
+            const char* close = (const char*)memchr( p,'}',(size_t)(end - p) );
+            if ( !close )
+                close = end;
+            if ( Contains( p,close,"EOT" ) )
+                inst.flags |= IsaFlags::EOT;
+            if ( Contains( p,close,"Compacted" ) )
+                inst.flags |= IsaFlags::COMPACTED;
+            if ( Contains( p,close,"NoMask" ) )
+                inst.flags |= IsaFlags::NOMASK;
+            p = (close < end) ? close+1 : end;
+            continue;
+        }
+
+        // an operand ends at whitespace, except inside an indirect address:  r[a0.0, 16]
+        const char* tokenEnd = p;
+        int depth = 0;
+        while ( tokenEnd < end && (depth > 0 || !IsSpace( *tokenEnd )) )
+        {
+            if ( *tokenEnd == '[' )
+                depth++;
+            else if ( *tokenEnd == ']' )
+                depth--;
+            tokenEnd++;
+        }
+
+        IsaOperand operand;
+        if ( ParseOperand( p,tokenEnd,operand,index,slot ) )
+        {
+            if ( inst.cls == IsaClass::SEND && operand.kind == IsaOperandKind::IMMEDIATE )
+            {
+                // message descriptors are not sources
+                if ( nImmediates < 4 )
+                    immediates[nImmediates++] = operand.value;
+            }
+            else if ( slot < 0 )
+            {
+                inst.dst = operand;
+                slot = 0;
+            }
+            else if ( slot < 3 )
+            {
+                inst.src[slot++] = operand;
+            }
+        }
+        p = tokenEnd;
+    }
+
+    inst.nSources = (uint8_t)std::max( slot,0 );
+
+    if ( inst.cls == IsaClass::SEND )
+        ClassifySend( inst,immediates,nImmediates,comment,end );
+
+    m_Instructions.push_back( inst );
+    return true;
+}
+
+bool IsaProgram::ParseOperand( const char* p, const char* end, IsaOperand& operand, size_t instruction, int slot )
+{
+    // source modifiers
+    if ( end - p >= 5 && memcmp( p,"(abs)",5 ) == 0 )
+    {
+        operand.abs = 1;
+        p += 5;
+    }
+    if ( p < end && (*p == '-' || *p == '~') && p+1 < end && !IsDigit( p[1] ) )
+    {
+        operand.negate = 1;
+        p++;
+    }
+    if ( p == end )
+        return false;
+
+    // immediates:  0x3F800000:f, 16:ud, -1:d, 1.5:f
+    if ( IsDigit( *p ) || *p == '-' )
+    {
+        operand.kind = IsaOperandKind::IMMEDIATE;
+        bool negative = (*p == '-');
+        if ( negative )
+            p++;
+        if ( end - p > 2 && p[0] == '0' && (p[1] == 'x' || p[1] == 'X') )
+        {
+            p += 2;
+            operand.value = ParseHex( p,end );
+        }
+        else
+        {
+            operand.value = ParseDecimal( p,end );
+        }
+        if ( negative )
+            operand.value = 0u - operand.value;
+        return true;
+    }
+
+    if ( end - p >= 4 && memcmp( p,"null",4 ) == 0 )
+    {
+        operand.kind = IsaOperandKind::NULLREG;
+        p += 4;
+    }
+    else if ( *p == 'r' && p+1 < end && p[1] == '[' )
+    {
+        operand.kind = IsaOperandKind::INDIRECT;
+        const char* close = (const char*)memchr( p,']',(size_t)(end - p) );
+        p = close ? close+1 : end;
+    }
+    else if ( *p == 'r' && p+1 < end && IsDigit( p[1] ) )
+    {
+        operand.kind = IsaOperandKind::GRF;
+        p++;
+        operand.value = ParseDecimal( p,end );
+    }
+    else if ( IsArchitectureRegister( p,end ) )
+    {
+        operand.kind = IsaOperandKind::ARF;
+        while ( p < end && IsAlpha( *p ) )
+            p++;
+        operand.value = ParseDecimal( p,end );
+    }
+    else if ( IsAlpha( *p ) || *p == '_' )
+    {
+        // anything else which looks like a name is a branch target
+        const char* name = p;
+        while ( p < end && IsIdent( *p ) )
+            p++;
+
+        // operands past the third source aren't stored, so there is nothing to resolve
+        operand.kind = IsaOperandKind::LABEL;
+        if ( slot < 3 )
+        {
+            PendingLabel pending;
+            pending.instruction = instruction;
+            pending.operand = slot;
+            pending.name = (uint32_t)(name - m_pText);
+            pending.nameLength = (uint16_t)std::min<size_t>( p - name,UINT16_MAX );
+            m_Pending.push_back( pending );
+        }
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+
+    // sub-register, region and type:  .2<8;8,1>:f
+    if ( p < end && *p == '.' )
+    {
+        p++;
+        operand.subreg = Clamp8( ParseDecimal( p,end ) );
+    }
+    if ( p < end && *p == '<' )
+    {
+        p++;
+        uint32_t a = ParseDecimal( p,end );
+        if ( p < end && *p == ';' )
+        {
+            p++;
+            operand.vstride = Clamp8( a );
+            operand.width = Clamp8( ParseDecimal( p,end ) );
+            if ( p < end && *p == ',' )
+                p++;
+            operand.hstride = Clamp8( ParseDecimal( p,end ) );
+        }
+        else
+        {
+            operand.hstride = Clamp8( a );
+        }
+    }
+    return true;
+}
+
+void IsaProgram::ClassifySend( IsaInstruction& inst, const uint32_t* immediates, size_t nImmediates, const char* comment, const char* end )
+{
+    // send <dst> <src0> [<src1>] <ex_desc> <desc>.  The low bits of the extended descriptor are the shared function id
+    inst.sfid = 0xFF;
+    if ( nImmediates >= 2 )
+    {
+        inst.sfid = (uint8_t)(immediates[0] & 0xF);
+        inst.descriptor = immediates[nImmediates-1];
+    }
+    else if ( nImmediates == 1 )
+    {
+        inst.descriptor = immediates[0];
+    }
+
+    bool writes = inst.dst.kind == IsaOperandKind::NULLREG || inst.dst.kind == IsaOperandKind::NONE;
+
+    switch ( inst.sfid )
+    {
+    case 0x2:   inst.send = IsaSendTarget::SAMPLER;         break;
+    case 0x3:   inst.send = IsaSendTarget::GATEWAY;         break;
+    case 0x4:   inst.send = IsaSendTarget::DATAPORT_READ;   break;      // sampler cache
+    case 0x5:   inst.send = IsaSendTarget::RENDER_TARGET;   break;
+    case 0x6:   inst.send = IsaSendTarget::URB;             break;
+    case 0x7:   inst.send = IsaSendTarget::THREAD_SPAWNER;  break;
+    case 0x9:   inst.send = IsaSendTarget::DATAPORT_READ;   break;      // constant cache
+    case 0xA:
+        // data cache 0.  Bit 18 of the descriptor selects scratch block messages, and bit 17 makes them writes
+        if ( inst.descriptor & (1u << 18) )
+            inst.send = (inst.descriptor & (1u << 17)) ? IsaSendTarget::SCRATCH_WRITE : IsaSendTarget::SCRATCH_READ;
+        else
+            inst.send = writes ? IsaSendTarget::DATAPORT_WRITE : IsaSendTarget::DATAPORT_READ;
+        break;
+    case 0xC:   
+        inst.send = writes ? IsaSendTarget::DATAPORT_WRITE : IsaSendTarget::DATAPORT_READ;
+        break;
+    default:    
+        inst.send = IsaSendTarget::OTHER;
+        break;
+    }
+
+    // the disassembler's comment is more specific, where it has one
+    if ( comment < end )
+    {
+        if ( Contains( comment,end,"spill" ) )
+            inst.send = IsaSendTarget::SCRATCH_WRITE;
+        else if ( Contains( comment,end,"fill" ) )
+            inst.send = IsaSendTarget::SCRATCH_READ;
+        else if ( Contains( comment,end,"scratch" ) )
+            inst.send = writes ? IsaSendTarget::SCRATCH_WRITE : IsaSendTarget::SCRATCH_READ;
+        else if ( inst.send == IsaSendTarget::OTHER && Contains( comment,end,"sampler" ) )
+            inst.send = IsaSendTarget::SAMPLER;
+        else if ( inst.send == IsaSendTarget::OTHER && Contains( comment,end,"urb" ) )
+            inst.send = IsaSendTarget::URB;
+    }
+
+    if ( inst.flags & IsaFlags::EOT )
+        inst.send = (inst.send == IsaSendTarget::OTHER) ? IsaSendTarget::THREAD_SPAWNER : inst.send;
+}
+
+void IsaProgram::ResolveLabels()
+{
+    m_LabelOrder.resize( m_Labels.size() );
+    for ( uint32_t i=0; i<(uint32_t)m_Labels.size(); i++ )
+        m_LabelOrder[i] = i;
+
+    const char* text = m_pText;
+    const std::vector<IsaLabel>& labels = m_Labels;
+    auto less = [text,&labels]( uint32_t a, uint32_t b )
+    {
+        const IsaLabel& la = labels[a];
+        const IsaLabel& lb = labels[b];
+        int c = memcmp( text+la.name,text+lb.name,std::min( la.nameLength,lb.nameLength ) );
+        return c != 0 ? c < 0 : la.nameLength < lb.nameLength;
+    };
+    std::sort( m_LabelOrder.begin(),m_LabelOrder.end(),less );
+
+    for ( const PendingLabel& pending : m_Pending )
+    {
+        IsaInstruction& inst = m_Instructions[pending.instruction];
+        IsaOperand& operand = (pending.operand < 0) ? inst.dst : inst.src[pending.operand];
+
+        // binary search for the name
+        size_t lo = 0, hi = m_LabelOrder.size();
+        bool found = false;
+        while ( lo < hi )
+        {
+            size_t mid = (lo + hi) / 2;
+            const IsaLabel& label = m_Labels[m_LabelOrder[mid]];
+            int c = memcmp( text+pending.name,text+label.name,std::min( pending.nameLength,label.nameLength ) );
+            if ( c == 0 )
+                c = (pending.nameLength < label.nameLength) ? -1 : (pending.nameLength > label.nameLength ? 1 : 0);
+            if ( c == 0 )
+            {
+                operand.value = m_LabelOrder[mid];
+                found = true;
+                break;
+            }
+            if ( c < 0 )
+                hi = mid;
+            else
+                lo = mid+1;
+        }
+
+        if ( !found )
+        {
+            operand.kind = IsaOperandKind::NONE;
+            m_nUnresolved++;
+        }
+    }
+}
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_PARSER_H_
+#define _ISA_PARSER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//
+//  Tokenizes Gen assembly, as returned by pfnGetIsaText, into a compact instruction table.
+//
+//   The parser makes a single pass over the text and does not copy it.  Mnemonics and label names are recorded as offsets 
+//   into the text, so the text must outlive the program.  Re-using an IsaProgram for several shaders avoids re-allocating its tables.
+//
+//   Lines which don't look like instructions or labels are skipped, so that changes in the disassembler's comments
+//   or headers don't break parsing
+//
+
+enum class IsaClass : uint8_t
+{
+    ALU,
+    MATH,
+    SEND,
+    FLOW,       // jumps, branches and structured control flow
+    OTHER,      // nop, wait, sync, and anything we don't recognize
+};
+
+enum class IsaOpcode : uint8_t
+{
+    UNKNOWN,
+
+    // ALU
+    ADD, ADDC, AND, ASR, AVG, BFE, BFI1, BFI2, BFREV, CBIT, CMP, CMPN, CSEL, DP2, DP3, DP4, DPH, F16TO32, F32TO16,
+    FBH, FBL, FRC, LINE, LRP, LZD, MAC, MACH, MAD, MADM, MOV, MOVI, MUL, NOT, OR, PLN, RNDD, RNDE, RNDU, RNDZ, 
+    ROL, ROR, SAD2, SADA2, SEL, SHL, SHR, SMOV, SUBB, XOR, DIM,
+
+    // math
+    MATH,
+
+    // send
+    SEND, SENDC, SENDS, SENDSC,
+
+    // flow control
+    BRC, BRD, BREAK, CALL, CALLA, CONT, ELSE, ENDIF, GOTO, HALT, IF, JMPI, JOIN, RET, WHILE,
+
+    // other
+    ILLEGAL, NOP, SYNC, WAIT,
+
+    COUNT
+};
+
+enum class IsaSendTarget : uint8_t
+{
+    NONE,
+    SAMPLER,
+    DATAPORT_READ,
+    DATAPORT_WRITE,
+    RENDER_TARGET,
+    URB,
+    SCRATCH_READ,       // fill
+    SCRATCH_WRITE,      // spill
+    GATEWAY,
+    THREAD_SPAWNER,
+    OTHER,
+};
+
+enum class IsaOperandKind : uint8_t
+{
+    NONE,
+    GRF,            // general register, r<n>
+    ARF,            // architecture register: acc, f, a, sr, ce, ip, ...
+    INDIRECT,       // r[a0.0,offset]
+    IMMEDIATE,
+    NULLREG,
+    LABEL,
+};
+
+struct IsaOperand
+{
+    IsaOperandKind kind = IsaOperandKind::NONE;
+    uint8_t subreg  = 0;
+    uint8_t vstride = 0;        // region, if one was given
+    uint8_t width   = 0;
+    uint8_t hstride = 0;
+    uint8_t negate  = 0;
+    uint8_t abs     = 0;
+    uint32_t value  = 0;        // register number, label index, or the low bits of an immediate
+};
+
+namespace IsaFlags
+{
+    static const uint8_t PREDICATED  = 1;
+    static const uint8_t PRED_INVERT = 2;
+    static const uint8_t NOMASK      = 4;
+    static const uint8_t EOT         = 8;
+    static const uint8_t COMPACTED   = 16;
+    static const uint8_t SATURATE    = 32;
+}
+
+struct IsaInstruction
+{
+    uint32_t mnemonic       = 0;    // offset of the full mnemonic (e.g. 'math.inv') in the text
+    uint16_t mnemonicLength = 0;
+    IsaOpcode opcode        = IsaOpcode::UNKNOWN;
+    IsaClass cls            = IsaClass::OTHER;
+    IsaSendTarget send      = IsaSendTarget::NONE;
+    uint8_t execSize        = 1;
+    uint8_t flags           = 0;    // IsaFlags
+    uint8_t nSources        = 0;
+    uint32_t line           = 0;    // 1-based line number in the text
+    uint32_t descriptor     = 0;    // message descriptor for sends
+    uint8_t sfid            = 0;    // shared function id for sends
+    IsaOperand dst;
+    IsaOperand src[3];
+};
+
+struct IsaLabel
+{
+    uint32_t name;              // offset in the text
+    uint16_t nameLength;
+    uint32_t instruction;       // index of the first instruction after the label
+};
+
+class IsaProgram
+{
+public:
+    // Returns false if nothing in the text looked like an instruction
+    bool Parse( const char* text, size_t length );
+
+    const char* GetText() const { return m_pText; }
+    size_t GetLength() const { return m_nLength; }
+    const std::vector<IsaInstruction>& GetInstructions() const { return m_Instructions; }
+    const std::vector<IsaLabel>& GetLabels() const { return m_Labels; }
+
+    // Number of label operands which didn't name a label in the program
+    size_t GetUnresolvedLabels() const { return m_nUnresolved; }
+
+    // The execution width used by most instructions, e.g. 8 or 16
+    uint32_t GetSimdWidth() const { return m_nSimdWidth; }
+
+    static const char* GetOpcodeName( IsaOpcode op );
+    static IsaClass GetOpcodeClass( IsaOpcode op );
+
+private:
+    struct PendingLabel
+    {
+        size_t instruction;
+        int operand;            // -1 for dst
+        uint32_t name;
+        uint16_t nameLength;
+    };
+
+    bool ParseLine( const char* line, const char* end, uint32_t lineNumber );
+    bool ParseOperand( const char* token, const char* end, IsaOperand& operand, size_t instruction, int slot );
+    void ClassifySend( IsaInstruction& inst, const uint32_t* immediates, size_t nImmediates, const char* comment, const char* end );
+    void ResolveLabels();
+
+    const char* m_pText = nullptr;
+    size_t m_nLength = 0;
+    std::vector<IsaInstruction> m_Instructions;
+    std::vector<IsaLabel> m_Labels;
+    std::vector<PendingLabel> m_Pending;
+    std::vector<uint32_t> m_LabelOrder;     // label indices sorted by name, for resolving
+    size_t m_nUnresolved = 0;
+    uint32_t m_nSimdWidth = 0;
+};
+
+#endif
@@ -0,0 +1,725 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IsaReport.h"
+#include "InputBuffer.h"
+#include "IsaArchive.h"
+#include "IsaBinary.h"
+#include "IsaCFG.h"
+#include "IsaParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+const std::vector<IsaReportMetric>& GetReportMetrics()
+{
+    static const std::vector<IsaReportMetric> metrics =
+    {
+        { "instructions",   []( const IsaStats& s ) -> uint64_t { return s.instructions; } },
+        { "sends",          []( const IsaStats& s ) -> uint64_t { return s.send; } },
+        { "sampler",        []( const IsaStats& s ) -> uint64_t { return s.sampler; } },
+        { "spills",         []( const IsaStats& s ) -> uint64_t { return s.scratch_write; } },
+        { "fills",          []( const IsaStats& s ) -> uint64_t { return s.scratch_read; } },
+        { "flow_control",   []( const IsaStats& s ) -> uint64_t { return s.flow_control; } },
+        { "basic_blocks",   []( const IsaStats& s ) -> uint64_t { return s.basic_blocks; } },
+        { "loops",          []( const IsaStats& s ) -> uint64_t { return s.loops; } },
+        { "isa_bytes",      []( const IsaStats& s ) -> uint64_t { return s.isa_bytes; } },
+    };
+    return metrics;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Aggregation
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool IsaTopList::Before( const Entry& a, const Entry& b )
+{
+    return (a.value != b.value) ? a.value > b.value : a.shader < b.shader;
+}
+
+void IsaTopList::Add( int64_t value, const std::string& shader )
+{
+    if ( value <= 0 || m_nCapacity == 0 )
+        return;
+
+    // most results don't make the list, so check before copying the name
+    if ( m_Heap.size() == m_nCapacity )
+    {
+        const Entry& last = m_Heap.front();
+        if ( value < last.value || (value == last.value && shader >= last.shader) )
+            return;
+        std::pop_heap( m_Heap.begin(),m_Heap.end(),Before );
+        m_Heap.back() = Entry{ value,shader };
+    }
+    else
+    {
+        m_Heap.push_back( Entry{ value,shader } );
+    }
+    std::push_heap( m_Heap.begin(),m_Heap.end(),Before );
+}
+
+std::vector<IsaTopList::Entry> IsaTopList::GetSorted() const
+{
+    std::vector<Entry> sorted = m_Heap;
+    std::sort( sorted.begin(),sorted.end(),Before );
+    return sorted;
+}
+
+static size_t GetBucket( uint64_t value )
+{
+    size_t bucket = 0;
+    while ( value )
+    {
+        bucket++;
+        value >>= 1;
+    }
+    return bucket;
+}
+
+static std::string GetBucketName( size_t bucket )
+{
+    if ( bucket <= 1 )
+        return std::to_string( bucket );
+    uint64_t lo = 1ull << (bucket-1);
+    uint64_t hi = lo + (lo-1);
+    return std::to_string( lo ) + "-" + std::to_string( hi );
+}
+
+IsaReport::IsaReport( size_t topCount, const std::vector<size_t>& metrics, const std::vector<std::string>& compare ) :
+    m_nTop( topCount ), m_Metrics( metrics ), m_Compare( compare )
+{
+}
+
+IsaReport::Group& IsaReport::GetGroup( const std::string& api, const std::string& platform )
+{
+    auto it = m_Groups.find( std::make_pair( api,platform ) );
+    if ( it != m_Groups.end() )
+        return it->second;
+
+    Group& group = m_Groups[std::make_pair( api,platform )];
+    group.metrics.resize( m_Metrics.size() );
+    for ( MetricSummary& metric : group.metrics )
+        metric.top = IsaTopList( m_nTop );
+    return group;
+}
+
+void IsaReport::Add( const std::string& shader, const std::string& api, const std::string& platform, const IsaStats& stats )
+{
+    m_nResults++;
+
+    Group& group = GetGroup( api,platform );
+    group.results++;
+    for ( size_t i=0; i<m_Metrics.size(); i++ )
+    {
+        uint64_t value = GetReportMetrics()[m_Metrics[i]].get( stats );
+        MetricSummary& metric = group.metrics[i];
+        metric.nonzero += value ? 1 : 0;
+        metric.total += value;
+        metric.max = std::max( metric.max,value );
+        metric.histogram[GetBucket( value )]++;
+        metric.top.Add( (int64_t)value,shader );
+    }
+
+    if ( m_Compare.empty() )
+        return;
+
+    m_Shader = shader;
+    if ( api == m_Compare[0] )
+        m_Old[platform] = stats;
+    else if ( api == m_Compare[1] )
+        m_New[platform] = stats;
+}
+
+void IsaReport::EndShader()
+{
+    for ( const auto& old : m_Old )
+    {
+        auto it = m_New.find( old.first );
+        if ( it == m_New.end() )
+            continue;
+
+        Comparison& comparison = m_Comparisons[old.first];
+        if ( comparison.growth.empty() )
+        {
+            comparison.grew.resize( m_Metrics.size() );
+            comparison.shrank.resize( m_Metrics.size() );
+            comparison.growth.resize( m_Metrics.size(),IsaTopList( m_nTop ) );
+        }
+
+        comparison.pairs++;
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const IsaReportMetric& metric = GetReportMetrics()[m_Metrics[i]];
+            int64_t growth = (int64_t)metric.get( it->second ) - (int64_t)metric.get( old.second );
+            comparison.grew[i] += (growth > 0) ? 1 : 0;
+            comparison.shrank[i] += (growth < 0) ? 1 : 0;
+            comparison.growth[i].Add( growth,m_Shader );
+        }
+    }
+    m_Old.clear();
+    m_New.clear();
+}
+
+void IsaReport::Print() const
+{
+    for ( const auto& it : m_Groups )
+    {
+        const Group& group = it.second;
+        printf( "%s %s:  %llu results\n",it.first.first.c_str(),it.first.second.c_str(),(unsigned long long)group.results );
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const MetricSummary& metric = group.metrics[i];
+            printf( "    %-14s max %llu, mean %.1f, nonzero in %llu",GetReportMetrics()[m_Metrics[i]].name,(unsigned long long)metric.max,
+                    (double)metric.total / group.results,(unsigned long long)metric.nonzero );
+            std::vector<IsaTopList::Entry> top = metric.top.GetSorted();
+            if ( !top.empty() )
+                printf( ", worst %s",top[0].shader.c_str() );
+            printf( "\n" );
+        }
+    }
+
+    for ( const auto& it : m_Comparisons )
+    {
+        const Comparison& comparison = it.second;
+        printf( "%s -> %s on %s:  %llu shaders\n",m_Compare[0].c_str(),m_Compare[1].c_str(),it.first.c_str(),
+                (unsigned long long)comparison.pairs );
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            printf( "    %-14s grew in %llu, shrank in %llu",GetReportMetrics()[m_Metrics[i]].name,(unsigned long long)comparison.grew[i],
+                    (unsigned long long)comparison.shrank[i] );
+            std::vector<IsaTopList::Entry> top = comparison.growth[i].GetSorted();
+            if ( !top.empty() )
+                printf( ", worst %s (+%lld)",top[0].shader.c_str(),(long long)top[0].value );
+            printf( "\n" );
+        }
+    }
+}
+
+bool IsaReport::WriteCsv( const char* path ) const
+{
+    FILE* fp = fopen( path,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open CSV file: %s\n",path );
+        return false;
+    }
+
+    // one table, so that it can be filtered by its first four columns
+    fprintf( fp,"table,api,platform,metric,rank,key,value\n" );
+    for ( const auto& it : m_Groups )
+    {
+        const Group& group = it.second;
+        const char* api = it.first.first.c_str();
+        const char* platform = it.first.second.c_str();
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const MetricSummary& metric = group.metrics[i];
+            const char* name = GetReportMetrics()[m_Metrics[i]].name;
+            fprintf( fp,"summary,%s,%s,%s,,results,%llu\n",api,platform,name,(unsigned long long)group.results );
+            fprintf( fp,"summary,%s,%s,%s,,nonzero,%llu\n",api,platform,name,(unsigned long long)metric.nonzero );
+            fprintf( fp,"summary,%s,%s,%s,,total,%llu\n",api,platform,name,(unsigned long long)metric.total );
+            fprintf( fp,"summary,%s,%s,%s,,max,%llu\n",api,platform,name,(unsigned long long)metric.max );
+            fprintf( fp,"summary,%s,%s,%s,,mean,%.3f\n",api,platform,name,(double)metric.total / group.results );
+
+            std::vector<IsaTopList::Entry> top = metric.top.GetSorted();
+            for ( size_t rank=0; rank<top.size(); rank++ )
+            {
+                fprintf( fp,"top,%s,%s,%s,%zu,",api,platform,name,rank+1 );
+                WriteCsvString( fp,top[rank].shader );
+                fprintf( fp,",%lld\n",(long long)top[rank].value );
+            }
+
+            for ( size_t b=0; b<=GetBucket( metric.max ); b++ )
+                fprintf( fp,"histogram,%s,%s,%s,%zu,%s,%llu\n",api,platform,name,b,GetBucketName( b ).c_str(),
+                         (unsigned long long)metric.histogram[b] );
+        }
+    }
+
+    for ( const auto& it : m_Comparisons )
+    {
+        std::string apis = m_Compare[0] + ">" + m_Compare[1];
+        const Comparison& comparison = it.second;
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const char* name = GetReportMetrics()[m_Metrics[i]].name;
+            std::vector<IsaTopList::Entry> top = comparison.growth[i].GetSorted();
+            for ( size_t rank=0; rank<top.size(); rank++ )
+            {
+                fprintf( fp,"growth,%s,%s,%s,%zu,",apis.c_str(),it.first.c_str(),name,rank+1 );
+                WriteCsvString( fp,top[rank].shader );
+                fprintf( fp,",%lld\n",(long long)top[rank].value );
+            }
+        }
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write CSV file: %s\n",path );
+    return succeeded;
+}
+
+static void WriteHtmlString( FILE* fp, const std::string& str )
+{
+    for ( char c : str )
+    {
+        switch ( c )
+        {
+        case '&':   fputs( "&amp;",fp );    break;
+        case '<':   fputs( "&lt;",fp );     break;
+        case '>':   fputs( "&gt;",fp );     break;
+        case '"':   fputs( "&quot;",fp );   break;
+        default:    fputc( c,fp );          break;
+        }
+    }
+}
+
+static void WriteHtmlTopList( FILE* fp, const char* heading, const std::vector<IsaTopList::Entry>& top, bool growth )
+{
+    if ( top.empty() )
+        return;
+
+    fprintf( fp,"<h3>%s</h3>\n<table>\n<tr><th>#</th><th>shader</th><th>%s</th></tr>\n",heading,growth ? "growth" : "value" );
+    for ( size_t rank=0; rank<top.size(); rank++ )
+    {
+        fprintf( fp,"<tr><td>%zu</td><td>",rank+1 );
+        WriteHtmlString( fp,top[rank].shader );
+        fprintf( fp,"</td><td>%s%lld</td></tr>\n",growth ? "+" : "",(long long)top[rank].value );
+    }
+    fprintf( fp,"</table>\n" );
+}
+
+bool IsaReport::WriteHtml( const char* path ) const
+{
+    FILE* fp = fopen( path,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open HTML file: %s\n",path );
+        return false;
+    }
+
+    fprintf( fp,"<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>ISA report</title>\n<style>\n" );
+    fprintf( fp,"body { font-family: sans-serif; } table { border-collapse: collapse; margin-bottom: 1em; }\n" );
+    fprintf( fp,"td, th { border: 1px solid #ccc; padding: 2px 8px; text-align: right; } td:nth-child(2) { text-align: left; }\n" );
+    fprintf( fp,".bar { background: #48c; height: 10px; }\n</style>\n</head>\n<body>\n" );
+    fprintf( fp,"<h1>ISA report</h1>\n<p>%llu results</p>\n",(unsigned long long)m_nResults );
+
+    for ( const auto& it : m_Groups )
+    {
+        const Group& group = it.second;
+        fprintf( fp,"<h2>" );
+        WriteHtmlString( fp,it.first.first + " " + it.first.second );
+        fprintf( fp,"</h2>\n<p>%llu results</p>\n",(unsigned long long)group.results );
+
+        fprintf( fp,"<table>\n<tr><th>metric</th><th>nonzero</th><th>mean</th><th>max</th><th>total</th></tr>\n" );
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const MetricSummary& metric = group.metrics[i];
+            fprintf( fp,"<tr><td>%s</td><td>%llu</td><td>%.1f</td><td>%llu</td><td>%llu</td></tr>\n",GetReportMetrics()[m_Metrics[i]].name,
+                     (unsigned long long)metric.nonzero,(double)metric.total / group.results,(unsigned long long)metric.max,
+                     (unsigned long long)metric.total );
+        }
+        fprintf( fp,"</table>\n" );
+
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+        {
+            const MetricSummary& metric = group.metrics[i];
+            const char* name = GetReportMetrics()[m_Metrics[i]].name;
+            WriteHtmlTopList( fp,(std::string( "Top " ) + name).c_str(),metric.top.GetSorted(),false );
+
+            // bars are scaled to the fullest bucket
+            uint64_t fullest = 1;
+            size_t nBuckets = GetBucket( metric.max ) + 1;
+            for ( size_t b=0; b<nBuckets; b++ )
+                fullest = std::max( fullest,metric.histogram[b] );
+
+            fprintf( fp,"<table>\n<tr><th>%s</th><th>results</th><th></th></tr>\n",name );
+            for ( size_t b=0; b<nBuckets; b++ )
+                fprintf( fp,"<tr><td>%s</td><td>%llu</td><td style=\"width: 200px\"><div class=\"bar\" style=\"width: %.0f%%\"></div></td></tr>\n",
+                         GetBucketName( b ).c_str(),(unsigned long long)metric.histogram[b],100.0 * metric.histogram[b] / fullest );
+            fprintf( fp,"</table>\n" );
+        }
+    }
+
+    for ( const auto& it : m_Comparisons )
+    {
+        const Comparison& comparison = it.second;
+        fprintf( fp,"<h2>" );
+        WriteHtmlString( fp,m_Compare[0] + " to " + m_Compare[1] + " on " + it.first );
+        fprintf( fp,"</h2>\n<p>%llu shaders</p>\n",(unsigned long long)comparison.pairs );
+
+        fprintf( fp,"<table>\n<tr><th>metric</th><th>grew</th><th>shrank</th></tr>\n" );
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+            fprintf( fp,"<tr><td>%s</td><td>%llu</td><td>%llu</td></tr>\n",GetReportMetrics()[m_Metrics[i]].name,
+                     (unsigned long long)comparison.grew[i],(unsigned long long)comparison.shrank[i] );
+        fprintf( fp,"</table>\n" );
+
+        for ( size_t i=0; i<m_Metrics.size(); i++ )
+            WriteHtmlTopList( fp,(std::string( "Largest growth in " ) + GetReportMetrics()[m_Metrics[i]].name).c_str(),
+                              comparison.growth[i].GetSorted(),true );
+    }
+
+    fprintf( fp,"</body>\n</html>\n" );
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write HTML file: %s\n",path );
+    return succeeded;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  report subcommand
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct ReportResult
+{
+    std::string shader;
+    std::string api;
+    std::string platform;
+    std::string label;          // for messages
+    std::vector<char> data;
+    bool binary = false;
+};
+
+// Produces results in order of shader name, so that all of a shader's results can be compared before moving on
+class ReportSource
+{
+public:
+    virtual ~ReportSource() {}
+
+    // Returns false at the end.  Results which can't be read are reported, and skipped
+    virtual bool Next( ReportResult& result, size_t& nFailed ) = 0;
+};
+
+// Archives are indexed by shader id, API and platform, so reading the index in order gives each shader's results together
+class ArchiveSource : public ReportSource
+{
+public:
+    bool Open( const char* path ) { m_Path = path; return m_Reader.Open( path ); }
+
+    bool Next( ReportResult& result, size_t& nFailed ) override
+    {
+        while ( m_nNext < m_Reader.GetEntryCount() )
+        {
+            ArchiveEntry entry = m_Reader.GetEntry( m_nNext++ );
+            result.shader = entry.id;
+            result.api = entry.api;
+            result.platform = entry.platform;
+            result.label = m_Path + ": " + entry.id + " " + entry.api + " " + entry.platform;
+            result.binary = (entry.format == IsaArchiveFormat::BINARY);
+            if ( m_Reader.Read( m_nNext-1,result.data ) )
+                return true;
+
+            printf( "Failed to read %s\n",result.label.c_str() );
+            nFailed++;
+        }
+        return false;
+    }
+
+private:
+    std::string m_Path;
+    IsaArchiveReader m_Reader;
+    size_t m_nNext = 0;
+};
+
+// .asm files are named <prefix><platform>.asm, and the prefix is taken to be the shader's name.  The API isn't recorded, so
+//  it comes from the command line.  Only the file names are kept, sorted by shader
+class FileSource : public ReportSource
+{
+public:
+    FileSource( const std::string& api ) : m_Api( api ) {}
+
+    bool List( const char* path )
+    {
+        std::error_code ec;
+        if ( !fs::is_directory( path,ec ) )
+        {
+            AddFile( fs::path( path ).filename().generic_string(),path );
+        }
+        else
+        {
+            for ( fs::recursive_directory_iterator it( path,ec ), end; !ec && it != end; it.increment( ec ) )
+            {
+                if ( it->is_regular_file() && it->path().extension() == ".asm" )
+                    AddFile( it->path().lexically_relative( path ).generic_string(),it->path().string() );
+            }
+            if ( ec )
+            {
+                printf( "Failed to read directory: %s\n",path );
+                return false;
+            }
+        }
+
+        std::sort( m_Files.begin(),m_Files.end(), []( const File& a, const File& b )
+        {
+            return (a.shader != b.shader) ? a.shader < b.shader : a.platform < b.platform;
+        } );
+        return true;
+    }
+
+    bool Next( ReportResult& result, size_t& nFailed ) override
+    {
+        while ( m_nNext < m_Files.size() )
+        {
+            const File& file = m_Files[m_nNext++];
+            result.shader = file.shader;
+            result.api = m_Api;
+            result.platform = file.platform;
+            result.label = file.path;
+            result.binary = false;
+
+            InputBuffer text;
+            if ( text.Load( file.path.c_str() ) )
+            {
+                result.data.assign( (const char*)text.data(),(const char*)text.data() + text.size() );
+                return true;
+            }
+
+            printf( "Failed to read ISA from: %s\n",file.path.c_str() );
+            nFailed++;
+        }
+        return false;
+    }
+
+private:
+    struct File
+    {
+        std::string shader;
+        std::string platform;
+        std::string path;
+    };
+
+    void AddFile( const std::string& name, const std::string& path )
+    {
+        std::string stem = name.substr( 0,name.size() - fs::path( name ).extension().string().size() );
+        size_t split = stem.rfind( '_' );
+        if ( split == std::string::npos || stem.find( '/',split ) != std::string::npos )
+            m_Files.push_back( File{ stem,"-",path } );
+        else
+            m_Files.push_back( File{ stem.substr( 0,split ),stem.substr( split+1 ),path } );
+    }
+
+    std::string m_Api;
+    std::vector<File> m_Files;
+    size_t m_nNext = 0;
+};
+
+bool AnalyzeResult( const ReportResult& result, IsaStats& stats )
+{
+    // kept between results, to re-use their tables
+    static IsaProgram program;
+    static IsaCFG cfg;
+    static IsaBinary binary;
+
+    if ( result.binary )
+    {
+        if ( !binary.Decode( result.data.data(),result.data.size() ) )
+        {
+            printf( "Invalid ISA binary in %s: %s\n",result.label.c_str(),binary.GetError().c_str() );
+            return false;
+        }
+        ComputeIsaStats( binary,stats );
+        return true;
+    }
+
+    if ( !program.Parse( result.data.data(),result.data.size() ) )
+    {
+        printf( "No instructions found in: %s\n",result.label.c_str() );
+        return false;
+    }
+    cfg.Build( program );
+    ComputeIsaStats( program,stats );
+    stats.basic_blocks = (uint32_t)cfg.GetBlocks().size();
+    stats.loops = cfg.GetLoopCount();
+    stats.max_loop_depth = cfg.GetMaxLoopDepth();
+    return true;
+}
+
+void ShowReportHelp()
+{
+    printf( "To summarize ISA use:  report <input>... [--api <name>] [--top <count>] [--metric <name>]... [--compare <old api> <new api>]\n" );
+    printf( "                              [--csv <file>] [--html <file>]\n" );
+    printf( "  inputs are ISA archives, .asm files, or directories of them.  --api names the API of the .asm files which follow it\n" );
+    printf( "  metrics are:" );
+    for ( const IsaReportMetric& metric : GetReportMetrics() )
+        printf( " %s",metric.name );
+    printf( "\n" );
+}
+
+}
+
+int ReportCommand( int argc, char* argv[] )
+{
+    std::vector< std::unique_ptr<ReportSource> > sources;
+    std::vector<size_t> metrics;
+    std::vector<std::string> compare;
+    std::string api = "-";
+    size_t topCount = 100;
+    const char* csv_file = nullptr;
+    const char* html_file = nullptr;
+
+    for ( int i=1; i<argc; i++ )
+    {
+        int nArgs = (strcmp( argv[i],"--compare" ) == 0) ? 2 :
+                    (strcmp( argv[i],"--api" ) == 0 || strcmp( argv[i],"--top" ) == 0 || strcmp( argv[i],"--metric" ) == 0 ||
+                     strcmp( argv[i],"--csv" ) == 0 || strcmp( argv[i],"--html" ) == 0) ? 1 : 0;
+        if ( i + nArgs >= argc )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return 1;
+        }
+
+        if ( strcmp( argv[i],"--api" ) == 0 )
+        {
+            api = argv[++i];
+        }
+        else if ( strcmp( argv[i],"--top" ) == 0 )
+        {
+            topCount = strtoul( argv[++i],nullptr,0 );
+        }
+        else if ( strcmp( argv[i],"--metric" ) == 0 )
+        {
+            const std::vector<IsaReportMetric>& all = GetReportMetrics();
+            size_t m = 0;
+            while ( m < all.size() && strcmp( all[m].name,argv[i+1] ) != 0 )
+                m++;
+            if ( m == all.size() )
+            {
+                printf( "Unknown metric: %s\n",argv[i+1] );
+                ShowReportHelp();
+                return 1;
+            }
+            metrics.push_back( m );
+            i++;
+        }
+        else if ( strcmp( argv[i],"--compare" ) == 0 )
+        {
+            compare = { argv[i+1],argv[i+2] };
+            i += 2;
+        }
+        else if ( strcmp( argv[i],"--csv" ) == 0 )
+        {
+            csv_file = argv[++i];
+        }
+        else if ( strcmp( argv[i],"--html" ) == 0 )
+        {
+            html_file = argv[++i];
+        }
+        else if ( argv[i][0] == '-' )
+        {
+            printf( "Don't understand what: '%s' means\n",argv[i] );
+            ShowReportHelp();
+            return 1;
+        }
+        else
+        {
+            // archives are recognized by their magic, whatever they are called
+            char magic[sizeof( IsaArchiveFormat::MAGIC )] = {};
+            FILE* fp = fopen( argv[i],"rb" );
+            bool archive = fp && fread( magic,1,sizeof( magic ),fp ) == sizeof( magic ) &&
+                           memcmp( magic,IsaArchiveFormat::MAGIC,sizeof( magic ) ) == 0;
+            if ( fp )
+                fclose( fp );
+
+            if ( archive )
+            {
+                std::unique_ptr<ArchiveSource> source( new ArchiveSource() );
+                if ( !source->Open( argv[i] ) )
+                    return 1;
+                sources.push_back( std::move( source ) );
+            }
+            else
+            {
+                std::unique_ptr<FileSource> source( new FileSource( api ) );
+                if ( !source->List( argv[i] ) )
+                    return 1;
+                sources.push_back( std::move( source ) );
+            }
+        }
+    }
+
+    if ( sources.empty() )
+    {
+        ShowReportHelp();
+        return 1;
+    }
+
+    if ( metrics.empty() )
+    {
+        for ( size_t m=0; m<GetReportMetrics().size(); m++ )
+            metrics.push_back( m );
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    IsaReport report( topCount,metrics,compare );
+    size_t nFailed = 0;
+
+    // one result is held for each source.  The sources are merged by shader name, so that each shader's results from every
+    //  source are added together
+    std::vector<ReportResult> pending( sources.size() );
+    std::vector<bool> hasPending( sources.size() );
+    for ( size_t s=0; s<sources.size(); s++ )
+        hasPending[s] = sources[s]->Next( pending[s],nFailed );
+
+    for ( ;; )
+    {
+        const std::string* shader = nullptr;
+        for ( size_t s=0; s<sources.size(); s++ )
+        {
+            if ( hasPending[s] && (!shader || pending[s].shader < *shader) )
+                shader = &pending[s].shader;
+        }
+        if ( !shader )
+            break;
+
+        std::string current = *shader;
+        for ( size_t s=0; s<sources.size(); s++ )
+        {
+            while ( hasPending[s] && pending[s].shader == current )
+            {
+                IsaStats stats;
+                if ( AnalyzeResult( pending[s],stats ) )
+                    report.Add( current,pending[s].api,pending[s].platform,stats );
+                else
+                    nFailed++;
+                hasPending[s] = sources[s]->Next( pending[s],nFailed );
+            }
+        }
+        report.EndShader();
+    }
+
+    report.Print();
+
+    bool succeeded = nFailed == 0;
+    if ( csv_file && !report.WriteCsv( csv_file ) )
+        succeeded = false;
+    if ( html_file && !report.WriteHtml( html_file ) )
+        succeeded = false;
+
+    double seconds = std::chrono::duration<double>( std::chrono::high_resolution_clock::now() - start ).count();
+    printf( "Report: %zu results, %zu failed in %.2fs\n",(size_t)report.GetResultCount(),nFailed,seconds );
+    return succeeded ? 0 : 1;
+}
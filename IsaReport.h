@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_REPORT_H_
+#define _ISA_REPORT_H_
+
+#include "IsaStats.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+//
+//  Corpus-wide summaries of compiled results, for finding the worst shaders in a sweep.  Results are added one at a time and
+//   never kept:  each (API, platform) group has a running total, a histogram and a top-K list for each metric, so memory
+//   depends on the number of groups and K, not on the number of results.
+//
+//  Histogram buckets are powers of two:  bucket 0 counts zeros, and bucket b counts values in [2^(b-1), 2^b).  Top lists are
+//   ordered by value, then by shader name, so they don't depend on the order results arrive in.  Zeros are never listed, so
+//   a list of the shaders which spill only holds shaders which do.
+//
+//  Comparing two APIs reports, for each platform, the shaders whose metrics grew the most from the first to the second.
+//   That needs both results for a shader at once, so results must be added grouped by shader.  See ReportCommand
+//
+
+struct IsaReportMetric
+{
+    const char* name;
+    uint64_t (*get)( const IsaStats& stats );
+};
+
+// Every metric a report can rank by
+const std::vector<IsaReportMetric>& GetReportMetrics();
+
+// The K largest values seen, by value and then name
+class IsaTopList
+{
+public:
+    struct Entry
+    {
+        int64_t value;
+        std::string shader;
+    };
+
+    explicit IsaTopList( size_t capacity = 0 ) : m_nCapacity( capacity ) {}
+
+    void Add( int64_t value, const std::string& shader );
+
+    // Sorted, largest first
+    std::vector<Entry> GetSorted() const;
+
+private:
+    static bool Before( const Entry& a, const Entry& b );
+
+    size_t m_nCapacity;
+    std::vector<Entry> m_Heap;      // the smallest kept entry is at the front
+};
+
+class IsaReport
+{
+public:
+    static const size_t HISTOGRAM_BUCKETS = 65;
+
+    // 'metrics' are indices into GetReportMetrics().  If 'compare' is not empty, it holds the old and new API to compare
+    IsaReport( size_t topCount, const std::vector<size_t>& metrics, const std::vector<std::string>& compare );
+
+    void Add( const std::string& shader, const std::string& api, const std::string& platform, const IsaStats& stats );
+
+    // Called after all of a shader's results have been added, to compare them
+    void EndShader();
+
+    void Print() const;
+    bool WriteCsv( const char* path ) const;
+    bool WriteHtml( const char* path ) const;
+
+    size_t GetResultCount() const { return m_nResults; }
+
+private:
+    struct MetricSummary
+    {
+        uint64_t nonzero = 0;       // results with a value other than 0
+        uint64_t total = 0;
+        uint64_t max = 0;
+        uint64_t histogram[HISTOGRAM_BUCKETS] = {};
+        IsaTopList top;
+    };
+
+    struct Group
+    {
+        uint64_t results = 0;
+        std::vector<MetricSummary> metrics;
+    };
+
+    // the growth of each metric for a platform, from the old API to the new
+    struct Comparison
+    {
+        uint64_t pairs = 0;
+        std::vector<uint64_t> grew;     // shaders, for each metric
+        std::vector<uint64_t> shrank;
+        std::vector<IsaTopList> growth;
+    };
+
+    Group& GetGroup( const std::string& api, const std::string& platform );
+
+    size_t m_nTop;
+    std::vector<size_t> m_Metrics;
+    std::vector<std::string> m_Compare;
+    uint64_t m_nResults = 0;
+    std::map< std::pair<std::string,std::string>,Group > m_Groups;
+    std::map< std::string,Comparison > m_Comparisons;
+
+    // the current shader's results for the compared APIs, by platform
+    std::string m_Shader;
+    std::map< std::string,IsaStats > m_Old;
+    std::map< std::string,IsaStats > m_New;
+};
+
+// The 'report' subcommand, which summarizes archives and directories of ISA
+int ReportCommand( int argc, char* argv[] );
+
+#endif
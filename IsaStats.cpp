@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IsaStats.h"
+#include "IsaParser.h"
+#include "IsaBinary.h"
+#include "Portability.h"
+
+#include <cstdio>
+
+void ComputeIsaStats( const IsaProgram& program, IsaStats& stats )
+{
+    stats = IsaStats();
+    stats.simd_width = program.GetSimdWidth();
+
+    for ( const IsaInstruction& inst : program.GetInstructions() )
+    {
+        stats.instructions++;
+        switch ( inst.cls )
+        {
+        case IsaClass::ALU:     stats.alu++;            break;
+        case IsaClass::MATH:    stats.math++;           break;
+        case IsaClass::SEND:    stats.send++;           break;
+        case IsaClass::FLOW:    stats.flow_control++;   break;
+        case IsaClass::OTHER:   stats.other++;          break;
+        }
+
+        switch ( inst.send )
+        {
+        case IsaSendTarget::NONE:                                   break;
+        case IsaSendTarget::SAMPLER:        stats.sampler++;        break;
+        case IsaSendTarget::DATAPORT_READ:  stats.dataport_read++;  break;
+        case IsaSendTarget::DATAPORT_WRITE: stats.dataport_write++; break;
+        case IsaSendTarget::RENDER_TARGET:  stats.render_target++;  break;
+        case IsaSendTarget::URB:            stats.urb++;            break;
+        case IsaSendTarget::SCRATCH_READ:   stats.scratch_read++;   break;
+        case IsaSendTarget::SCRATCH_WRITE:  stats.scratch_write++;  break;
+        default:                            stats.other_send++;     break;
+        }
+    }
+}
+
+void ComputeIsaStats( const IsaBinary& binary, IsaStats& stats )
+{
+    stats = IsaStats();
+    stats.simd_width = binary.GetSimdWidth();
+
+    for ( const IsaBinaryInstruction& inst : binary.GetInstructions() )
+    {
+        stats.instructions++;
+        switch ( IsaProgram::GetOpcodeClass( inst.opcode ) )
+        {
+        case IsaClass::ALU:     stats.alu++;            break;
+        case IsaClass::MATH:    stats.math++;           break;
+        case IsaClass::SEND:    stats.send++;           break;
+        case IsaClass::FLOW:    stats.flow_control++;   break;
+        case IsaClass::OTHER:   stats.other++;          break;
+        }
+    }
+
+    ComputeEncodingStats( binary,stats );
+}
+
+void ComputeEncodingStats( const IsaBinary& binary, IsaStats& stats )
+{
+    stats.isa_bytes = binary.GetEncodedSize();
+    stats.compacted = binary.GetCompactedCount();
+    stats.full = (uint32_t)binary.GetInstructions().size() - stats.compacted;
+}
+
+bool ParseStatsFormat( const char* name, StatsFormat& format )
+{
+    if ( _stricmp( name,"json" ) == 0 )
+        format = StatsFormat::JSON;
+    else if ( _stricmp( name,"csv" ) == 0 )
+        format = StatsFormat::CSV;
+    else
+        return false;
+    return true;
+}
+
+void IsaStatsReport::Add( const char* shader, const char* api, const char* platform, const IsaStats& stats )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_Records.push_back( Record{ shader,api,platform,stats } );
+}
+
+// the same columns, in the same order, for both formats
+#define STATS_FIELDS( X ) \
+    X( simd_width )      \
+    X( instructions )    \
+    X( alu )             \
+    X( math )            \
+    X( send )            \
+    X( flow_control )    \
+    X( other )           \
+    X( sampler )         \
+    X( dataport_read )   \
+    X( dataport_write )  \
+    X( render_target )   \
+    X( urb )             \
+    X( scratch_read )    \
+    X( scratch_write )   \
+    X( other_send )      \
+    X( basic_blocks )    \
+    X( loops )           \
+    X( max_loop_depth )  \
+    X( est_cycles )      \
+    X( isa_bytes )       \
+    X( compacted )       \
+    X( full )
+
+// share of the encoded instructions which use the 8-byte form
+static double CompactedFraction( const IsaStats& stats )
+{
+    uint32_t encoded = stats.compacted + stats.full;
+    return encoded ? (double)stats.compacted / encoded : 0.0;
+}
+
+void WriteJsonString( FILE* fp, const std::string& str )
+{
+    fputc( '"',fp );
+    for ( char c : str )
+    {
+        if ( c == '"' || c == '\\' )
+            fprintf( fp,"\\%c",c );
+        else if ( (unsigned char)c < 0x20 )
+            fprintf( fp,"\\u%04x",c );
+        else
+            fputc( c,fp );
+    }
+    fputc( '"',fp );
+}
+
+void WriteCsvString( FILE* fp, const std::string& str )
+{
+    if ( str.find_first_of( ",\"\n" ) == std::string::npos )
+    {
+        fputs( str.c_str(),fp );
+        return;
+    }
+
+    fputc( '"',fp );
+    for ( char c : str )
+    {
+        if ( c == '"' )
+            fputc( '"',fp );
+        fputc( c,fp );
+    }
+    fputc( '"',fp );
+}
+
+bool IsaStatsReport::Write( StatsFormat format, const char* path )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+
+    FILE* fp = stdout;
+    if ( path )
+    {
+        fp = fopen( path,"w" );
+        if ( !fp )
+        {
+            printf( "Failed to open stats file: %s\n",path );
+            return false;
+        }
+    }
+
+    if ( format == StatsFormat::JSON )
+    {
+        fprintf( fp,"[\n" );
+        for ( size_t i=0; i<m_Records.size(); i++ )
+        {
+            const Record& r = m_Records[i];
+            fprintf( fp,"  { \"shader\": " );
+            WriteJsonString( fp,r.shader );
+            fprintf( fp,", \"api\": \"%s\", \"asic\": \"%s\"",r.api.c_str(),r.platform.c_str() );
+#define X( name ) fprintf( fp,", \"" #name "\": %llu",(unsigned long long)r.stats.name );
+            STATS_FIELDS( X )
+#undef X
+            fprintf( fp,", \"compacted_fraction\": %.3f",CompactedFraction( r.stats ) );
+            fprintf( fp," }%s\n",(i+1 < m_Records.size()) ? "," : "" );
+        }
+        fprintf( fp,"]\n" );
+    }
+    else
+    {
+        fprintf( fp,"shader,api,asic" );
+#define X( name ) fprintf( fp,"," #name );
+        STATS_FIELDS( X )
+#undef X
+        fprintf( fp,",compacted_fraction\n" );
+
+        for ( const Record& r : m_Records )
+        {
+            WriteCsvString( fp,r.shader );
+            fprintf( fp,",%s,%s",r.api.c_str(),r.platform.c_str() );
+#define X( name ) fprintf( fp,",%llu",(unsigned long long)r.stats.name );
+            STATS_FIELDS( X )
+#undef X
+            fprintf( fp,",%.3f\n",CompactedFraction( r.stats ) );
+        }
+    }
+
+    bool succeeded = !ferror( fp );
+    if ( path )
+        succeeded = (fclose( fp ) == 0) && succeeded;
+    else
+        fflush( fp );
+
+    if ( !succeeded )
+        printf( "Failed to write stats\n" );
+    return succeeded;
+}
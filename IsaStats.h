@@ -0,0 +1,105 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ISA_STATS_H_
+#define _ISA_STATS_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class IsaProgram;
+class IsaBinary;
+
+struct IsaStats
+{
+    uint32_t simd_width     = 0;
+    uint32_t instructions   = 0;
+    uint32_t alu            = 0;
+    uint32_t math           = 0;
+    uint32_t send           = 0;
+    uint32_t flow_control   = 0;
+    uint32_t other          = 0;
+
+    // sends, by target
+    uint32_t sampler        = 0;
+    uint32_t dataport_read  = 0;
+    uint32_t dataport_write = 0;
+    uint32_t render_target  = 0;
+    uint32_t urb            = 0;
+    uint32_t scratch_read   = 0;    // fills
+    uint32_t scratch_write  = 0;    // spills
+    uint32_t other_send     = 0;
+
+    // control flow
+    uint32_t basic_blocks   = 0;
+    uint32_t loops          = 0;
+    uint32_t max_loop_depth = 0;
+    uint64_t est_cycles     = 0;    // static estimate for one thread, see CycleModel.h
+
+    // encoding, from the ISA binary
+    uint64_t isa_bytes      = 0;
+    uint32_t compacted      = 0;    // 8-byte instructions
+    uint32_t full           = 0;    // 16-byte instructions
+};
+
+void ComputeIsaStats( const IsaProgram& program, IsaStats& stats );
+
+// Counts a binary's instructions by class, and fills the encoding fields.  Send targets and control flow need the text
+void ComputeIsaStats( const IsaBinary& binary, IsaStats& stats );
+
+// Fills only the encoding fields, for results which have the text as well
+void ComputeEncodingStats( const IsaBinary& binary, IsaStats& stats );
+
+enum class StatsFormat
+{
+    JSON,
+    CSV,
+};
+
+bool ParseStatsFormat( const char* name, StatsFormat& format );
+
+// Writes a quoted, escaped JSON string
+void WriteJsonString( FILE* fp, const std::string& str );
+
+// Writes a CSV field, quoted if it needs to be
+void WriteCsvString( FILE* fp, const std::string& str );
+
+// Collects statistics for every compiled result, and writes them out once the tool is done
+class IsaStatsReport
+{
+public:
+    void Add( const char* shader, const char* api, const char* platform, const IsaStats& stats );
+
+    // Writes to stdout if path is null
+    bool Write( StatsFormat format, const char* path );
+
+private:
+    struct Record
+    {
+        std::string shader;
+        std::string api;
+        std::string platform;
+        IsaStats stats;
+    };
+
+    std::mutex m_Mutex;
+    std::vector<Record> m_Records;
+};
+
+#endif
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*
+ *  Compiles a DXBC shader for every device with the analyzer library, and prints the size of each result.
+ *    This is written in C to keep the library's interface honest.
+ *
+ *  Usage:  LibraryExample shader.dxbc [compiler_library]
+ */
+
+#include "IntelShaderAnalyzerLib.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static void* ReadFile( const char* path, size_t* size )
+{
+    FILE* fp = fopen( path,"rb" );
+    if ( !fp )
+        return NULL;
+
+    fseek( fp,0,SEEK_END );
+    long length = ftell( fp );
+    fseek( fp,0,SEEK_SET );
+
+    void* data = length > 0 ? malloc( (size_t)length ) : NULL;
+    if ( data && fread( data,1,(size_t)length,fp ) != (size_t)length )
+    {
+        free( data );
+        data = NULL;
+    }
+    fclose( fp );
+
+    *size = (size_t)length;
+    return data;
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( argc < 2 )
+    {
+        printf( "Usage: LibraryExample shader.dxbc [compiler_library]\n" );
+        return 1;
+    }
+
+    size_t size = 0;
+    void* data = ReadFile( argv[1],&size );
+    if ( !data )
+    {
+        printf( "Failed to read: %s\n",argv[1] );
+        return 1;
+    }
+
+    ISA_AnalyzerDesc analyzerDesc = { 0 };
+    analyzerDesc.struct_size = sizeof( analyzerDesc );
+    analyzerDesc.compiler_path = argc > 2 ? argv[2] : NULL;
+
+    char error[256];
+    ISA_Analyzer* analyzer = NULL;
+    if ( ISA_CreateAnalyzer( &analyzerDesc,&analyzer,error,sizeof( error ) ) != ISA_OK )
+    {
+        printf( "%s\n",error );
+        free( data );
+        return 1;
+    }
+
+    ISA_CompileDesc compileDesc = { 0 };
+    compileDesc.struct_size = sizeof( compileDesc );
+    compileDesc.source = ISA_SOURCE_DXBC;
+    compileDesc.data = data;
+    compileDesc.size = size;
+    compileDesc.flags = ISA_COMPILE_BINARY;
+
+    ISA_Result* result = NULL;
+    ISA_Status status = ISA_Compile( analyzer,&compileDesc,&result );
+
+    /* the result does not depend on the analyzer, or on the caller's buffers */
+    ISA_DestroyAnalyzer( analyzer );
+    free( data );
+
+    if ( !result )
+    {
+        printf( "ISA_Compile failed: %d\n",(int)status );
+        return 1;
+    }
+
+    size_t diagnosticsSize = 0;
+    const char* diagnostics = ISA_GetDiagnostics( result,&diagnosticsSize );
+    if ( diagnosticsSize )
+        printf( "%s",diagnostics );
+
+    uint32_t outputs = ISA_GetOutputCount( result );
+    for ( uint32_t i = 0; i < outputs; i++ )
+    {
+        size_t textSize = 0;
+        size_t binarySize = 0;
+        ISA_GetOutputText( result,i,&textSize );
+        ISA_GetOutputBinary( result,i,&binarySize );
+        printf( "%s: %zu bytes of ISA text, %zu bytes of binary\n",ISA_GetOutputAsic( result,i ),textSize,binarySize );
+    }
+
+    ISA_ReleaseResult( result );
+    return (status == ISA_OK && outputs > 0) ? 0 : 1;
+}
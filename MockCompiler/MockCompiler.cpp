@@ -0,0 +1,727 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//
+//  A stand-in for the Intel GPU compiler DLL.  It implements the IntelGPUCompiler interface without a GPU or a driver, 
+//   so the rest of the tool can be tested and benchmarked on any machine.
+//
+//  The mock produces plausible Gen assembly: a structured program with ALU, math, send, and flow control instructions, 
+//   derived deterministically from the shader bytes, the API and the platform.  Its behavior is configured through environment
+//   variables, which are read when OpenCompiler is called:
+//
+//      MOCK_COMPILER_COMPILE_MS     Time taken by each pfnCreateShader call, in milliseconds.  Default 0
+//      MOCK_COMPILER_CONTEXT_MS     Time taken by each pfnCreateCompiler call, in milliseconds.  Default 0
+//      MOCK_COMPILER_BUSY           If 1, spin the CPU for the above times instead of sleeping
+//      MOCK_COMPILER_ISA_SIZE       Approximate size of the ISA text, in bytes.  Default is proportional to the shader size
+//      MOCK_COMPILER_FAILURE_RATE   Fraction of shaders which fail to compile, from 0 to 1.  The same shaders always fail
+//      MOCK_COMPILER_CRASH_RATE     Fraction of shaders which crash the process, from 0 to 1.  The same shaders always crash
+//      MOCK_COMPILER_THREADING      'safe' (default) allows concurrent calls.  'locked' serializes calls internally, like a driver 
+//                                     with a global lock.  'unsafe' fails any call made while another call is in progress
+//
+
+#include "Portability.h"
+#include "IntelGPUCompiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define MOCK_EXPORT extern "C" __declspec(dllexport)
+#else
+#define MOCK_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+using namespace IntelGPUCompiler;
+
+namespace
+{
+
+enum class Threading
+{
+    SAFE,
+    LOCKED,
+    UNSAFE,
+};
+
+struct MockConfig
+{
+    double compile_ms   = 0;
+    double context_ms   = 0;
+    bool busy           = false;
+    size_t isa_size     = 0;    // 0 means derive it from the shader size
+    double failure_rate = 0;
+    double crash_rate   = 0;
+    Threading threading = Threading::SAFE;
+};
+
+struct MockCompiler
+{
+    Platform platform;
+    const char* api;
+};
+
+struct MockShader
+{
+    std::string text;
+    std::vector<uint8_t> binary;
+};
+
+const PlatformInfo PLATFORMS[] = 
+{
+    { Platform::SKL,   "Skylake" },
+    { Platform::KBL,   "Kabylake" },
+    { Platform::ICLLP, "Icelake" },
+};
+
+MockConfig g_Config;
+std::mutex g_CallMutex;
+std::atomic<int> g_nActiveCalls( 0 );
+thread_local std::string t_LastError;
+
+double GetEnvNumber( const char* name, double defaultValue )
+{
+    const char* pValue = getenv( name );
+    return (pValue && pValue[0]) ? atof( pValue ) : defaultValue;
+}
+
+void ReadConfig()
+{
+    g_Config = MockConfig();
+    g_Config.compile_ms   = GetEnvNumber( "MOCK_COMPILER_COMPILE_MS",0 );
+    g_Config.context_ms   = GetEnvNumber( "MOCK_COMPILER_CONTEXT_MS",0 );
+    g_Config.busy         = GetEnvNumber( "MOCK_COMPILER_BUSY",0 ) != 0;
+    g_Config.isa_size     = (size_t)GetEnvNumber( "MOCK_COMPILER_ISA_SIZE",0 );
+    g_Config.failure_rate = GetEnvNumber( "MOCK_COMPILER_FAILURE_RATE",0 );
+    g_Config.crash_rate   = GetEnvNumber( "MOCK_COMPILER_CRASH_RATE",0 );
+
+    const char* pThreading = getenv( "MOCK_COMPILER_THREADING" );
+    if ( pThreading && _stricmp( pThreading,"locked" ) == 0 )
+        g_Config.threading = Threading::LOCKED;
+    else if ( pThreading && _stricmp( pThreading,"unsafe" ) == 0 )
+        g_Config.threading = Threading::UNSAFE;
+}
+
+// Applies the configured threading behavior for the duration of one call into the mock
+class CallGuard
+{
+public:
+    CallGuard()
+    {
+        if ( g_Config.threading == Threading::LOCKED )
+            g_CallMutex.lock();
+
+        m_bConcurrent = g_nActiveCalls.fetch_add( 1 ) != 0;
+    }
+    ~CallGuard()
+    {
+        g_nActiveCalls.fetch_sub( 1 );
+
+        if ( g_Config.threading == Threading::LOCKED )
+            g_CallMutex.unlock();
+    }
+
+    // In 'unsafe' mode, a call which overlaps another one fails, as a driver with unprotected global state might
+    bool Check()
+    {
+        if ( g_Config.threading == Threading::UNSAFE && m_bConcurrent )
+        {
+            t_LastError = "Concurrent call into a compiler which is not thread-safe";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool m_bConcurrent;
+};
+
+void SimulateWork( double milliseconds )
+{
+    if ( milliseconds <= 0 )
+        return;
+
+    auto duration = std::chrono::duration<double,std::milli>( milliseconds );
+    if ( !g_Config.busy )
+    {
+        std::this_thread::sleep_for( duration );
+        return;
+    }
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>( duration );
+    while ( std::chrono::steady_clock::now() < end )
+        ;
+}
+
+uint64_t HashBytes( uint64_t h, const void* pBytes, size_t nBytes )
+{
+    const uint8_t* p = (const uint8_t*)pBytes;
+    for ( size_t i=0; i<nBytes; i++ )
+    {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+// Hashes the parts of a container which affect code generation, so that containers which differ only in reflection data,
+//  statistics or checksums produce the same ISA, as they would with the real compiler
+uint64_t HashParts( uint64_t h, const uint8_t* pContainer, size_t nSize, const char* const* pFourCCs, size_t nFourCCs, size_t& nHashed )
+{
+    const size_t HEADER_SIZE = 32;
+    uint32_t nParts = 0;
+    if ( nSize >= HEADER_SIZE )
+        memcpy( &nParts,pContainer+28,4 );
+    if ( nSize < HEADER_SIZE || nParts > (nSize - HEADER_SIZE) / 4 )
+    {
+        nHashed += nSize;
+        return HashBytes( h,pContainer,nSize );
+    }
+
+    for ( uint32_t i=0; i<nParts; i++ )
+    {
+        uint32_t offset;
+        memcpy( &offset,pContainer + HEADER_SIZE + 4*i,4 );
+        if ( offset > nSize || nSize - offset < 8 )
+            continue;
+
+        uint32_t partSize;
+        memcpy( &partSize,pContainer+offset+4,4 );
+        if ( partSize > nSize - offset - 8 )
+            continue;
+
+        for ( size_t j=0; j<nFourCCs; j++ )
+            if ( memcmp( pContainer+offset,pFourCCs[j],4 ) == 0 )
+            {
+                nHashed += 8 + (size_t)partSize;
+                h = HashBytes( h,pContainer+offset,8 + (size_t)partSize );
+            }
+    }
+    return h;
+}
+
+const char* PROGRAM_PARTS[] = { "SHEX","SHDR","DXIL","ISGN","OSGN","ISG1","OSG1" };
+const char* ROOTSIG_PARTS[] = { "RTS0" };
+
+// splitmix64
+class Random
+{
+public:
+    explicit Random( uint64_t seed ) : m_State( seed ) {}
+
+    uint64_t Next()
+    {
+        uint64_t z = (m_State += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    uint32_t Below( uint32_t n ) { return (uint32_t)(Next() % n); }
+    bool Chance( uint32_t percent ) { return Below( 100 ) < percent; }
+
+private:
+    uint64_t m_State;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  ISA generation
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Gen opcode numbers, used for the binary encoding
+enum Opcode : uint8_t
+{
+    OP_MOV   = 0x01,
+    OP_SEL   = 0x02,
+    OP_AND   = 0x05,
+    OP_OR    = 0x06,
+    OP_SHR   = 0x08,
+    OP_SHL   = 0x09,
+    OP_CMP   = 0x10,
+    OP_JMPI  = 0x20,
+    OP_IF    = 0x22,
+    OP_ELSE  = 0x24,
+    OP_ENDIF = 0x25,
+    OP_WHILE = 0x27,
+    OP_BREAK = 0x28,
+    OP_CONT  = 0x29,
+    OP_SEND  = 0x31,
+    OP_MATH  = 0x38,
+    OP_ADD   = 0x40,
+    OP_MUL   = 0x41,
+    OP_FRC   = 0x43,
+    OP_RNDD  = 0x45,
+    OP_DP4   = 0x54,
+    OP_MAD   = 0x5B,
+    OP_LRP   = 0x5C,
+};
+
+struct AluOp
+{
+    const char* name;
+    Opcode opcode;
+    int nSources;
+};
+
+const AluOp ALU_OPS[] =
+{
+    { "mov",  OP_MOV,  1 },
+    { "mov",  OP_MOV,  1 },
+    { "add",  OP_ADD,  2 },
+    { "add",  OP_ADD,  2 },
+    { "mul",  OP_MUL,  2 },
+    { "mul",  OP_MUL,  2 },
+    { "mad",  OP_MAD,  3 },
+    { "mad",  OP_MAD,  3 },
+    { "sel",  OP_SEL,  2 },
+    { "and",  OP_AND,  2 },
+    { "or",   OP_OR,   2 },
+    { "shl",  OP_SHL,  2 },
+    { "shr",  OP_SHR,  2 },
+    { "dp4",  OP_DP4,  2 },
+    { "lrp",  OP_LRP,  3 },
+    { "frc",  OP_FRC,  1 },
+    { "rndd", OP_RNDD, 1 },
+};
+
+const char* MATH_FUNCTIONS[] = { "inv","sqrt","rsqrt","exp","log","sin","cos","pow","fdiv" };
+
+struct SendType
+{
+    const char* comment;
+    uint32_t sfid;
+    uint32_t descriptor;
+    bool hasDest;
+};
+
+const SendType SEND_SAMPLER       = { "sampler",            0x2, 0x04420001, true };
+const SendType SEND_DP_READ       = { "dataport read",      0xA, 0x02106E00, true };
+const SendType SEND_DP_WRITE      = { "dataport write",     0xA, 0x020A8000, false };
+const SendType SEND_URB           = { "urb write",          0x6, 0x0A08000B, false };
+const SendType SEND_SCRATCH_READ  = { "scratch read (fill)",  0xA, 0x02140000, true };
+const SendType SEND_SCRATCH_WRITE = { "scratch write (spill)",0xA, 0x020E0000, false };
+
+class IsaGenerator
+{
+public:
+    IsaGenerator( uint64_t seed, const MockCompiler& compiler, size_t targetSize ) 
+        : m_Random( seed ), m_Compiler( compiler ), m_nTargetSize( targetSize )
+    {
+        // newer platforms get slightly better code, so that results differ between devices
+        m_nSpillPercent = (compiler.platform == Platform::ICLLP) ? 2 : 4;
+        m_nSimd = m_Random.Chance( 70 ) ? 8 : 16;
+    }
+
+    void Generate( MockShader& shader )
+    {
+        m_pShader = &shader;
+
+        char header[256];
+        snprintf( header,sizeof( header ),
+                  "// Mock Intel GPU compiler\n"
+                  "// API: %s  Platform: %s\n"
+                  "// SIMD%u kernel\n",
+                  m_Compiler.api,PLATFORMS[PlatformIndex()].platformName,m_nSimd );
+        shader.text = header;
+
+        // load the payload, then generate regions until the program is big enough
+        EmitSend( SEND_DP_READ );
+        while ( shader.text.size() < m_nTargetSize )
+            EmitRegion( 0 );
+
+        Emit( nullptr,OP_SEND,"send","null","r127:ud","0x27","0x02000010","{EOT}","// thread spawner",false );
+    }
+
+private:
+    size_t PlatformIndex() const
+    {
+        for ( size_t i=0; i<sizeof( PLATFORMS ) / sizeof( PLATFORMS[0] ); i++ )
+            if ( PLATFORMS[i].Identifier == m_Compiler.platform )
+                return i;
+        return 0;
+    }
+
+    void EmitRegion( int depth )
+    {
+        uint32_t choice = m_Random.Below( 100 );
+        if ( depth < 3 && choice < 15 )
+            EmitIf( depth );
+        else if ( depth < 3 && choice < 22 )
+            EmitLoop( depth );
+        else
+            EmitBlock();
+    }
+
+    void EmitBlock()
+    {
+        uint32_t n = 4 + m_Random.Below( 12 );
+        for ( uint32_t i=0; i<n; i++ )
+        {
+            uint32_t choice = m_Random.Below( 100 );
+            if ( choice < m_nSpillPercent )
+                EmitSend( m_Random.Chance( 50 ) ? SEND_SCRATCH_WRITE : SEND_SCRATCH_READ );
+            else if ( choice < 8 )
+                EmitSend( SEND_SAMPLER );
+            else if ( choice < 11 )
+                EmitSend( m_Random.Chance( 70 ) ? SEND_DP_READ : SEND_DP_WRITE );
+            else if ( choice < 12 )
+                EmitSend( SEND_URB );
+            else if ( choice < 20 )
+                EmitMath();
+            else
+                EmitAlu();
+        }
+    }
+
+    void EmitIf( int depth )
+    {
+        std::string elseLabel = NewLabel();
+        std::string endLabel = NewLabel();
+        bool hasElse = m_Random.Chance( 40 );
+
+        EmitCompare();
+        Emit( "(f0.0)",OP_IF,"if",hasElse ? elseLabel.c_str() : endLabel.c_str(),endLabel.c_str(),nullptr,nullptr,nullptr,nullptr,false );
+        EmitRegion( depth+1 );
+        if ( hasElse )
+        {
+            Emit( nullptr,OP_ELSE,"else",endLabel.c_str(),endLabel.c_str(),nullptr,nullptr,nullptr,nullptr,false );
+            EmitLabel( elseLabel );
+            EmitRegion( depth+1 );
+        }
+        EmitLabel( endLabel );
+        Emit( nullptr,OP_ENDIF,"endif",nullptr,nullptr,nullptr,nullptr,nullptr,nullptr,false );
+    }
+
+    void EmitLoop( int depth )
+    {
+        // like the real compiler, break and cont jump to the while instruction, which then exits or loops
+        std::string topLabel = NewLabel();
+        std::string whileLabel = NewLabel();
+
+        EmitLabel( topLabel );
+        EmitRegion( depth+1 );
+        if ( m_Random.Chance( 30 ) )
+        {
+            EmitCompare();
+            Emit( "(f0.0)",m_Random.Chance( 50 ) ? OP_BREAK : OP_CONT,nullptr,whileLabel.c_str(),whileLabel.c_str(),nullptr,nullptr,nullptr,nullptr,false );
+            EmitBlock();
+        }
+        EmitCompare();
+        EmitLabel( whileLabel );
+        Emit( "(f0.0)",OP_WHILE,"while",topLabel.c_str(),nullptr,nullptr,nullptr,nullptr,nullptr,false );
+    }
+
+    void EmitAlu()
+    {
+        const AluOp& op = ALU_OPS[m_Random.Below( sizeof( ALU_OPS ) / sizeof( ALU_OPS[0] ) )];
+        std::string dst = Dst( "f" );
+        std::string src[3];
+        for ( int i=0; i<op.nSources; i++ )
+            src[i] = Src( "f" );
+
+        Emit( m_Random.Chance( 5 ) ? "(W)" : nullptr,op.opcode,op.name,dst.c_str(),
+              op.nSources > 0 ? src[0].c_str() : nullptr,
+              op.nSources > 1 ? src[1].c_str() : nullptr,
+              op.nSources > 2 ? src[2].c_str() : nullptr,
+              nullptr,nullptr,op.nSources < 3 && m_Random.Chance( 60 ) );
+    }
+
+    void EmitMath()
+    {
+        const char* pFunction = MATH_FUNCTIONS[m_Random.Below( sizeof( MATH_FUNCTIONS ) / sizeof( MATH_FUNCTIONS[0] ) )];
+        bool binary = strcmp( pFunction,"pow" ) == 0 || strcmp( pFunction,"fdiv" ) == 0;
+        std::string name = std::string( "math." ) + pFunction;
+        std::string dst = Dst( "f" );
+        std::string src0 = Src( "f" );
+        std::string src1 = binary ? Src( "f" ) : std::string( "null<0;1,0>:f" );
+        Emit( nullptr,OP_MATH,name.c_str(),dst.c_str(),src0.c_str(),src1.c_str(),nullptr,nullptr,nullptr,false );
+    }
+
+    void EmitCompare()
+    {
+        const char* conditions[] = { "lt","ge","eq","ne","gt","le" };
+        std::string name = std::string( "cmp." ) + conditions[m_Random.Below( 6 )] + ".f0.0";
+        std::string src0 = Src( "f" );
+        std::string src1 = Src( "f" );
+        Emit( nullptr,OP_CMP,name.c_str(),"null<1>:f",src0.c_str(),src1.c_str(),nullptr,nullptr,nullptr,true );
+    }
+
+    void EmitSend( const SendType& type )
+    {
+        char reg[32];
+        snprintf( reg,sizeof( reg ),"r%u:f",m_Random.Below( 112 ) );
+        std::string payload = "r" + std::to_string( m_Random.Below( 112 ) ) + ":ud";
+
+        char sfid[16], desc[16];
+        snprintf( sfid,sizeof( sfid ),"0x%X",type.sfid );
+        snprintf( desc,sizeof( desc ),"0x%08X",type.descriptor );
+
+        std::string comment = std::string( "// " ) + type.comment;
+        Emit( nullptr,OP_SEND,"send",type.hasDest ? reg : "null",payload.c_str(),sfid,desc,nullptr,comment.c_str(),false );
+    }
+
+    std::string Dst( const char* type )
+    {
+        return "r" + std::to_string( m_Random.Below( 112 ) ) + ".0<1>:" + type;
+    }
+
+    std::string Src( const char* type )
+    {
+        if ( m_Random.Chance( 10 ) )
+        {
+            char imm[32];
+            snprintf( imm,sizeof( imm ),"0x%X:%s",m_Random.Below( 0x10000 ),type );
+            return imm;
+        }
+        const char* region = m_Random.Chance( 20 ) ? "<0;1,0>:" : "<8;8,1>:";
+        return "r" + std::to_string( m_Random.Below( 112 ) ) + "." + std::to_string( m_Random.Below( 8 ) ) + region + type;
+    }
+
+    std::string NewLabel()
+    {
+        return "L" + std::to_string( m_nLabels++ );
+    }
+
+    void EmitLabel( const std::string& label )
+    {
+        m_pShader->text += label;
+        m_pShader->text += ":\n";
+    }
+
+    // Appends one instruction to the text, and its encoding to the binary
+    void Emit( const char* pPredicate, Opcode opcode, const char* pName, const char* pDst, 
+               const char* pSrc0, const char* pSrc1, const char* pSrc2, const char* pOptions, const char* pComment, bool compacted )
+    {
+        if ( pName == nullptr )
+            pName = (opcode == OP_BREAK) ? "break" : "cont";
+
+        char instruction[64];
+        snprintf( instruction,sizeof( instruction ),"%s (%u|M0)",pName,m_nSimd );
+
+        char line[512];
+        int n = snprintf( line,sizeof( line ),"%-8s %-24s",pPredicate ? pPredicate : "",instruction );
+        const char* operands[] = { pDst,pSrc0,pSrc1,pSrc2,pOptions,pComment };
+        for ( const char* pOperand : operands )
+            if ( pOperand && n < (int)sizeof( line ) )
+                n += snprintf( line+n,sizeof( line )-n," %-16s",pOperand );
+
+        std::string& text = m_pShader->text;
+        text.append( line,strlen( line ) );
+        while ( !text.empty() && text.back() == ' ' )
+            text.pop_back();
+        text += '\n';
+
+        // The encoding only needs to be the right size, with the opcode and compaction bit where the hardware puts them
+        uint32_t dword0 = opcode | (compacted ? (1u << 29) : 0) | (uint32_t)((m_nSimd == 16 ? 4 : 3) << 21);
+        std::vector<uint8_t>& binary = m_pShader->binary;
+        size_t nBytes = compacted ? 8 : 16;
+        size_t offset = binary.size();
+        binary.resize( offset + nBytes );
+        memcpy( &binary[offset],&dword0,4 );
+        for ( size_t i=4; i<nBytes; i++ )
+            binary[offset+i] = (uint8_t)m_Random.Below( 256 );
+    }
+
+    Random m_Random;
+    const MockCompiler& m_Compiler;
+    size_t m_nTargetSize;
+    uint32_t m_nSpillPercent;
+    uint32_t m_nSimd;
+    uint32_t m_nLabels = 0;
+    MockShader* m_pShader = nullptr;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Function table
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool CreateCompiler( Platform platform, OpaqueCompiler& compiler, const char* api )
+{
+    CallGuard guard;
+    if ( !guard.Check() )
+        return false;
+
+    bool known = false;
+    for ( const PlatformInfo& info : PLATFORMS )
+        known |= (info.Identifier == platform);
+    if ( !known )
+    {
+        t_LastError = "Unsupported platform";
+        return false;
+    }
+
+    SimulateWork( g_Config.context_ms );
+
+    MockCompiler* pCompiler = new MockCompiler();
+    pCompiler->platform = platform;
+    pCompiler->api = api;
+    compiler = pCompiler;
+    return true;
+}
+
+void __stdcall DeleteCompiler( OpaqueCompiler& compiler )
+{
+    CallGuard guard;
+    delete (MockCompiler*)compiler;
+    compiler = nullptr;
+}
+
+bool CreateShader( OpaqueCompiler compiler, const void* pDXBC, const void* pRootSig, size_t nRootSigSize, OpaqueShader& output )
+{
+    CallGuard guard;
+    if ( !guard.Check() )
+        return false;
+
+    MockCompiler* pCompiler = (MockCompiler*)compiler;
+    if ( !pCompiler || !pDXBC )
+    {
+        t_LastError = "Invalid arguments";
+        return false;
+    }
+
+    // like the real compiler, we trust the size in the container header
+    const uint8_t* pBytes = (const uint8_t*)pDXBC;
+    if ( memcmp( pBytes,"DXBC",4 ) != 0 )
+    {
+        t_LastError = "Input is not a DXBC container";
+        return false;
+    }
+
+    uint32_t nSize;
+    memcpy( &nSize,pBytes+24,4 );
+
+    if ( strcmp( pCompiler->api,"dx12" ) == 0 && (!pRootSig || nRootSigSize == 0) )
+    {
+        t_LastError = "Missing root signature";
+        return false;
+    }
+
+    size_t nProgramSize = 0;
+    size_t nRootSigHashed = 0;
+    uint64_t seed = HashParts( 0xCBF29CE484222325ull,pBytes,nSize,PROGRAM_PARTS,sizeof( PROGRAM_PARTS ) / sizeof( PROGRAM_PARTS[0] ),nProgramSize );
+    if ( pRootSig )
+        seed = HashParts( seed,(const uint8_t*)pRootSig,nRootSigSize,ROOTSIG_PARTS,1,nRootSigHashed );
+    seed = HashBytes( seed,pCompiler->api,strlen( pCompiler->api ) );
+    seed = HashBytes( seed,&pCompiler->platform,sizeof( pCompiler->platform ) );
+
+    SimulateWork( g_Config.compile_ms );
+
+    // crashes are chosen from the other end of the range, so that they are never also failures
+    if ( g_Config.crash_rate > 0 && (double)(9999 - seed % 10000) < g_Config.crash_rate * 10000 )
+        abort();
+
+    if ( g_Config.failure_rate > 0 && (double)(seed % 10000) < g_Config.failure_rate * 10000 )
+    {
+        t_LastError = "Simulated compile failure";
+        return false;
+    }
+
+    size_t targetSize = g_Config.isa_size ? g_Config.isa_size : 1024 + nProgramSize * 16;
+
+    MockShader* pShader = new MockShader();
+    IsaGenerator( seed,*pCompiler,targetSize ).Generate( *pShader );
+    output = pShader;
+    return true;
+}
+
+void __stdcall DeleteShader( OpaqueShader& shader )
+{
+    CallGuard guard;
+    delete (MockShader*)shader;
+    shader = nullptr;
+}
+
+bool __stdcall CreateCompilerDX11( Platform platform, OpaqueCompiler& compiler )
+{
+    return CreateCompiler( platform,compiler,"dx11" );
+}
+
+bool __stdcall CreateCompilerDX12( Platform platform, OpaqueCompiler& compiler )
+{
+    return CreateCompiler( platform,compiler,"dx12" );
+}
+
+bool __stdcall CreateShaderDX11( OpaqueCompiler compiler, const ShaderInput_DX11_V1& input, OpaqueShader& output )
+{
+    return CreateShader( compiler,input.DXBCBin,nullptr,0,output );
+}
+
+bool __stdcall CreateShaderDX12( OpaqueCompiler compiler, const ShaderInput_DX12_V1& input, OpaqueShader& output )
+{
+    return CreateShader( compiler,input.DXBCBin,input.rootSignature,input.rootSignatureSize,output );
+}
+
+char* __stdcall GetIsaText( OpaqueShader shader, size_t& textSize )
+{
+    MockShader* pShader = (MockShader*)shader;
+    textSize = pShader->text.size() + 1;
+    return &pShader->text[0];
+}
+
+void* __stdcall GetIsaBinary( OpaqueShader shader, size_t& shaderSize )
+{
+    MockShader* pShader = (MockShader*)shader;
+    shaderSize = pShader->binary.size();
+    return pShader->binary.data();
+}
+
+const char* __stdcall GetLastErrorText()
+{
+    return t_LastError.c_str();
+}
+
+size_t __stdcall EnumPlatforms( PlatformInfo* pPlatforms, size_t nMaxPlatforms )
+{
+    size_t nPlatforms = sizeof( PLATFORMS ) / sizeof( PLATFORMS[0] );
+    if ( pPlatforms == nullptr )
+        return nPlatforms;
+
+    size_t n = (nMaxPlatforms < nPlatforms) ? nMaxPlatforms : nPlatforms;
+    for ( size_t i=0; i<n; i++ )
+        pPlatforms[i] = PLATFORMS[i];
+    return n;
+}
+
+}
+
+MOCK_EXPORT bool __stdcall OpenCompiler( SOpenCompiler& desc )
+{
+    if ( desc.InterfaceVersion != 1 || desc.pCompilerFuncs == nullptr )
+        return false;
+
+    ReadConfig();
+
+    SFunctionTable_V1& table = desc.pCompilerFuncs->interface1;
+    table.pfnDX11.pfnCreateCompiler       = CreateCompilerDX11;
+    table.pfnDX11.pfnDeleteShaderCompiler = DeleteCompiler;
+    table.pfnDX11.pfnCreateShader         = CreateShaderDX11;
+    table.pfnDX11.pfnDeleteShader         = DeleteShader;
+    table.pfnDX12.pfnCreateCompiler       = CreateCompilerDX12;
+    table.pfnDX12.pfnDeleteShaderCompiler = DeleteCompiler;
+    table.pfnDX12.pfnCreateShader         = CreateShaderDX12;
+    table.pfnDX12.pfnDeleteShader         = DeleteShader;
+    table.pfnEnumPlatforms = EnumPlatforms;
+    table.pfnGetIsaText    = GetIsaText;
+    table.pfnGetIsaBinary  = GetIsaBinary;
+    table.pfnGetLastError  = GetLastErrorText;
+    return true;
+}
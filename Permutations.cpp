@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "Permutations.h"
+#include "IntelShaderAnalyzer.h"
+
+#include <cstring>
+#include <set>
+
+bool ParsePermuteOption( const char* option, std::string& name, std::vector<std::string>& values )
+{
+    const char* equals = strchr( option,'=' );
+    if ( !equals || equals == option )
+        return false;
+
+    name.assign( option,equals );
+    values.clear();
+    const char* p = equals + 1;
+    for ( ;; )
+    {
+        const char* comma = strchr( p,',' );
+        if ( !comma )
+        {
+            values.emplace_back( p );
+            return true;
+        }
+        values.emplace_back( p,comma );
+        p = comma + 1;
+    }
+}
+
+void ExpandPermutations( const JobOptions& job, std::vector<Permutation>& permutations )
+{
+    permutations.assign( 1,Permutation() );
+    for ( const char* option : job.permute )
+    {
+        std::string name;
+        std::vector<std::string> values;
+        if ( !ParsePermuteOption( option,name,values ) )
+            continue;
+
+        std::vector<Permutation> expanded;
+        expanded.reserve( permutations.size() * values.size() );
+        for ( const Permutation& p : permutations )
+        {
+            for ( const std::string& value : values )
+            {
+                Permutation e = p;
+                e.name += (e.name.empty() ? "" : "_") + name + "=" + value;
+                e.defines.emplace_back( name,value );
+                expanded.push_back( std::move( e ) );
+            }
+        }
+        permutations.swap( expanded );
+    }
+}
+
+Hash128 HashProgram( const ToolInputs& inputs )
+{
+    Hasher h;
+    h.UpdateValue( inputs.bytecode.size() );
+    h.Update( inputs.bytecode.data(),inputs.bytecode.size() );
+    h.UpdateValue( inputs.rootsig.size() );
+    h.Update( inputs.rootsig.data(),inputs.rootsig.size() );
+    return h.Finish();
+}
+
+std::string ProgramMemo::MakeKey( const Hash128& program, const char* api, int platform )
+{
+    return program.ToString() + api + "/" + std::to_string( platform );
+}
+
+std::shared_ptr<const ProgramMemo::Result> ProgramMemo::Lookup( const Hash128& program, const char* api, int platform ) const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    auto it = m_Results.find( MakeKey( program,api,platform ) );
+    if ( it == m_Results.end() )
+        return nullptr;
+    m_nHits++;
+    return it->second;
+}
+
+void ProgramMemo::Store( const Hash128& program, const char* api, int platform, const char* text, size_t textLength,
+                         const void* pBinary, size_t binarySize )
+{
+    std::shared_ptr<Result> result = std::make_shared<Result>();
+    if ( text )
+        result->text.assign( text,textLength );
+    if ( pBinary )
+        result->binary.assign( (const uint8_t*)pBinary,(const uint8_t*)pBinary + binarySize );
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_Results.emplace( MakeKey( program,api,platform ),std::move( result ) );
+}
+
+bool RunPermutations( ToolContext& ctx, JobOptions& job )
+{
+    if ( job.frontend.input_file == nullptr )
+    {
+        LogMessage( job.inputs,"No input filename" );
+        return false;
+    }
+
+    std::vector<Permutation> permutations;
+    ExpandPermutations( job,permutations );
+
+    // read the source once.  Every permutation shares it
+    if ( _stricmp( job.source_lang,"hlsl" ) == 0 && job.frontend.input_text.empty() )
+        job.frontend.input_text.Load( job.frontend.input_file );
+
+    // the memo only lives as long as the job, so it never holds more than one shader's results
+    ProgramMemo memo;
+    ToolContext permutationCtx = ctx;
+    permutationCtx.programs = &memo;
+
+    std::string basePrefix = job.inputs.isa_prefix ? job.inputs.isa_prefix : "";
+    std::string baseId = job.inputs.shader_id ? job.inputs.shader_id : job.frontend.input_file;
+
+    std::set<Hash128> programs;
+    size_t nFailed = 0;
+    for ( const Permutation& permutation : permutations )
+    {
+        // the permutation's options point into these strings, so they must outlive it
+        std::string prefix = basePrefix + permutation.name + "_";
+        std::string id = baseId + "_" + permutation.name;
+
+        JobOptions permutationJob = job;
+        permutationJob.permute.clear();
+        permutationJob.inputs.isa_prefix = prefix.c_str();
+        permutationJob.inputs.shader_id = id.c_str();
+        for ( const auto& define : permutation.defines )
+            permutationJob.frontend.defines.emplace_back( define.first.c_str(),define.second.c_str() );
+
+        bool succeeded = PrepareInputs( permutationJob );
+        if ( succeeded )
+        {
+            programs.insert( HashProgram( permutationJob.inputs ) );
+            succeeded = RunJob( permutationCtx,permutationJob );
+        }
+
+        if ( !succeeded )
+        {
+            LogMessage( job.inputs,"Permutation failed: %s",permutation.name.c_str() );
+            nFailed++;
+        }
+
+        // every permutation compiles for the same platforms.  Callers want to know which
+        job.inputs.asics = permutationJob.inputs.asics;
+    }
+
+    LogMessage( job.inputs,"Permutations: %zu, %zu distinct programs, %zu failed",permutations.size(),programs.size(),nFailed );
+    return nFailed == 0;
+}
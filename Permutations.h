@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _PERMUTATIONS_H_
+#define _PERMUTATIONS_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Hash.h"
+
+struct JobOptions;
+struct ToolInputs;
+
+//
+//  --permute NAME=v1,v2,...  expands a job into one job for each combination of values, like a set of -D options.
+//
+//   Each permutation writes its results to '<isa_prefix><name>_<device>.asm', where the name lists its values in the
+//   order the options were given, e.g. 'FOO=1_BAR=2'.  The first option varies slowest.
+//
+//   Uber-shader permutations often compile to the same bytecode.  Each distinct program is compiled only once per
+//   platform:  the other permutations share its results.
+//
+struct Permutation
+{
+    std::string name;
+    std::vector< std::pair<std::string,std::string> > defines;
+};
+
+// Splits one --permute argument.  Returns false if it is malformed
+bool ParsePermuteOption( const char* option, std::string& name, std::vector<std::string>& values );
+
+// Lists every combination of the job's --permute options
+void ExpandPermutations( const JobOptions& job, std::vector<Permutation>& permutations );
+
+// Identifies the program a job compiles:  its bytecode and root signature
+Hash128 HashProgram( const ToolInputs& inputs );
+
+// Results of the programs a job has already compiled.  Safe to use from several threads at once
+class ProgramMemo
+{
+public:
+    struct Result
+    {
+        std::string text;
+        std::vector<uint8_t> binary;
+    };
+
+    std::shared_ptr<const Result> Lookup( const Hash128& program, const char* api, int platform ) const;
+    void Store( const Hash128& program, const char* api, int platform, const char* text, size_t textLength,
+                const void* pBinary, size_t binarySize );
+
+    size_t GetHitCount() const { return m_nHits; }
+
+private:
+    static std::string MakeKey( const Hash128& program, const char* api, int platform );
+
+    mutable std::mutex m_Mutex;
+    mutable size_t m_nHits = 0;
+    std::unordered_map< std::string,std::shared_ptr<const Result> > m_Results;
+};
+
+#endif
@@ -0,0 +1,1052 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "RootSignature.h"
+#include "IntelShaderAnalyzer.h"
+#include "IncludeScanner.h"
+#include "DXBCContainer.h"
+
+#include <cctype>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+namespace
+{
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Root signature description.  Field values are the D3D12 enum values, which is what the serialized form holds
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace ParameterType
+{
+    const uint32_t TABLE     = 0;
+    const uint32_t CONSTANTS = 1;
+    const uint32_t CBV       = 2;
+    const uint32_t SRV       = 3;
+    const uint32_t UAV       = 4;
+}
+
+namespace RangeType
+{
+    const uint32_t SRV     = 0;
+    const uint32_t UAV     = 1;
+    const uint32_t CBV     = 2;
+    const uint32_t SAMPLER = 3;
+}
+
+const uint32_t UNBOUNDED     = 0xffffffff;
+const uint32_t OFFSET_APPEND = 0xffffffff;
+
+struct DescriptorRange
+{
+    uint32_t type;
+    uint32_t count  = 1;
+    uint32_t reg    = 0;
+    uint32_t space  = 0;
+    uint32_t flags  = 0;
+    uint32_t offset = OFFSET_APPEND;
+};
+
+struct RootParameter
+{
+    uint32_t type;
+    uint32_t visibility = 0;
+    uint32_t reg        = 0;    // CONSTANTS, CBV, SRV and UAV
+    uint32_t space      = 0;
+    uint32_t flags      = 0;    // CBV, SRV and UAV
+    uint32_t constants  = 0;    // CONSTANTS
+    std::vector<DescriptorRange> ranges;    // TABLE
+};
+
+// Defaults are the ones the HLSL root signature language documents
+struct StaticSampler
+{
+    uint32_t filter         = 0x55;     // FILTER_ANISOTROPIC
+    uint32_t address[3]     = { 1,1,1 };// TEXTURE_ADDRESS_WRAP
+    float mipLODBias        = 0.0f;
+    uint32_t maxAnisotropy  = 16;
+    uint32_t comparison     = 4;        // COMPARISON_LESS_EQUAL
+    uint32_t border         = 2;        // STATIC_BORDER_COLOR_OPAQUE_WHITE
+    float minLOD            = 0.0f;
+    float maxLOD            = FLT_MAX;
+    uint32_t reg            = 0;
+    uint32_t space          = 0;
+    uint32_t visibility     = 0;
+};
+
+struct RootSignatureDesc
+{
+    uint32_t version = 1;   // 1 for 1.0, 2 for 1.1
+    uint32_t flags = 0;
+    std::vector<RootParameter> parameters;
+    std::vector<StaticSampler> samplers;
+};
+
+struct NamedValue
+{
+    const char* name;
+    uint32_t value;
+};
+
+const NamedValue ROOT_FLAGS[] =
+{
+    { "ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT",   0x1 },
+    { "DENY_VERTEX_SHADER_ROOT_ACCESS",       0x2 },
+    { "DENY_HULL_SHADER_ROOT_ACCESS",         0x4 },
+    { "DENY_DOMAIN_SHADER_ROOT_ACCESS",       0x8 },
+    { "DENY_GEOMETRY_SHADER_ROOT_ACCESS",     0x10 },
+    { "DENY_PIXEL_SHADER_ROOT_ACCESS",        0x20 },
+    { "ALLOW_STREAM_OUTPUT",                  0x40 },
+    { "LOCAL_ROOT_SIGNATURE",                 0x80 },
+    { "DENY_AMPLIFICATION_SHADER_ROOT_ACCESS",0x100 },
+    { "DENY_MESH_SHADER_ROOT_ACCESS",         0x200 },
+    { "CBV_SRV_UAV_HEAP_DIRECTLY_INDEXED",    0x400 },
+    { "SAMPLER_HEAP_DIRECTLY_INDEXED",        0x800 },
+};
+
+const NamedValue VISIBILITIES[] =
+{
+    { "SHADER_VISIBILITY_ALL",            0 },
+    { "SHADER_VISIBILITY_VERTEX",         1 },
+    { "SHADER_VISIBILITY_HULL",           2 },
+    { "SHADER_VISIBILITY_DOMAIN",         3 },
+    { "SHADER_VISIBILITY_GEOMETRY",       4 },
+    { "SHADER_VISIBILITY_PIXEL",          5 },
+    { "SHADER_VISIBILITY_AMPLIFICATION",  6 },
+    { "SHADER_VISIBILITY_MESH",           7 },
+};
+
+const NamedValue ROOT_DESCRIPTOR_FLAGS[] =
+{
+    { "DATA_VOLATILE",                    0x2 },
+    { "DATA_STATIC_WHILE_SET_AT_EXECUTE", 0x4 },
+    { "DATA_STATIC",                      0x8 },
+};
+
+const NamedValue RANGE_FLAGS[] =
+{
+    { "DESCRIPTORS_VOLATILE",                             0x1 },
+    { "DATA_VOLATILE",                                    0x2 },
+    { "DATA_STATIC_WHILE_SET_AT_EXECUTE",                 0x4 },
+    { "DATA_STATIC",                                      0x8 },
+    { "DESCRIPTORS_STATIC_KEEPING_BUFFER_BOUNDS_CHECKS",  0x10000 },
+};
+
+const NamedValue ADDRESS_MODES[] =
+{
+    { "TEXTURE_ADDRESS_WRAP",        1 },
+    { "TEXTURE_ADDRESS_MIRROR",      2 },
+    { "TEXTURE_ADDRESS_CLAMP",       3 },
+    { "TEXTURE_ADDRESS_BORDER",      4 },
+    { "TEXTURE_ADDRESS_MIRROR_ONCE", 5 },
+};
+
+const NamedValue COMPARISON_FUNCS[] =
+{
+    { "COMPARISON_NEVER",         1 },
+    { "COMPARISON_LESS",          2 },
+    { "COMPARISON_EQUAL",         3 },
+    { "COMPARISON_LESS_EQUAL",    4 },
+    { "COMPARISON_GREATER",       5 },
+    { "COMPARISON_NOT_EQUAL",     6 },
+    { "COMPARISON_GREATER_EQUAL", 7 },
+    { "COMPARISON_ALWAYS",        8 },
+};
+
+const NamedValue BORDER_COLORS[] =
+{
+    { "STATIC_BORDER_COLOR_TRANSPARENT_BLACK", 0 },
+    { "STATIC_BORDER_COLOR_OPAQUE_BLACK",      1 },
+    { "STATIC_BORDER_COLOR_OPAQUE_WHITE",      2 },
+    { "STATIC_BORDER_COLOR_OPAQUE_BLACK_UINT", 3 },
+    { "STATIC_BORDER_COLOR_OPAQUE_WHITE_UINT", 4 },
+};
+
+// every filter is FILTER_[COMPARISON_|MINIMUM_|MAXIMUM_]<mode>.  The reduction type lives in bits 7 and 8
+const NamedValue FILTER_REDUCTIONS[] =
+{
+    { "COMPARISON_", 0x80 },
+    { "MINIMUM_",    0x100 },
+    { "MAXIMUM_",    0x180 },
+};
+
+const NamedValue FILTER_MODES[] =
+{
+    { "MIN_MAG_MIP_POINT",                0x0 },
+    { "MIN_MAG_POINT_MIP_LINEAR",         0x1 },
+    { "MIN_POINT_MAG_LINEAR_MIP_POINT",   0x4 },
+    { "MIN_POINT_MAG_MIP_LINEAR",         0x5 },
+    { "MIN_LINEAR_MAG_MIP_POINT",         0x10 },
+    { "MIN_LINEAR_MAG_POINT_MIP_LINEAR",  0x11 },
+    { "MIN_MAG_LINEAR_MIP_POINT",         0x14 },
+    { "MIN_MAG_MIP_LINEAR",               0x15 },
+    { "MIN_MAG_ANISOTROPIC_MIP_POINT",    0x54 },
+    { "ANISOTROPIC",                      0x55 },
+};
+
+template< size_t N >
+bool FindValue( const NamedValue (&table)[N], const char* name, uint32_t& value )
+{
+    for ( const NamedValue& entry : table )
+    {
+        if ( _stricmp( entry.name,name ) == 0 )
+        {
+            value = entry.value;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FindFilter( const char* name, uint32_t& value )
+{
+    if ( _strnicmp( name,"FILTER_",7 ) != 0 )
+        return false;
+    name += 7;
+
+    uint32_t reduction = 0;
+    for ( const NamedValue& entry : FILTER_REDUCTIONS )
+    {
+        size_t length = strlen( entry.name );
+        if ( _strnicmp( name,entry.name,length ) == 0 )
+        {
+            reduction = entry.value;
+            name += length;
+            break;
+        }
+    }
+
+    if ( !FindValue( FILTER_MODES,name,value ) )
+        return false;
+    value |= reduction;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Parser
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct Token
+{
+    enum Kind
+    {
+        END,
+        WORD,       // identifiers, registers and numbers
+        PUNCT,      // ( ) , = |
+    };
+
+    Kind kind;
+    std::string text;
+};
+
+class Parser
+{
+public:
+    Parser( const std::string& text, uint32_t version );
+
+    bool Parse( RootSignatureDesc& desc );
+    const std::string& GetError() const { return m_Error; }
+
+private:
+    const Token& Peek() const { return m_Tokens[m_nNext]; }
+    bool PeekPunct( char c ) const { return Peek().kind == Token::PUNCT && Peek().text[0] == c; }
+    bool Accept( char c );
+    bool Expect( char c );
+    bool Fail( const std::string& message );
+
+    bool ParseWord( std::string& word );
+    bool ParseOption( std::string& name );
+    bool ParseUInt( uint32_t& value );
+    bool ParseFloat( float& value );
+    bool ParseRegister( char kind, uint32_t& reg );
+    bool IsRegister( char kind ) const;
+
+    template< size_t N >
+    bool ParseEnum( const NamedValue (&table)[N], const char* what, uint32_t& value );
+
+    template< size_t N >
+    bool ParseFlags( const NamedValue (&table)[N], uint32_t& flags );
+
+    bool ParseRootFlags( RootSignatureDesc& desc );
+    bool ParseRootConstants( RootParameter& param );
+    bool ParseRootDescriptor( uint32_t type, char kind, RootParameter& param );
+    bool ParseTable( RootParameter& param );
+    bool ParseRange( uint32_t type, char kind, DescriptorRange& range );
+    bool ParseStaticSampler( StaticSampler& sampler );
+
+    std::vector<Token> m_Tokens;
+    size_t m_nNext = 0;
+    uint32_t m_nVersion;
+    std::string m_Error;
+};
+
+Parser::Parser( const std::string& text, uint32_t version ) : m_nVersion( version )
+{
+    const char* p = text.c_str();
+    while ( *p )
+    {
+        if ( isspace( (unsigned char)*p ) )
+        {
+            p++;
+        }
+        else if ( strchr( "(),=|",*p ) )
+        {
+            m_Tokens.push_back( Token{ Token::PUNCT,std::string( 1,*p++ ) } );
+        }
+        else
+        {
+            // a word runs to the next space or punctuation.  Numbers such as '-0.5f' and '1e-3' are words too
+            const char* start = p;
+            while ( *p && !isspace( (unsigned char)*p ) && !strchr( "(),=|",*p ) )
+                p++;
+            m_Tokens.push_back( Token{ Token::WORD,std::string( start,p ) } );
+        }
+    }
+    m_Tokens.push_back( Token{ Token::END,std::string() } );
+}
+
+bool Parser::Fail( const std::string& message )
+{
+    if ( m_Error.empty() )
+    {
+        m_Error = message;
+        m_Error += (Peek().kind == Token::END) ? " at end of root signature" : " near '" + Peek().text + "'";
+    }
+    return false;
+}
+
+bool Parser::Accept( char c )
+{
+    if ( !PeekPunct( c ) )
+        return false;
+    m_nNext++;
+    return true;
+}
+
+bool Parser::Expect( char c )
+{
+    if ( Accept( c ) )
+        return true;
+    return Fail( std::string( "expected '" ) + c + "'" );
+}
+
+bool Parser::ParseWord( std::string& word )
+{
+    if ( Peek().kind != Token::WORD )
+        return Fail( "expected a name or a number" );
+    word = m_Tokens[m_nNext++].text;
+    return true;
+}
+
+bool Parser::ParseOption( std::string& name )
+{
+    // a register here is either the wrong kind, or a second one
+    for ( char kind : { 'b','t','u','s' } )
+        if ( IsRegister( kind ) )
+            return Fail( "unexpected register" );
+    return ParseWord( name ) && Expect( '=' );
+}
+
+bool Parser::ParseUInt( uint32_t& value )
+{
+    const std::string& text = Peek().text;
+    char* end = nullptr;
+    unsigned long long v = (Peek().kind == Token::WORD && isdigit( (unsigned char)text[0] )) ? strtoull( text.c_str(),&end,0 ) : 0;
+    if ( !end || *end || v > 0xffffffffull )
+        return Fail( "expected an unsigned integer" );
+    value = (uint32_t)v;
+    m_nNext++;
+    return true;
+}
+
+bool Parser::ParseFloat( float& value )
+{
+    const std::string& text = Peek().text;
+    char* end = nullptr;
+    float v = (Peek().kind == Token::WORD) ? strtof( text.c_str(),&end ) : 0.0f;
+    if ( end && (*end == 'f' || *end == 'F') )
+        end++;
+    if ( !end || end == text.c_str() || *end )
+        return Fail( "expected a number" );
+    value = v;
+    m_nNext++;
+    return true;
+}
+
+bool Parser::IsRegister( char kind ) const
+{
+    const std::string& text = Peek().text;
+    if ( Peek().kind != Token::WORD || text.size() < 2 || tolower( (unsigned char)text[0] ) != kind )
+        return false;
+    for ( size_t i=1; i<text.size(); i++ )
+        if ( !isdigit( (unsigned char)text[i] ) )
+            return false;
+    return true;
+}
+
+bool Parser::ParseRegister( char kind, uint32_t& reg )
+{
+    if ( !IsRegister( kind ) )
+        return Fail( std::string( "expected a register such as '" ) + kind + "0'" );
+    reg = (uint32_t)strtoul( Peek().text.c_str() + 1,nullptr,10 );
+    m_nNext++;
+    return true;
+}
+
+template< size_t N >
+bool Parser::ParseEnum( const NamedValue (&table)[N], const char* what, uint32_t& value )
+{
+    if ( Peek().kind != Token::WORD || !FindValue( table,Peek().text.c_str(),value ) )
+        return Fail( std::string( "expected " ) + what );
+    m_nNext++;
+    return true;
+}
+
+template< size_t N >
+bool Parser::ParseFlags( const NamedValue (&table)[N], uint32_t& flags )
+{
+    if ( m_nVersion < 2 )
+        return Fail( "flags require root signature version 1.1" );
+
+    flags = 0;
+    do
+    {
+        uint32_t flag;
+        if ( Peek().text == "0" )
+            flag = 0;
+        else if ( Peek().kind != Token::WORD || !FindValue( table,Peek().text.c_str(),flag ) )
+            return Fail( "unknown flag" );
+        flags |= flag;
+        m_nNext++;
+    } while ( Accept( '|' ) );
+    return true;
+}
+
+bool Parser::ParseRootFlags( RootSignatureDesc& desc )
+{
+    if ( !Expect( '(' ) )
+        return false;
+
+    if ( !PeekPunct( ')' ) )
+    {
+        do
+        {
+            uint32_t flag;
+            if ( Peek().text == "0" )
+                flag = 0;
+            else if ( Peek().kind != Token::WORD || !FindValue( ROOT_FLAGS,Peek().text.c_str(),flag ) )
+                return Fail( "unknown root signature flag" );
+            desc.flags |= flag;
+            m_nNext++;
+        } while ( Accept( '|' ) );
+    }
+    return Expect( ')' );
+}
+
+bool Parser::ParseRootConstants( RootParameter& param )
+{
+    param.type = ParameterType::CONSTANTS;
+    bool haveRegister = false;
+    bool haveCount = false;
+
+    if ( !Expect( '(' ) )
+        return false;
+    do
+    {
+        if ( IsRegister( 'b' ) && !haveRegister )
+        {
+            haveRegister = ParseRegister( 'b',param.reg );
+            continue;
+        }
+
+        std::string name;
+        if ( !ParseOption( name ) )
+            return false;
+
+        bool parsed;
+        if ( _stricmp( name.c_str(),"num32BitConstants" ) == 0 )
+            parsed = haveCount = ParseUInt( param.constants );
+        else if ( _stricmp( name.c_str(),"space" ) == 0 )
+            parsed = ParseUInt( param.space );
+        else if ( _stricmp( name.c_str(),"visibility" ) == 0 )
+            parsed = ParseEnum( VISIBILITIES,"a shader visibility",param.visibility );
+        else
+            return Fail( "unknown RootConstants option '" + name + "'" );
+
+        if ( !parsed )
+            return false;
+    } while ( Accept( ',' ) );
+
+    if ( !haveRegister || !haveCount )
+        return Fail( "RootConstants needs a 'b' register and num32BitConstants" );
+    return Expect( ')' );
+}
+
+bool Parser::ParseRootDescriptor( uint32_t type, char kind, RootParameter& param )
+{
+    param.type = type;
+    bool haveRegister = false;
+
+    if ( !Expect( '(' ) )
+        return false;
+    do
+    {
+        if ( IsRegister( kind ) && !haveRegister )
+        {
+            haveRegister = ParseRegister( kind,param.reg );
+            continue;
+        }
+
+        std::string name;
+        if ( !ParseOption( name ) )
+            return false;
+
+        bool parsed;
+        if ( _stricmp( name.c_str(),"space" ) == 0 )
+            parsed = ParseUInt( param.space );
+        else if ( _stricmp( name.c_str(),"visibility" ) == 0 )
+            parsed = ParseEnum( VISIBILITIES,"a shader visibility",param.visibility );
+        else if ( _stricmp( name.c_str(),"flags" ) == 0 )
+            parsed = ParseFlags( ROOT_DESCRIPTOR_FLAGS,param.flags );
+        else
+            return Fail( "unknown root descriptor option '" + name + "'" );
+
+        if ( !parsed )
+            return false;
+    } while ( Accept( ',' ) );
+
+    if ( !haveRegister )
+        return Fail( std::string( "missing '" ) + kind + "' register" );
+    return Expect( ')' );
+}
+
+bool Parser::ParseRange( uint32_t type, char kind, DescriptorRange& range )
+{
+    range.type = type;
+    bool haveRegister = false;
+
+    if ( !Expect( '(' ) )
+        return false;
+    do
+    {
+        if ( IsRegister( kind ) && !haveRegister )
+        {
+            haveRegister = ParseRegister( kind,range.reg );
+            continue;
+        }
+
+        std::string name;
+        if ( !ParseOption( name ) )
+            return false;
+
+        bool parsed;
+        if ( _stricmp( name.c_str(),"numDescriptors" ) == 0 )
+        {
+            if ( _stricmp( Peek().text.c_str(),"unbounded" ) == 0 )
+            {
+                range.count = UNBOUNDED;
+                m_nNext++;
+                parsed = true;
+            }
+            else
+            {
+                parsed = ParseUInt( range.count );
+            }
+        }
+        else if ( _stricmp( name.c_str(),"space" ) == 0 )
+        {
+            parsed = ParseUInt( range.space );
+        }
+        else if ( _stricmp( name.c_str(),"offset" ) == 0 )
+        {
+            if ( _stricmp( Peek().text.c_str(),"DESCRIPTOR_RANGE_OFFSET_APPEND" ) == 0 )
+            {
+                range.offset = OFFSET_APPEND;
+                m_nNext++;
+                parsed = true;
+            }
+            else
+            {
+                parsed = ParseUInt( range.offset );
+            }
+        }
+        else if ( _stricmp( name.c_str(),"flags" ) == 0 )
+        {
+            parsed = ParseFlags( RANGE_FLAGS,range.flags );
+        }
+        else
+        {
+            return Fail( "unknown descriptor range option '" + name + "'" );
+        }
+
+        if ( !parsed )
+            return false;
+    } while ( Accept( ',' ) );
+
+    if ( !haveRegister )
+        return Fail( std::string( "missing '" ) + kind + "' register" );
+    return Expect( ')' );
+}
+
+bool Parser::ParseTable( RootParameter& param )
+{
+    param.type = ParameterType::TABLE;
+
+    if ( !Expect( '(' ) )
+        return false;
+
+    if ( !PeekPunct( ')' ) )
+    {
+        do
+        {
+            std::string name;
+            if ( !ParseWord( name ) )
+                return false;
+
+            bool parsed;
+            DescriptorRange range;
+            if ( _stricmp( name.c_str(),"CBV" ) == 0 )
+                parsed = ParseRange( RangeType::CBV,'b',range );
+            else if ( _stricmp( name.c_str(),"SRV" ) == 0 )
+                parsed = ParseRange( RangeType::SRV,'t',range );
+            else if ( _stricmp( name.c_str(),"UAV" ) == 0 )
+                parsed = ParseRange( RangeType::UAV,'u',range );
+            else if ( _stricmp( name.c_str(),"Sampler" ) == 0 )
+                parsed = ParseRange( RangeType::SAMPLER,'s',range );
+            else if ( _stricmp( name.c_str(),"visibility" ) == 0 )
+            {
+                if ( !Expect( '=' ) || !ParseEnum( VISIBILITIES,"a shader visibility",param.visibility ) )
+                    return false;
+                continue;
+            }
+            else
+                return Fail( "unknown descriptor range type '" + name + "'" );
+
+            if ( !parsed )
+                return false;
+
+            // the runtime rejects tables which mix samplers with other descriptors, because they live in different heaps
+            if ( !param.ranges.empty() && (param.ranges[0].type == RangeType::SAMPLER) != (range.type == RangeType::SAMPLER) )
+                return Fail( "a descriptor table can't mix samplers with CBVs, SRVs or UAVs" );
+            param.ranges.push_back( range );
+        } while ( Accept( ',' ) );
+    }
+    return Expect( ')' );
+}
+
+bool Parser::ParseStaticSampler( StaticSampler& sampler )
+{
+    bool haveRegister = false;
+
+    if ( !Expect( '(' ) )
+        return false;
+    do
+    {
+        if ( IsRegister( 's' ) && !haveRegister )
+        {
+            haveRegister = ParseRegister( 's',sampler.reg );
+            continue;
+        }
+
+        std::string name;
+        if ( !ParseOption( name ) )
+            return false;
+
+        bool parsed;
+        const char* option = name.c_str();
+        if ( _stricmp( option,"filter" ) == 0 )
+        {
+            parsed = Peek().kind == Token::WORD && FindFilter( Peek().text.c_str(),sampler.filter );
+            if ( !parsed )
+                return Fail( "expected a filter" );
+            m_nNext++;
+        }
+        else if ( _stricmp( option,"addressU" ) == 0 )
+            parsed = ParseEnum( ADDRESS_MODES,"a texture address mode",sampler.address[0] );
+        else if ( _stricmp( option,"addressV" ) == 0 )
+            parsed = ParseEnum( ADDRESS_MODES,"a texture address mode",sampler.address[1] );
+        else if ( _stricmp( option,"addressW" ) == 0 )
+            parsed = ParseEnum( ADDRESS_MODES,"a texture address mode",sampler.address[2] );
+        else if ( _stricmp( option,"mipLODBias" ) == 0 )
+            parsed = ParseFloat( sampler.mipLODBias );
+        else if ( _stricmp( option,"maxAnisotropy" ) == 0 )
+            parsed = ParseUInt( sampler.maxAnisotropy );
+        else if ( _stricmp( option,"comparisonFunc" ) == 0 )
+            parsed = ParseEnum( COMPARISON_FUNCS,"a comparison function",sampler.comparison );
+        else if ( _stricmp( option,"borderColor" ) == 0 )
+            parsed = ParseEnum( BORDER_COLORS,"a border color",sampler.border );
+        else if ( _stricmp( option,"minLOD" ) == 0 )
+            parsed = ParseFloat( sampler.minLOD );
+        else if ( _stricmp( option,"maxLOD" ) == 0 )
+            parsed = ParseFloat( sampler.maxLOD );
+        else if ( _stricmp( option,"space" ) == 0 )
+            parsed = ParseUInt( sampler.space );
+        else if ( _stricmp( option,"visibility" ) == 0 )
+            parsed = ParseEnum( VISIBILITIES,"a shader visibility",sampler.visibility );
+        else
+            return Fail( "unknown StaticSampler option '" + name + "'" );
+
+        if ( !parsed )
+            return false;
+    } while ( Accept( ',' ) );
+
+    if ( !haveRegister )
+        return Fail( "missing 's' register" );
+    return Expect( ')' );
+}
+
+bool Parser::Parse( RootSignatureDesc& desc )
+{
+    desc.version = m_nVersion;
+    if ( Peek().kind == Token::END )
+        return true;
+
+    bool haveFlags = false;
+    do
+    {
+        std::string name;
+        if ( !ParseWord( name ) )
+            return false;
+
+        const char* element = name.c_str();
+        bool parsed;
+        RootParameter param;
+        if ( _stricmp( element,"RootFlags" ) == 0 )
+        {
+            if ( haveFlags )
+                return Fail( "RootFlags given twice" );
+            haveFlags = true;
+            if ( !ParseRootFlags( desc ) )
+                return false;
+            continue;
+        }
+        else if ( _stricmp( element,"StaticSampler" ) == 0 )
+        {
+            StaticSampler sampler;
+            if ( !ParseStaticSampler( sampler ) )
+                return false;
+            desc.samplers.push_back( sampler );
+            continue;
+        }
+        else if ( _stricmp( element,"RootConstants" ) == 0 )
+            parsed = ParseRootConstants( param );
+        else if ( _stricmp( element,"CBV" ) == 0 )
+            parsed = ParseRootDescriptor( ParameterType::CBV,'b',param );
+        else if ( _stricmp( element,"SRV" ) == 0 )
+            parsed = ParseRootDescriptor( ParameterType::SRV,'t',param );
+        else if ( _stricmp( element,"UAV" ) == 0 )
+            parsed = ParseRootDescriptor( ParameterType::UAV,'u',param );
+        else if ( _stricmp( element,"DescriptorTable" ) == 0 )
+            parsed = ParseTable( param );
+        else
+            return Fail( "unknown root signature element '" + name + "'" );
+
+        if ( !parsed )
+            return false;
+        desc.parameters.push_back( std::move( param ) );
+    } while ( Accept( ',' ) );
+
+    if ( Peek().kind != Token::END )
+        return Fail( "expected ','" );
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//  Serializer
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t FloatBits( float f )
+{
+    uint32_t bits;
+    memcpy( &bits,&f,4 );
+    return bits;
+}
+
+//
+//  RTS0 layout.  Everything is a little-endian dword, and offsets are from the start of the part:
+//
+//      header:       version, parameter count, parameter offset, static sampler count, static sampler offset, flags
+//      parameters:   type, visibility, payload offset.  One for each parameter
+//      payloads:     in parameter order.  A table is its range count and range offset, followed by its ranges
+//      samplers:     13 dwords each
+//
+//  Version 1.1 adds a flags dword to root descriptors, after the space, and to ranges, before the offset
+//
+void Serialize( const RootSignatureDesc& desc, std::vector<uint8_t>& part )
+{
+    std::vector<uint32_t> d = { desc.version,(uint32_t)desc.parameters.size(),24,(uint32_t)desc.samplers.size(),0,desc.flags };
+    bool v11 = desc.version >= 2;
+
+    size_t headers = d.size();
+    d.resize( headers + 3 * desc.parameters.size() );
+    for ( size_t i=0; i<desc.parameters.size(); i++ )
+    {
+        const RootParameter& param = desc.parameters[i];
+        d[headers + 3*i + 0] = param.type;
+        d[headers + 3*i + 1] = param.visibility;
+        d[headers + 3*i + 2] = (uint32_t)(4 * d.size());
+
+        switch ( param.type )
+        {
+        case ParameterType::TABLE:
+            d.push_back( (uint32_t)param.ranges.size() );
+            d.push_back( (uint32_t)(4 * (d.size() + 1)) );
+            for ( const DescriptorRange& range : param.ranges )
+            {
+                d.insert( d.end(),{ range.type,range.count,range.reg,range.space } );
+                if ( v11 )
+                    d.push_back( range.flags );
+                d.push_back( range.offset );
+            }
+            break;
+
+        case ParameterType::CONSTANTS:
+            d.insert( d.end(),{ param.reg,param.space,param.constants } );
+            break;
+
+        default:
+            d.insert( d.end(),{ param.reg,param.space } );
+            if ( v11 )
+                d.push_back( param.flags );
+            break;
+        }
+    }
+
+    d[4] = (uint32_t)(4 * d.size());
+    for ( const StaticSampler& s : desc.samplers )
+    {
+        d.insert( d.end(),{ s.filter,s.address[0],s.address[1],s.address[2],FloatBits( s.mipLODBias ),s.maxAnisotropy,s.comparison,
+                            s.border,FloatBits( s.minLOD ),FloatBits( s.maxLOD ),s.reg,s.space,s.visibility } );
+    }
+
+    part.resize( 4 * d.size() );
+    for ( size_t i=0; i<d.size(); i++ )
+    {
+        part[4*i + 0] = (uint8_t)(d[i]);
+        part[4*i + 1] = (uint8_t)(d[i] >> 8);
+        part[4*i + 2] = (uint8_t)(d[i] >> 16);
+        part[4*i + 3] = (uint8_t)(d[i] >> 24);
+    }
+}
+
+}
+
+bool JoinStringLiterals( const std::string& value, std::string& text )
+{
+    text.clear();
+    bool any = false;
+    size_t i = 0;
+    while ( i < value.size() )
+    {
+        if ( isspace( (unsigned char)value[i] ) )
+        {
+            i++;
+            continue;
+        }
+        if ( value[i] != '"' )
+            return false;
+
+        for ( i++; i < value.size() && value[i] != '"'; i++ )
+        {
+            if ( value[i] == '\\' && i + 1 < value.size() )
+                i++;
+            text.push_back( value[i] );
+        }
+        if ( i == value.size() )
+            return false;
+        i++;
+        any = true;
+    }
+    return any;
+}
+
+bool ResolveRootSignatureMacro( const FrontendOptions& opts, const char* sourceFile, const void* source, size_t sourceSize,
+                                std::string& text )
+{
+    if ( !opts.rs_macro )
+        return false;
+
+    // the scanner reads the shader's #includes.  A job without a shared source cache, such as a server request, reads its own
+    std::unique_ptr<SourceCache> localSources;
+    SourceCache* sources = opts.include_cache;
+    if ( !sources )
+    {
+        localSources.reset( new SourceCache() );
+        sources = localSources.get();
+    }
+
+    std::string value;
+    return ResolveMacro( *sources,sourceFile,source,sourceSize,opts.defines,opts.rs_macro,value ) && JoinStringLiterals( value,text );
+}
+
+bool CompileRootSignature( const std::string& text, const char* profile, std::vector<uint8_t>& container, std::string& error )
+{
+    uint32_t version;
+    if ( _stricmp( profile,"rootsig_1_0" ) == 0 )
+        version = 1;
+    else if ( _stricmp( profile,"rootsig_1_1" ) == 0 )
+        version = 2;
+    else
+    {
+        error = "Unsupported root signature profile: " + std::string( profile );
+        return false;
+    }
+
+    RootSignatureDesc desc;
+    Parser parser( text,version );
+    if ( !parser.Parse( desc ) )
+    {
+        error = parser.GetError();
+        return false;
+    }
+
+    std::vector<uint8_t> part;
+    Serialize( desc,part );
+
+    uint32_t fourcc = DXBCPart::RTS0;
+    ByteSpan span{ part.data(),part.size() };
+    BuildDXBCContainer( &fourcc,&span,1,container );
+    return true;
+}
+
+bool CompileRootSignatureSource( const FrontendOptions& opts, const char* sourceFile, const void* source, size_t sourceSize,
+                                 std::vector<uint8_t>& container, std::string& error )
+{
+    std::string text;
+    if ( opts.rs_macro )
+    {
+        if ( !ResolveRootSignatureMacro( opts,sourceFile,source,sourceSize,text ) )
+        {
+            error = "Unable to find a root signature in macro '" + std::string( opts.rs_macro ) + "'";
+            return false;
+        }
+    }
+    else
+    {
+        std::string raw( (const char*)source,sourceSize );
+        if ( !JoinStringLiterals( raw,text ) )
+            text = raw;
+    }
+
+    if ( !CompileRootSignature( text,opts.rs_profile,container,error ) )
+    {
+        error = std::string( sourceFile ) + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+static void ShowRootSignatureHelp()
+{
+    printf( "Usage: IntelShaderAnalyzer rootsig <source> [--rootsig_macro <name>] [--rootsig_profile <profile>]\n"
+            "                                   [-D <name>=<value> ...] [-o <output>]\n"
+            "  Compiles an HLSL root signature to a container.  With --rootsig_macro, <source> is a shader which defines it\n" );
+}
+
+int RootSignatureCommand( int argc, char* argv[] )
+{
+    FrontendOptions opts;
+    const char* output = nullptr;
+
+    // defines are split in place, the same way the main command line does it
+    for ( int i=1; i<argc; i++ )
+    {
+        const char** target = nullptr;
+        if ( strcmp( argv[i],"--rootsig_macro" ) == 0 )
+            target = &opts.rs_macro;
+        else if ( strcmp( argv[i],"--rootsig_profile" ) == 0 )
+            target = &opts.rs_profile;
+        else if ( strcmp( argv[i],"-o" ) == 0 )
+            target = &output;
+        else if ( strcmp( argv[i],"-D" ) == 0 )
+        {
+            if ( i == argc-1 )
+            {
+                printf( "Missing argument for -D\n" );
+                return 1;
+            }
+            char* name = argv[++i];
+            char* value = strchr( name,'=' );
+            if ( value )
+                *value++ = 0;
+            opts.defines.emplace_back( name,value ? value : "" );
+            continue;
+        }
+        else if ( argv[i][0] == '-' )
+        {
+            printf( "Don't understand what: '%s' means\n",argv[i] );
+            ShowRootSignatureHelp();
+            return 1;
+        }
+        else
+        {
+            opts.input_file = argv[i];
+            continue;
+        }
+
+        if ( i == argc-1 )
+        {
+            printf( "Missing argument for %s\n",argv[i] );
+            return 1;
+        }
+        *target = argv[++i];
+    }
+
+    if ( !opts.input_file )
+    {
+        printf( "No input filename\n" );
+        ShowRootSignatureHelp();
+        return 1;
+    }
+
+    if ( !opts.input_text.Load( opts.input_file ) )
+    {
+        printf( "Failed to read source from: %s\n",opts.input_file );
+        return 1;
+    }
+
+    std::vector<uint8_t> container;
+    std::string error;
+    if ( !CompileRootSignatureSource( opts,opts.input_file,opts.input_text.data(),opts.input_text.size(),container,error ) )
+    {
+        printf( "%s\n",error.c_str() );
+        return 1;
+    }
+
+    if ( output )
+    {
+        FILE* fp = fopen( output,"wb" );
+        if ( !fp )
+        {
+            printf( "Failed to open output file: %s\n",output );
+            return 1;
+        }
+        bool written = fwrite( container.data(),1,container.size(),fp ) == container.size();
+        written = (fclose( fp ) == 0) && written;
+        if ( !written )
+        {
+            printf( "Failed to write output file: %s\n",output );
+            return 1;
+        }
+    }
+
+    printf( "Root signature: %zu bytes\n",container.size() );
+    return 0;
+}
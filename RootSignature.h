@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ROOT_SIGNATURE_H_
+#define _ROOT_SIGNATURE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct FrontendOptions;
+
+//
+//  Compiler for the HLSL root signature language, e.g:
+//
+//      "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT ), CBV( b0 ), DescriptorTable( SRV( t0, numDescriptors = 4 ) ),"
+//      "StaticSampler( s0, filter = FILTER_MIN_MAG_MIP_LINEAR )"
+//
+//   The result is a container holding a serialized root signature (RTS0 part), laid out byte for byte the way D3DCompile
+//   lays it out for a rootsig_1_0 or rootsig_1_1 profile.  This lets root signatures be compiled without the D3D compiler,
+//   and much faster than a round trip through it.
+//
+//   Unspecified 1.1 flags are serialized as 0, which the runtime reads as the 1.1 defaults
+//
+
+// Joins the string literals a root signature macro expands to.  Fails if there is anything else in it
+bool JoinStringLiterals( const std::string& value, std::string& text );
+
+// Finds the root signature text defined by the macro 'opts.rs_macro', in HLSL source which need not have come from a file.
+//  Fails if the macro's value can't be worked out without running the preprocessor
+bool ResolveRootSignatureMacro( const FrontendOptions& opts, const char* sourceFile, const void* source, size_t sourceSize,
+                                std::string& text );
+
+bool CompileRootSignature( const std::string& text, const char* profile, std::vector<uint8_t>& container, std::string& error );
+
+// Compiles a root signature written in HLSL.  With 'opts.rs_macro' the source is a shader which defines it, otherwise the 
+//  source is the root signature itself, either bare or as string literals
+bool CompileRootSignatureSource( const FrontendOptions& opts, const char* sourceFile, const void* source, size_t sourceSize,
+                                 std::vector<uint8_t>& container, std::string& error );
+
+// 'rootsig' subcommand, which compiles a root signature to a file
+int RootSignatureCommand( int argc, char* argv[] );
+
+#endif
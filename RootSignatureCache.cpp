@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "RootSignatureCache.h"
+#include "DXBCContainer.h"
+#include "IntelShaderAnalyzer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// change this whenever CompileRootSignature's output changes, so that entries it wrote before are never used
+static const uint32_t KEY_VERSION = 1;
+
+// A stored entry must be a whole, intact container with a root signature in it
+static bool IsRootSignatureContainer( const InputBuffer& rootsig )
+{
+    DXBCContainer container;
+    if ( !container.Parse( rootsig.data(),rootsig.size() ) || container.GetContainer().size != rootsig.size() ||
+         !container.HasPart( DXBCPart::RTS0 ) )
+        return false;
+
+    uint8_t checksum[16];
+    ComputeDXBCChecksum( rootsig.data(),rootsig.size(),checksum );
+    return !container.HasChecksum() || memcmp( checksum,container.GetChecksum(),sizeof( checksum ) ) == 0;
+}
+
+bool RootSignatureCache::Open( const char* root )
+{
+    std::error_code ec;
+    fs::create_directories( root,ec );
+    if ( ec || !fs::is_directory( root,ec ) )
+    {
+        m_Error = "Failed to create root signature cache directory: " + std::string( root );
+        return false;
+    }
+    m_Root = root;
+    return true;
+}
+
+Hash128 RootSignatureCache::MakeKey( const std::string& rootsig, const FrontendOptions& opts, RootSignatureCompiler compiler ) const
+{
+    Hasher h;
+    h.UpdateValue( KEY_VERSION );
+    h.UpdateValue( (uint32_t)compiler );
+    h.Update( rootsig );
+    h.Update( std::string( opts.rs_profile ) );
+    if ( compiler == RootSignatureCompiler::D3D )
+    {
+        h.Update( std::string( opts.dx_location ) );
+        h.UpdateValue( opts.dx_flags );
+    }
+    return h.Finish();
+}
+
+bool RootSignatureCache::Lookup( const Hash128& key, InputBuffer& rootsig )
+{
+    std::string name = key.ToString();
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        auto it = m_Memo.find( name );
+        if ( it != m_Memo.end() )
+        {
+            rootsig = it->second;
+            m_nHits++;
+            return true;
+        }
+    }
+
+    InputBuffer stored;
+    if ( !m_Root.empty() && stored.Load( (fs::path( m_Root ) / (name + ".rts")).string().c_str() ) && IsRootSignatureContainer( stored ) )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        rootsig = m_Memo.emplace( name,stored ).first->second;
+        m_nHits++;
+        return true;
+    }
+
+    m_nMisses++;
+    return false;
+}
+
+void RootSignatureCache::Store( const Hash128& key, const void* rootsig, size_t size )
+{
+    std::string name = key.ToString();
+
+    InputBuffer copy;
+    copy.Assign( rootsig,size );
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_Memo.emplace( name,copy );
+    }
+
+    if ( m_Root.empty() )
+        return;
+
+    // stage the entry under a name no other thread or process will pick, and rename it into place.  Concurrent writers of 
+    //  the same key write the same bytes, so it doesn't matter whose rename lands last
+    fs::path path = fs::path( m_Root ) / (name + ".rts");
+    Hasher h;
+    h.UpdateValue( std::hash<std::thread::id>()( std::this_thread::get_id() ) );
+    h.UpdateValue( std::chrono::high_resolution_clock::now().time_since_epoch().count() );
+    h.UpdateValue( (uintptr_t)&h );
+    fs::path tmp = path;
+    tmp += "." + h.Finish().ToString().substr( 0,16 ) + ".tmp";
+
+    FILE* fp = fopen( tmp.string().c_str(),"wb" );
+    if ( !fp )
+        return;
+    bool written = fwrite( rootsig,1,size,fp ) == size;
+    written = (fclose( fp ) == 0) && written;
+
+    std::error_code ec;
+    if ( written )
+        fs::rename( tmp,path,ec );
+    if ( !written || ec )
+        fs::remove( tmp,ec );
+}
+
+void RootSignatureCache::PrintStats() const
+{
+    size_t lookups = m_nHits + m_nMisses;
+    if ( lookups + m_nUncacheable == 0 )
+        return;
+
+    printf( "Root signature cache: %zu lookups, %zu hits, %zu misses (%.1f%% hit rate), %zu not cacheable\n",
+            lookups,(size_t)m_nHits,(size_t)m_nMisses,lookups ? 100.0 * m_nHits / lookups : 0.0,(size_t)m_nUncacheable );
+}
@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _ROOT_SIGNATURE_CACHE_H_
+#define _ROOT_SIGNATURE_CACHE_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Hash.h"
+#include "InputBuffer.h"
+
+struct FrontendOptions;
+
+//
+//  Remembers root signatures compiled from HLSL with --rootsig_macro, so that shaders which share a root signature
+//   don't each pay for a second run of the HLSL compiler.
+//
+//  The key is the root signature text, with every macro it refers to expanded, the root signature profile, and what
+//   compiled it:  the native serializer, or the D3D compiler and its flags.  Shaders whose macro can't be resolved without
+//   the preprocessor are compiled every time.  Root signatures are kept in memory, and optionally in a directory:
+//   <root>/<32 hex digits>.rts
+//
+enum class RootSignatureCompiler
+{
+    NATIVE,     // CompileRootSignature
+    D3D,        // D3DCompile
+};
+
+class RootSignatureCache
+{
+public:
+    // Persist root signatures in a directory.  Without this, they only last as long as the process
+    bool Open( const char* root );
+    const std::string& GetError() const { return m_Error; }
+
+    // 'rootsig' is the text found by ResolveRootSignatureMacro.  Shaders where that fails should be counted as uncacheable
+    Hash128 MakeKey( const std::string& rootsig, const FrontendOptions& opts, RootSignatureCompiler compiler ) const;
+    void CountUncacheable() { m_nUncacheable++; }
+
+    // Entries on disk which aren't a container holding a root signature are misses
+    bool Lookup( const Hash128& key, InputBuffer& rootsig );
+    void Store( const Hash128& key, const void* rootsig, size_t size );
+
+    // Prints nothing if no shader asked for a root signature
+    void PrintStats() const;
+
+private:
+    std::string m_Root;
+    std::string m_Error;
+
+    std::mutex m_Mutex;
+    std::unordered_map< std::string,InputBuffer > m_Memo;
+
+    std::atomic<size_t> m_nHits{ 0 };
+    std::atomic<size_t> m_nMisses{ 0 };
+    std::atomic<size_t> m_nUncacheable{ 0 };
+};
+
+#endif
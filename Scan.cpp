@@ -0,0 +1,226 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "IntelShaderAnalyzer.h"
+#include "DXBCContainer.h"
+#include "DependencyDatabase.h"
+#include "Hash.h"
+#include "IsaStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+namespace fs = std::filesystem;
+
+//
+//  A scan compiles every shader container found in a directory tree, such as a game capture or a dump of a pipeline cache.
+//   These hold the same shaders many times over, so files are grouped by the program they contain, and each program is only
+//   compiled once, from the first of its files.  Its results are named after the program, and the summary maps every file
+//   to the program it contains, and so to its results.
+//
+//  Files are recognized by the container magic, whatever they are called, and both DXBC and DXIL shaders are accepted.  Other
+//   containers, such as serialized root signatures, are ignored.  A program is identified by the checksum in its container's
+//   header, which covers the whole container, so files need not be hashed.  Containers which weren't signed have no checksum,
+//   so those are identified by a hash of their contents instead.  Contents aren't kept:  the first file of each program is
+//   read again when it is compiled.  The name of every file in the tree is kept, to sort the walk and for the summary, so
+//   memory grows with the number of files, though not with their size
+//
+
+struct ScannedProgram
+{
+    Hash128 key;
+    std::vector<std::string> files;     // sorted.  The first is compiled
+    bool succeeded = false;
+    bool up_to_date = false;
+    double milliseconds = 0;
+};
+
+// Reads a file, if it holds a shader container, and finds which program is in it
+static bool ReadContainer( const std::string& path, InputBuffer& contents, Hash128& key )
+{
+    // most files in a capture aren't shaders, so look at the magic before reading the rest
+    uint8_t header[32];
+    FILE* fp = fopen( path.c_str(),"rb" );
+    if ( !fp )
+        return false;
+    size_t size = fread( header,1,sizeof( header ),fp );
+    fclose( fp );
+    bool sniffed = IsDXBCContainer( header,size );
+
+    if ( !sniffed || !contents.Load( path.c_str() ) )
+        return false;
+
+    DXBCContainer container;
+    if ( !container.Parse( contents.data(),contents.size() ) )
+    {
+        printf( "Skipping malformed container: %s (%s)\n",path.c_str(),container.GetError() );
+        return false;
+    }
+
+    if ( !container.HasPart( DXBCPart::SHEX ) && !container.HasPart( DXBCPart::SHDR ) && !container.HasPart( DXBCPart::DXIL ) )
+        return false;
+
+    if ( container.HasChecksum() )
+    {
+        memcpy( &key.lo,container.GetChecksum(),sizeof( key.lo ) );
+        memcpy( &key.hi,container.GetChecksum() + sizeof( key.lo ),sizeof( key.hi ) );
+    }
+    else
+    {
+        ByteSpan whole = container.GetContainer();
+        key = Hasher::Compute( whole.data,whole.size );
+    }
+    return true;
+}
+
+static bool WriteScanSummary( const char* summary_file, const char* api, const std::vector<ScannedProgram>& programs )
+{
+    // one line per file, sorted by file, so that the files sharing a result can be found from either end
+    std::vector< std::pair<const std::string*,const ScannedProgram*> > files;
+    for ( const ScannedProgram& program : programs )
+        for ( const std::string& file : program.files )
+            files.emplace_back( &file,&program );
+    std::sort( files.begin(),files.end(), []( const auto& a, const auto& b ) { return *a.first < *b.first; } );
+
+    FILE* fp = fopen( summary_file,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open summary file: %s\n",summary_file );
+        return false;
+    }
+
+    fprintf( fp,"program,status,api,milliseconds,input\n" );
+    for ( const auto& file : files )
+    {
+        const ScannedProgram& p = *file.second;
+        const char* status = p.up_to_date ? "up-to-date" : p.succeeded ? "ok" : "failed";
+        fprintf( fp,"%s,%s,%s,%.3f,",p.key.ToString().c_str(),status,api,p.milliseconds );
+        WriteCsvString( fp,*file.first );
+        fputc( '\n',fp );
+    }
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write summary file: %s\n",summary_file );
+    return succeeded;
+}
+
+bool RunScan( ToolContext& ctx, const JobOptions& defaults, const char* directory, const char* summary_file )
+{
+    auto scanStart = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::string> files;
+    std::error_code ec;
+    for ( fs::recursive_directory_iterator it( directory,fs::directory_options::skip_permission_denied,ec ), end;
+          !ec && it != end; it.increment( ec ) )
+    {
+        if ( it->is_regular_file( ec ) )
+            files.push_back( it->path().generic_string() );
+    }
+    if ( ec )
+    {
+        printf( "Failed to read directory: %s\n",directory );
+        return false;
+    }
+
+    // sorted, so that which file of a program is compiled, and the order results are written in, don't depend on the file system
+    std::sort( files.begin(),files.end() );
+
+    std::vector<ScannedProgram> programs;
+    std::map<Hash128,size_t> known;
+    size_t nContainers = 0;
+    for ( const std::string& file : files )
+    {
+        InputBuffer contents;
+        Hash128 key;
+        if ( !ReadContainer( file,contents,key ) )
+            continue;
+
+        nContainers++;
+        auto it = known.find( key );
+        if ( it != known.end() )
+        {
+            programs[it->second].files.push_back( file );
+            continue;
+        }
+
+        known.emplace( key,programs.size() );
+        programs.emplace_back();
+        programs.back().key = key;
+        programs.back().files.push_back( file );
+    }
+
+    printf( "Scan: %zu files, %zu containers, %zu programs\n",files.size(),nContainers,programs.size() );
+
+    size_t nFailed = 0;
+    size_t nUpToDate = 0;
+    for ( ScannedProgram& program : programs )
+    {
+        auto jobStart = std::chrono::high_resolution_clock::now();
+
+        std::string prefix = std::string( defaults.inputs.isa_prefix ? defaults.inputs.isa_prefix : "" ) + program.key.ToString() + "_";
+
+        JobOptions job = defaults;
+        job.source_lang = "dxbc";
+        job.frontend.input_file = program.files[0].c_str();
+        job.inputs.isa_prefix = prefix.c_str();
+
+        DependencyRecord record;
+        program.up_to_date = ctx.deps && ctx.deps->Check( job,record );
+        if ( program.up_to_date )
+        {
+            program.succeeded = true;
+            nUpToDate++;
+        }
+        else
+        {
+            program.succeeded = PrepareInputs( job ) && RunJob( ctx,job );
+            if ( ctx.deps && program.succeeded )
+                ctx.deps->Update( record,job );
+            else if ( ctx.deps )
+                ctx.deps->Remove( record.key );
+        }
+
+        auto jobEnd = std::chrono::high_resolution_clock::now();
+        program.milliseconds = std::chrono::duration<double,std::milli>( jobEnd - jobStart ).count();
+
+        if ( !program.succeeded )
+        {
+            printf( "Program %s failed: %s\n",program.key.ToString().c_str(),program.files[0].c_str() );
+            nFailed++;
+        }
+    }
+
+    auto scanEnd = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>( scanEnd - scanStart ).count();
+
+    printf( "Scan: %zu programs, %zu succeeded",programs.size(),programs.size() - nFailed );
+    if ( ctx.deps )
+        printf( " (%zu up to date)",nUpToDate );
+    printf( ", %zu failed in %.2fs\n",nFailed,seconds );
+
+    // results are named after programs, so they can't be found without the summary.  It is written next to them by default
+    std::string defaultSummary = std::string( defaults.inputs.isa_prefix ? defaults.inputs.isa_prefix : "" ) + "scan.csv";
+    if ( !WriteScanSummary( summary_file ? summary_file : defaultSummary.c_str(),defaults.api,programs ) )
+        return false;
+
+    return nFailed == 0;
+}
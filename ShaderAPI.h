@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _SHADER_API_H_
+#define _SHADER_API_H_
+
+#include <cstdio>
+#include "IntelShaderAnalyzer.h"
+
+// Wrappers around the per-API halves of the compiler function table
+class API
+{
+public:
+    virtual const char* GetName() const = 0;
+    virtual bool CanRun( ToolInputs& opts ) = 0;
+    virtual bool CreateCompiler( IntelGPUCompiler::Platform platformID,IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler ) = 0;    
+    virtual bool CreateShader( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler,IntelGPUCompiler::OpaqueShader& output,ToolInputs& opts ) = 0;
+    virtual void DeleteShader( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueShader& shader ) = 0;
+    virtual void DeleteCompiler( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler ) = 0;
+};
+
+class API_DX11 : public API
+{
+public:
+    virtual const char* GetName() const override
+    {
+        return "dx11";
+    }
+
+    virtual bool CanRun( ToolInputs& opts ) override
+    {
+        if ( opts.bytecode.empty() )
+        {
+            LogMessage( opts,"Missing shader bytecode" );
+            return false;
+        }
+        return true;
+    }
+
+    virtual bool CreateCompiler( IntelGPUCompiler::Platform platformID, IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler ) override
+    {
+        return functionTable.interface1.pfnDX11.pfnCreateCompiler( platformID,compiler );
+    }
+
+    virtual bool CreateShader( IntelGPUCompiler::SFunctionTable& functionTable, IntelGPUCompiler::OpaqueCompiler& compiler, IntelGPUCompiler::OpaqueShader& output,ToolInputs& opts ) override
+    {
+        IntelGPUCompiler::ShaderInput_DX11_V1 input;
+        input.DXBCBin = (void*)opts.bytecode.data();
+        return functionTable.interface1.pfnDX11.pfnCreateShader( compiler,input,output );
+    }
+
+    virtual void DeleteCompiler( IntelGPUCompiler::SFunctionTable& functionTable, IntelGPUCompiler::OpaqueCompiler& compiler ) override
+    {
+        functionTable.interface1.pfnDX11.pfnDeleteShaderCompiler( compiler );
+    }
+
+    virtual void DeleteShader( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueShader& shader ) override
+    {
+        functionTable.interface1.pfnDX11.pfnDeleteShader( shader );
+    }
+};
+
+class API_DX12 : public API
+{
+public:
+    virtual const char* GetName() const override
+    {
+        return "dx12";
+    }
+
+    virtual bool CanRun( ToolInputs& opts ) override
+    {
+        if ( opts.bytecode.empty() )
+        {
+            LogMessage( opts,"Missing shader bytecode" );
+            return false;
+        }
+        if ( opts.rootsig.empty() )
+        {
+            LogMessage( opts,"Missing root signature" );
+            return false;
+        }
+        return true;
+    }
+
+    virtual bool CreateCompiler( IntelGPUCompiler::Platform platformID,IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler ) override
+    {
+        return functionTable.interface1.pfnDX12.pfnCreateCompiler( platformID,compiler );
+    }
+
+    virtual bool CreateShader( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler,IntelGPUCompiler::OpaqueShader& output,ToolInputs& opts ) override
+    {
+        IntelGPUCompiler::ShaderInput_DX12_V1 input;
+        input.DXBCBin = (void*)opts.bytecode.data();
+        input.rootSignature = (void*)opts.rootsig.data();
+        input.rootSignatureSize = opts.rootsig.size();
+        return functionTable.interface1.pfnDX12.pfnCreateShader( compiler,input,output );
+    }
+
+    virtual void DeleteCompiler( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueCompiler& compiler ) override
+    {
+        functionTable.interface1.pfnDX12.pfnDeleteShaderCompiler( compiler );
+    }
+
+    virtual void DeleteShader( IntelGPUCompiler::SFunctionTable& functionTable,IntelGPUCompiler::OpaqueShader& shader ) override
+    {
+        functionTable.interface1.pfnDX12.pfnDeleteShader( shader );
+    }
+};
+
+// Returns a shared instance of the wrapper for the named API, or null if the name is not recognized
+API* GetAPI( const char* name );
+
+#endif
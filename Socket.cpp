@@ -0,0 +1,442 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "Socket.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#include <io.h>
+
+#pragma comment( lib,"ws2_32.lib" )
+
+typedef SOCKET NativeSocket;
+#define INVALID_NATIVE_SOCKET INVALID_SOCKET
+
+static int GetSocketError()              { return WSAGetLastError(); }
+static void CloseNativeSocket( SOCKET s ) { closesocket( s ); }
+static int PollSocket( WSAPOLLFD* fds, int timeoutMs ) { return WSAPoll( fds,1,timeoutMs ); }
+static void RemoveSocketFile( const char* path ) { _unlink( path ); }
+static bool Interrupted()                { return false; }
+typedef WSAPOLLFD PollFd;
+
+// Winsock must be initialized once per process, before the first socket is created
+static bool StartSockets()
+{
+    static bool started = []()
+    {
+        WSADATA data;
+        return WSAStartup( MAKEWORD( 2,2 ),&data ) == 0;
+    }();
+    return started;
+}
+
+#else
+
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef int NativeSocket;
+#define INVALID_NATIVE_SOCKET (-1)
+
+static int GetSocketError()              { return errno; }
+static void CloseNativeSocket( int s )   { close( s ); }
+static int PollSocket( pollfd* fds, int timeoutMs ) { return poll( fds,1,timeoutMs ); }
+static void RemoveSocketFile( const char* path ) { unlink( path ); }
+static bool Interrupted()                { return errno == EINTR; }
+typedef pollfd PollFd;
+
+static bool StartSockets()
+{
+    return true;
+}
+
+#endif
+
+// a peer which disconnects must not kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+static bool MakeAddress( const char* path, sockaddr_un& address, std::string& error )
+{
+    memset( &address,0,sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if ( strlen( path ) >= sizeof( address.sun_path ) )
+    {
+        error = "Socket path is too long: " + std::string( path );
+        return false;
+    }
+    strcpy( address.sun_path,path );
+    return true;
+}
+
+static NativeSocket CreateSocket( std::string& error, int family = AF_UNIX )
+{
+    if ( !StartSockets() )
+    {
+        error = "Failed to initialize sockets";
+        return INVALID_NATIVE_SOCKET;
+    }
+
+    NativeSocket s = socket( family,SOCK_STREAM,0 );
+    if ( s == INVALID_NATIVE_SOCKET )
+        error = "Failed to create socket, error " + std::to_string( GetSocketError() );
+    return s;
+}
+
+// Messages are small and answered at once, so they mustn't wait to be combined with later ones
+static void SetNoDelay( NativeSocket s )
+{
+    int on = 1;
+    setsockopt( s,IPPROTO_TCP,TCP_NODELAY,(const char*)&on,sizeof( on ) );
+}
+
+// Looks up a 'host:port' address.  The result must be freed with freeaddrinfo
+static addrinfo* ResolveAddress( const char* address, bool listening, std::string& error )
+{
+    if ( !StartSockets() )
+    {
+        error = "Failed to initialize sockets";
+        return nullptr;
+    }
+
+    std::string host = address;
+    size_t colon = host.rfind( ':' );
+    if ( colon == std::string::npos || colon + 1 == host.size() )
+    {
+        error = "Expected host:port, not: " + host;
+        return nullptr;
+    }
+    std::string port = host.substr( colon + 1 );
+    host.resize( colon );
+    if ( host.size() >= 2 && host.front() == '[' && host.back() == ']' )
+        host = host.substr( 1,host.size() - 2 );
+
+    addrinfo hints;
+    memset( &hints,0,sizeof( hints ) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = listening ? AI_PASSIVE : 0;
+
+    addrinfo* result = nullptr;
+    int status = getaddrinfo( host.empty() ? nullptr : host.c_str(),port.c_str(),&hints,&result );
+    if ( status != 0 )
+    {
+        error = "Failed to resolve: " + std::string( address ) + ", " + gai_strerror( status );
+        return nullptr;
+    }
+    return result;
+}
+
+Socket::~Socket()
+{
+    Close();
+}
+
+Socket::Socket( Socket&& other )
+{
+    *this = std::move( other );
+}
+
+Socket& Socket::operator=( Socket&& other )
+{
+    if ( this != &other )
+    {
+        Close();
+        m_Handle = other.m_Handle;
+        m_bTcp = other.m_bTcp;
+        m_Path = std::move( other.m_Path );
+        m_Error = std::move( other.m_Error );
+        other.m_Handle = -1;
+        other.m_Path.clear();
+    }
+    return *this;
+}
+
+bool Socket::IsOpen() const
+{
+    return m_Handle != -1;
+}
+
+void Socket::Close()
+{
+    if ( IsOpen() )
+        CloseNativeSocket( (NativeSocket)m_Handle );
+    m_Handle = -1;
+    m_bTcp = false;
+
+    if ( !m_Path.empty() )
+        RemoveSocketFile( m_Path.c_str() );
+    m_Path.clear();
+}
+
+bool Socket::Listen( const char* path, int backlog )
+{
+    Close();
+
+    sockaddr_un address;
+    if ( !MakeAddress( path,address,m_Error ) )
+        return false;
+
+    // the file outlives a server which was killed.  Only replace it if nobody answers
+    {
+        Socket probe;
+        if ( probe.Connect( path,0 ) )
+        {
+            m_Error = "Another server is already listening on: " + std::string( path );
+            return false;
+        }
+    }
+    RemoveSocketFile( path );
+
+    NativeSocket s = CreateSocket( m_Error );
+    if ( s == INVALID_NATIVE_SOCKET )
+        return false;
+
+    if ( bind( s,(const sockaddr*)&address,sizeof( address ) ) != 0 ||
+         listen( s,backlog ) != 0 )
+    {
+        m_Error = "Failed to listen on: " + std::string( path ) + ", error " + std::to_string( GetSocketError() );
+        CloseNativeSocket( s );
+        return false;
+    }
+
+    m_Handle = (intptr_t)s;
+    m_Path = path;
+    return true;
+}
+
+bool Socket::ListenTcp( const char* address, int backlog )
+{
+    Close();
+
+    addrinfo* addresses = ResolveAddress( address,true,m_Error );
+    if ( !addresses )
+        return false;
+
+    for ( addrinfo* ai = addresses; ai && !IsOpen(); ai = ai->ai_next )
+    {
+        NativeSocket s = CreateSocket( m_Error,ai->ai_family );
+        if ( s == INVALID_NATIVE_SOCKET )
+            continue;
+
+#ifndef _WIN32
+        // a restarted coordinator mustn't have to wait for the last one's connections to time out.  On Windows this
+        //  would let two listeners share the port instead
+        int on = 1;
+        setsockopt( s,SOL_SOCKET,SO_REUSEADDR,(const char*)&on,sizeof( on ) );
+#endif
+
+        if ( bind( s,ai->ai_addr,(int)ai->ai_addrlen ) != 0 || listen( s,backlog ) != 0 )
+        {
+            m_Error = "Failed to listen on: " + std::string( address ) + ", error " + std::to_string( GetSocketError() );
+            CloseNativeSocket( s );
+            continue;
+        }
+
+        m_Handle = (intptr_t)s;
+        m_bTcp = true;
+    }
+
+    freeaddrinfo( addresses );
+    return IsOpen();
+}
+
+bool Socket::ConnectTcp( const char* address, int timeoutMs )
+{
+    Close();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMs );
+    for ( ;; )
+    {
+        addrinfo* addresses = ResolveAddress( address,false,m_Error );
+        for ( addrinfo* ai = addresses; ai && !IsOpen(); ai = ai->ai_next )
+        {
+            NativeSocket s = CreateSocket( m_Error,ai->ai_family );
+            if ( s == INVALID_NATIVE_SOCKET )
+                continue;
+
+            if ( connect( s,ai->ai_addr,(int)ai->ai_addrlen ) != 0 )
+            {
+                m_Error = "Failed to connect to: " + std::string( address ) + ", error " + std::to_string( GetSocketError() );
+                CloseNativeSocket( s );
+                continue;
+            }
+
+            SetNoDelay( s );
+            m_Handle = (intptr_t)s;
+            m_bTcp = true;
+        }
+        if ( addresses )
+            freeaddrinfo( addresses );
+
+        // the coordinator may still be starting up
+        if ( IsOpen() )
+            return true;
+        if ( std::chrono::steady_clock::now() >= deadline )
+            return false;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    }
+}
+
+int Socket::GetPort() const
+{
+    sockaddr_storage address;
+    socklen_t size = sizeof( address );
+    if ( !m_bTcp || getsockname( (NativeSocket)m_Handle,(sockaddr*)&address,&size ) != 0 )
+        return 0;
+
+    if ( address.ss_family == AF_INET6 )
+        return ntohs( ((const sockaddr_in6*)&address)->sin6_port );
+    return ntohs( ((const sockaddr_in*)&address)->sin_port );
+}
+
+bool Socket::SetSendTimeout( int timeoutMs )
+{
+#ifdef _WIN32
+    DWORD timeout = (DWORD)timeoutMs;
+#else
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+    if ( setsockopt( (NativeSocket)m_Handle,SOL_SOCKET,SO_SNDTIMEO,(const char*)&timeout,sizeof( timeout ) ) != 0 )
+    {
+        m_Error = "setsockopt failed with error " + std::to_string( GetSocketError() );
+        return false;
+    }
+    return true;
+}
+
+bool Socket::Poll( int timeoutMs )
+{
+    PollFd fd;
+    fd.fd = (NativeSocket)m_Handle;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    return PollSocket( &fd,timeoutMs ) > 0;
+}
+
+bool Socket::Accept( Socket& client, int timeoutMs )
+{
+    if ( !Poll( timeoutMs ) )
+        return false;
+
+    NativeSocket s = accept( (NativeSocket)m_Handle,nullptr,nullptr );
+    if ( s == INVALID_NATIVE_SOCKET )
+    {
+        m_Error = "accept failed with error " + std::to_string( GetSocketError() );
+        return false;
+    }
+
+    client.Close();
+    client.m_Handle = (intptr_t)s;
+    client.m_bTcp = m_bTcp;
+    if ( m_bTcp )
+        SetNoDelay( s );
+    return true;
+}
+
+bool Socket::Connect( const char* path, int timeoutMs )
+{
+    Close();
+
+    sockaddr_un address;
+    if ( !MakeAddress( path,address,m_Error ) )
+        return false;
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMs );
+    for ( ;; )
+    {
+        NativeSocket s = CreateSocket( m_Error );
+        if ( s == INVALID_NATIVE_SOCKET )
+            return false;
+
+        if ( connect( s,(const sockaddr*)&address,sizeof( address ) ) == 0 )
+        {
+            m_Handle = (intptr_t)s;
+            return true;
+        }
+
+        m_Error = "Failed to connect to: " + std::string( path ) + ", error " + std::to_string( GetSocketError() );
+        CloseNativeSocket( s );
+
+        // the server may still be starting up
+        if ( std::chrono::steady_clock::now() >= deadline )
+            return false;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+}
+
+bool Socket::Read( void* data, size_t size )
+{
+    char* p = (char*)data;
+    while ( size > 0 )
+    {
+        int chunk = (int)std::min<size_t>( size,1 << 30 );
+        int n = (int)recv( (NativeSocket)m_Handle,p,chunk,0 );
+        if ( n < 0 && Interrupted() )
+            continue;
+        if ( n <= 0 )
+        {
+            if ( n < 0 )
+                m_Error = "recv failed with error " + std::to_string( GetSocketError() );
+            else
+                m_Error = (p == (char*)data) ? "Connection closed" : "Unexpected end of input";
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+bool Socket::Write( const void* data, size_t size )
+{
+    const char* p = (const char*)data;
+    while ( size > 0 )
+    {
+        int chunk = (int)std::min<size_t>( size,1 << 30 );
+        int n = (int)send( (NativeSocket)m_Handle,p,chunk,SEND_FLAGS );
+        if ( n < 0 && Interrupted() )
+            continue;
+        if ( n <= 0 )
+        {
+            m_Error = "send failed with error " + std::to_string( GetSocketError() );
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _SOCKET_H_
+#define _SOCKET_H_
+
+#include "ByteStream.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//
+//  A local (unix domain) stream socket.  Windows 10 supports these as well, through Winsock.  TCP sockets are for talking to
+//    other machines.  Sockets are closed on destruction.  Reads and writes block, and always transfer the whole buffer
+//
+class Socket : public ByteStream
+{
+public:
+    Socket() {}
+    ~Socket();
+
+    Socket( Socket&& other );
+    Socket& operator=( Socket&& other );
+    Socket( const Socket& ) = delete;
+    Socket& operator=( const Socket& ) = delete;
+
+    bool IsOpen() const;
+    void Close();
+
+    // Creates the socket file and listens on it.  A stale socket file left by a dead server is replaced.
+    //   Fails if another server is still listening on the path
+    bool Listen( const char* path, int backlog );
+
+    // Waits up to timeoutMs for a connection.  Returns false on timeout, or on error
+    bool Accept( Socket& client, int timeoutMs );
+
+    // Waits up to timeoutMs for data, or for the peer to hang up.  Returns false on timeout
+    bool Poll( int timeoutMs );
+
+    // Retries until the server is listening, or timeoutMs has passed
+    bool Connect( const char* path, int timeoutMs );
+
+    // TCP versions of the above.  'address' is 'host:port', where an IPv6 host is in brackets.  With no host, a listener
+    //   accepts connections on any interface, and with port 0 it picks a free port, which GetPort returns
+    bool ListenTcp( const char* address, int backlog );
+    bool ConnectTcp( const char* address, int timeoutMs );
+    int GetPort() const;
+
+    // Makes a write fail once it has made no progress for timeoutMs, instead of blocking until the peer reads
+    bool SetSendTimeout( int timeoutMs );
+
+    // False on error, or if the peer closed the connection first
+    virtual bool Read( void* data, size_t size ) override;
+    virtual bool Write( const void* data, size_t size ) override;
+
+    virtual const std::string& GetError() const override { return m_Error; }
+
+private:
+    intptr_t m_Handle = -1;
+    bool m_bTcp = false;
+    std::string m_Path;     // removed when a listening socket is closed
+    std::string m_Error;
+};
+
+#endif
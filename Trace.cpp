@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static const char* STAGE_NAMES[] =
+{
+    "read_input",
+    "load_compiler",
+    "load_d3d",
+    "d3d_compile",
+    "compile_rootsig",
+    "extract_rootsig",
+    "cache_lookup",
+    "create_compiler",
+    "create_shader",
+    "get_isa",
+    "analyze",
+    "write_output",
+};
+static_assert( sizeof( STAGE_NAMES ) / sizeof( STAGE_NAMES[0] ) == (size_t)TraceStage::COUNT,"a stage is missing its name" );
+
+Tracer::Tracer() : m_Start( Clock::now() )
+{
+}
+
+void Tracer::Record( TraceStage stage, const TraceLabel& label, Clock::time_point start, Clock::time_point end )
+{
+    Span span;
+    span.stage = stage;
+    span.shader = label.shader ? label.shader : "";
+    span.api = label.api;
+    span.platform = label.platform;
+    span.start = std::chrono::duration<double,std::micro>( start - m_Start ).count();
+    span.duration = std::chrono::duration<double,std::micro>( end - start ).count();
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    auto thread = m_Threads.emplace( std::this_thread::get_id(),(uint32_t)m_Threads.size() + 1 ).first;
+    span.thread = thread->second;
+    m_Spans.push_back( std::move( span ) );
+}
+
+bool Tracer::WriteChromeTrace( const char* path )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+
+    FILE* fp = fopen( path,"w" );
+    if ( !fp )
+    {
+        printf( "Failed to open trace file: %s\n",path );
+        return false;
+    }
+
+    // complete events ('X'), one per span.  Timestamps are in microseconds
+    fprintf( fp,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+    for ( size_t i=0; i<m_Spans.size(); i++ )
+    {
+        const Span& s = m_Spans[i];
+        fprintf( fp,"{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+                 STAGE_NAMES[(size_t)s.stage],s.thread,s.start,s.duration );
+
+        const char* separator = "";
+        if ( !s.shader.empty() )
+        {
+            fprintf( fp,"\"shader\":" );
+            WriteJsonString( fp,s.shader );
+            separator = ",";
+        }
+        if ( s.api )
+        {
+            fprintf( fp,"%s\"api\":\"%s\"",separator,s.api );
+            separator = ",";
+        }
+        if ( s.platform )
+            fprintf( fp,"%s\"platform\":\"%s\"",separator,s.platform );
+        fprintf( fp,"}}%s\n",(i+1 < m_Spans.size()) ? "," : "" );
+    }
+    fprintf( fp,"]}\n" );
+
+    bool succeeded = !ferror( fp );
+    succeeded = (fclose( fp ) == 0) && succeeded;
+    if ( !succeeded )
+        printf( "Failed to write trace file: %s\n",path );
+    return succeeded;
+}
+
+bool Tracer::WriteSummary( StatsFormat format, const char* path )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+
+    std::vector<double> durations[(size_t)TraceStage::COUNT];
+    for ( const Span& s : m_Spans )
+        durations[(size_t)s.stage].push_back( s.duration / 1000.0 );
+
+    FILE* fp = stdout;
+    if ( path )
+    {
+        fp = fopen( path,"w" );
+        if ( !fp )
+        {
+            printf( "Failed to open timing file: %s\n",path );
+            return false;
+        }
+    }
+
+    if ( format == StatsFormat::JSON )
+        fprintf( fp,"[\n" );
+    else
+        fprintf( fp,"stage,count,total_ms,min_ms,mean_ms,p95_ms,max_ms\n" );
+
+    // stages which never ran are left out
+    bool first = true;
+    for ( size_t stage=0; stage<(size_t)TraceStage::COUNT; stage++ )
+    {
+        std::vector<double>& d = durations[stage];
+        if ( d.empty() )
+            continue;
+
+        std::sort( d.begin(),d.end() );
+        double total = 0;
+        for ( double ms : d )
+            total += ms;
+
+        // nearest-rank percentile
+        size_t rank = (size_t)std::ceil( 0.95 * d.size() );
+        double p95 = d[std::max<size_t>( rank,1 ) - 1];
+
+        if ( format == StatsFormat::JSON )
+        {
+            fprintf( fp,"%s  { \"stage\": \"%s\", \"count\": %zu, \"total_ms\": %.3f, \"min_ms\": %.3f, \"mean_ms\": %.3f, "
+                        "\"p95_ms\": %.3f, \"max_ms\": %.3f }",first ? "" : ",\n",STAGE_NAMES[stage],d.size(),total,d.front(),
+                     total / d.size(),p95,d.back() );
+        }
+        else
+        {
+            fprintf( fp,"%s,%zu,%.3f,%.3f,%.3f,%.3f,%.3f\n",STAGE_NAMES[stage],d.size(),total,d.front(),total / d.size(),p95,d.back() );
+        }
+        first = false;
+    }
+
+    if ( format == StatsFormat::JSON )
+        fprintf( fp,"%s]\n",first ? "" : "\n" );
+
+    bool succeeded = !ferror( fp );
+    if ( path )
+        succeeded = (fclose( fp ) == 0) && succeeded;
+    else
+        fflush( fp );
+
+    if ( !succeeded )
+        printf( "Failed to write timing\n" );
+    return succeeded;
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "IsaStats.h"
+
+// The stages of the tool that are timed.  Names are in Trace.cpp
+enum class TraceStage
+{
+    READ_INPUT,         // reading the shader, bytecode or root signature file
+    LOAD_COMPILER,      // loading the GPU compiler library
+    LOAD_D3D,           // loading the D3D compiler DLL
+    D3D_COMPILE,        // D3DCompile, for the shader and for root signatures the native compiler can't handle
+    COMPILE_ROOTSIG,    // the native root signature compiler
+    EXTRACT_ROOTSIG,    // finding the root signature part in a container
+    CACHE_LOOKUP,       // ISA cache lookups
+    CREATE_COMPILER,    // creating a compiler context, when the pool has none to spare
+    CREATE_SHADER,
+    GET_ISA,            // fetching the ISA text and binary
+    ANALYZE,            // --stats and --cfg
+    WRITE_OUTPUT,       // writing results to files, an archive, or a client
+    COUNT
+};
+
+class Tracer;
+
+// What a span of time was spent on.  Any of the names may be null.  With a null tracer nothing is recorded
+struct TraceLabel
+{
+    Tracer* tracer       = nullptr;
+    const char* shader   = nullptr;
+    const char* api      = nullptr;
+    const char* platform = nullptr;
+};
+
+//
+//  Collects timed spans from every thread, and writes them out when the tool is done:  either every span, in the Chrome 
+//   trace event format which chrome://tracing and Perfetto read, or a summary of each stage
+//
+class Tracer
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    Tracer();
+
+    void Record( TraceStage stage, const TraceLabel& label, Clock::time_point start, Clock::time_point end );
+
+    bool WriteChromeTrace( const char* path );
+
+    // Count, total, min, mean, 95th percentile and max duration of each stage, in milliseconds.  Writes to stdout if path is null
+    bool WriteSummary( StatsFormat format, const char* path );
+
+private:
+    struct Span
+    {
+        TraceStage stage;
+        uint32_t thread;
+        std::string shader;
+        const char* api;        // API and platform names are static
+        const char* platform;
+        double start;           // microseconds since the tracer was created
+        double duration;
+    };
+
+    Clock::time_point m_Start;
+
+    std::mutex m_Mutex;
+    std::vector<Span> m_Spans;
+    std::unordered_map< std::thread::id,uint32_t > m_Threads;   // small numbers are easier to read in a trace viewer
+};
+
+// Times the enclosing scope.  Costs a test of the tracer pointer when tracing is off
+class TraceScope
+{
+public:
+    TraceScope( const TraceLabel& label, TraceStage stage ) : m_Label( label ), m_Stage( stage )
+    {
+        if ( m_Label.tracer )
+            m_Start = Tracer::Clock::now();
+    }
+
+    ~TraceScope()
+    {
+        if ( m_Label.tracer )
+            m_Label.tracer->Record( m_Stage,m_Label,m_Start,Tracer::Clock::now() );
+    }
+
+    TraceScope( const TraceScope& ) = delete;
+    TraceScope& operator=( const TraceScope& ) = delete;
+
+private:
+    TraceLabel m_Label;
+    TraceStage m_Stage;
+    Tracer::Clock::time_point m_Start;
+};
+
+#endif
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerProcess.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+
+#define NOMINMAX
+#include <windows.h>
+
+#else
+
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#endif
+
+// A process inherits whichever pipes are open when it starts, so a worker could end up holding another worker's pipes, and keep
+//   them open after that worker dies.  Workers are started one at a time, and each is only given its own
+static std::mutex g_StartMutex;
+
+WorkerProcess::~WorkerProcess()
+{
+    if ( IsRunning() )
+        Reap();
+}
+
+bool WorkerProcess::IsRunning() const
+{
+    return m_Process != -1;
+}
+
+void WorkerProcess::Stop()
+{
+    ClosePipes();
+    if ( IsRunning() )
+        Wait();
+}
+
+#ifdef _WIN32
+
+// Quotes an argument so that the worker's CommandLineToArgv gives it back unchanged
+static std::string QuoteArgument( const std::string& arg )
+{
+    if ( !arg.empty() && arg.find_first_of( " \t\"" ) == std::string::npos )
+        return arg;
+
+    std::string quoted = "\"";
+    size_t nBackslashes = 0;
+    for ( char c : arg )
+    {
+        if ( c == '\\' )
+        {
+            nBackslashes++;
+            continue;
+        }
+
+        // backslashes are only special in front of a quote
+        if ( c == '"' )
+            quoted.append( nBackslashes * 2 + 1,'\\' );
+        else
+            quoted.append( nBackslashes,'\\' );
+        quoted.push_back( c );
+        nBackslashes = 0;
+    }
+    quoted.append( nBackslashes * 2,'\\' );
+    quoted.push_back( '"' );
+    return quoted;
+}
+
+bool WorkerProcess::Start( const std::string& executable, const std::vector<std::string>& args, bool pipes )
+{
+    std::lock_guard<std::mutex> lock( g_StartMutex );
+
+    SECURITY_ATTRIBUTES sa = { sizeof( sa ),nullptr,TRUE };
+    HANDLE childIn, toWorker;
+    if ( !CreatePipe( &childIn,&toWorker,&sa,0 ) )
+    {
+        m_Error = "Failed to create pipe: error " + std::to_string( GetLastError() );
+        return false;
+    }
+    HANDLE fromWorker, childOut;
+    if ( !CreatePipe( &fromWorker,&childOut,&sa,0 ) )
+    {
+        m_Error = "Failed to create pipe: error " + std::to_string( GetLastError() );
+        CloseHandle( childIn );
+        CloseHandle( toWorker );
+        return false;
+    }
+
+    // the worker only inherits its own ends
+    SetHandleInformation( toWorker,HANDLE_FLAG_INHERIT,0 );
+    SetHandleInformation( fromWorker,HANDLE_FLAG_INHERIT,0 );
+
+    std::string commandLine = QuoteArgument( executable );
+    for ( const std::string& arg : args )
+        commandLine += " " + QuoteArgument( arg );
+
+    STARTUPINFOA si = {};
+    si.cb = sizeof( si );
+    si.dwFlags = STARTF_USESTDHANDLES;
+    si.hStdInput = pipes ? childIn : GetStdHandle( STD_INPUT_HANDLE );
+    si.hStdOutput = pipes ? childOut : GetStdHandle( STD_OUTPUT_HANDLE );
+    si.hStdError = GetStdHandle( STD_ERROR_HANDLE );
+
+    PROCESS_INFORMATION pi = {};
+    BOOL started = CreateProcessA( executable.c_str(),&commandLine[0],nullptr,nullptr,TRUE,0,nullptr,nullptr,&si,&pi );
+    DWORD error = GetLastError();
+
+    CloseHandle( childIn );
+    CloseHandle( childOut );
+    if ( !started )
+    {
+        m_Error = "Failed to start " + executable + ": error " + std::to_string( error );
+        CloseHandle( toWorker );
+        CloseHandle( fromWorker );
+        return false;
+    }
+
+    CloseHandle( pi.hThread );
+    m_Process = (intptr_t)pi.hProcess;
+    m_In = (intptr_t)toWorker;
+    m_Out = (intptr_t)fromWorker;
+    if ( !pipes )
+        ClosePipes();
+    return true;
+}
+
+void WorkerProcess::ClosePipes()
+{
+    if ( m_In != -1 )
+        CloseHandle( (HANDLE)m_In );
+    if ( m_Out != -1 )
+        CloseHandle( (HANDLE)m_Out );
+    m_In = -1;
+    m_Out = -1;
+}
+
+std::string WorkerProcess::Wait()
+{
+    HANDLE hProcess = (HANDLE)m_Process;
+    WaitForSingleObject( hProcess,INFINITE );
+
+    DWORD code = 0;
+    GetExitCodeProcess( hProcess,&code );
+    CloseHandle( hProcess );
+    m_Process = -1;
+
+    // crashes exit with an NTSTATUS, which is only recognizable in hex
+    char text[32];
+    snprintf( text,sizeof( text ),code > 255 ? "exit code 0x%08lX" : "exit code %lu",(unsigned long)code );
+    return text;
+}
+
+bool WorkerProcess::HasExited()
+{
+    if ( !IsRunning() || WaitForSingleObject( (HANDLE)m_Process,0 ) == WAIT_TIMEOUT )
+        return false;
+    Wait();
+    return true;
+}
+
+std::string WorkerProcess::Reap()
+{
+    ClosePipes();
+    if ( !IsRunning() )
+        return "not running";
+
+    if ( WaitForSingleObject( (HANDLE)m_Process,0 ) == WAIT_TIMEOUT )
+        TerminateProcess( (HANDLE)m_Process,1 );
+    return Wait();
+}
+
+bool WorkerProcess::Poll( int timeoutMs )
+{
+    // anonymous pipes can't be waited on, so peek until something arrives.  A broken pipe is for Read to report
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( timeoutMs );
+    for ( ;; )
+    {
+        DWORD available = 0;
+        if ( !PeekNamedPipe( (HANDLE)m_Out,nullptr,0,nullptr,&available,nullptr ) || available > 0 )
+            return true;
+        if ( std::chrono::steady_clock::now() >= deadline )
+            return false;
+        std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    }
+}
+
+bool WorkerProcess::Read( void* data, size_t size )
+{
+    uint8_t* p = (uint8_t*)data;
+    while ( size > 0 )
+    {
+        DWORD n = 0;
+        if ( !ReadFile( (HANDLE)m_Out,p,(DWORD)std::min<size_t>( size,1u << 30 ),&n,nullptr ) || n == 0 )
+        {
+            DWORD error = GetLastError();
+            if ( n != 0 && error != ERROR_BROKEN_PIPE )
+                m_Error = "Read failed: error " + std::to_string( error );
+            else
+                m_Error = (p == (uint8_t*)data) ? "Connection closed" : "Unexpected end of input";
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool WorkerProcess::Write( const void* data, size_t size )
+{
+    const uint8_t* p = (const uint8_t*)data;
+    while ( size > 0 )
+    {
+        DWORD n = 0;
+        if ( !WriteFile( (HANDLE)m_In,p,(DWORD)std::min<size_t>( size,1u << 30 ),&n,nullptr ) )
+        {
+            DWORD error = GetLastError();
+            m_Error = (error == ERROR_BROKEN_PIPE || error == ERROR_NO_DATA) ? "Connection closed" : "Write failed: error " + std::to_string( error );
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+std::string GetExecutablePath( const char* argv0 )
+{
+    char path[MAX_PATH];
+    DWORD n = GetModuleFileNameA( nullptr,path,MAX_PATH );
+    if ( n == 0 || n == MAX_PATH )
+        return argv0;
+    return std::string( path,n );
+}
+
+#else
+
+bool WorkerProcess::Start( const std::string& executable, const std::vector<std::string>& args, bool pipes )
+{
+    std::lock_guard<std::mutex> lock( g_StartMutex );
+
+    // a worker which dies must not take us with it, the next time we write to its pipe
+    signal( SIGPIPE,SIG_IGN );
+
+    int toWorker[2];
+    if ( pipe( toWorker ) != 0 )
+    {
+        m_Error = "Failed to create pipe: " + std::string( strerror( errno ) );
+        return false;
+    }
+    int fromWorker[2];
+    if ( pipe( fromWorker ) != 0 )
+    {
+        m_Error = "Failed to create pipe: " + std::string( strerror( errno ) );
+        close( toWorker[0] );
+        close( toWorker[1] );
+        return false;
+    }
+
+    // nothing may be allocated between fork and exec, so the arguments are ready beforehand
+    std::vector<char*> argv;
+    argv.push_back( const_cast<char*>( executable.c_str() ) );
+    for ( const std::string& arg : args )
+        argv.push_back( const_cast<char*>( arg.c_str() ) );
+    argv.push_back( nullptr );
+
+    pid_t pid = fork();
+    if ( pid == 0 )
+    {
+        if ( pipes )
+        {
+            dup2( toWorker[0],STDIN_FILENO );
+            dup2( fromWorker[1],STDOUT_FILENO );
+        }
+        close( toWorker[0] );
+        close( toWorker[1] );
+        close( fromWorker[0] );
+        close( fromWorker[1] );
+        execvp( executable.c_str(),argv.data() );
+        _exit( 127 );
+    }
+
+    int error = errno;
+    close( toWorker[0] );
+    close( fromWorker[1] );
+    if ( pid < 0 )
+    {
+        m_Error = "Failed to start " + executable + ": " + strerror( error );
+        close( toWorker[1] );
+        close( fromWorker[0] );
+        return false;
+    }
+
+    // later workers only inherit their own ends
+    fcntl( toWorker[1],F_SETFD,FD_CLOEXEC );
+    fcntl( fromWorker[0],F_SETFD,FD_CLOEXEC );
+
+    m_Process = pid;
+    m_In = toWorker[1];
+    m_Out = fromWorker[0];
+    if ( !pipes )
+        ClosePipes();
+    return true;
+}
+
+void WorkerProcess::ClosePipes()
+{
+    if ( m_In != -1 )
+        close( (int)m_In );
+    if ( m_Out != -1 )
+        close( (int)m_Out );
+    m_In = -1;
+    m_Out = -1;
+}
+
+std::string WorkerProcess::Wait()
+{
+    int status = 0;
+    while ( waitpid( (pid_t)m_Process,&status,0 ) < 0 && errno == EINTR )
+        ;
+    m_Process = -1;
+
+    if ( WIFSIGNALED( status ) )
+        return "signal " + std::to_string( WTERMSIG( status ) );
+    return "exit code " + std::to_string( WEXITSTATUS( status ) );
+}
+
+bool WorkerProcess::HasExited()
+{
+    int status = 0;
+    if ( !IsRunning() || waitpid( (pid_t)m_Process,&status,WNOHANG ) != (pid_t)m_Process )
+        return false;
+    m_Process = -1;
+    return true;
+}
+
+std::string WorkerProcess::Reap()
+{
+    ClosePipes();
+    if ( !IsRunning() )
+        return "not running";
+
+    // a worker which has already died keeps the status it died with
+    kill( (pid_t)m_Process,SIGKILL );
+    return Wait();
+}
+
+bool WorkerProcess::Poll( int timeoutMs )
+{
+    pollfd fd;
+    fd.fd = (int)m_Out;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    int n;
+    do
+    {
+        n = poll( &fd,1,timeoutMs );
+    } while ( n < 0 && errno == EINTR );
+    return n != 0;
+}
+
+bool WorkerProcess::Read( void* data, size_t size )
+{
+    uint8_t* p = (uint8_t*)data;
+    while ( size > 0 )
+    {
+        ssize_t n = read( (int)m_Out,p,size );
+        if ( n < 0 && errno == EINTR )
+            continue;
+        if ( n <= 0 )
+        {
+            if ( n < 0 )
+                m_Error = "Read failed: " + std::string( strerror( errno ) );
+            else
+                m_Error = (p == (uint8_t*)data) ? "Connection closed" : "Unexpected end of input";
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool WorkerProcess::Write( const void* data, size_t size )
+{
+    const uint8_t* p = (const uint8_t*)data;
+    while ( size > 0 )
+    {
+        ssize_t n = write( (int)m_In,p,size );
+        if ( n < 0 && errno == EINTR )
+            continue;
+        if ( n < 0 )
+        {
+            m_Error = (errno == EPIPE) ? "Connection closed" : "Write failed: " + std::string( strerror( errno ) );
+            return false;
+        }
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+std::string GetExecutablePath( const char* argv0 )
+{
+    // Linux can tell us.  Elsewhere, argv[0] is a path, or a name found on the PATH, which execvp searches the same way
+    char path[4096];
+    ssize_t n = readlink( "/proc/self/exe",path,sizeof( path ) );
+    if ( n <= 0 || n == (ssize_t)sizeof( path ) )
+        return argv0;
+    return std::string( path,n );
+}
+
+#endif
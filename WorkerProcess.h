@@ -0,0 +1,78 @@
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019, Intel Corporation
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+// documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to the following conditions:
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of
+// the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO
+// THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef _WORKER_PROCESS_H_
+#define _WORKER_PROCESS_H_
+
+#include "ByteStream.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+//  A child process whose stdin and stdout are pipes to this one.  Its stderr is shared with ours.
+//    Batch workers are copies of this tool, which read COMPILE messages from the pipe and answer with DONE.  See RunStream.
+//    A coordinator's local workers talk to it over a socket instead, and have no pipes.  A worker which is still running on
+//    destruction is killed
+//
+class WorkerProcess : public ByteStream
+{
+public:
+    WorkerProcess() {}
+    ~WorkerProcess();
+
+    WorkerProcess( const WorkerProcess& ) = delete;
+    WorkerProcess& operator=( const WorkerProcess& ) = delete;
+
+    // Runs 'executable' with 'args', which don't include the program name.  Without 'pipes', the worker shares our stdin and
+    //  stdout, and can't be read or written
+    bool Start( const std::string& executable, const std::vector<std::string>& args, bool pipes = true );
+    bool IsRunning() const;
+
+    // True once a worker has ended by itself, after which it isn't running
+    bool HasExited();
+
+    // Closes the worker's stdin, which is its signal to exit, and waits until it has
+    void Stop();
+
+    // Kills the worker, unless it has already died, and waits for it.  Returns how it ended, e.g. "signal 11"
+    std::string Reap();
+
+    // True once the worker's stdout can be read without blocking, or has been closed.  False if it is still silent after timeoutMs
+    bool Poll( int timeoutMs );
+
+    // False on error, or if the worker closed its stdout first.  As for ByteStream, the error is "Connection closed" only if it
+    //  did so before sending any of the data
+    virtual bool Read( void* data, size_t size ) override;
+    virtual bool Write( const void* data, size_t size ) override;
+
+    virtual const std::string& GetError() const override { return m_Error; }
+
+private:
+    void ClosePipes();
+    std::string Wait();
+
+    intptr_t m_Process = -1;    // a pid, or a process handle
+    intptr_t m_In = -1;         // the worker's stdin
+    intptr_t m_Out = -1;        // the worker's stdout
+    std::string m_Error;
+};
+
+// The path of the running executable, for starting copies of it.  'argv0' is used where the OS can't tell us
+std::string GetExecutablePath( const char* argv0 );
+
+#endif
@@ -0,0 +1,143 @@
+#
+#  Measures the round-trip latency of compiling one shader, three ways:
+#     cold    a new tool process for every compile, as integrators do today
+#     client  a new 'client' process for every compile, talking to a running server
+#     socket  requests sent straight to a running server over one connection
+#
+#   Usage:  python server_latency.py <path_to_executable> [-n iterations] [job options] <shader>
+#     Job options are passed through unchanged, for example:  -s dxbc --api dx11 -c Skylake shader.dxbc
+#     The compiler library may be overridden by setting INTEL_GPU_COMPILER, for example to the mock compiler
+#
+#   The protocol is described in CompileServer.h
+#
+
+import os;
+import socket;
+import struct;
+import subprocess;
+import sys;
+import tempfile;
+import time;
+
+MAGIC       = 0x53415349
+COMPILE     = 1
+SHUTDOWN    = 2
+ISA         = 16
+ERROR_TEXT  = 17
+DONE        = 18
+
+ARGUMENT    = 1
+INPUT       = 2
+ROOTSIG     = 3
+TEXT        = 5
+STATUS      = 6
+
+def field(tag, data):
+    return struct.pack('<II', tag, len(data)) + data;
+
+def message(type, payload):
+    return struct.pack('<III', MAGIC, type, len(payload)) + payload;
+
+def read_exactly(sock, size):
+    data = b'';
+    while len(data) < size:
+        chunk = sock.recv(size - len(data));
+        if not chunk:
+            raise RuntimeError('server closed the connection');
+        data += chunk;
+    return data;
+
+def read_message(sock):
+    magic, type, size = struct.unpack('<III', read_exactly(sock, 12));
+    if magic != MAGIC:
+        raise RuntimeError('malformed reply');
+    payload = read_exactly(sock, size);
+    fields = {};
+    offset = 0;
+    while offset + 8 <= len(payload):
+        tag, length = struct.unpack_from('<II', payload, offset);
+        fields[tag] = payload[offset+8 : offset+8+length];
+        offset += 8 + length;
+    return type, fields;
+
+# returns True if the compile succeeded
+def compile_over_socket(sock, request):
+    sock.sendall(request);
+    while True:
+        type, fields = read_message(sock);
+        if type == ERROR_TEXT:
+            print('    server: ' + fields.get(TEXT, b'').decode(errors='replace'));
+        elif type == DONE:
+            return struct.unpack('<I', fields.get(STATUS, b'\0\0\0\0'))[0] == 0;
+
+def make_request(args):
+    payload = b'';
+    i = 0;
+    while i < len(args):
+        if args[i] == '--rootsig_file':
+            payload += field(ROOTSIG, open(args[i+1], 'rb').read());
+            i += 2;
+            continue;
+        payload += field(ARGUMENT, args[i].encode());
+        i += 1;
+    payload += field(INPUT, open(args[-1], 'rb').read());
+    return message(COMPILE, payload);
+
+def percentile(samples, p):
+    ordered = sorted(samples);
+    index = min(len(ordered) - 1, int(round(p / 100.0 * (len(ordered) - 1))));
+    return ordered[index];
+
+def report(name, samples):
+    print('%-8s  %6d  %9.2f  %9.2f  %9.2f' % (name, len(samples), percentile(samples, 50), percentile(samples, 99),
+                                              sum(samples) / len(samples)));
+
+def time_runs(iterations, run):
+    samples = [];
+    for i in range(0, iterations):
+        start = time.perf_counter();
+        if not run():
+            print('Compile failed');
+            sys.exit(1);
+        samples.append((time.perf_counter() - start) * 1000.0);
+    return samples;
+
+if len(sys.argv) < 3:
+    print('Usage:  python server_latency.py <path_to_executable> [-n iterations] [job options] <shader>');
+    sys.exit(1);
+
+exe = sys.argv[1];
+args = sys.argv[2:];
+iterations = 100;
+if args[0] == '-n':
+    iterations = int(args[1]);
+    args = args[2:];
+
+workdir = tempfile.mkdtemp();
+socket_path = os.path.join(workdir, 'server.sock');
+isa_prefix = os.path.join(workdir, 'isa_');
+devnull = open(os.devnull, 'w');
+
+server = subprocess.Popen([exe, '--serve', socket_path], stdout=devnull);
+sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM);
+for attempt in range(0, 500):
+    try:
+        sock.connect(socket_path);
+        break;
+    except OSError:
+        time.sleep(0.01);
+
+request = make_request(args);
+
+# the first request creates the server's compiler contexts
+compile_over_socket(sock, request);
+
+print('mode       runs   p50 (ms)   p99 (ms)  mean (ms)');
+report('cold', time_runs(iterations, lambda: subprocess.call([exe, '--isa', isa_prefix] + args, stdout=devnull) == 0));
+report('client', time_runs(iterations, lambda: subprocess.call([exe, 'client', socket_path, '--isa', isa_prefix] + args, stdout=devnull) == 0));
+report('socket', time_runs(iterations, lambda: compile_over_socket(sock, request)));
+
+sock.sendall(message(SHUTDOWN, b''));
+read_message(sock);
+sock.close();
+server.wait();
@@ -0,0 +1,371 @@
+#
+#  Measures the tool's throughput and latency over a corpus of shaders, and compares the results with a stored baseline.
+#
+#   The corpus is every compile job in tests/cases which is expected to succeed, plus generated DXBC containers, small
+#   and large.  On Windows, generated HLSL shaders are added too.  Each scenario runs the whole corpus:
+#     process          a new tool process for every shader
+#     batch            one --batch run over the corpus
+#     batch_threads    the same, compiling every device at once with -j 0
+#
+#   For each scenario it reports shaders per second, per-shader latency percentiles, the peak resident set size of
+#   the tool, and the bytes of output it wrote.  Each scenario is run several times and the best run is kept.
+#
+#   Usage:  python throughput.py <path_to_executable> [options]
+#     --iterations <n>               times each shader appears in the corpus.  Default 3
+#     --repeat <n>                   runs of each scenario.  Default 3
+#     --scenario <name>              only run the given scenario.  May be repeated
+#     --save <file>                  write the results as JSON, for use as a baseline
+#     --baseline <file>              compare with a baseline, and exit with 1 if anything regressed
+#     --threshold <metric>=<percent> allowed regression for a metric, e.g. p95_ms=20.  'all' sets every metric
+#     --noise-ms <ms>                latency changes smaller than this are never regressions.  Default 0.5
+#     Any other options, such as --compiler, are passed to the tool
+#
+#   The compiler library may be overridden by setting INTEL_GPU_COMPILER, for example to the mock compiler, which
+#    makes the numbers independent of the driver.  MOCK_COMPILER_COMPILE_MS adds a fixed compile time per shader
+#
+
+import json;
+import os;
+import random;
+import shutil;
+import struct;
+import subprocess;
+import sys;
+import tempfile;
+import time;
+
+tests_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'tests');
+
+# metric:  (higher is better, default threshold in percent)
+METRICS = {
+    'shaders_per_sec':  (True,  10.0),
+    'p50_ms':           (False, 10.0),
+    'p95_ms':           (False, 15.0),
+    'p99_ms':           (False, 25.0),
+    'peak_rss_kb':      (False, 10.0),
+    'bytes_written':    (False, 1.0),
+};
+LATENCY_METRICS = ('p50_ms', 'p95_ms', 'p99_ms');
+
+# per-job options which compile the shader and nothing more.  A test line using any other option is left out
+JOB_FLAGS = ('--serialize-backend',);
+JOB_OPTIONS = ('-s', '--api', '-p', '--profile', '-f', '--function', '-D', '-c', '--asic', '--rootsig_file', '--rootsig_macro',
+               '--rootsig_profile', '--DXFlags', '--DXLocation', '-j', '--threads', '--isa', '--id');
+
+############################################################################################################
+#  Corpus
+############################################################################################################
+
+# The compile jobs in one test case, as argument lists.  Paths are made absolute, so jobs can run from anywhere
+def jobs_from_test_case(path, features):
+    lines = open(path, 'r').readlines();
+    for line in lines:
+        tokens = line.split();
+        if len(tokens) > 1 and tokens[0] == '@REQUIRES' and tokens[1] not in features:
+            return [];
+
+    jobs = [];
+    for line in lines:
+        tokens = line.split();
+        if len(tokens) == 0:
+            continue;
+        if tokens[0] == '@END':
+            break;
+        if tokens[0] != '@DO' or len(tokens) < 3 or tokens[1] != '$EXE$' or not tokens[2].startswith('-'):
+            continue;
+
+        args = [];
+        tokens = tokens[2:];
+        i = 0;
+        usable = True;
+        while i < len(tokens) and usable:
+            tok = tokens[i].replace('$PATH$', path).replace('$DIR$', os.path.join(tests_dir, 'cases'));
+            if tok in JOB_OPTIONS and i + 1 < len(tokens):
+                value = tokens[i+1].replace('$PATH$', path).replace('$DIR$', os.path.join(tests_dir, 'cases'));
+                if tok == '--rootsig_file':
+                    value = os.path.join(tests_dir, value);
+                    usable = os.path.isfile(value);
+                # outputs and threading are up to the scenario
+                if tok not in ('--isa', '-j', '--threads'):
+                    args += [tok, value];
+                i += 1;
+            elif tok in JOB_FLAGS:
+                args.append(tok);
+            elif tok.startswith('-') or tok in ('>', '|', '&&', ';'):
+                usable = False;
+            else:
+                args.append(os.path.join(tests_dir, tok));
+            i += 1;
+
+        if usable and len(args) > 0 and os.path.isfile(args[-1]):
+            jobs.append(args);
+    return jobs;
+
+# A DXBC container holding a shader program of the given size.  The mock compiler's output grows with the program
+def make_dxbc(size, seed):
+    rng = random.Random(seed);
+    program = b'SHEX' + struct.pack('<I', size) + bytes(rng.getrandbits(8) for i in range(size));
+    header_size = 32 + 4;
+    total = header_size + len(program);
+    return b'DXBC' + b'\0' * 16 + struct.pack('<IIII', 1, total, 1, header_size) + program;
+
+# A pixel shader with roughly 'statements' lines of arithmetic
+def make_hlsl(statements, seed):
+    rng = random.Random(seed);
+    lines = ['float4 main( float4 uv : uv ) : SV_Target', '{', '    float4 v = uv;'];
+    for i in range(statements):
+        lines.append('    v = %s( v * %.3f + %.3f );' % (rng.choice(['sin', 'cos', 'sqrt', 'abs', 'frac']), rng.random(), rng.random()));
+    lines += ['    return v;', '}'];
+    return '\n'.join(lines) + '\n';
+
+def build_corpus(workdir, features):
+    corpus = [];
+    cases = os.path.join(tests_dir, 'cases');
+    for file in sorted(os.listdir(cases)):
+        path = os.path.join(cases, file);
+        if os.path.isfile(path):
+            corpus += jobs_from_test_case(path, features);
+
+    # the same job often appears in several test cases
+    unique = [];
+    for job in corpus:
+        if job not in unique:
+            unique.append(job);
+    corpus = unique;
+
+    generated = os.path.join(workdir, 'generated');
+    os.mkdir(generated);
+    for i, size in enumerate([256] * 8 + [16 * 1024] * 2 + [128 * 1024]):
+        path = os.path.join(generated, 'shader_%d.dxbc' % i);
+        open(path, 'wb').write(make_dxbc(size, i));
+        corpus.append(['-s', 'dxbc', '--api', 'dx11', path]);
+
+    if 'hlsl' in features:
+        for i, statements in enumerate([8] * 4 + [2000]):
+            path = os.path.join(generated, 'shader_%d.hlsl' % i);
+            open(path, 'w').write(make_hlsl(statements, i));
+            corpus.append(['-s', 'hlsl', '--api', 'dx11', '-p', 'ps_5_0', path]);
+
+    return corpus;
+
+############################################################################################################
+#  Measurement
+############################################################################################################
+
+# Runs a command, and returns its exit code, wall time in seconds, and peak resident set size in KB (0 if unknown)
+def run(command, stdout):
+    start = time.perf_counter();
+    process = subprocess.Popen(command, stdout=stdout, stderr=subprocess.STDOUT);
+    if hasattr(os, 'wait4'):
+        pid, status, usage = os.wait4(process.pid, 0);
+        seconds = time.perf_counter() - start;
+        process.returncode = os.waitstatus_to_exitcode(status) if hasattr(os, 'waitstatus_to_exitcode') else (status >> 8);
+        # Linux reports KB, macOS bytes
+        rss = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss;
+        return process.returncode, seconds, rss;
+    process.wait();
+    return process.returncode, time.perf_counter() - start, 0;
+
+def directory_size(path):
+    total = 0;
+    for root, dirs, files in os.walk(path):
+        for f in files:
+            total += os.path.getsize(os.path.join(root, f));
+    return total;
+
+# Nearest-rank percentile
+def percentile(samples, p):
+    ordered = sorted(samples);
+    rank = max(1, int(-(-p * len(ordered) // 100)));
+    return ordered[rank - 1];
+
+def summarize(n_shaders, seconds, latencies, rss, bytes_written):
+    return {
+        'shaders': n_shaders,
+        'shaders_per_sec': n_shaders / seconds,
+        'p50_ms': percentile(latencies, 50),
+        'p95_ms': percentile(latencies, 95),
+        'p99_ms': percentile(latencies, 99),
+        'peak_rss_kb': rss,
+        'bytes_written': bytes_written,
+    };
+
+def run_process_scenario(exe, tool_args, corpus, outdir, log):
+    latencies = [];
+    peak = 0;
+    start = time.perf_counter();
+    for i, job in enumerate(corpus):
+        prefix = os.path.join(outdir, 'job%d_' % i);
+        code, seconds, rss = run([exe] + tool_args + ['--isa', prefix] + job, log);
+        if code != 0:
+            raise RuntimeError('job failed: ' + ' '.join(job));
+        latencies.append(seconds * 1000.0);
+        peak = max(peak, rss);
+    seconds = time.perf_counter() - start;
+    return summarize(len(corpus), seconds, latencies, peak, directory_size(outdir));
+
+def run_batch_scenario(exe, tool_args, corpus, outdir, log, extra):
+    manifest = os.path.join(outdir, '..', os.path.basename(outdir) + '.manifest');
+    summary = os.path.join(outdir, '..', os.path.basename(outdir) + '.csv');
+    with open(manifest, 'w') as f:
+        for i, job in enumerate(corpus):
+            f.write(' '.join('"%s"' % arg for arg in ['--isa', os.path.join(outdir, 'job%d_' % i)] + job) + '\n');
+
+    code, seconds, rss = run([exe] + tool_args + extra + ['--batch', manifest, '--summary', summary], log);
+    if code != 0:
+        raise RuntimeError('batch failed');
+
+    latencies = [];
+    for line in open(summary, 'r').readlines()[1:]:
+        latencies.append(float(line.split(',')[3]));
+    return summarize(len(corpus), seconds, latencies, rss, directory_size(outdir));
+
+SCENARIOS = {
+    'process':       lambda exe, args, corpus, outdir, log: run_process_scenario(exe, args, corpus, outdir, log),
+    'batch':         lambda exe, args, corpus, outdir, log: run_batch_scenario(exe, args, corpus, outdir, log, []),
+    'batch_threads': lambda exe, args, corpus, outdir, log: run_batch_scenario(exe, args, corpus, outdir, log, ['-j', '0']),
+};
+SCENARIO_ORDER = ['process', 'batch', 'batch_threads'];
+
+# The best of several runs:  the one with the highest throughput
+def measure(name, exe, tool_args, corpus, workdir, repeat, log):
+    best = None;
+    for r in range(repeat):
+        outdir = os.path.join(workdir, '%s_%d' % (name, r));
+        os.mkdir(outdir);
+        result = SCENARIOS[name](exe, tool_args, corpus, outdir, log);
+        shutil.rmtree(outdir);
+        if best is None or result['shaders_per_sec'] > best['shaders_per_sec']:
+            best = result;
+    return best;
+
+############################################################################################################
+#  Baseline comparison
+############################################################################################################
+
+# Returns a list of regression descriptions
+def compare(results, baseline, thresholds, noise_ms):
+    regressions = [];
+    for scenario in SCENARIO_ORDER:
+        if scenario not in results or scenario not in baseline:
+            continue;
+        if results[scenario]['shaders'] != baseline[scenario]['shaders']:
+            print('%s: the corpus has changed size since the baseline was taken (%d shaders, was %d)' %
+                  (scenario, results[scenario]['shaders'], baseline[scenario]['shaders']));
+
+        for metric in sorted(METRICS):
+            higher_is_better = METRICS[metric][0];
+            current = results[scenario][metric];
+            previous = baseline[scenario].get(metric, 0);
+            if previous == 0:
+                continue;
+
+            change = 100.0 * (current - previous) / previous;
+            worse = -change if higher_is_better else change;
+            if metric in LATENCY_METRICS and abs(current - previous) < noise_ms:
+                continue;
+            if worse > thresholds[metric]:
+                regressions.append('%s %s: %.3f, baseline %.3f (%+.1f%%, allowed %.1f%%)' %
+                                   (scenario, metric, current, previous, change, thresholds[metric]));
+    return regressions;
+
+def print_results(results):
+    print('scenario          shaders  shaders/s   p50 (ms)   p95 (ms)   p99 (ms)  peak RSS (KB)  bytes written');
+    for scenario in SCENARIO_ORDER:
+        if scenario in results:
+            r = results[scenario];
+            print('%-16s  %7d  %9.1f  %9.2f  %9.2f  %9.2f  %13d  %13d' % (scenario, r['shaders'], r['shaders_per_sec'], r['p50_ms'],
+                                                                      r['p95_ms'], r['p99_ms'], r['peak_rss_kb'], r['bytes_written']));
+
+def usage():
+    print('Usage:  python throughput.py <path_to_executable> [--iterations n] [--repeat n] [--scenario name] [--save file]');
+    print('                             [--baseline file] [--threshold metric=percent] [--noise-ms ms] [tool options]');
+    sys.exit(1);
+
+if len(sys.argv) < 2:
+    usage();
+
+exe = os.path.abspath(sys.argv[1]);
+iterations = 3;
+repeat = 3;
+scenarios = [];
+save_file = None;
+baseline_file = None;
+thresholds = dict((metric, METRICS[metric][1]) for metric in METRICS);
+noise_ms = 0.5;
+tool_args = [];
+
+args = sys.argv[2:];
+i = 0;
+while i < len(args):
+    arg = args[i];
+    value = args[i+1] if i + 1 < len(args) else None;
+    if arg in ('--iterations', '--repeat', '--scenario', '--save', '--baseline', '--threshold', '--noise-ms') and value is None:
+        usage();
+    if arg == '--iterations':
+        iterations = int(value);
+    elif arg == '--repeat':
+        repeat = int(value);
+    elif arg == '--scenario':
+        if value not in SCENARIOS:
+            print('Unknown scenario: ' + value + '.  Use one of: ' + ', '.join(SCENARIO_ORDER));
+            sys.exit(1);
+        scenarios.append(value);
+    elif arg == '--save':
+        save_file = value;
+    elif arg == '--baseline':
+        baseline_file = value;
+    elif arg == '--threshold':
+        metric, percent = value.split('=');
+        if metric != 'all' and metric not in METRICS:
+            print('Unknown metric: ' + metric + '.  Use one of: all, ' + ', '.join(sorted(METRICS)));
+            sys.exit(1);
+        for m in (METRICS if metric == 'all' else [metric]):
+            thresholds[m] = float(percent);
+    elif arg == '--noise-ms':
+        noise_ms = float(value);
+    else:
+        tool_args.append(arg);
+        i += 1;
+        continue;
+    i += 2;
+
+if not scenarios:
+    scenarios = SCENARIO_ORDER;
+
+features = ['hlsl'] if sys.platform == 'win32' else ['posix'];
+if 'MockCompiler' in os.environ.get('INTEL_GPU_COMPILER', '') or any('MockCompiler' in arg for arg in tool_args):
+    features.append('mock');
+
+workdir = tempfile.mkdtemp();
+log = open(os.path.join(workdir, 'tool.log'), 'w');
+try:
+    corpus = build_corpus(workdir, features) * iterations;
+    print('Corpus: %d shaders' % len(corpus));
+
+    results = {};
+    for name in scenarios:
+        results[name] = measure(name, exe, tool_args, corpus, workdir, repeat, log);
+    print_results(results);
+except RuntimeError as e:
+    log.close();
+    print('Benchmark failed: %s.  Tool output was:' % e);
+    print(open(os.path.join(workdir, 'tool.log'), 'r').read());
+    shutil.rmtree(workdir);
+    sys.exit(1);
+
+log.close();
+shutil.rmtree(workdir);
+
+if save_file:
+    with open(save_file, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True);
+        f.write('\n');
+
+if baseline_file:
+    regressions = compare(results, json.load(open(baseline_file, 'r')), thresholds, noise_ms);
+    for r in regressions:
+        print('REGRESSION: ' + r);
+    if regressions:
+        sys.exit(1);
+    print('No regressions against ' + baseline_file);
@@ -0,0 +1,8 @@
+(W) mov (8|M0) r1.0<1>:f r2.0<8;8,1>:f
+L0:
+(W) add (8|M0) r1.0<1>:f r2.0<8;8,1>:f r3.0<8;8,1>:f
+(f0.0) break (8|M0) L1 r4.0<0;1,0>:d
+(W) while (8|M0) L0
+L1:
+(W) add (8|M0) r1.0<1>:f r2.0<8;8,1>:f r3.0<8;8,1>:f
+(W) send (8|M0) null r5 0xC 0x02000010 {EOT}
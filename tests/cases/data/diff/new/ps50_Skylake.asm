@@ -0,0 +1,48 @@
+// Mock Intel GPU compiler (new driver)
+// API: dx11  Platform: Skylake
+// SIMD8 kernel
+         send (8|M0)              r45:f            r73:ud           0xA              0x02106E00       // dataport read
+BB_10:
+         shr (8|M0)               r17.0<1>:f       r80.4<8;8,1>:f   r101.4<8;8,1>:f
+         dp4 (8|M0)               r94.0<1>:f       r10.0<8;8,1>:f   r52.5<0;1,0>:f
+(W)      shl (8|M0)               r24.0<1>:f       r59.6<0;1,0>:f    r108.3<8;8,1>:f
+         shr (8|M0)               r87.0<1>:f       0x693C:f         0x4505:f
+         rndd (8|M0)              r94.0<1>:f       r10.4<8;8,1>:f
+         cmp.ge.f0.0 (8|M0)       null<1>:f        r94.1<0;1,0>:f   r10.4<8;8,1>:f
+BB_11:
+(f0.0)   while (8|M0)             BB_10
+         sel (8|M0)               r38.0<1>:f        r87.2<8;8,1>:f   r3.0<8;8,1>:f
+         add (8|M0)               r17.0<1>:f       r66.2<0;1,0>:f   r31.0<8;8,1>:f
+         send (8|M0)              r87:f            r3:ud           0xA              0x02140000       // scratch read (fill)
+         mad (8|M0)               r108.0<1>:f       r94.1<8;8,1>:f   r45.3<8;8,1>:f  r31.6<0;1,0>:f
+         math.exp (8|M0)          r66.0<1>:f       r66.5<8;8,1>:f    null<0;1,0>:f
+         cmp.ne.f0.0 (8|M0)       null<1>:f        r3.7<0;1,0>:f   r31.6<8;8,1>:f
+(f0.0)   if (8|M0)                BB_13               BB_13
+         send (8|M0)              null:f           r12:ud           0xA              0x020E0000       // scratch write (spill)
+         math.fdiv (8|M0)         r101.0<1>:f       r10.2<8;8,1>:f   r10.4<8;8,1>:f
+         mov (8|M0)               r87.0<1>:f       r101.3<8;8,1>:f
+         mad (8|M0)               r87.0<1>:f       r24.3<0;1,0>:f    r10.4<8;8,1>:f   r101.4<8;8,1>:f
+         shr (8|M0)               r66.0<1>:f       r94.2<0;1,0>:f   r3.7<8;8,1>:f
+         shr (8|M0)               r66.0<1>:f        r101.5<8;8,1>:f   r38.5<8;8,1>:f
+         lrp (8|M0)               r10.0<1>:f       r17.6<8;8,1>:f   r108.0<0;1,0>:f   r52.1<8;8,1>:f
+         mul (8|M0)               r80.0<1>:f       0x466F:f         r10.4<8;8,1>:f
+(W)      add (8|M0)               r17.0<1>:f        r59.6<8;8,1>:f   r24.7<0;1,0>:f
+         add (8|M0)               r38.0<1>:f      0x8F21:f         r31.0<8;8,1>:f
+         or (8|M0)                r108.0<1>:f       r52.5<8;8,1>:f   r80.3<8;8,1>:f
+         or (8|M0)                r66.0<1>:f       r94.5<8;8,1>:f   r31.6<0;1,0>:f
+         mad (8|M0)               r24.0<1>:f       r45.6<0;1,0>:f   r10.6<0;1,0>:f   r66.4<8;8,1>:f
+BB_13:
+         endif (8|M0)
+         or (8|M0)                r3.0<1>:f       r59.4<8;8,1>:f   r52.7<0;1,0>:f
+         add (8|M0)               r52.0<1>:f       r38.3<8;8,1>:f   r17.6<8;8,1>:f
+         add (8|M0)               r24.0<1>:f       r59.2<8;8,1>:f   0x4D47:f
+         add (8|M0)               r94.0<1>:f       r94.2<8;8,1>:f   r80.2<8;8,1>:f
+         add (8|M0)               r101.0<1>:f       r17.0<8;8,1>:f    r10.1<0;1,0>:f
+         shr (8|M0)               r94.0<1>:f       r108.6<8;8,1>:f   r101.4<8;8,1>:f
+         frc (8|M0)               r10.0<1>:f       r38.6<8;8,1>:f
+         add (8|M0)               r52.0<1>:f       r10.4<8;8,1>:f    r108.4<8;8,1>:f
+         lrp (8|M0)               r73.0<1>:f       r101.2<8;8,1>:f   r73.0<8;8,1>:f  0xC434:f
+         shr (8|M0)               r59.0<1>:f      r94.3<8;8,1>:f   r108.0<8;8,1>:f
+         rndd (8|M0)              r87.0<1>:f       r73.4<8;8,1>:f
+         send (8|M0)              null             r108:ud          0x27             0x02000010       {EOT}            // thread spawner
+
@@ -0,0 +1,47 @@
+// Mock Intel GPU compiler
+// API: dx11  Platform: Skylake
+// SIMD8 kernel
+         send (8|M0)              r70:f            r90:ud           0xA              0x02106E00       // dataport read
+L0:
+         shr (8|M0)               r18.0<1>:f       r75.4<8;8,1>:f   r30.4<8;8,1>:f
+         dp4 (8|M0)               r77.0<1>:f       r33.0<8;8,1>:f   r71.5<0;1,0>:f
+(W)      shl (8|M0)               r51.0<1>:f       r8.6<0;1,0>:f    r111.3<8;8,1>:f
+         shr (8|M0)               r92.0<1>:f       0x693C:f         0x4505:f
+         rndd (8|M0)              r93.0<1>:f       r97.4<8;8,1>:f
+         cmp.ge.f0.0 (8|M0)       null<1>:f        r93.1<0;1,0>:f   r49.4<8;8,1>:f
+L1:
+(f0.0)   while (8|M0)             L0
+         add (8|M0)               r67.0<1>:f       r56.2<8;8,1>:f   0x4D47:f
+         add (8|M0)               r29.0<1>:f       r45.2<8;8,1>:f   r11.2<8;8,1>:f
+         add (8|M0)               r14.0<1>:f       r2.0<8;8,1>:f    r81.1<0;1,0>:f
+         sel (8|M0)               r5.0<1>:f        r60.2<8;8,1>:f   r48.0<8;8,1>:f
+         add (8|M0)               r34.0<1>:f       r89.2<0;1,0>:f   r20.0<8;8,1>:f
+         send (8|M0)              r28:f            r64:ud           0xA              0x02140000       // scratch read (fill)
+         mad (8|M0)               r79.0<1>:f       r77.1<8;8,1>:f   r102.3<8;8,1>:f  r52.6<0;1,0>:f
+         math.exp (8|M0)          r73.0<1>:f       r9.5<8;8,1>:f    null<0;1,0>:f
+         cmp.ne.f0.0 (8|M0)       null<1>:f        r80.7<0;1,0>:f   r100.6<8;8,1>:f
+(f0.0)   if (8|M0)                L3               L3
+         math.fdiv (8|M0)         r78.0<1>:f       r65.2<8;8,1>:f   r33.4<8;8,1>:f
+         mov (8|M0)               r44.0<1>:f       r62.3<8;8,1>:f
+         frc (8|M0)               r42.0<1>:f       r3.5<8;8,1>:f
+         mad (8|M0)               r28.0<1>:f       r3.3<0;1,0>:f    r81.4<8;8,1>:f   r14.4<8;8,1>:f
+         shr (8|M0)               r41.0<1>:f       r29.2<0;1,0>:f   r64.7<8;8,1>:f
+         shr (8|M0)               r9.0<1>:f        r94.5<8;8,1>:f   r85.5<8;8,1>:f
+         lrp (8|M0)               r17.0<1>:f       r18.6<8;8,1>:f   r31.0<0;1,0>:f   r87.1<8;8,1>:f
+         mul (8|M0)               r91.0<1>:f       0x466F:f         r49.4<8;8,1>:f
+(W)      add (8|M0)               r2.0<1>:f        r40.6<8;8,1>:f   r3.7<0;1,0>:f
+         add (8|M0)               r101.0<1>:f      0x8F21:f         r52.0<8;8,1>:f
+         or (8|M0)                r15.0<1>:f       r23.5<8;8,1>:f   r43.3<8;8,1>:f
+         or (8|M0)                r57.0<1>:f       r77.5<8;8,1>:f   r52.6<0;1,0>:f
+         mad (8|M0)               r51.0<1>:f       r86.6<0;1,0>:f   r17.6<0;1,0>:f   r57.4<8;8,1>:f
+L3:
+         endif (8|M0)
+         or (8|M0)                r96.0<1>:f       r40.4<8;8,1>:f   r7.7<0;1,0>:f
+         add (8|M0)               r55.0<1>:f       r53.3<8;8,1>:f   r98.6<8;8,1>:f
+         shr (8|M0)               r77.0<1>:f       r31.6<8;8,1>:f   r62.4<8;8,1>:f
+         frc (8|M0)               r33.0<1>:f       r53.6<8;8,1>:f
+         add (8|M0)               r39.0<1>:f       r1.4<8;8,1>:f    r111.4<8;8,1>:f
+         lrp (8|M0)               r90.0<1>:f       r30.2<8;8,1>:f   r106.0<8;8,1>:f  0xC434:f
+         shr (8|M0)               r104.0<1>:f      r61.3<8;8,1>:f   r79.0<8;8,1>:f
+         rndd (8|M0)              r92.0<1>:f       r90.4<8;8,1>:f
+         send (8|M0)              null             r127:ud          0x27             0x02000010       {EOT}            // thread spawner
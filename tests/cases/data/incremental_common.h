@@ -0,0 +1,7 @@
+// included by incremental_hlsl.txt
+
+#ifdef USE_ALTERNATE_VALUE
+#define INCREMENTAL_VALUE 1
+#else
+#define INCREMENTAL_VALUE 2
+#endif
@@ -0,0 +1,2 @@
+L0:
+(W) add (8|M0) r1.0<1>:f r2.0<8;8,1>:f r3.0<8;8,1>:f r4.0<8;8,1>:f L0
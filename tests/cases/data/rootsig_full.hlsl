@@ -0,0 +1,14 @@
+// Every kind of root signature element, for comparing the native root signature compiler against a known layout
+#define FullRS \
+    "RootFlags( ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT | DENY_HULL_SHADER_ROOT_ACCESS ), " \
+    "RootConstants( num32BitConstants = 4, b1, space = 2, visibility = SHADER_VISIBILITY_VERTEX ), " \
+    "CBV( b0, flags = DATA_STATIC ), " \
+    "UAV( u3, space = 1, visibility = SHADER_VISIBILITY_PIXEL ), " \
+    "DescriptorTable( SRV( t0, numDescriptors = unbounded, flags = DESCRIPTORS_VOLATILE ), " \
+                     "CBV( b2, numDescriptors = 2, offset = 8 ), visibility = SHADER_VISIBILITY_PIXEL ), " \
+    "DescriptorTable( Sampler( s1, numDescriptors = 3, space = 4 ) ), " \
+    "StaticSampler( s0 ), " \
+    "StaticSampler( s2, filter = FILTER_COMPARISON_MIN_MAG_MIP_LINEAR, addressU = TEXTURE_ADDRESS_BORDER, " \
+                   "mipLODBias = -0.5f, maxAnisotropy = 8, comparisonFunc = COMPARISON_GREATER, " \
+                   "borderColor = STATIC_BORDER_COLOR_OPAQUE_BLACK, minLOD = 1.0, maxLOD = 12, " \
+                   "visibility = SHADER_VISIBILITY_PIXEL )"
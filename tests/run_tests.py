@@ -10,6 +10,13 @@
 #      $DIR$ is replaced with the path to the test directory
 #      $EXE$ is the path to the test executable
 #
+#   A test file containing '@REQUIRES hlsl' is skipped on platforms without the D3D compiler.
+#    '@REQUIRES mock' marks tests which depend on the behavior of the mock compiler
+#    '@REQUIRES posix' marks tests which need a POSIX shell, for example to run commands in the background
+#
+#   Usage:  python run_tests.py [path_to_executable]
+#     The compiler library may be overridden by setting INTEL_GPU_COMPILER, for example to the mock compiler
+#
 
 import os;
 import sys;
@@ -17,8 +24,18 @@ import subprocess;
 
 test_path   = './cases'
 binary_path = 'IntelShaderAnalyzer.exe'
+if len(sys.argv) > 1:
+    binary_path = sys.argv[1];
 
-for file in os.listdir(test_path):
+features = [];
+if sys.platform == 'win32':
+    features.append('hlsl');
+else:
+    features.append('posix');
+if 'MockCompiler' in os.environ.get('INTEL_GPU_COMPILER', ''):
+    features.append('mock');
+
+for file in sorted(os.listdir(test_path)):
     
     fullpath = os.path.join(test_path, file);
 
@@ -29,6 +46,16 @@ for file in os.listdir(test_path):
         lines = f.readlines();
         f.close();
 
+        missing = [];
+        for line in lines :
+            tokens = line.split();
+            if len(tokens) > 1 and tokens[0] == "@REQUIRES" and tokens[1] not in features:
+                missing.append(tokens[1]);
+
+        if len(missing) > 0:
+            print('    SKIPPED: requires ' + ' '.join(missing));
+            continue;
+
         #  extract commands
         commands = [];
         expect_fail = [];
@@ -70,16 +97,16 @@ for file in os.listdir(test_path):
             print('    COMMAND: ' + command);
             sys.stdout.flush();
             
-            result = os.system( command );
+            result = subprocess.call( command, shell=True );
             fail = (result != 0);
 
             if( result != 0 and result != 1 ):
                 print( '   UNEXPECTED RETURN CODE: ' + str(result) + ' TEST FAILED!' );
-                sys.exit();
+                sys.exit(1);
 
             if (result == 0 and expect_fail[i]) or (result == 1 and not expect_fail[i]):
                 print( 'WRONG RETURN CODE: TEST FAILED!!!!!!!' )
-                sys.exit();
+                sys.exit(1);
 
 
 print( 'TEST PASSED')
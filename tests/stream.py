@@ -0,0 +1,91 @@
+#
+#  Writes and reads the records used with '-' as the input file or --isa prefix, for tests and as an example.
+#
+#   Usage:  python stream.py pack [--arg <argument>]... [--rootsig <file>] <shader>  >> records.bin
+#             Appends one COMPILE record for a shader.  Each --arg is a command line option for this shader alone
+#           python stream.py unpack <isa_prefix>  < results.bin
+#             Writes <isa_prefix><record>_<platform>.asm (or .bin) for each result, and prints errors.  Exits with 1
+#             if any record failed
+#
+#   The format is the compile server's, and is described in CompileServer.h
+#
+
+import struct;
+import sys;
+
+MAGIC       = 0x53415349
+COMPILE     = 1
+ISA         = 16
+ERROR_TEXT  = 17
+DONE        = 18
+
+ARGUMENT    = 1
+INPUT       = 2
+ROOTSIG     = 3
+PLATFORM    = 4
+TEXT        = 5
+STATUS      = 6
+BINARY      = 7
+
+def field(tag, data):
+    return struct.pack('<II', tag, len(data)) + data;
+
+def pack(args):
+    payload = b'';
+    i = 0;
+    while i < len(args) - 1:
+        if args[i] == '--arg':
+            payload += field(ARGUMENT, args[i+1].encode());
+        elif args[i] == '--rootsig':
+            payload += field(ROOTSIG, open(args[i+1], 'rb').read());
+        else:
+            print('Unknown option: ' + args[i]);
+            sys.exit(1);
+        i += 2;
+    payload += field(INPUT, open(args[-1], 'rb').read());
+    sys.stdout.buffer.write(struct.pack('<III', MAGIC, COMPILE, len(payload)) + payload);
+
+def unpack(prefix):
+    data = sys.stdin.buffer.read();
+    offset = 0;
+    record = 1;
+    failed = False;
+    while offset < len(data):
+        magic, type, size = struct.unpack_from('<III', data, offset);
+        if magic != MAGIC or offset + 12 + size > len(data):
+            print('Malformed message');
+            sys.exit(1);
+        payload = data[offset+12 : offset+12+size];
+        offset += 12 + size;
+
+        fields = {};
+        i = 0;
+        while i + 8 <= len(payload):
+            tag, length = struct.unpack_from('<II', payload, i);
+            fields[tag] = payload[i+8 : i+8+length];
+            i += 8 + length;
+
+        if type == ISA:
+            platform = fields[PLATFORM].decode();
+            if TEXT in fields:
+                open('%s%d_%s.asm' % (prefix, record, platform), 'wb').write(fields[TEXT]);
+            if BINARY in fields:
+                open('%s%d_%s.bin' % (prefix, record, platform), 'wb').write(fields[BINARY]);
+        elif type == ERROR_TEXT:
+            print('%d: %s' % (record, fields.get(TEXT, b'').decode(errors='replace')));
+        elif type == DONE:
+            if struct.unpack('<I', fields.get(STATUS, b'\0\0\0\0'))[0] != 0:
+                failed = True;
+            record += 1;
+
+    print('%d records' % (record - 1));
+    sys.exit(1 if failed else 0);
+
+if len(sys.argv) >= 3 and sys.argv[1] == 'pack':
+    pack(sys.argv[2:]);
+elif len(sys.argv) == 3 and sys.argv[1] == 'unpack':
+    unpack(sys.argv[2]);
+else:
+    print('Usage:  python stream.py pack [--arg <argument>]... [--rootsig <file>] <shader>');
+    print('        python stream.py unpack <isa_prefix>');
+    sys.exit(1);